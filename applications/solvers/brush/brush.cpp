@@ -85,6 +85,9 @@ int main(int argc, char* argv[])
     std::string partsolnfile("partsoln.xml");
     std::string tranfile("");
 
+    // Directory of cached mechanisms, none if empty.
+    std::string cachedir("");
+
     // Offset for random number sequence so that independent realisations
     // can be computed in separated program instances.
     size_t randomSeedOffset = 0;
@@ -132,6 +135,10 @@ int main(int argc, char* argv[])
             // Verbosity
             diag = atoi(argv[++i]);
         }
+        else if (strcmp(argv[i], "--mechcache") == 0) {
+            // Directory for binary copies of the chemical mechanism.
+            cachedir = argv[++i];
+        }
         else if (strcmp(argv[i], "--premix-chem") == 0) {
             chemFileType = ResetChemistry::Premix;
         }
@@ -328,10 +335,10 @@ int main(int argc, char* argv[])
         // See if there is a transport data file (not needed for advection only)
         if(tranfile.length() > 0)
             // Read species transport data along with rest of mechanism
-            Sprog::IO::MechanismParser::ReadChemkin(chemfile, mech.GasMech(), thermfile, diag, tranfile);
+            Sprog::IO::MechanismParser::ReadChemkinCached(cachedir, chemfile, mech.GasMech(), thermfile, diag, tranfile);
         else
             // Skip species transport data - properties such as thermal conductivity will not be available
-            Sprog::IO::MechanismParser::ReadChemkin(chemfile, mech.GasMech(), thermfile, diag);
+            Sprog::IO::MechanismParser::ReadChemkinCached(cachedir, chemfile, mech.GasMech(), thermfile, diag);
 
         if (diag>0)
             mech.GasMech().WriteDiagnostics("ckmech.diag");
@@ -493,6 +500,7 @@ void printUsage() {
     std::cout << "-s SWEEP-SETTINGS-FILE\n";
     std::cout << "-t THERMODYNAMICAL-DATA-FILE\n";
     std::cout << "-v verbosity (Integer indicating level of debug info, higher integers mean more output)\n";
+    std::cout << "--mechcache DIRECTORY for binary copies of the chemical mechanism, which are read instead of the CK files when these have not changed\n";
     std::cout << "--premix-chem initial chemistry solution file is in Chemkin format\n";
     std::cout << "--premix-alpha initial chemistry solution file as Chemkin format, but with alpha column instead of wDotA4\n";
 }
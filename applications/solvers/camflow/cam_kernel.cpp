@@ -38,8 +38,10 @@
  *  Website :   http://como.cheng.cam.ac.uk
  */
 
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "gpc.h"
 #include "cam_read.h"
 #include "cam_admin.h"
@@ -53,6 +55,7 @@
 #include "cam_models.h"
 #include "cam_soot.h"
 #include "interface.h"
+#include "flamelet_library.h"
 
 
 using namespace std;
@@ -67,6 +70,20 @@ int main(int argc, char *argv[])
     string fTrans("tran.dat");
     string fCamFlow("camflow.xml");
 
+    //camflow-app --mechcache dir ... reads the mechanism through a binary
+    //cache in dir, which is skipped when parsing the other arguments.
+    string fCache("");
+    vector<string> args(argv, argv + argc);
+    for (size_t i = 1; i + 1 < args.size(); ++i)
+    {
+        if (args[i] == "--mechcache")
+        {
+            fCache = args[i+1];
+            args.erase(args.begin() + i, args.begin() + i + 2);
+            break;
+        }
+    }
+
     //mechanism object
     Mechanism mech;
 
@@ -98,12 +115,13 @@ int main(int argc, char *argv[])
     //Prints out the chemistry, thermodynamic and transport data after being successfully parsed.
     if (config.getConfiguration() == config.BATCH_CV)
     {
-        Sprog::IO::MechanismParser::ReadChemkin(fChem, mech, fThermo, 1);
+        Sprog::IO::MechanismParser::ReadChemkinCached(fCache, fChem, mech, fThermo, 1);
     }
     else
     {
-        Sprog::IO::MechanismParser::ReadChemkin
+        Sprog::IO::MechanismParser::ReadChemkinCached
         (
+            fCache,
             fChem,
             mech,
             fThermo,
@@ -128,6 +146,38 @@ int main(int argc, char *argv[])
 //    int dd; cin >> dd;
 //----------------------------------------------------------
 
+    //camflow-app --library sdr.dat [library.bin] solves a steady flamelet for
+    //every SDR listed in sdr.dat and writes them to one binary table.
+    if (args.size() > 2 && args[1] == "--library")
+    {
+        string fLibrary(args.size() > 3 ? args[3] : "flameletLibrary.bin");
+        try
+        {
+            if (config.getConfiguration() != config.FLAMELET &&
+                config.getConfiguration() != config.FLAMELET_NULN)
+                throw CamError("--library requires a flamelet configuration\n");
+
+            ifstream sdrFile(args[2].c_str());
+            if (!sdrFile.good())
+                throw CamError("Could not open " + args[2] + "\n");
+            vector<double> sdr;
+            double value;
+            while (sdrFile >> value) sdr.push_back(value);
+
+            FlameletLibrary library(ca, config, cc, cg, cp, cSoot, mech);
+            library.generate(sdr);
+            library.write(fLibrary);
+        }
+        catch (CamError &ce)
+        {
+            cout<< ce.errorMessage;
+            exit(EXIT_FAILURE);
+        }
+
+        cout << "\nCamflow: End of execution.\n";
+        return (EXIT_SUCCESS);
+    }
+
     try
     {
         models.solve(ca, config, cc, cg, cp, cSoot, mech);
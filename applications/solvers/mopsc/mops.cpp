@@ -56,12 +56,14 @@ int main(int argc, char* argv[])
     string gpfile("");      // Gas-phase profile
     string surfcfile("");   // Surface chemistry
     string surftfile("");   // Surface thermocehmical data
+    string cachedir("");    // Directory of cached mechanisms
 
     // Declare solver options
     size_t rand(0);         // Random seed
     Mops::SolverType soltype = Mops::GPC;
     bool fsurf(false);      // Surface capability on?
     bool fsen(false);       // Sensitivity analysis on?
+    bool frestart(false);   // Continue from the checkpoint file?
 
     // Output options
     int diag(0);            // Diagnostics
@@ -102,6 +104,7 @@ int main(int argc, char* argv[])
         ("sensi,q", po::value(&senfile)->default_value("sensi.xml"), "path to sensitivity analysis")
         ("schem", po::value(&surfcfile)->default_value("surfchem.inp"), "path to surface chemical mechanism")
         ("stherm", po::value(&surftfile)->default_value("surftherm.dat"), "path to surface thermochemical data")
+        ("mechcache", po::value(&cachedir)->default_value(""), "directory for binary copies of the chemical mechanism")
         ;
 
         // Solver options
@@ -114,6 +117,7 @@ int main(int argc, char* argv[])
         ("strang", "use strang solver")
         ("predcor", "use predcor solver")
         ("flamepp", "use flamepp solver")
+        ("restart", "continue the simulation from its checkpoint file")
         ;
 
         // Output options
@@ -185,6 +189,7 @@ int main(int argc, char* argv[])
         if (vm.count("strang")) soltype = Mops::Strang;
         if (vm.count("predcor")) soltype = Mops::PredCor;
         if (vm.count("flamepp")) soltype = Mops::FlamePP;
+        if (vm.count("restart")) frestart = true;
 
         // Get the seed
         rand = vm["rand"].as< size_t >();
@@ -245,7 +250,8 @@ int main(int argc, char* argv[])
     // Load the (chemical) mechanism
     try {
         if (fsurf) {
-            Sprog::IO::MechanismParser::ReadChemkin(
+            Sprog::IO::MechanismParser::ReadChemkinCached(
+                    cachedir,
                     cfile,
                     surfcfile,
                     mech.GasMech(),
@@ -254,7 +260,8 @@ int main(int argc, char* argv[])
                     diag,
                     tranfile);
         } else {
-            Sprog::IO::MechanismParser::ReadChemkin(
+            Sprog::IO::MechanismParser::ReadChemkinCached(
+                    cachedir,
                     cfile,
                     mech.GasMech(),
                     tfile,
@@ -369,7 +376,14 @@ int main(int argc, char* argv[])
                 nsim->Run(*net, *solver, rand);
             } else {
                 sim.SetTimeVector(times);
+                sim.SetRestart(frestart);
                 sim.RunSimulation(*reactor, *solver, rand);
+
+                // Postprocessing waits until the simulation is complete.
+                if (!sim.Finished()) {
+                    printf("mops: Stopped at the wall-clock limit; continue with --restart.\n");
+                    fpostproc = false;
+                }
             }
         }
     } catch (std::logic_error &le) {
@@ -0,0 +1,312 @@
+/*!
+ * \file   library_test.cpp
+ *
+ * \brief  Checks of Camflow::FlameletLibrary and its binary table
+ *
+ *  Builds a steady flamelet library for a few SDRs through
+ *  Interface::flameletLibrary, once with one thread and once with several,
+ *  and reads both tables back.  Checks the header and the layout of the
+ *  table, that the serial and the threaded tables agree and that every
+ *  flamelet in the table agrees with a single Interface::flameletSDR solve
+ *  at the same SDR.  The library solves continue from their neighbours
+ *  while the single solves start from the initial profile, so the values
+ *  are compared to the steady state tolerance rather than bit for bit.
+ *
+ *  Usage: camflowLibrary-test dir [threads], where dir holds the
+ *  camflow.xml, grid.inp, chem.inp, therm.dat and tran.dat of a flamelet
+ *  without a restart file.
+ *
+ Licence:
+    This file is part of "camflow".
+
+    camflow is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "interface.h"
+#include "flamelet_library.h"
+#include "cam_error.h"
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// SDRs of the library (1/s), deliberately not in order.
+const double sdrs[] = {20.0, 1.0, 50.0, 5.0};
+const unsigned int nsdrs = sizeof(sdrs) / sizeof(sdrs[0]);
+
+// Largest difference allowed, relative to the largest value of a variable.
+const double tolerance = 1e-6;
+
+const char *serialFile = "library1-serial.bin";
+const char *threadedFile = "library1-threaded.bin";
+
+double seconds(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+           .total_microseconds() * 1.0e-6;
+}
+
+// Contents of a binary table, as described in flamelet_library.h.
+struct Table {
+    std::vector<std::string> names;
+    std::vector<double> sdr;
+    std::vector<double> Z;
+    std::vector<double> data;
+
+    double value(size_t k, size_t var, size_t i) const
+    {
+        return data[(k * names.size() + var) * Z.size() + i];
+    }
+};
+
+// Read a table and check its header and layout, counting the failures.
+bool readTable(const std::string &fileName, Table &table, int &failures)
+{
+    std::ifstream in(fileName.c_str(), std::ios::binary | std::ios::ate);
+    const std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+    char magic[8];
+    boost::uint32_t header[4];
+    if (!in.read(magic, sizeof(magic)) ||
+        !in.read(reinterpret_cast<char *>(header), sizeof(header))) {
+        std::cout << "  Could not read the header of " << fileName << "\n";
+        ++failures;
+        return false;
+    }
+    if (std::memcmp(magic, "CAMFLIB", 8) != 0) {
+        std::cout << "  " << fileName << " does not start with CAMFLIB\n";
+        ++failures;
+    }
+    if (header[0] != Camflow::FlameletLibrary::formatVersion) {
+        std::cout << "  " << fileName << " has version " << header[0] << "\n";
+        ++failures;
+    }
+
+    const size_t nSDR = header[1], nPoints = header[2], nVars = header[3];
+    const size_t nameBytes = nVars * Camflow::FlameletLibrary::nameLength;
+    const size_t sdrOffset = sizeof(magic) + sizeof(header) + nameBytes;
+    const size_t ZOffset = sdrOffset + nSDR * sizeof(double);
+    const size_t dataOffset = ZOffset + nPoints * sizeof(double);
+    const size_t size = dataOffset + nSDR * nVars * nPoints * sizeof(double);
+    if (sdrOffset % 8 != 0 || ZOffset % 8 != 0 || dataOffset % 8 != 0) {
+        std::cout << "  Blocks of " << fileName << " are not 8 byte aligned\n";
+        ++failures;
+    }
+    if (fileSize != static_cast<std::streamoff>(size)) {
+        std::cout << "  " << fileName << " has " << fileSize << " bytes instead of " << size << "\n";
+        ++failures;
+        return false;
+    }
+
+    std::vector<char> names(nameBytes);
+    table.sdr.resize(nSDR);
+    table.Z.resize(nPoints);
+    table.data.resize(nSDR * nVars * nPoints);
+    if (nameBytes == 0 || nSDR == 0 || nPoints == 0 ||
+        !in.read(&names[0], nameBytes) ||
+        !in.read(reinterpret_cast<char *>(&table.sdr[0]), nSDR * sizeof(double)) ||
+        !in.read(reinterpret_cast<char *>(&table.Z[0]), nPoints * sizeof(double)) ||
+        !in.read(reinterpret_cast<char *>(&table.data[0]), table.data.size() * sizeof(double))) {
+        std::cout << "  Could not read the tables of " << fileName << "\n";
+        ++failures;
+        return false;
+    }
+
+    for (size_t v = 0; v != nVars; ++v) {
+        const char *name = &names[v * Camflow::FlameletLibrary::nameLength];
+        if (name[Camflow::FlameletLibrary::nameLength - 1] != '\0') {
+            std::cout << "  Name " << v << " of " << fileName << " is not null padded\n";
+            ++failures;
+        }
+        std::string padded(name, Camflow::FlameletLibrary::nameLength);
+        table.names.push_back(padded.substr(0, padded.find('\0')));
+    }
+    return true;
+}
+
+// Largest difference of two profiles relative to the largest value of b.
+double difference(const std::vector<double> &a, const std::vector<double> &b)
+{
+    double scale = 0.0, diff = 0.0;
+    for (size_t i = 0; i != b.size(); ++i) {
+        scale = std::max(scale, std::fabs(b[i]));
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return scale > 0.0 ? diff / scale : diff;
+}
+
+std::vector<double> profile(const Table &table, size_t k, size_t var)
+{
+    std::vector<double> p(table.Z.size());
+    for (size_t i = 0; i != p.size(); ++i) p[i] = table.value(k, var, i);
+    return p;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " dir [threads]\n";
+        return 1;
+    }
+    const int nThreads = argc > 2 ? boost::lexical_cast<int>(argv[2]) : 3;
+
+    int failures = 0;
+    try {
+        boost::filesystem::current_path(argv[1]);
+        Camflow::Interface intf;
+        const std::vector<std::string> species = intf.getSpeciesNames();
+        std::vector<double> sdr(sdrs, sdrs + nsdrs);
+
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        intf.flameletLibrary(sdr, serialFile, 1);
+        const double tSerial = seconds(start);
+        start = boost::posix_time::microsec_clock::universal_time();
+        intf.flameletLibrary(sdr, threadedFile, nThreads);
+        const double tThreaded = seconds(start);
+
+        Table serial, threaded;
+        if (!readTable(serialFile, serial, failures) || !readTable(threadedFile, threaded, failures)) {
+            throw std::runtime_error("the tables could not be read");
+        }
+
+        // Header: the sorted SDRs, T, rho and the species, and Z from 0 to 1.
+        std::sort(sdr.begin(), sdr.end());
+        if (serial.sdr != sdr) {
+            std::cout << "  The SDRs of the table are not the sorted input SDRs\n";
+            ++failures;
+        }
+        std::vector<std::string> names;
+        names.push_back("T");
+        names.push_back("rho");
+        names.insert(names.end(), species.begin(), species.end());
+        if (serial.names != names) {
+            std::cout << "  The variables of the table are not T, rho and the species\n";
+            ++failures;
+        }
+        bool ascending = true;
+        for (size_t i = 1; i != serial.Z.size(); ++i) {
+            if (serial.Z[i] <= serial.Z[i - 1]) ascending = false;
+        }
+        if (serial.Z.front() != 0.0 || serial.Z.back() != 1.0 || !ascending) {
+            std::cout << "  The mixture fractions do not go from 0 to 1\n";
+            ++failures;
+        }
+        if (threaded.names != serial.names || threaded.sdr != serial.sdr ||
+            threaded.Z != serial.Z) {
+            std::cout << "  The headers of the serial and threaded tables differ\n";
+            ++failures;
+        }
+        if (failures > 0) throw std::runtime_error("the tables do not match");
+
+        double worstThreads = 0.0, worstSingle = 0.0;
+        for (size_t k = 0; k != sdr.size(); ++k) {
+            // The same flamelet from a table built with several threads.
+            for (size_t var = 0; var != names.size(); ++var) {
+                const double err = difference(profile(threaded, k, var), profile(serial, k, var));
+                worstThreads = std::max(worstThreads, err);
+                if (err > tolerance) {
+                    std::cout << "  " << names[var] << " at SDR " << sdr[k]
+                              << " differs by " << err << " between 1 and " << nThreads << " threads\n";
+                    ++failures;
+                }
+            }
+
+            // A single steady solve at the same SDR.
+            intf.flameletSDR(sdr[k]);
+            std::vector<std::vector<double> > single(names.size());
+            single[0] = intf.getTemperatures();
+            for (size_t i = 0; i != serial.Z.size(); ++i) {
+                single[1].push_back(intf.getDensity(serial.Z[i]));
+            }
+            for (size_t l = 0; l != species.size(); ++l) {
+                single[2 + l] = intf.getMassFracsBySpecies(l);
+            }
+            for (size_t var = 0; var != names.size(); ++var) {
+                if (single[var].size() != serial.Z.size()) {
+                    std::cout << "  The single solve of " << names[var] << " has "
+                              << single[var].size() << " points\n";
+                    ++failures;
+                    continue;
+                }
+                const double err = difference(profile(serial, k, var), single[var]);
+                worstSingle = std::max(worstSingle, err);
+                if (err > tolerance) {
+                    std::cout << "  " << names[var] << " at SDR " << sdr[k]
+                              << " differs by " << err << " from a single solve\n";
+                    ++failures;
+                }
+            }
+        }
+
+        // The residual reports of the solves leave cout in scientific notation.
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << "Largest difference between 1 and " << nThreads << " threads " << worstThreads
+                  << ", from single solves " << worstSingle << "\n";
+        std::cout << "Seconds for " << sdr.size() << " flamelets: " << std::setprecision(4)
+                  << tSerial << " with 1 thread, " << tThreaded << " with " << nThreads << "\n";
+    } catch (Camflow::CamError &ce) {
+        std::cout << "library_test: " << ce.errorMessage << "\n";
+        failures = -1;
+    } catch (std::exception &e) {
+        std::cout << "library_test: " << e.what() << "\n";
+        failures = -1;
+    }
+
+    // Files written by the tables, the single solves and the mechanism checks.
+    std::remove(serialFile);
+    std::remove(threadedFile);
+    std::remove("initialProfile.dat");
+    std::remove("profile.dat");
+    std::remove("SystemMWs.dat");
+    std::remove("LewisNumbers");
+    std::remove("mech.log");
+    std::remove("reactionsParsed");
+    std::remove("speciesParsed");
+
+    if (failures < 0) return 1;
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
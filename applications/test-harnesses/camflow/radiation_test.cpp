@@ -0,0 +1,218 @@
+/*!
+ * \file   radiation_test.cpp
+ *
+ * \brief  Checks and timings of Camflow::Radiation
+ *
+ *  Evaluates the radiative heat loss of a grid of random temperatures
+ *  (including the change of CO fit at 750K), compositions and soot volume
+ *  fractions with Camflow::Radiation and compares it with a cell by cell
+ *  evaluation of the Planck mean absorption fits of H2O, CO2, CO and CH4
+ *  as they are written in reference [1] of cam_radiation.cpp.  The times
+ *  per grid of the two are then printed.
+ *
+ *  Usage: camflowRadiation-test dir chem therm, where dir holds a
+ *  camflow.xml naming the radiative species and chem and therm are a
+ *  mechanism that contains them.
+ *
+ Licence:
+    This file is part of "camflow".
+
+    camflow is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "cam_radiation.h"
+#include "gpc_mech_io.h"
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+// Radiative species of camflow.xml.
+const char *species[] = {"H2O", "CO2", "CO", "CH4"};
+const unsigned int nspecies = sizeof(species) / sizeof(species[0]);
+
+// Cells of the grid and repetitions for the timings.
+const int ncells = 2000;
+const unsigned int repeats = 200;
+
+// Operating pressure (Pa).
+const double opPre = 101325.0;
+
+double seconds(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+           .total_microseconds() * 1.0e-6;
+}
+
+// Planck mean absorption coefficient (1/m/atm) written as in reference [1].
+double absorption(const std::string &name, const double T)
+{
+    const double beta = 1000 / T;
+    const double beta2 = beta * beta;
+    const double beta3 = beta2 * beta;
+    const double beta4 = beta3 * beta;
+    const double beta5 = beta4 * beta;
+
+    if (name == "H2O") {
+        return -0.23093 - 1.12390 * beta + 9.41530 * beta2 - 2.99880 * beta3 + 0.51382 * beta4
+               - 1.86840e-5 * beta5;
+    } else if (name == "CO2") {
+        return 18.7410 - 121.3100 * beta + 273.5000 * beta2 - 194.0500 * beta3 + 56.3100 * beta4
+               - 5.8169 * beta5;
+    } else if (name == "CO") {
+        if (T <= 750) {
+            return 4.7869 + T * (-0.06953 + T * (2.95775e-4 + T * (-4.25732e-7 + T * 2.02894e-10)));
+        }
+        return 10.0900 + T * (-0.01183 + T * (4.7753e-6 + T * (-5.87209e-10 + T * -2.5334e-14)));
+    }
+    return 6.6334 + T * (-0.0035686 + T * (1.6682e-8 + T * (2.5611e-10 + T * -2.6558e-14)));
+}
+
+// Radiative heat loss of cell i and the size of its terms, for the tolerance.
+double heatLoss(const Sprog::Mechanism &mech, const std::vector<int> &index,
+                const Camflow::Array2D &mf, int i, double avgMolWt,
+                double T, double fv, double &scale)
+{
+    double spectral = 0.0, spectralScale = 0.0;
+    for (unsigned int j = 0; j != nspecies; ++j) {
+        const int k = index[j];
+        const double p = mf(i, k) * avgMolWt / mech.Species(k)->MolWt() * opPre;
+        const double a = absorption(species[j], T) / 101325.0;
+        spectral += p * a;
+        spectralScale += std::fabs(p * a);
+    }
+    const double T4 = T * T * T * T;
+    scale = 4 * 5.669e-8 * (T4 + 81e8) * spectralScale + 3.3337e-4 * fv * T4 * T;
+    return 4 * 5.669e-8 * (T4 - 81e8) * spectral + 3.3337e-4 * fv * T4 * T;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " dir chem therm\n";
+        return 1;
+    }
+
+    Sprog::Mechanism mech;
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(argv[2], mech, argv[3], 0);
+    } catch (std::exception &e) {
+        std::cerr << "radiation_test: Failed to read the mechanism: " << e.what() << "\n";
+        return 1;
+    }
+    const int nsp = mech.SpeciesCount();
+
+    // A random grid, with cells either side of the change of the CO fit.
+    boost::mt19937 rng(2013);
+    boost::uniform_01<boost::mt19937&, double> unif(rng);
+    std::vector<double> T(ncells), fv(ncells), avgMolWt(ncells);
+    Camflow::Array2D mf(ncells, nsp);
+    std::vector<int> index(nspecies);
+    for (unsigned int j = 0; j != nspecies; ++j) index[j] = mech.FindSpecies(species[j]);
+    for (int i = 0; i != ncells; ++i) {
+        T[i] = 250.0 + 2750.0 * unif();
+        fv[i] = 1e-6 * unif();
+        avgMolWt[i] = 0.01 + 0.02 * unif();
+        for (unsigned int j = 0; j != nspecies; ++j) {
+            mf(i, index[j]) = 0.2 * unif();
+        }
+    }
+    T[1] = 750.0;
+    T[2] = 750.0 + 1e-9;
+    T[3] = 300.0;
+
+    int failures = 0;
+    try {
+        Camflow::Radiation radiation(std::string(argv[1]) + "/camflow.xml", ncells,
+                                     &mech, avgMolWt, mf);
+        radiation.calculateRadiativeHeatLoss(1, ncells, T, opPre, fv);
+
+        double worst = 0.0;
+        for (int i = 1; i != ncells; ++i) {
+            double scale;
+            const double expected = heatLoss(mech, index, mf, i, avgMolWt[i], T[i], fv[i], scale);
+            const double err = std::fabs(radiation.getRadiation(i) - expected) / scale;
+            if (err > worst) worst = err;
+            if (err > 1e-12) {
+                std::cout << "  Cell " << i << " at " << T[i] << "K: " << radiation.getRadiation(i)
+                          << " instead of " << expected << "\n";
+                ++failures;
+            }
+        }
+        std::cout << "Largest difference from the fits " << worst << " of the size of the terms\n";
+        if (radiation.getRadiation(0) != 0.0) {
+            std::cout << "  Cell 0 outside the range was changed\n";
+            ++failures;
+        }
+
+        // Timings of a pass over the grid.
+        double sumBatch = 0.0;
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        for (unsigned int r = 0; r != repeats; ++r) {
+            radiation.calculateRadiativeHeatLoss(0, ncells, T, opPre, fv);
+            sumBatch += radiation.getRadiation(r % ncells);
+        }
+        const double tBatch = seconds(start) / repeats;
+
+        double sumCells = 0.0;
+        start = boost::posix_time::microsec_clock::universal_time();
+        for (unsigned int r = 0; r != repeats; ++r) {
+            for (int i = 0; i != ncells; ++i) {
+                double scale;
+                const double q = heatLoss(mech, index, mf, i, avgMolWt[i], T[i], fv[i], scale);
+                if (i == int(r % ncells)) sumCells += q;
+            }
+        }
+        const double tCells = seconds(start) / repeats;
+        if (std::fabs(sumBatch - sumCells) > 1e-12 * std::fabs(sumCells)) {
+            std::cout << "  Timed passes differ\n";
+            ++failures;
+        }
+        std::cout << "Microseconds per grid of " << ncells << " cells: "
+                  << std::setprecision(4) << tBatch * 1e6 << " in one pass, "
+                  << tCells * 1e6 << " cell by cell\n";
+    } catch (std::exception &e) {
+        std::cout << "radiation_test: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
@@ -0,0 +1,297 @@
+/*!
+ *\file chemkinReaderBench.cpp
+ *
+ *\brief Compares the chemkin reader's tokenizer with its regex parsers.
+ *
+ *  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "chemkinReader.h"
+#include "stringFunctions.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+//! Number of times each mechanism is read by each parser.
+const int nRepeats = 3;
+
+//! Deterministic pseudo random numbers in [0, 1).
+double nextRandom(unsigned long &seed)
+{
+    seed = (1103515245UL * seed + 12345UL) % 2147483648UL;
+    return static_cast<double>(seed) / 2147483648.0;
+}
+
+//! Redirects std::cout to nowhere while the readers report their progress.
+class QuietCout
+{
+public:
+    QuietCout() : m_buf(std::cout.rdbuf(m_null.rdbuf())) {}
+    ~QuietCout() {std::cout.rdbuf(m_buf);}
+private:
+    std::ostringstream m_null;
+    std::streambuf *m_buf;
+};
+
+//! Everything the reader produced, including the flags operator<< omits.
+std::string describe(const IO::ChemkinReader &reader)
+{
+    std::ostringstream out;
+    out.precision(17);
+    out << reader.elements() << "\n" << reader.phase() << "\n"
+        << reader.species() << "\n" << reader.reactions() << "\n";
+    for (size_t i = 0; i != reader.species().size(); ++i) {
+        out << reader.species()[i].phasename() << "\n";
+    }
+    for (size_t i = 0; i != reader.reactions().size(); ++i) {
+        const IO::Reaction &r = reader.reactions()[i];
+        out << r.hasREV() << r.hasLOW() << r.hasTROE() << r.hasSRI()
+            << r.hasThirdBody() << " " << r.getFallOffBody() << "\n";
+    }
+    return out.str();
+}
+
+/*!
+ * Reads a mechanism nRepeats times and returns the fastest time in
+ * seconds.  Both parsers share the ChemkinReader constructor, which reads
+ * the mechanism file and checks its format.
+ */
+double load(const std::string &chem, const std::string &therm,
+            const std::string &tran, bool regex, std::string &description)
+{
+    double best = 0.0;
+    for (int i=0; i<nRepeats; ++i) {
+        QuietCout quiet;
+        const std::clock_t start = std::clock();
+        IO::ChemkinReader reader(chem, therm, tran);
+        if (regex) {
+            reader.readWithRegex();
+        } else {
+            reader.read();
+        }
+        const double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+        if (i == 0 || t < best) best = t;
+        if (i == 0) description = describe(reader);
+    }
+    return best;
+}
+
+//! Name of synthetic species i, some with the punctuation of real names.
+std::string speciesName(int i)
+{
+    std::ostringstream name;
+    name << "SP" << i;
+    if (i % 7 == 3) name << "-A";
+    if (i % 11 == 5) name << "(S)";
+    return name.str();
+}
+
+//! One NASA polynomial record.
+void writeThermo(std::ostream &out, const std::string &name, unsigned long &seed)
+{
+    char line[128];
+    std::sprintf(line, "%-18s%-6s%-5s%-5s%-5s%-5sG%10.3f%10.3f%8.2f      1\n",
+                 name.c_str(), "SYNTH", "C   1", "H   4", "O   1", "",
+                 300.0, 5000.0, 1000.0);
+    out << line;
+    double a[14];
+    for (int k=0; k<14; ++k) {
+        a[k] = (nextRandom(seed) - 0.5) * std::pow(10.0, -12.0 + 14.0 * nextRandom(seed));
+    }
+    for (int l=0; l<3; ++l) {
+        std::string record;
+        for (int k=0; k<5 && 5*l+k<14; ++k) {
+            std::sprintf(line, "%15.8E", a[5*l+k]);
+            record += line;
+        }
+        record.resize(79, ' ');
+        out << record << static_cast<char>('2' + l) << "\n";
+    }
+}
+
+/*!
+ * Writes a mechanism with nSpecies species and 5 reactions per species,
+ * using every reaction type the reader supports.
+ */
+void writeSyntheticMechanism(int nSpecies, const std::string &chem,
+                             const std::string &therm, const std::string &tran)
+{
+    unsigned long seed = 4321;
+    std::vector<std::string> names;
+    names.push_back("H2");
+    names.push_back("H2O");
+    names.push_back("AR");
+    for (int i=0; i<nSpecies; ++i) names.push_back(speciesName(i));
+
+    std::ofstream fchem(chem.c_str());
+    fchem << "! Synthetic mechanism for chemkinReader-bench\n"
+          << "ELEMENTS\nC H O AR\nEND\nSPECIES\n";
+    for (size_t i=0; i<names.size(); ++i) {
+        fchem << names[i] << ((i % 6 == 5) ? "\n" : " ");
+    }
+    fchem << "\nEND\nREACTIONS CAL/MOLE\n";
+
+    char arrh[128];
+    for (int i=0; i<5*nSpecies; ++i) {
+        const std::string &a = names[3 + static_cast<int>(nSpecies * nextRandom(seed))];
+        const std::string &b = names[3 + static_cast<int>(nSpecies * nextRandom(seed))];
+        const std::string &c = names[3 + static_cast<int>(nSpecies * nextRandom(seed))];
+        const std::string &d = names[3 + static_cast<int>(nSpecies * nextRandom(seed))];
+        std::sprintf(arrh, "   %.4E  %.3f  %.1f", std::pow(10.0, 6.0 + 8.0 * nextRandom(seed)),
+                     2.0 * nextRandom(seed) - 1.0, 50000.0 * nextRandom(seed));
+        switch (i % 8) {
+        case 0:
+            fchem << a << "+" << b << "<=>" << c << "+" << d << arrh << " ! reaction " << i << "\n";
+            break;
+        case 1:
+            fchem << a << " + " << b << " => " << c << " + " << d << arrh << "\n";
+            break;
+        case 2:
+            fchem << a << "+M<=>" << c << "+" << d << "+M" << arrh << "\n"
+                  << "H2/2.0/ H2O/6.0/ AR/0.7/\n";
+            break;
+        case 3:
+            fchem << a << "+" << b << "(+M)<=>" << c << "(+M)" << arrh << "\n"
+                  << "     LOW  /  2.477E+33  -4.760  2440.00/\n"
+                  << "     TROE/ 0.7830  74.00  2941.00  6964.00 /\n"
+                  << "H2/2.00/ H2O/6.00/\n";
+            break;
+        case 4:
+            fchem << a << "(+M)=" << c << "+" << d << "(+M)" << arrh << "\n"
+                  << "     LOW  /  1.0E+20  -1.0  1000.0/\n"
+                  << "     SRI / 0.5 100.0 1000.0 1.0 0.0 /\n";
+            break;
+        case 5:
+            fchem << "2" << a << "<=>" << c << "+" << d << arrh << "\n"
+                  << "    REV / 1.0E+12 0.5 2000.0 /\n";
+            break;
+        case 6:
+            fchem << a << "+" << b << "=" << c << "+" << d << arrh << "\n"
+                  << "DUPLICATE\n"
+                  << a << "+" << b << "=" << c << "+" << d << arrh << "\n"
+                  << "DUP\n";
+            break;
+        default:
+            fchem << a << "+" << b << "<=>" << c << "+" << d << arrh << "\n"
+                  << "    FORD / " << a << " 1.5 /\n";
+            break;
+        }
+    }
+    fchem << "END\n";
+
+    std::ofstream ftherm(therm.c_str());
+    ftherm << "THERMO ALL\n   300.000  1000.000  5000.000\n";
+    for (size_t i=0; i<names.size(); ++i) writeThermo(ftherm, names[i], seed);
+    ftherm << "END\n";
+
+    std::ofstream ftran(tran.c_str());
+    char line[128];
+    for (size_t i=0; i<names.size(); ++i) {
+        std::sprintf(line, "%-16s %d %9.3f %9.3f %9.3f %9.3f %9.3f    ! record %d\n",
+                     names[i].c_str(), static_cast<int>(i % 3), 500.0 * nextRandom(seed),
+                     2.0 + 5.0 * nextRandom(seed), 0.0, 3.0 * nextRandom(seed),
+                     10.0 * nextRandom(seed), static_cast<int>(i));
+        ftran << line;
+    }
+}
+
+//! Reads a mechanism with both parsers; returns false if they differ.
+bool compare(const std::string &label, const std::string &chem,
+             const std::string &therm, const std::string &tran)
+{
+    std::string withRegex, withTokenizer;
+    const double tRegex = load(chem, therm, tran, true, withRegex);
+    const double tTokenizer = load(chem, therm, tran, false, withTokenizer);
+
+    std::cout << label << ": regex " << tRegex << " s, tokenizer "
+              << tTokenizer << " s";
+    if (tTokenizer > 0.0) std::cout << " (" << tRegex / tTokenizer << " times faster)";
+    std::cout << "\n";
+
+    if (withRegex != withTokenizer) {
+        std::ofstream(("bench-" + label + "-regex.txt").c_str()) << withRegex;
+        std::ofstream(("bench-" + label + "-tokenizer.txt").c_str()) << withTokenizer;
+        std::cout << "The parsers read " << label << " differently, see bench-"
+                  << label << "-*.txt\n";
+        return false;
+    }
+    return true;
+}
+}
+
+/*!
+ * Read a mechanism with ChemkinReader::readWithRegex and with
+ * ChemkinReader::read, which uses the ChemkinTokenizer, then do the same
+ * for a synthetic mechanism written to the working directory.  The
+ * loading times are printed, and the test fails if the elements, species
+ * or reactions differ.
+ *
+ * Usage: chemkinReader-bench chem.inp therm.dat tran.dat [nspecies]
+ */
+int main(int argc, char *argv[])
+{
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " chem.inp therm.dat tran.dat [nspecies]\n";
+        return 255;
+    }
+    const int nSpecies = (argc > 4) ? std::atoi(argv[4]) : 1000;
+
+    bool ok = true;
+    try {
+        ok = compare("mechanism", argv[1], argv[2], argv[3]) && ok;
+
+        writeSyntheticMechanism(nSpecies, "bench-chem.inp", "bench-therm.dat", "bench-tran.dat");
+        ok = compare("synthetic", "bench-chem.inp", "bench-therm.dat", "bench-tran.dat") && ok;
+    } catch (std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 254;
+    }
+
+    if (!ok) {
+        std::cout << "TEST FAILURE\n";
+        return 1;
+    }
+    std::remove("bench-chem.inp");
+    std::remove("bench-therm.dat");
+    std::remove("bench-tran.dat");
+    std::cout << "Both parsers read the same mechanisms\n";
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*!
+ * \file   mops_bench.cpp
+ *
+ * \brief  Times the particle solvers of mops on a fixed-seed workload
+ *
+ *  Runs the first run of a mops simulation, without save points or
+ *  console output, and appends one line of results to a CSV file, so
+ *  that the results of different builds can be compared line by line.
+ *  The mops-bench-* targets run it on the inputs of the regression tests.
+ *
+ Licence:
+
+    This utility file is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have file a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "mops.h"
+#include "swp_profile.h"
+#include "string_functions.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+//! Calls of operator new and bytes requested, from all threads.
+volatile unsigned long long allocCount = 0;
+volatile unsigned long long allocBytes = 0;
+
+void countAllocation(std::size_t n)
+{
+#if defined(__GNUC__)
+    __sync_fetch_and_add(&allocCount, 1ULL);
+    __sync_fetch_and_add(&allocBytes, (unsigned long long)n);
+#else
+    ++allocCount;
+    allocBytes += n;
+#endif
+}
+
+void *allocate(std::size_t n)
+{
+    countAllocation(n);
+    void *p = std::malloc(n ? n : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+//! Peak resident set size of the process (kB), or 0 where unknown.
+long peakRSS(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+}
+
+// The counting versions of the global allocation functions replace the
+// library ones in the whole program.
+void *operator new(std::size_t n) {return allocate(n);}
+void *operator new[](std::size_t n) {return allocate(n);}
+void operator delete(void *p) {std::free(p);}
+void operator delete[](void *p) {std::free(p);}
+
+int main(int argc, char* argv[])
+{
+    std::string name, ifile, cfile, tfile, sfile, gpfile, results;
+    size_t seed(456);
+    Mops::SolverType soltype = Mops::Strang;
+
+    try {
+        po::options_description options("mops-bench options");
+        options.add_options()
+        ("help,h", "print usage message")
+        ("name", po::value(&name)->default_value("workload"), "name of the workload in the results")
+        ("mops,r", po::value(&ifile)->default_value("mops.inx"), "path to main input file")
+        ("chem,c", po::value(&cfile)->default_value("chem.inp"), "path to chemical mechanism")
+        ("therm,t", po::value(&tfile)->default_value("therm.dat"), "path to thermochemical data")
+        ("gasphase,g", po::value(&gpfile)->default_value("gasphase.inp"), "path to gas phase profile")
+        ("sweep,s", po::value(&sfile)->default_value("sweep.xml"), "path to particle mechanism")
+        ("rand,e", po::value(&seed)->default_value(456), "random seed")
+        ("flamepp", "use flamepp solver instead of strang")
+        ("results", po::value(&results)->default_value("mops-bench.csv"), "CSV file to which the results are appended")
+        ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, options), vm);
+        if (vm.count("help")) {
+            std::cout << options << "\n";
+            return 0;
+        }
+        po::notify(vm);
+        if (vm.count("flamepp")) soltype = Mops::FlamePP;
+    } catch (std::exception &e) {
+        std::cerr << "mops-bench: Error getting options. Message:\n" << e.what() << "\n";
+        return 1;
+    }
+
+    Mops::Solver *solver = Mops::SolverFactory::Create(soltype);
+    Mops::Reactor *reactor = NULL;
+    Mops::Mechanism mech;
+    Mops::timevector times;
+    Mops::Simulator sim;
+
+    double seconds = 0.0;
+    unsigned long long events = 0, allocs = 0, bytes = 0;
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(cfile, mech.GasMech(), tfile, 0);
+        mech.ParticleMech().SetSpecies(mech.GasMech().Species());
+        if (soltype == Mops::FlamePP) {
+            dynamic_cast<Sweep::FlameSolver*>(solver)->LoadGasProfile(gpfile, mech);
+        }
+        Sweep::MechParser::Read(sfile, mech.ParticleMech());
+        reactor = Mops::Settings_IO::LoadFromXML(ifile, reactor, times, sim, *solver, mech);
+
+        // Only the engines are timed: one run, and as little output as
+        // the simulator allows.
+        sim.SetRunCount(1);
+        sim.SetTimeVector(times);
+        sim.SetOutputFile(name);
+        sim.SetWriteSavePoints(false);
+        sim.SetUseConsoleMsgs(false);
+        sim.SetConsoleInterval(std::numeric_limits<unsigned int>::max());
+
+        const unsigned long long allocs0 = allocCount, bytes0 = allocBytes;
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        sim.RunSimulation(*reactor, *solver, seed);
+        seconds = (boost::posix_time::microsec_clock::universal_time() - start)
+                  .total_microseconds() * 1.0e-6;
+        allocs = allocCount - allocs0;
+        bytes = allocBytes - bytes0;
+        events = sim.JumpCount();
+    } catch (std::exception &e) {
+        std::cerr << "mops-bench: Workload " << name << " failed. Message:\n  "
+                  << e.what() << "\n";
+        delete solver;
+        delete reactor;
+        return 1;
+    }
+
+    // The LPDA timer is only compiled in with SWEEP_PROFILE.
+    std::string lpda;
+#ifdef SWEEP_PROFILE
+    Sweep::Profile::Summary sum;
+    Sweep::Profile::Collect(sum);
+    lpda = Strings::cstr(sum.Time[Sweep::Profile::LPDA] / sum.TicksPerSecond);
+#endif
+
+    // Write the header if the results file is new.
+    bool header = true;
+    {
+        std::ifstream fin(results.c_str());
+        header = !fin.good() || (fin.peek() == std::ifstream::traits_type::eof());
+    }
+    std::ofstream fout(results.c_str(), std::ios_base::out | std::ios_base::app);
+    if (header) {
+        fout << "Workload,Events,Time (s),Events/s,LPDA (s),Peak RSS (kB),"
+                "Allocations,Allocated (bytes)\n";
+    }
+    fout << name << "," << events << "," << seconds << ","
+         << (seconds > 0.0 ? events / seconds : 0.0) << "," << lpda << ","
+         << peakRSS() << "," << allocs << "," << bytes << "\n";
+    fout.close();
+    if (!fout) {
+        std::cerr << "mops-bench: Failed to write " << results << "\n";
+        delete solver;
+        delete reactor;
+        return 1;
+    }
+
+    printf("mops-bench: %s: %llu events in %.3f s (%.4g events/s), %llu allocations, "
+           "peak RSS %ld kB.\n", name.c_str(), events, seconds,
+           seconds > 0.0 ? events / seconds : 0.0, allocs, peakRSS());
+#ifndef SWEEP_PROFILE
+    printf("mops-bench: Configure with -DSWEEP_PROFILE=ON to time LPDA.\n");
+#endif
+
+    delete solver;
+    delete reactor;
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*!
+ * \file   rates_threads_test.cpp
+ *
+ * \brief  Stress test of Sprog rate evaluation from many threads
+ *
+ Licence:
+
+    This utility file is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This file is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have file a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "gpc.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace Sprog;
+
+namespace
+{
+//! Number of threads sharing the mechanism.
+const int nThreads = 32;
+
+//! Number of mixture states to evaluate.
+const int nStates = 256;
+
+//! Number of times each thread passes over all the states.
+const int nPasses = 4;
+
+//! Deterministic pseudo random numbers in [0, 1).
+double nextRandom(unsigned long &seed)
+{
+    seed = (1103515245UL * seed + 12345UL) % 2147483648UL;
+    return static_cast<double>(seed) / 2147483648.0;
+}
+
+//! Molar production rates with a private gas and workspace.
+void molarProdRates(const Mechanism &mech, double T, double density,
+                    const fvector &x, Kinetics::RateWorkspace &wk,
+                    Thermo::IdealGas &gas, fvector &wdot)
+{
+    gas.SetTemperature(T);
+    gas.SetFracs(x);
+    gas.SetDensity(density);
+    mech.Reactions().GetMolarProdRates(T, density, &x[0], x.size(), gas,
+                                       wk, wdot);
+}
+}
+
+/*!
+ * Evaluate the molar production rates of a set of mixture states
+ * serially, then again from 32 threads sharing one Mechanism object, and
+ * check that every thread reproduces the serial results.
+ *
+ * Usage: sprogc-threads-test chem.inp therm.dat
+ */
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " chem.inp therm.dat\n";
+        return 255;
+    }
+
+    Mechanism mech;
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(argv[1], mech, argv[2]);
+    } catch (std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 254;
+    }
+    std::cout << "Read " << mech.SpeciesCount() << " species and "
+              << mech.ReactionCount() << " reactions\n";
+
+    // Mixture states spanning the temperature range of the mechanism.
+    const unsigned int nsp = mech.SpeciesCount();
+    std::vector<double> temps(nStates), dens(nStates);
+    std::vector<fvector> fracs(nStates, fvector(nsp));
+    unsigned long seed = 12345;
+    for (int s=0; s<nStates; ++s) {
+        temps[s] = 800.0 + 1700.0 * nextRandom(seed);
+        dens[s]  = 101325.0 / (R * temps[s]);
+        double sum = 0.0;
+        for (unsigned int k=0; k<nsp; ++k) {
+            fracs[s][k] = std::pow(10.0, -6.0 * nextRandom(seed));
+            sum += fracs[s][k];
+        }
+        for (unsigned int k=0; k<nsp; ++k) {
+            fracs[s][k] /= sum;
+        }
+    }
+
+    // Serial reference values, which must agree with the functions that
+    // use the workspace held by the reaction set.
+    std::vector<fvector> reference(nStates);
+    {
+        Kinetics::RateWorkspace wk;
+        mech.Reactions().InitWorkspace(wk);
+        Thermo::IdealGas gas(mech.Species());
+        fvector wdot;
+        for (int s=0; s<nStates; ++s) {
+            molarProdRates(mech, temps[s], dens[s], fracs[s], wk, gas,
+                           reference[s]);
+            mech.Reactions().GetMolarProdRates(temps[s], dens[s], &fracs[s][0],
+                                               nsp, gas, wdot);
+            if (wdot != reference[s]) {
+                std::cout << "Workspace rates differ from the original "
+                          << "interface for state " << s << "\nTEST FAILURE\n";
+                return 2;
+            }
+        }
+    }
+
+    // Every thread evaluates all the states, starting at a different one
+    // so that the threads work on different states at the same time.
+    std::vector<int> failures(nThreads, 0);
+#pragma omp parallel for schedule(static, 1) num_threads(nThreads)
+    for (int t=0; t<nThreads; ++t) {
+        Kinetics::RateWorkspace wk;
+        mech.Reactions().InitWorkspace(wk);
+        Thermo::IdealGas gas(mech.Species());
+        fvector wdot;
+        for (int i=0; i<nPasses*nStates; ++i) {
+            const int s = (i + t * nStates / nThreads) % nStates;
+            molarProdRates(mech, temps[s], dens[s], fracs[s], wk, gas, wdot);
+            for (unsigned int k=0; k<nsp; ++k) {
+                const double ref = reference[s][k];
+                if (std::abs(wdot[k] - ref) > 1.0e-12 * std::abs(ref)) {
+                    ++failures[t];
+                    break;
+                }
+            }
+        }
+    }
+
+    int nFailed = 0;
+    for (int t=0; t<nThreads; ++t) {
+        if (failures[t] > 0) {
+            std::cout << "Thread " << t << " differed from the serial rates for "
+                      << failures[t] << " evaluations\n";
+            ++nFailed;
+        }
+    }
+
+#ifdef _OPENMP
+    std::cout << "Compared " << nThreads << " threads (OpenMP)\n";
+#else
+    std::cout << "Compared " << nThreads << " passes (no OpenMP)\n";
+#endif
+
+    if (nFailed > 0) {
+        std::cout << "TEST FAILURE\n";
+        return 1;
+    }
+    std::cout << "All threads matched the serial rates\n";
+    return 0;
+}
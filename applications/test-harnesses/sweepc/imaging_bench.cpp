@@ -0,0 +1,216 @@
+/*!
+ * \file   imaging_bench.cpp
+ *
+ * \brief  Checks and timings of Sweep::Imaging::ParticleImage
+ *
+ *  Builds free-molecular images of surface-volume aggregates of 16 to
+ *  2^k primaries and checks that no two primaries overlap and that each
+ *  primary touches another, then prints the time to build each image.
+ *  A batch of images is then written with ParticleImage::WriteBatchPOVRAY
+ *  using one thread and all threads, the two files are checked to be
+ *  identical and the times are printed.
+ *
+ *  Usage: sweepImaging-bench dir [k], where dir holds chem.inp, therm.dat
+ *  and sweep.surfvol.xml and the largest aggregate has 2^k primaries (by
+ *  default 2^12).
+ *
+ Licence:
+    This file is part of "sweep".
+
+    sweep is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "gpc_mech.h"
+#include "gpc_mech_io.h"
+#include "swp_mechanism.h"
+#include "swp_mech_parser.h"
+#include "swp_particle_image.h"
+#include "swp_surfvol_primary.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// Particles in the batch and primaries in each of them.
+const unsigned int batchCount = 64;
+const unsigned int batchPrimaries = 256;
+
+double seconds(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+           .total_microseconds() * 1.0e-6;
+}
+
+// A surface-volume particle that is drawn with n primaries.
+Sweep::Particle *makeParticle(const Sweep::Mechanism &mech, unsigned int n)
+{
+    Sweep::Particle *sp = mech.CreateParticle(0.0);
+    Sweep::fvector comp(mech.ComponentCount(), 0.0);
+    comp[0] = 1.0e4 * n;
+    sp->Primary()->SetComposition(comp);
+    sp->UpdateCache();
+    const double vol = sp->Primary()->Volume();
+    sp->Primary()->SetSurfaceArea(std::pow(36.0 * Sweep::PI * vol * vol * (n + 0.5), 1.0 / 3.0));
+    sp->UpdateCache();
+    return sp;
+}
+
+// Checks that no two primaries overlap and that each touches another.
+bool check(const std::vector<Sweep::fvector> &coords, unsigned int n)
+{
+    if (coords.size() != n) {
+        std::cout << "  " << coords.size() << " primaries drawn, " << n << " expected\n";
+        return false;
+    }
+    std::vector<bool> touching(n, n == 1);
+    for (unsigned int i = 0; i != n; ++i) {
+        for (unsigned int j = i + 1; j != n; ++j) {
+            const double dx = coords[i][0] - coords[j][0];
+            const double dy = coords[i][1] - coords[j][1];
+            const double dz = coords[i][2] - coords[j][2];
+            const double d = std::sqrt(dx * dx + dy * dy + dz * dz);
+            const double sumr = coords[i][3] + coords[j][3];
+            if (d < sumr * (1.0 - 1.0e-6)) {
+                std::cout << "  Primaries " << i << " and " << j << " overlap by "
+                          << (sumr - d) / sumr << " of their radii\n";
+                return false;
+            }
+            if (d <= sumr * (1.0 + 1.0e-6)) touching[i] = touching[j] = true;
+        }
+    }
+    for (unsigned int i = 0; i != n; ++i) {
+        if (!touching[i]) {
+            std::cout << "  Primary " << i << " touches no other\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes a batch to a file and returns its contents and the time taken.
+std::string writeBatch(const std::vector<const Sweep::Particle*> &particles,
+                       const std::string &fname, double &t)
+{
+    std::ofstream file(fname.c_str());
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    Sweep::Imaging::ParticleImage::WriteBatchPOVRAY(file, particles, 100);
+    t = seconds(start);
+    file.close();
+
+    std::ifstream in(fname.c_str());
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    in.close();
+    std::remove(fname.c_str());
+    return contents.str();
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " dir [k]\n";
+        return 1;
+    }
+    const std::string dir = std::string(argv[1]) + "/";
+    const unsigned int k = (argc > 2) ? std::atoi(argv[2]) : 12;
+
+    Sprog::Mechanism gas;
+    Sweep::Mechanism mech;
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(dir + "chem.inp", gas, dir + "therm.dat", 0);
+        mech.SetSpecies(gas.Species());
+        Sweep::MechParser::Read(dir + "sweep.surfvol.xml", mech);
+    } catch (std::exception &e) {
+        std::cerr << "imaging_bench: Failed to read the inputs: " << e.what() << "\n";
+        return 1;
+    }
+
+    int failures = 0;
+    std::cout << "Milliseconds to build an image\n"
+              << std::setw(10) << "Primaries" << std::setw(12) << "Time" << '\n';
+    for (unsigned int n = 16; n <= (1u << k); n *= 4) {
+        Sweep::Particle *sp = makeParticle(mech, n);
+        Sweep::rng_type rng(2013);
+        Sweep::Imaging::ParticleImage image;
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        image.Construct(*sp, *sp->Primary()->ParticleModel(), rng);
+        const double t = seconds(start);
+
+        std::vector<Sweep::fvector> coords;
+        image.GetPriCoords(coords);
+        if (!check(coords, n)) ++failures;
+        std::cout << std::setw(10) << n << std::setw(12) << std::setprecision(4) << t * 1e3 << '\n';
+        delete sp;
+    }
+
+    // A batch of images, written with one thread and then with all of them.
+    std::vector<const Sweep::Particle*> particles;
+    for (unsigned int i = 0; i != batchCount; ++i) {
+        particles.push_back(makeParticle(mech, batchPrimaries));
+    }
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    double tSerial, tParallel;
+    const std::string serial = writeBatch(particles, "imaging-bench-1.pov", tSerial);
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    const std::string parallel = writeBatch(particles, "imaging-bench-2.pov", tParallel);
+    if (serial != parallel || serial.empty()) {
+        std::cout << "  The batch files written with 1 and " << threads << " threads differ\n";
+        ++failures;
+    }
+    std::cout << "Milliseconds to write " << batchCount << " images of " << batchPrimaries
+              << " primaries: " << tSerial * 1e3 << " with 1 thread, "
+              << tParallel * 1e3 << " with " << threads << '\n';
+    for (unsigned int i = 0; i != batchCount; ++i) delete particles[i];
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*!
+ * \file   remove_bench.cpp
+ *
+ * \brief  Checks and timings of Sweep::Ensemble::RemoveInvalids
+ *
+ *  Fills an ensemble, invalidates a random fraction of its particles
+ *  (from 0.01% to 50%) and removes them.  Checks that exactly the valid
+ *  particles remain and that the property sums held by the binary tree
+ *  agree with sums over the remaining particles, then prints the time
+ *  per call against the time to rebuild the tree for the same particles.
+ *
+ *  Usage: sweepRemove-bench dir [k], where dir holds chem.inp, therm.dat
+ *  and sweep-fo-spherical.xml and the ensemble holds 2^k particles
+ *  (by default 2^17).
+ *
+ Licence:
+    This file is part of "sweep".
+
+    sweep is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "gpc_mech.h"
+#include "gpc_mech_io.h"
+#include "swp_mechanism.h"
+#include "swp_mech_parser.h"
+#include "swp_ensemble.h"
+
+#include <boost/random/uniform_01.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+// Fractions of the particles that are invalidated.
+const double fractions[] = {0.0001, 0.001, 0.01, 0.05, 0.1, 0.25, 0.5};
+const unsigned int nfractions = sizeof(fractions) / sizeof(fractions[0]);
+
+// Repetitions of each removal, to average the timings.
+const unsigned int repeats = 5;
+
+double seconds(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+           .total_microseconds() * 1.0e-6;
+}
+
+// Checks the particles left in the ensemble and the sums in its tree.
+bool check(const Sweep::Ensemble &ens, unsigned int expected)
+{
+    if (ens.Count() != expected) {
+        std::cout << "  " << ens.Count() << " particles left, " << expected << " expected\n";
+        return false;
+    }
+    double mass = 0.0, diam = 0.0;
+    for (unsigned int i = 0; i != ens.Count(); ++i) {
+        if (!ens.At(i)->IsValid()) {
+            std::cout << "  Invalid particle left at " << i << "\n";
+            return false;
+        }
+        mass += ens.At(i)->Mass();
+        diam += ens.At(i)->CollDiameter();
+    }
+    const bool ok = (std::fabs(ens.GetSum(Sweep::iM) - mass) <= 1e-9 * mass) &&
+                    (std::fabs(ens.GetSum(Sweep::iDcol) - diam) <= 1e-9 * diam);
+    if (!ok) std::cout << "  Tree sums differ from the particle sums\n";
+    return ok;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " dir [k]\n";
+        return 1;
+    }
+    const std::string dir = std::string(argv[1]) + "/";
+    const unsigned int k = (argc > 2) ? std::atoi(argv[2]) : 17;
+    const unsigned int n = 1u << k;
+
+    Sprog::Mechanism gas;
+    Sweep::Mechanism mech;
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(dir + "chem.inp", gas, dir + "therm.dat", 0);
+        mech.SetSpecies(gas.Species());
+        Sweep::MechParser::Read(dir + "sweep-fo-spherical.xml", mech);
+    } catch (std::exception &e) {
+        std::cerr << "remove_bench: Failed to read the inputs: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Particles of random sizes.
+    Sweep::rng_type rng(2013);
+    boost::uniform_01<Sweep::rng_type&, double> unif(rng);
+    std::list<Sweep::Particle*> particles;
+    for (unsigned int i = 0; i != n; ++i) {
+        Sweep::Particle *sp = mech.CreateParticle(0.0);
+        Sweep::fvector comp(mech.ComponentCount(), 0.0);
+        comp[0] = 1.0 + std::floor(1000.0 * unif());
+        sp->Primary()->SetComposition(comp);
+        sp->UpdateCache();
+        particles.push_back(sp);
+    }
+    Sweep::Ensemble full;
+    full.Initialise(n);
+    full.SetParticles(particles.begin(), particles.end(), rng);
+
+    int failures = 0;
+    std::cout << "Microseconds per removal from " << n << " particles\n"
+              << std::setw(10) << "Fraction" << std::setw(10) << "Removed"
+              << std::setw(16) << "RemoveInvalids" << std::setw(16) << "Tree rebuild" << '\n';
+    for (unsigned int f = 0; f != nfractions; ++f) {
+        double tRemove = 0.0, tRebuild = 0.0;
+        unsigned int removed = 0;
+        for (unsigned int r = 0; r != repeats; ++r) {
+            Sweep::Ensemble ens;
+            ens = full;
+            removed = 0;
+            for (unsigned int i = 0; i != n; ++i) {
+                if (unif() < fractions[f]) {
+                    ens.At(i)->setStatisticalWeight(0.0);
+                    ++removed;
+                }
+            }
+
+            boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            ens.RemoveInvalids();
+            tRemove += seconds(start);
+            if (!check(ens, n - removed)) ++failures;
+
+            // Time a rebuild of the tree for the remaining particles.
+            Sweep::PartPtrList left = ens.TakeParticles();
+            start = boost::posix_time::microsec_clock::universal_time();
+            ens.SetParticles(left.begin(), left.end(), rng);
+            tRebuild += seconds(start);
+        }
+        std::cout << std::setw(9) << 100.0 * fractions[f] << '%' << std::setw(10) << removed
+                  << std::setw(16) << std::setprecision(4) << tRemove / repeats * 1e6
+                  << std::setw(16) << tRebuild / repeats * 1e6 << '\n';
+    }
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
@@ -0,0 +1,249 @@
+/*!
+ * \file   rng_test.cpp
+ *
+ * \brief  Tests and throughput of the Philox random number generator
+ *
+ *  Checks Sweep::Philox4x32 against the known answers of the Random123
+ *  reference implementation, checks skipping, stream derivation and
+ *  saving of the state, and checks the moments of the distributions used
+ *  in sweep when they are driven by it.  The throughput of each
+ *  distribution is then printed for it and for boost::mt19937.
+ *
+ Licence:
+    This file is part of "sweep".
+
+    sweep is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "swp_philox.h"
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/random/poisson_distribution.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+#include <boost/random/exponential_distribution.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+int failures = 0;
+
+void check(bool ok, const std::string &what)
+{
+    if (!ok) {
+        std::cout << "  ****** " << what << " failed ******\n";
+        ++failures;
+    }
+}
+
+// Known answers of Philox-4x32-10 from the Random123 distribution.
+void knownAnswers()
+{
+    const boost::uint32_t ctrs[3][4] = {
+        {0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u},
+        {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+        {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+    const boost::uint32_t keys[3][2] = {
+        {0x00000000u, 0x00000000u},
+        {0xffffffffu, 0xffffffffu},
+        {0xa4093822u, 0x299f31d0u}};
+    const boost::uint32_t answers[3][4] = {
+        {0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+        {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu},
+        {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+
+    for (int t = 0; t != 3; ++t) {
+        boost::uint32_t out[4];
+        Sweep::Philox4x32::Bijection(ctrs[t], keys[t], out);
+        bool ok = true;
+        for (int i = 0; i != 4; ++i) ok = ok && (out[i] == answers[t][i]);
+        check(ok, "Known answer " + std::string(1, char('1' + t)));
+    }
+
+    // A generator seeded with zero starts from counter zero.
+    Sweep::Philox4x32 rng(0);
+    bool ok = true;
+    for (int i = 0; i != 4; ++i) ok = ok && (rng() == answers[0][i]);
+    check(ok, "First block of the stream");
+}
+
+void engine()
+{
+    // Skipping is the same as drawing, from any position in a block.
+    for (unsigned int start = 0; start != 5; ++start) {
+        for (unsigned int n = 0; n != 11; ++n) {
+            Sweep::Philox4x32 a(42), b(42);
+            for (unsigned int i = 0; i != start; ++i) {a(); b();}
+            for (unsigned int i = 0; i != n; ++i) a();
+            b.discard(n);
+            check(a == b && a() == b(), "discard");
+        }
+    }
+
+    // A long skip carries into the second counter word.
+    Sweep::Philox4x32 far(7);
+    far.discard(4 * 0xFFFFFFFFull + 3);
+    far.discard(6);
+    std::ostringstream farOut;
+    farOut << far;
+    check(farOut.str() == "7 0 2 1 0 0 1", "Counter carry (" + farOut.str() + ")");
+
+    // The state is saved and restored in the middle of a block.
+    Sweep::Philox4x32 c(99);
+    for (int i = 0; i != 6; ++i) c();
+    std::stringstream state;
+    state << c;
+    Sweep::Philox4x32 d;
+    state >> d;
+    check(c == d, "Restored state");
+    bool same = true;
+    for (int i = 0; i != 10; ++i) same = same && (c() == d());
+    check(same, "Restored stream");
+
+    // Streams depend on their identifiers and the parent key, but not
+    // on the numbers drawn from the parent.
+    Sweep::Philox4x32 parent(2013);
+    const Sweep::Philox4x32 s1 = parent.Stream(1);
+    for (int i = 0; i != 3; ++i) parent();
+    check(parent.Stream(1) == s1, "Stream independent of parent position");
+    check(parent.Stream(2) != s1, "Streams differ");
+    check(Sweep::Philox4x32(2014).Stream(1) != s1, "Streams differ between seeds");
+    check(parent.Stream(1).Stream(2) != parent.Stream(2).Stream(1), "Nested streams differ");
+}
+
+// Checks that the mean of samples is within five standard errors.
+void checkMean(const std::string &name, double sum, double sum2, double n,
+               double mean, double variance)
+{
+    const double m = sum / n;
+    const double v = sum2 / n - m * m;
+    const double z = std::fabs(m - mean) / std::sqrt(variance / n);
+    std::cout << name << ": mean " << m << " (expected " << mean << ", z = " << z
+              << "), variance " << v << " (expected " << variance << ")\n";
+    check(z < 5.0 && std::fabs(v / variance - 1.0) < 0.02, name);
+}
+
+void distributions()
+{
+    Sweep::Philox4x32 rng(12345);
+    const unsigned int n = 1000000;
+
+    double sum = 0.0, sum2 = 0.0;
+    boost::uniform_01<Sweep::Philox4x32&, double> unif(rng);
+    for (unsigned int i = 0; i != n; ++i) {
+        const double x = unif();
+        sum += x;
+        sum2 += x * x;
+    }
+    checkMean("uniform_01", sum, sum2, n, 0.5, 1.0 / 12.0);
+
+    sum = sum2 = 0.0;
+    boost::random::poisson_distribution<unsigned int, double> poisson(3.7);
+    for (unsigned int i = 0; i != n; ++i) {
+        const double x = poisson(rng);
+        sum += x;
+        sum2 += x * x;
+    }
+    checkMean("poisson(3.7)", sum, sum2, n, 3.7, 3.7);
+
+    sum = sum2 = 0.0;
+    boost::random::bernoulli_distribution<double> bernoulli(0.3);
+    for (unsigned int i = 0; i != n; ++i) {
+        const double x = bernoulli(rng) ? 1.0 : 0.0;
+        sum += x;
+        sum2 += x * x;
+    }
+    checkMean("bernoulli(0.3)", sum, sum2, n, 0.3, 0.21);
+
+    sum = sum2 = 0.0;
+    boost::random::exponential_distribution<double> exponential(2.0);
+    for (unsigned int i = 0; i != n; ++i) {
+        const double x = exponential(rng);
+        sum += x;
+        sum2 += x * x;
+    }
+    checkMean("exponential(2)", sum, sum2, n, 0.5, 0.25);
+}
+
+// Times n draws of each distribution in millions per second.
+template<class Engine> void throughput(const std::string &name, unsigned int n)
+{
+    Engine rng(2718);
+    double sink = 0.0;
+
+    boost::random::poisson_distribution<unsigned int, double> poisson(3.7);
+    boost::random::bernoulli_distribution<double> bernoulli(0.3);
+    boost::random::exponential_distribution<double> exponential(2.0);
+    boost::uniform_01<Engine&, double> unif(rng);
+
+    std::cout << std::setw(10) << name;
+    for (int d = 0; d != 5; ++d) {
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        switch (d) {
+        case 0: for (unsigned int i = 0; i != n; ++i) sink += rng(); break;
+        case 1: for (unsigned int i = 0; i != n; ++i) sink += unif(); break;
+        case 2: for (unsigned int i = 0; i != n; ++i) sink += poisson(rng); break;
+        case 3: for (unsigned int i = 0; i != n; ++i) sink += bernoulli(rng); break;
+        default: for (unsigned int i = 0; i != n; ++i) sink += exponential(rng); break;
+        }
+        const double seconds = (boost::posix_time::microsec_clock::universal_time() - start)
+                               .total_microseconds() * 1.0e-6;
+        std::cout << std::setw(14) << std::setprecision(4)
+                  << (seconds > 0.0 ? n / seconds * 1.0e-6 : 0.0);
+    }
+    // Print the sum so that the draws are not optimised away.
+    std::cout << "   (" << sink << ")\n";
+}
+}
+
+int main(int argc, char *argv[])
+{
+    knownAnswers();
+    engine();
+    distributions();
+
+    const unsigned int n = (argc > 1) ? std::atoi(argv[1]) : 4000000;
+    std::cout << "\nMillions of draws per second\n"
+              << std::setw(10) << "Generator" << std::setw(14) << "raw" << std::setw(14) << "uniform_01"
+              << std::setw(14) << "poisson" << std::setw(14) << "bernoulli" << std::setw(14) << "exponential\n";
+    throughput<boost::mt19937>("mt19937", n);
+    throughput<Sweep::Philox4x32>("Philox", n);
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
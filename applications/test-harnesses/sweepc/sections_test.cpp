@@ -0,0 +1,204 @@
+/*!
+ * \file   sections_test.cpp
+ *
+ * \brief  Statistical test of Sweep::Mechanism::UpdateSections
+ *
+ *  UpdateSections draws the surface growth jumps of all the particles at
+ *  an index of the particle-number list together.  This harness applies
+ *  it and the per-particle update it replaced many times to the same
+ *  particle-number list and checks that the means and variances of the
+ *  resulting populations agree within sampling error.
+ *
+ Licence:
+    This file is part of "sweep".
+
+    sweep is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "mops.h"
+#include "string_functions.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+// Threshold of the particle-number list, smaller than that of the input
+// so that copying the list for each sample is cheap.
+const unsigned int threshold = 500;
+
+// Samples of each update.
+const unsigned int samples = 400;
+
+// Particles put in the list, and the indices at which they are counted
+// after the update.
+const unsigned int fillIndices[] = {1, 2, 10, 100, 497, 499};
+const unsigned int fillNumbers[] = {20000, 5000, 1000, 300, 200, 50};
+const unsigned int countIndices[] = {1, 2, 3, 10, 11, 12, 100, 101, 499};
+
+const unsigned int nfill = sizeof(fillIndices) / sizeof(fillIndices[0]);
+const unsigned int ncount = sizeof(countIndices) / sizeof(countIndices[0]);
+
+// Observables: the counts, the number of particles in the ensemble and
+// the TiCl4 concentration.
+const unsigned int nobs = ncount + 2;
+
+struct Moments
+{
+    Moments() : sum(nobs, 0.0), sum2(nobs, 0.0), seconds(0.0) {}
+    std::vector<double> sum, sum2;
+    double seconds;
+};
+
+typedef void (Sweep::Mechanism::*UpdateFn)(double, double, Sweep::Cell &, Sweep::rng_type &) const;
+
+// Applies one update to copies of the reactor and accumulates the observables.
+Moments sample(const Mops::Reactor &r, const Sweep::Mechanism &mech, UpdateFn update,
+               double dt, int iticl4, unsigned int seed)
+{
+    Moments m;
+    Sweep::rng_type rng(seed);
+    for (unsigned int s = 0; s != samples; ++s) {
+        Mops::Reactor *copy = r.Clone();
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        (mech.*update)(dt, dt, *copy->Mixture(), rng);
+        m.seconds += (boost::posix_time::microsec_clock::universal_time() - start)
+                     .total_microseconds() * 1.0e-6;
+
+        const Sweep::Ensemble &ens = copy->Mixture()->Particles();
+        std::vector<double> obs(nobs);
+        for (unsigned int i = 0; i != ncount; ++i) {
+            obs[i] = ens.NumberAtIndex(countIndices[i]);
+        }
+        obs[ncount] = ens.Count();
+        obs[ncount + 1] = copy->Mixture()->GasPhase().MolarConc(iticl4);
+        for (unsigned int i = 0; i != nobs; ++i) {
+            m.sum[i] += obs[i];
+            m.sum2[i] += obs[i] * obs[i];
+        }
+        delete copy;
+    }
+    return m;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string dir = (argc > 1) ? std::string(argv[1]) + "/" : std::string();
+
+    Mops::Solver *solver = Mops::SolverFactory::Create(Mops::Strang);
+    Mops::Reactor *reactor = NULL;
+    Mops::Mechanism mech;
+    Mops::timevector times;
+    Mops::Simulator sim;
+
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(dir + "chem.inp", mech.GasMech(), dir + "therm.dat", 0);
+        mech.ParticleMech().SetSpecies(mech.GasMech().Species());
+        Sweep::MechParser::Read(dir + "sweep-fo-spherical.xml", mech.ParticleMech());
+        mech.ParticleMech().SetHybridThreshold(threshold);
+        reactor = Mops::Settings_IO::LoadFromXML(dir + "mops-psr.xml", reactor, times, sim, *solver, mech);
+    } catch (std::exception &e) {
+        std::cerr << "sections_test: Failed to read the inputs: " << e.what() << "\n";
+        delete solver;
+        return 1;
+    }
+
+    // Put the inflow gas in the reactor, so that the particles grow.
+    const int iticl4 = mech.GasMech().FindSpecies("TICL4");
+    const int io2 = mech.GasMech().FindSpecies("O2");
+    Sprog::fvector fracs(mech.GasMech().SpeciesCount(), 0.0);
+    fracs[iticl4] = 0.01;
+    fracs[io2] = 0.99;
+    reactor->Mixture()->GasPhase().SetFracs(fracs);
+
+    const Sweep::Mechanism &pmech = mech.ParticleMech();
+    Sweep::Ensemble &ens = reactor->Mixture()->Particles();
+    pmech.InitialisePNParticles(0.0, *reactor->Mixture(), pmech);
+    for (unsigned int i = 0; i != nfill; ++i) {
+        ens.UpdateNumberAtIndex(fillIndices[i], fillNumbers[i]);
+    }
+    ens.SetTotalParticleNumber();
+    ens.RecalcPNPropertySums();
+
+    // Choose the step so that monomers make 0.05 jumps on average, and
+    // the particles near the threshold about 3.
+    double rate = 0.0;
+    for (Sweep::Processes::PartProcPtrVector::const_iterator p = pmech.Processes().begin();
+         p != pmech.Processes().end(); ++p) {
+        if ((*p)->IsDeferred()) rate = (*p)->Rate(0.0, *reactor->Mixture());
+    }
+    if (!(rate > 0.0)) {
+        std::cerr << "sections_test: The deferred process has no rate.\n";
+        return 1;
+    }
+    const double dt = 0.05 / (Sweep::PI * rate * ens.Diameter2AtIndex(1));
+
+    const Moments batched = sample(*reactor, pmech, &Sweep::Mechanism::UpdateSections, dt, iticl4, 123);
+    const Moments single = sample(*reactor, pmech, &Sweep::Mechanism::UpdateSectionsPerParticle, dt, iticl4, 456);
+
+    // Compare the means by Welch's test and the variances by their ratio,
+    // both at about five standard errors.
+    int failures = 0;
+    for (unsigned int i = 0; i != nobs; ++i) {
+        const double n = samples;
+        const double m1 = batched.sum[i] / n, m2 = single.sum[i] / n;
+        const double v1 = std::max(batched.sum2[i] / n - m1 * m1, 0.0) * n / (n - 1);
+        const double v2 = std::max(single.sum2[i] / n - m2 * m2, 0.0) * n / (n - 1);
+        const double se = std::sqrt((v1 + v2) / n);
+        const double z = (se > 0.0) ? std::fabs(m1 - m2) / se : (m1 == m2 ? 0.0 : HUGE_VAL);
+        const bool varOk = (v1 == 0.0 && v2 == 0.0) ||
+                           (v1 > 0.0 && v2 > 0.0 && v1 / v2 > 0.5 && v1 / v2 < 2.0);
+
+        std::string name;
+        if (i < ncount) name = "N(" + Strings::cstr(countIndices[i]) + ")";
+        else if (i == ncount) name = "Particles";
+        else name = "[TiCl4]";
+        std::cout << name << ": mean " << m1 << " against " << m2 << " (z = " << z
+                  << "), variance " << v1 << " against " << v2 << "\n";
+        if (z > 5.0 || !varOk) {
+            std::cout << "  ****** " << name << " differs ******\n";
+            ++failures;
+        }
+    }
+    std::cout << "Time per update: " << batched.seconds / samples << " s batched, "
+              << single.seconds / samples << " s per particle\n";
+
+    delete reactor;
+    delete solver;
+    if (failures > 0) {
+        std::cout << failures << " observables differ\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
@@ -0,0 +1,241 @@
+/*!
+ * \file   stats_test.cpp
+ *
+ * \brief  Checks and timings of Sweep::Stats::ParticleStats::Calculate
+ *
+ *  Fills an ensemble with particles of random sizes, statistical weights
+ *  and coagulation counts and calculates their stats, with a bound on the
+ *  collision diameter that leaves out about a third of them.  The stats
+ *  are compared with a particle by particle sum, and the stats calculated
+ *  with and without the threaded reduction, which uses four threads even
+ *  on a single core, are checked to be identical.
+ *  The times per call of the two sums are then printed.
+ *
+ *  Usage: sweepStats-test dir [k], where dir holds chem.inp, therm.dat
+ *  and sweep-fo-spherical.xml and the ensemble holds about 2^k particles
+ *  (by default 2^17).
+ *
+ Licence:
+    This file is part of "sweep".
+
+    sweep is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "gpc_mech.h"
+#include "gpc_mech_io.h"
+#include "swp_mechanism.h"
+#include "swp_mech_parser.h"
+#include "swp_ensemble.h"
+#include "swp_particle_stats.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <boost/random/uniform_01.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+// Repetitions of each calculation, to average the timings.
+const unsigned int repeats = 20;
+
+// Scaling factor to unit volume (1/m3).
+const double scale = 1.0e12;
+
+double seconds(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+           .total_microseconds() * 1.0e-6;
+}
+
+// The stats of ParticleStats::Calculate, summed particle by particle.
+Sweep::fvector particleSums(const Sweep::Ensemble &ens, const Sweep::Stats::IModelStats::StatBound &sb,
+                            unsigned int ncomp, unsigned int ntrack)
+{
+    Sweep::fvector sums(15 + 2 * (ncomp + ntrack), 0.0);
+    unsigned int maxCoag = 0;
+    for (unsigned int i = 0; i != ens.Count(); ++i) {
+        const Sweep::Particle &sp = *ens.At(i);
+        const double sz = sp.Property(sb.PID);
+        if ((sz <= sb.Lower) || (sz >= sb.Upper)) continue;
+        const double wt = sp.getStatisticalWeight();
+        const double m = sp.Mass();
+        sums[1] += wt;
+        sums[2] += sp.SphDiameter() * wt;
+        sums[3] += sp.CollDiameter() * wt;
+        sums[4] += sp.MobDiameter() * wt;
+        sums[5] += sp.SurfaceArea() * wt;
+        sums[7] += sp.Volume() * wt;
+        sums[9] += m * wt;
+        sums[11] += m * m * wt;
+        sums[12] += m * m * m * wt;
+        sums[13] += sp.getCoagCount() * wt;
+        maxCoag = std::max(maxCoag, sp.getCoagCount());
+        for (unsigned int j = 0; j != ncomp; ++j) sums[15 + 2 * j] += sp.Composition(j) * wt;
+        for (unsigned int j = 0; j != ntrack; ++j) sums[15 + 2 * (ncomp + j)] += sp.Values(j) * wt;
+    }
+
+    // Scale the totals and take the averages, as Calculate does.
+    const double invWeight = 1.0 / sums[1];
+    sums[0] = ens.Count();
+    sums[6] = sums[5];
+    sums[8] = sums[7];
+    sums[10] = sums[9];
+    sums[14] = maxCoag;
+    const unsigned int avg[] = {2, 3, 4, 6, 8, 10, 13};
+    const unsigned int total[] = {1, 5, 7, 9, 11, 12};
+    for (unsigned int i = 0; i != sizeof(avg) / sizeof(avg[0]); ++i) sums[avg[i]] *= invWeight;
+    for (unsigned int i = 0; i != sizeof(total) / sizeof(total[0]); ++i) sums[total[i]] *= scale;
+    for (unsigned int i = 15; i != sums.size(); i += 2) {
+        sums[i + 1] = sums[i] * invWeight;
+        sums[i] *= scale * 1.0e-6;
+    }
+    return sums;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " dir [k]\n";
+        return 1;
+    }
+    const std::string dir = std::string(argv[1]) + "/";
+    const unsigned int k = (argc > 2) ? std::atoi(argv[2]) : 17;
+    // Leave the last block of particles part full.
+    const unsigned int n = (1u << k) + 37;
+
+    Sprog::Mechanism gas;
+    Sweep::Mechanism mech;
+    try {
+        Sprog::IO::MechanismParser::ReadChemkin(dir + "chem.inp", gas, dir + "therm.dat", 0);
+        mech.SetSpecies(gas.Species());
+        Sweep::MechParser::Read(dir + "sweep-fo-spherical.xml", mech);
+    } catch (std::exception &e) {
+        std::cerr << "stats_test: Failed to read the inputs: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Particles of random sizes, weights and coagulation counts.
+    Sweep::rng_type rng(2013);
+    boost::uniform_01<Sweep::rng_type&, double> unif(rng);
+    std::list<Sweep::Particle*> particles;
+    for (unsigned int i = 0; i != n; ++i) {
+        Sweep::Particle *sp = mech.CreateParticle(0.0);
+        Sweep::fvector comp(mech.ComponentCount(), 0.0);
+        comp[0] = 1.0 + std::floor(1000.0 * unif());
+        sp->Primary()->SetComposition(comp);
+        sp->setStatisticalWeight(0.5 + unif());
+        const unsigned int coags = static_cast<unsigned int>(10.0 * unif());
+        for (unsigned int j = 0; j != coags; ++j) sp->incrementCoagCount();
+        sp->UpdateCache();
+        particles.push_back(sp);
+    }
+    Sweep::Ensemble ens;
+    ens.Initialise(n);
+    ens.SetParticles(particles.begin(), particles.end(), rng);
+
+    // Leave out the particles of less than 334 units.
+    Sweep::Stats::IModelStats::StatBound sb;
+    sb.PID = Sweep::iDcol;
+    sb.Lower = std::pow(334.0, 1.0 / 3.0) * ens.At(0)->CollDiameter()
+               / std::pow(ens.At(0)->Composition(0), 1.0 / 3.0);
+
+    int failures = 0;
+    Sweep::Stats::ParticleStats stats(mech);
+    stats.SetStatBoundary(sb);
+#ifdef _OPENMP
+    // The default on a single core would never run the threaded reduction.
+    omp_set_num_threads(4);
+#endif
+    stats.Calculate(ens, scale);
+    const Sweep::fvector threaded = stats.Get();
+    stats.SetThreadedReduction(false);
+    stats.Calculate(ens, scale);
+    if (stats.Get() != threaded) {
+        std::cout << "  The stats with and without the threaded reduction differ\n";
+        ++failures;
+    }
+
+    const Sweep::fvector expected = particleSums(ens, sb, mech.ComponentCount(), mech.TrackerCount());
+    double worst = 0.0;
+    for (unsigned int i = 0; i != expected.size(); ++i) {
+        const double err = std::fabs(threaded[i] - expected[i]) / std::max(std::fabs(expected[i]), 1e-300);
+        worst = std::max(worst, err);
+        if (err > 1e-12) {
+            std::cout << "  Stat " << i << " (" << stats.Names()[i] << ") is " << threaded[i]
+                      << " instead of " << expected[i] << "\n";
+            ++failures;
+        }
+    }
+    std::cout << "Largest relative difference from the particle by particle sums " << worst << "\n";
+    if (expected[1] >= scale * ens.GetSum(Sweep::iW) * 0.9) {
+        std::cout << "  The stats bound left out too few particles\n";
+        ++failures;
+    }
+
+    // Timings of a calculation.
+    stats.SetThreadedReduction(true);
+    double sumStats = 0.0;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (unsigned int r = 0; r != repeats; ++r) {
+        stats.Calculate(ens, scale);
+        sumStats += stats.M0();
+    }
+    const double tStats = seconds(start) / repeats;
+
+    double sumParticles = 0.0;
+    start = boost::posix_time::microsec_clock::universal_time();
+    for (unsigned int r = 0; r != repeats; ++r) {
+        sumParticles += particleSums(ens, sb, mech.ComponentCount(), mech.TrackerCount())[1];
+    }
+    const double tParticles = seconds(start) / repeats;
+    if (std::fabs(sumStats - sumParticles) > 1e-12 * sumParticles) {
+        std::cout << "  Timed calculations differ\n";
+        ++failures;
+    }
+    std::cout << "Milliseconds per calculation for " << n << " particles: "
+              << std::setprecision(4) << tStats * 1e3 << " in blocks, "
+              << tParticles * 1e3 << " particle by particle\n";
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
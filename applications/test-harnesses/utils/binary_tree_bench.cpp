@@ -0,0 +1,250 @@
+/*!
+ * \file   binary_tree_bench.cpp
+ *
+ * \brief  Checks and microbenchmarks of the indexed selection in Utils::BinaryTree
+ *
+ *  For trees of 2^k entries, with weights the size of the particle caches
+ *  used by sweep, this checks that selection by indexed weights picks the
+ *  same entries as selection by walking the nodes and that batched
+ *  replacement and removal leave the same sums as one change at a time.
+ *  It then prints the time per selection of one and of two particles by
+ *  each method and the time per changed entry of batched and single
+ *  replacement.
+ *
+ *  Usage: binaryTree-bench [kmin [kmax]], by default k = 14 to 20.
+ *
+ Licence:
+    This file is part of "utils".
+
+    utils is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include "binary_tree.hpp"
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+// Number of properties in a weight, so that it is about as large as
+// Sweep::TreeTransCoagWeightedCache.
+const unsigned int nprops = 30;
+
+// Weight with the layout of a particle cache.
+struct Cache
+{
+    Cache() {for (unsigned int i = 0; i != nprops; ++i) p[i] = 0.0;}
+    Cache operator+(const Cache &rhs) const
+    {
+        Cache c;
+        for (unsigned int i = 0; i != nprops; ++i) c.p[i] = p[i] + rhs.p[i];
+        return c;
+    }
+    bool operator==(const Cache &rhs) const
+    {
+        for (unsigned int i = 0; i != nprops; ++i) {
+            if (p[i] != rhs.p[i]) return false;
+        }
+        return true;
+    }
+    double p[nprops];
+};
+
+// Extracts one property, as Ensemble::WeightExtractor does.
+struct Extractor
+{
+    explicit Extractor(unsigned int i) : id(i) {}
+    double operator()(const Cache &c) const {return c.p[id];}
+    unsigned int id;
+};
+
+typedef Utils::BinaryTree<Cache, unsigned int> Tree;
+typedef boost::uniform_01<boost::mt19937&, double> Uniform;
+
+// Properties by which two particles are chosen in the benchmark.
+const unsigned int prop1 = 3, prop2 = 17;
+
+Cache randomCache(Uniform &unif)
+{
+    Cache c;
+    for (unsigned int i = 0; i != nprops; ++i) c.p[i] = unif();
+    // Some zero weights, like particles without a property.
+    if (unif() < 0.01) c.p[prop1] = 0.0;
+    return c;
+}
+
+int failures = 0;
+
+void check(bool ok, const std::string &what)
+{
+    if (!ok) {
+        std::cout << "  ****** " << what << " failed ******\n";
+        ++failures;
+    }
+}
+
+double seconds(const boost::posix_time::ptime &start)
+{
+    return (boost::posix_time::microsec_clock::universal_time() - start)
+           .total_microseconds() * 1.0e-6;
+}
+
+// Compares the sums and a sample of selections from two trees.
+bool sameTrees(const Tree &a, const Tree &b, Uniform &unif)
+{
+    if (a.size() != b.size() || !(a.head() == b.head())) return false;
+    for (unsigned int i = 0; i != 1000; ++i) {
+        const double d = unif() * a.head().p[prop2];
+        if (a.select(d, Extractor(prop2)) - a.begin() != b.select(d, Extractor(prop2)) - b.begin())
+            return false;
+    }
+    return true;
+}
+
+// Relative difference of the sums of a property over the nodes and the index.
+bool sameSums(const Tree &t, unsigned int w, unsigned int prop)
+{
+    const double a = t.head().p[prop], b = t.indexHead(w);
+    return std::fabs(a - b) <= 1e-12 * std::fabs(a);
+}
+
+void run(unsigned int k, Uniform &unif)
+{
+    const unsigned int n = 1u << k;
+    std::vector<Tree::value_type> values;
+    values.reserve(n);
+    for (unsigned int i = 0; i != n; ++i) values.push_back(Tree::value_type(randomCache(unif), i));
+
+    Tree tree(n);
+    tree.assign(values.begin(), values.end());
+    Tree::size_type w[2];
+    w[0] = tree.index(Extractor(prop1));
+    w[1] = tree.index(Extractor(prop2));
+    check(tree.isValid() && sameSums(tree, w[0], prop1) && sameSums(tree, w[1], prop2),
+          "Indexed sums");
+
+    // Selection by the index and by the nodes.
+    const Tree &ct = tree;
+    const unsigned int nsel = 200000;
+    std::vector<double> d(2 * nsel);
+    for (unsigned int i = 0; i != nsel; ++i) {
+        d[2 * i] = unif() * ct.head().p[prop1];
+        d[2 * i + 1] = unif() * ct.head().p[prop2];
+    }
+
+    std::vector<unsigned int> byNodes(2 * nsel), byIndex(2 * nsel), byPairs(2 * nsel);
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (unsigned int i = 0; i != nsel; ++i) {
+        byNodes[2 * i] = ct.select(d[2 * i], Extractor(prop1)) - ct.begin();
+        byNodes[2 * i + 1] = ct.select(d[2 * i + 1], Extractor(prop2)) - ct.begin();
+    }
+    const double tNodes = seconds(start);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    for (unsigned int i = 0; i != nsel; ++i) {
+        byIndex[2 * i] = ct.select_indexed(w[0], d[2 * i]) - ct.begin();
+        byIndex[2 * i + 1] = ct.select_indexed(w[1], d[2 * i + 1]) - ct.begin();
+    }
+    const double tIndex = seconds(start);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    Tree::const_iterator selected[2];
+    for (unsigned int i = 0; i != nsel; ++i) {
+        ct.select_indexed(2, w, &d[2 * i], selected);
+        byPairs[2 * i] = selected[0] - ct.begin();
+        byPairs[2 * i + 1] = selected[1] - ct.begin();
+    }
+    const double tPairs = seconds(start);
+    check(byNodes == byIndex && byNodes == byPairs, "Same selections");
+
+    // Replacement of 1% of the entries, one at a time and batched, in
+    // two copies of the tree.
+    const unsigned int nrep = (n >= 200) ? n / 100 : 2;
+    std::vector<unsigned int> positions(nrep);
+    std::vector<Tree::value_type> newValues;
+    for (unsigned int i = 0; i != nrep; ++i) {
+        positions[i] = static_cast<unsigned int>(unif() * n) % n;
+        newValues.push_back(Tree::value_type(randomCache(unif), positions[i]));
+    }
+    Tree single(tree), batched(tree);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    for (unsigned int i = 0; i != nrep; ++i) single.replace(single.begin() + positions[i], newValues[i]);
+    const double tSingle = seconds(start);
+
+    start = boost::posix_time::microsec_clock::universal_time();
+    batched.replace(positions.begin(), positions.end(), newValues.begin());
+    const double tBatched = seconds(start);
+
+    check(sameTrees(single, batched, unif) &&
+          sameSums(batched, w[0], prop1) && sameSums(batched, w[1], prop2),
+          "Batched replacement");
+
+    // Removal of the last 1% of the entries.
+    for (unsigned int i = 0; i != nrep; ++i) single.pop_back();
+    batched.pop_back(nrep);
+    check(sameTrees(single, batched, unif) && batched.isValid() &&
+          sameSums(batched, w[0], prop1) && sameSums(batched, w[1], prop2),
+          "Batched removal");
+
+    std::cout << std::setw(4) << k
+              << std::setw(14) << tNodes / nsel * 1e9 << std::setw(14) << tIndex / nsel * 1e9
+              << std::setw(14) << tPairs / nsel * 1e9
+              << std::setw(14) << tSingle / nrep * 1e9 << std::setw(14) << tBatched / nrep * 1e9
+              << '\n';
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const unsigned int kmin = (argc > 1) ? std::atoi(argv[1]) : 14;
+    const unsigned int kmax = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+    boost::mt19937 rng(123);
+    Uniform unif(rng);
+
+    std::cout << "Nanoseconds per pair of selections and per replaced entry\n"
+              << std::setw(4) << "k" << std::setw(14) << "nodes" << std::setw(14) << "indexed"
+              << std::setw(14) << "indexed pair" << std::setw(14) << "replace" << std::setw(14)
+              << "batched" << '\n' << std::setprecision(4);
+    for (unsigned int k = kmin; k <= kmax; ++k) run(k, unif);
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*! Converts text gas-phase profiles into binary ones.
+ *
+ *  The binary profiles hold the same columns as the text files and are
+ *  memory-mapped by mops and the PAH-KMC simulator instead of being
+ *  parsed, which matters for profiles with many points and species.
+ */
+
+#include "gpc_gas_profile_io.h"
+#include "boost/program_options.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace boost::program_options;
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    vector<string> inputFiles;
+    string outputFile;
+    bool info = false;
+
+    try {
+        // Parse arguments.
+        options_description desc("Allowed options for program");
+        desc.add_options()
+            ("help", "Show this help message.")
+            ("info", "Print the columns and point counts instead of converting.")
+            ("output,o", value<string>(&outputFile), "Output file, if there is one input file.")
+            ("input", value< vector<string> >(&inputFiles), "Text gas-phase profiles.");
+
+        positional_options_description pos;
+        pos.add("input", -1);
+
+        variables_map vm;
+        store(command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+        notify(vm);
+
+        if (vm.count("help") || inputFiles.empty()) {
+            cout << "Usage: " << argv[0] << " [options] gasphase.inp ...\n" << desc << "\n";
+            return 1;
+        }
+        if (vm.count("info")) info = true;
+        if (!outputFile.empty() && inputFiles.size() > 1) {
+            throw std::logic_error("--output can only be used with one input file.");
+        }
+    } catch (std::exception &e) {
+        cerr << argv[0] << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        for (size_t f = 0; f != inputFiles.size(); ++f) {
+            if (info) {
+                boost::shared_ptr<const Sprog::IO::GasProfileFile> prof =
+                    Sprog::IO::GasProfileFile::Open(inputFiles[f]);
+                cout << inputFiles[f] << ": " << prof->PointCount() << " points, "
+                     << (prof->IsMapped() ? "binary" : "text") << "\n";
+                for (size_t i = 0; i != prof->Columns().size(); ++i) {
+                    cout << "  " << prof->Columns()[i] << "\n";
+                }
+                continue;
+            }
+
+            // By default replace the extension by .bin.
+            string binFile = outputFile;
+            if (binFile.empty()) {
+                binFile = inputFiles[f];
+                const size_t dot = binFile.find_last_of('.');
+                const size_t slash = binFile.find_last_of("/\\");
+                if (dot != string::npos && (slash == string::npos || dot > slash)) {
+                    binFile.resize(dot);
+                }
+                binFile += ".bin";
+            }
+            if (binFile == inputFiles[f]) {
+                throw std::logic_error(inputFiles[f] + " would be overwritten.");
+            }
+
+            Sprog::IO::GasProfileFile::Convert(inputFiles[f], binFile);
+            cout << "Wrote " << binFile << "\n";
+        }
+    } catch (std::exception &e) {
+        cerr << argv[0] << ": " << e.what() << "\n";
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*! Converts binary PSL files written by mops into CSV files.
+ *
+ *  The CSV files are identical to those mops writes itself when the PSL
+ *  format is set to csv.
+ */
+
+#include "mops_psl_file.h"
+#include "csv_io.h"
+#include "boost/program_options.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace boost::program_options;
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    vector<string> inputFiles;
+    string outputFile;
+    bool info = false;
+
+    try {
+        // Parse arguments.
+        options_description desc("Allowed options for program");
+        desc.add_options()
+            ("help", "Show this help message.")
+            ("info", "Print the columns and row counts instead of converting.")
+            ("output,o", value<string>(&outputFile), "Output file, if there is one input file.")
+            ("input", value< vector<string> >(&inputFiles), "Binary PSL files.");
+
+        positional_options_description pos;
+        pos.add("input", -1);
+
+        variables_map vm;
+        store(command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+        notify(vm);
+
+        if (vm.count("help") || inputFiles.empty()) {
+            cout << "Usage: " << argv[0] << " [options] file.bin ...\n" << desc << "\n";
+            return 1;
+        }
+        if (vm.count("info")) info = true;
+        if (!outputFile.empty() && inputFiles.size() > 1) {
+            throw std::logic_error("--output can only be used with one input file.");
+        }
+    } catch (std::exception &e) {
+        cerr << argv[0] << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        for (size_t f = 0; f != inputFiles.size(); ++f) {
+            const Mops::PSLFileReader psl(inputFiles[f]);
+
+            if (info) {
+                cout << inputFiles[f] << ": " << psl.RowCount() << " rows in "
+                     << psl.ChunkCount() << " chunks\n";
+                for (unsigned int i = 0; i != psl.ColumnCount(); ++i) {
+                    cout << "  " << psl.Name(i);
+                    if (!psl.Unit(i).empty()) cout << " [" << psl.Unit(i) << "]";
+                    cout << "\n";
+                }
+                continue;
+            }
+
+            // By default replace the .bin extension by .csv.
+            string csvFile = outputFile;
+            if (csvFile.empty()) {
+                csvFile = inputFiles[f];
+                if (csvFile.size() > 4 && csvFile.substr(csvFile.size() - 4) == ".bin") {
+                    csvFile.resize(csvFile.size() - 4);
+                }
+                csvFile += ".csv";
+            }
+
+            CSV_IO out(csvFile, true);
+            vector<string> header;
+            psl.Headings(header);
+            out.Write(header);
+
+            vector<double> row;
+            for (unsigned int k = 0; k != psl.ChunkCount(); ++k) {
+                for (unsigned int j = 0; j != psl.ChunkRows(k); ++j) {
+                    psl.ReadRow(k, j, row);
+                    out.Write(row);
+                }
+            }
+            out.Close();
+
+            cout << "Wrote " << psl.RowCount() << " rows to " << csvFile << "\n";
+        }
+    } catch (std::exception &e) {
+        cerr << argv[0] << ": " << e.what() << "\n";
+        return 2;
+    }
+
+    return 0;
+}
@@ -38,16 +38,29 @@ background {color White}
 #declare fbase = "calc/0.8/wu-tem";
 #declare time = "0.8s";
 
+// Were the images written to one file per time (ptrack combined="true")?
+#declare combined = 0;
+
 // Declare number of particles to draw
 #declare nump = 25;
 #declare i = 1;
 
+#if (combined)
+    #include concat(fbase, "(", time, ").pov")
+    #declare nump = min(nump, ParticleCount);
+#end
+
 // Loop over particles to plot them all
 #while (i < nump)
+    #if (combined)
+    #declare d  = ParticleDiameter[i];
+    #declare sp = blob {MyParticle(i)};
+    #else
     #declare fname = concat(fbase, "(", time, ", ", str(i,0,0), ").pov")
     #include fname
     #declare d  = ParticleDiameter;
     #declare sp = blob {MyParticle};
+    #end
     
     blob {
         sp
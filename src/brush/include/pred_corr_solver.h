@@ -89,6 +89,15 @@ public:
     void solve(Reactor1d &reac, const double t_start, const double t_stop, const int n_steps,
                const size_t seed) const;
 
+    //! Wall clock seconds spent on the particle processes of each cell since the last reset
+    const fvector& getCellTimes() const {return mCellTimes;}
+
+    //! Work predicted for each cell by the cost model at the last step
+    const fvector& getCellCosts() const {return mCellCosts;}
+
+    //! Start accumulating the cell times from zero
+    void resetCellTimes() const;
+
 protected:
     //! Perform one time step using a predictor followed by some corrector iterations
     void predictorCorrectorStep(Reactor1d &reac, const double t_start, const double t_stop,
@@ -98,6 +107,10 @@ protected:
     void solveParticlesByCell(Reactor1d &reac, const double t_start, const double t_stop,
                               std::vector<Sweep::rng_type>& cell_rngs) const;
 
+    //! Advance the particles in all cells, the most expensive cells first
+    void solveCellsByCost(Reactor1d &reac, const double t_start, const double t_stop,
+                          std::vector<Sweep::rng_type>& cell_rngs) const;
+
     //! Advance particle population to specified time
     void solveParticlesInOneCell(Sweep::Cell &cell, const Geometry::LocalGeometry1d &geom,
                                  const Sweep::Mechanism &mech, double t, double t_stop,
@@ -129,19 +142,20 @@ private:
                                     Sweep::Particle& sp, Sweep::rng_type &rng) const;
 
     /*!
-     *  \brief Lists of particles due to be added to cells
+     *  \brief Particles moving between cells
      *
-     *  Particles in the the lists at index i in the vector are destined to be added to
-     *  cell i of a reactor.
+     *  Each entry holds the index of a cell and a particle moving out of it or
+     *  into it.  Only the particles that change cell are listed, so the lists
+     *  are short when the particles mostly move to neighbouring cells or stay.
      */
-    typedef std::vector<std::list<Sweep::Particle*> > inflow_lists_vector;
+    typedef std::vector<std::pair<size_t, Sweep::Particle*> > transfer_vector;
 
-    //! Take the particles from a cell and put them in lists according to their new positions
-    inflow_lists_vector updateParticleListPositions(const double t_start, const double t_stop, Sweep::Cell &mix,
-                                                    const size_t cell_index, const Sweep::Mechanism &mech,
-                                                    const Geometry::Geometry1d &geom,
-                                                    const std::vector<const Sweep::Cell*> &neighbouring_cells,
-                                                    Sweep::rng_type &rng) const;
+    //! Update the particle positions in a cell and take out those which leave it
+    transfer_vector updateParticleListPositions(const double t_start, const double t_stop, Sweep::Cell &mix,
+                                                const size_t cell_index, const Sweep::Mechanism &mech,
+                                                const Geometry::Geometry1d &geom,
+                                                const std::vector<const Sweep::Cell*> &neighbouring_cells,
+                                                Sweep::rng_type &rng) const;
 
 
     //! Object for setting reactor chemistry to fixed values (? just use pointer)
@@ -219,6 +233,12 @@ private:
     //! True if transport should be CSTR like random jumps between cell centres.
     bool mCSTRTransport;
 
+    //! Seconds spent advancing the particles in each cell, for load balance diagnostics
+    mutable fvector mCellTimes;
+
+    //! Predicted work for each cell at the last step
+    mutable fvector mCellCosts;
+
 }; //class PredCorrSolver
 } //namespace Brush
 
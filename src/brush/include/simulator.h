@@ -89,6 +89,9 @@ protected:
     //! Save process rates in a text file
     void saveProcessRates(const Reactor1d &reac, const double t, std::ostream &out);
 
+    //! Save the time spent in each cell since the last call in a text file
+    void saveCellTimes(const Reactor1d &reac, const double t, std::ostream &out);
+
     //! Build the name of the moments file for a path
     std::string buildParticleStatsFileName(const int seed) const;
 
@@ -98,6 +101,9 @@ protected:
     //! Build the name of the particle rates log file for a path
     std::string buildParticleRatesFileName(const int seed) const;
 
+    //! Build the name of the cell timing file for a path
+    std::string buildCellTimesFileName(const int seed) const;
+
 private:
     //! Number of paths to run
     size_t mPaths;
@@ -54,6 +54,7 @@
 #include <list>
 #include <cassert>
 #include <boost/functional/hash.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/bernoulli_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
@@ -135,6 +136,14 @@ void Brush::PredCorrSolver::solve(Reactor1d &reac, const double t_start, const d
     }
 }
 
+/*!
+ * The cell times accumulate over all calls to solve, so that callers can
+ * report the time spent in each cell over an output interval.
+ */
+void Brush::PredCorrSolver::resetCellTimes() const {
+    std::fill(mCellTimes.begin(), mCellTimes.end(), 0.0);
+}
+
 /*!
  * Advance the solution to t_stop by means of a predictor step followed
  * by zero or more corrector iterations
@@ -231,20 +240,10 @@ void Brush::PredCorrSolver::solveChemistry(Reactor1d &reac,
 void Brush::PredCorrSolver::solveParticlesByCell(Reactor1d &reac, const double t_start, const double t_stop,
                                                  std::vector<Sweep::rng_type>& cell_rngs) const {
 
-    const size_t numCells = reac.getNumCells();
-    const Sweep::Mechanism &mech = reac.getParticleMechanism();
-
     // Select time step for Strang or first order splitting
     const double firstStop = mStrangTransportSplitting ? (t_start + t_stop) / 2.0 : t_stop;
 
-#pragma omp parallel for schedule(dynamic) ordered
-    for(int i = numCells; i > 0; --i) {
-        // Get details of cell i
-        Sweep::Cell& cell = reac.getCell(i - 1);
-        Geometry::LocalGeometry1d geom(reac.getGeometry(), i - 1);
-
-        solveParticlesInOneCell(cell, geom, mech, t_start, firstStop, cell_rngs[i - 1]);
-    }
+    solveCellsByCost(reac, t_start, firstStop, cell_rngs);
 
     // Now do the split particle transport, if there is any
     if(mSplitDiffusion || mSplitAdvection) {
@@ -253,16 +252,63 @@ void Brush::PredCorrSolver::solveParticlesByCell(Reactor1d &reac, const double t
 
     if(mStrangTransportSplitting) {
         // Do the second part of the particle simulation for the Strang splitting
-#pragma omp parallel for schedule(dynamic) ordered
-        for(int i = numCells; i > 0; --i) {
-            // Get details of cell i
-            Sweep::Cell& cell = reac.getCell(i - 1);
-            Geometry::LocalGeometry1d geom(reac.getGeometry(), i - 1);
+        solveCellsByCost(reac, firstStop, t_stop, cell_rngs);
+    }
 
-            solveParticlesInOneCell(cell, geom, mech, firstStop, t_stop, cell_rngs[i - 1]);
-        }
+}
+
+/*!
+ * The work in a cell varies by orders of magnitude across a flame, so the
+ * cells are handed to the threads in order of decreasing predicted work,
+ * which keeps a few expensive cells from being started last.  The work is
+ * predicted as the number of particles, each of which is updated by the
+ * LPDA, plus the expected number of jump events in the step.
+ *
+ * Each cell has its own RNG, so the results do not depend on the order in
+ * which the cells are solved or on the number of threads.
+ *
+ *\param[in,out]        reac        Reactor describing system state
+ *\param[in]            t_start     Time from which to advance solution
+ *\param[in]            t_stop      Time to which to advance solution
+ *\param[in]            cell_rngs   Vector of independent RNGs, one for each cell
+ */
+void Brush::PredCorrSolver::solveCellsByCost(Reactor1d &reac, const double t_start, const double t_stop,
+                                             std::vector<Sweep::rng_type>& cell_rngs) const {
+    const size_t numCells = reac.getNumCells();
+    const Sweep::Mechanism &mech = reac.getParticleMechanism();
+
+    mCellTimes.resize(numCells, 0.0);
+    mCellCosts.resize(numCells);
+
+    // Predict the work in each cell
+    std::vector<std::pair<double, int> > order(numCells);
+    for(size_t i = 0; i != numCells; ++i) {
+        const Sweep::Cell& cell = reac.getCell(i);
+        Geometry::LocalGeometry1d geom(reac.getGeometry(), i);
+
+        fvector jumpRates;
+        const double jumpRate = mech.CalcJumpRateTerms(t_start, cell, geom, jumpRates);
+        mCellCosts[i] = cell.ParticleCount() + jumpRate * (t_stop - t_start);
+
+        // Negate the cost so that sorting puts the most expensive cells
+        // first, and the lowest index first among cells of equal cost.
+        order[i] = std::make_pair(-mCellCosts[i], static_cast<int>(i));
     }
+    std::sort(order.begin(), order.end());
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for(int k = 0; k < static_cast<int>(numCells); ++k) {
+        const int i = order[k].second;
 
+        // Get details of cell i
+        Sweep::Cell& cell = reac.getCell(i);
+        Geometry::LocalGeometry1d geom(reac.getGeometry(), i);
+
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        solveParticlesInOneCell(cell, geom, mech, t_start, t_stop, cell_rngs[i]);
+        mCellTimes[i] += (boost::posix_time::microsec_clock::universal_time() - start)
+                         .total_microseconds() * 1.0e-6;
+    }
 }
 
 /*!
@@ -323,6 +369,12 @@ void Brush::PredCorrSolver::solveParticlesInOneCell(Sweep::Cell &cell, const Geo
  }
 
 /*!
+ * Particles that stay in their cell are left in its ensemble, so the work
+ * here is proportional to the number of particles that change cell.  These
+ * are taken out of their old ensembles, reweighted for their new cells and
+ * added to the new ensembles, where only the leaves of the trees that
+ * change are updated.
+ *
  *@param[in,out]    reac        Reactor in which particles are being transported
  *@param[in]        t_start     Time at which position was last calculated by splitting
  *@param[in]        t_stop      Time upto which transport is to be simulated
@@ -332,11 +384,9 @@ void Brush::PredCorrSolver::splitParticleTransport(Reactor1d &reac, const double
                                                    const double t_stop, std::vector<Sweep::rng_type>& cell_rngs) const {
     const size_t numCells = reac.getNumCells();
 
-    // Element i of the outer vector will contain the outflow from cell i of the reactor.
-    // Element j of the inner vector will contain particles destined for cell j of the reactor.
-    // After this vector of vectors of lists had been populated, it will be necessary to merge
-    // the lists of particles being transported into each cell of the reactor.
-    std::vector<inflow_lists_vector> inflowLists(numCells, inflow_lists_vector(numCells));
+    // Element i will contain the particles leaving cell i of the reactor,
+    // each with the index of the cell it is moving into.
+    std::vector<transfer_vector> outflows(numCells);
     std::vector<double> statisticalWeights(numCells);
     std::vector<double> cellVolumes(numCells);
     std::vector<double> maxCapacities(numCells);
@@ -364,24 +414,35 @@ void Brush::PredCorrSolver::splitParticleTransport(Reactor1d &reac, const double
         if(neighbourIndex >= 0)
             neighbouringCells[1] = &(reac.getCell(neighbourIndex));
 
-        // The weight will be needed when the particles are put back into the cell
+        // The weight will be needed when particles are added to the cell
         statisticalWeights[i] = 1.0 / mix.SampleVolume();
         cellVolumes[i] = geom.cellVolume();
         maxCapacities[i] = static_cast<double>(mix.Particles().Capacity());
         velocities[i] = mix.GasPhase().Velocity();
 
-        // Remove all particles from the cell and add them
-        // to the inflow list for the appropriate cell
-        inflowLists[i] = updateParticleListPositions(t_start, t_stop, mix, i,
-                                                     reac.getParticleMechanism(),
-                                                     reac.getGeometry(), neighbouringCells,
-                                                     cell_rngs[i]);
+        // Take the particles that are changing cell out of the cell
+        outflows[i] = updateParticleListPositions(t_start, t_stop, mix, i,
+                                                  reac.getParticleMechanism(),
+                                                  reac.getGeometry(), neighbouringCells,
+                                                  cell_rngs[i]);
     }// loop over all cells and build up lists of particles that are moving cells
 
     // There has to be a synchronisation point here, in that parallel replacement of
     // particles in cells cannot begin until the positions and cells of all particles
     // have been calculated.
 
+    // Sort the moving particles by destination.  Element i will contain the
+    // particles moving into cell i, each with the index of the cell it left,
+    // in order of the cells they left.
+    std::vector<transfer_vector> inflows(numCells);
+    for(size_t j = 0; j != numCells; ++j) {
+        const transfer_vector::const_iterator itEnd = outflows[j].end();
+        for(transfer_vector::const_iterator it = outflows[j].begin(); it != itEnd; ++it) {
+            inflows[it->first].push_back(std::make_pair(j, it->second));
+        }
+        transfer_vector().swap(outflows[j]);
+    }
+
 #pragma omp parallel for schedule(dynamic)
     for(long int i = 0; i < numCells; ++i) {
         // i is the index of the destination cell
@@ -390,52 +451,50 @@ void Brush::PredCorrSolver::splitParticleTransport(Reactor1d &reac, const double
         // this variable is local to each loop iteration
         Sweep::PartPtrList partList;
 
-        for(size_t j = 0; j != numCells; ++j) {
+        const transfer_vector::const_iterator itEnd = inflows[i].end();
+        for(transfer_vector::const_iterator it = inflows[i].begin(); it != itEnd; ++it) {
+            // j is the index of the cell the particle came from
+            const size_t j = it->first;
+            Sweep::Particle *sp = it->second;
+
             // Adjustment factor for particle statistical weight
             const double weightFactor = (maxCapacities[j] * statisticalWeights[j]) /
                                       (maxCapacities[i] * statisticalWeights[i]);
 
             const double repeatCountConst =  cellVolumes[j] * maxCapacities[i] * velocities[i]
                                          / cellVolumes[i] / maxCapacities[j] / velocities[j];
-//            if(i == j + 1) {
-//                std::cout << j << ' ' << " max capac " << maxCapacities[j] << " inv sample vol " << statisticalWeights[j] << " cell volume " << cellVolumes[j] <<std::endl;
-//                std::cout << i << ' ' << " max capac " << maxCapacities[i] << " inv sample vol " << statisticalWeights[i] << " cell volume " << cellVolumes[i] <<std::endl;
-//                std::cout << j << ' ' << i << ' ' << " repeat count " << repeatCountConst << " weight factor " << weightFactor  << std::endl;
-//            }
-
-            // Work through the particles coming from cell j
-            std::list<Sweep::Particle*>::const_iterator it = inflowLists[j][i].begin();
-            const std::list<Sweep::Particle*>::const_iterator itEnd = inflowLists[j][i].end();
-            while(it != itEnd) {
-                // Repeat count in destination cell (may be less than one), fractional parts are probability
-                // of a particle being added to destination.
-                double repeatCount = repeatCountConst;
-
-                (*it)->setStatisticalWeight((*it)->getStatisticalWeight() * weightFactor);
-
-                while(repeatCount > 0) {
-                    if(repeatCount > 1) {
-                        partList.push_back((*it)->Clone());
-                    }
+
+            // Repeat count in destination cell (may be less than one), fractional parts are probability
+            // of a particle being added to destination.
+            double repeatCount = repeatCountConst;
+
+            sp->setStatisticalWeight(sp->getStatisticalWeight() * weightFactor);
+
+            while(repeatCount > 0) {
+                if(repeatCount > 1) {
+                    partList.push_back(sp->Clone());
+                }
+                else {
+                    // Final copy of the particle can be the original, but is only added with
+                    // probability repeatCount.
+                    boost::random::bernoulli_distribution<double> particleDecider(repeatCount);
+                    if(particleDecider(cell_rngs[i]))
+                        partList.push_back(sp);
                     else {
-                        // Final copy of the particle can be the original, but is only added with
-                        // probability repeatCount.
-                        boost::random::bernoulli_distribution<double> particleDecider(repeatCount);
-                        if(particleDecider(cell_rngs[i]))
-                            partList.push_back((*it));
-                        else {
-                            delete (*it);
-                        }
+                        delete sp;
                     }
-                    repeatCount -= 1.0;
                 }
-                ++it;
+                repeatCount -= 1.0;
             }
         }
-        if(partList.size() > reac.getCell(i).Particles().Capacity())
-            std::cout << "Setting " << partList.size() << " particles on cell with center " << reac.getGeometry().cellCentre(i) << std::endl;
 
-        reac.getCell(i).SetParticles(partList.begin(), partList.end(), statisticalWeights[i], cell_rngs[i]);
+        Sweep::Cell &mix = reac.getCell(i);
+        if(mix.ParticleCount() + partList.size() > mix.Particles().Capacity())
+            std::cout << "Adding " << partList.size() << " particles to " << mix.ParticleCount()
+                      << " on cell with center " << reac.getGeometry().cellCentre(i) << std::endl;
+
+        // This also clears the ensemble scaling, as replacing all the particles did.
+        mix.AddParticles(partList.begin(), partList.end(), cell_rngs[i]);
     }
 }
 
@@ -537,16 +596,18 @@ void Brush::PredCorrSolver::updateParticlePositionCSTR(const double t_start, con
  *@param[in]        neighbouringCells   Pointers to the contents of surrounding cells
  *@param[in,out]    rng                 Random number generator
  *
- *@return       Vector of lists of particles to be transported into other cells
+ *@return       Particles leaving the cell, each with the index of the cell it is moving into
  */
-Brush::PredCorrSolver::inflow_lists_vector
+Brush::PredCorrSolver::transfer_vector
   Brush::PredCorrSolver::updateParticleListPositions(const double t_start, const double t_stop, Sweep::Cell &mix,
                                                      const size_t cell_index, const Sweep::Mechanism &mech,
                                                      const Geometry::Geometry1d & geom,
                                                      const std::vector<const Sweep::Cell*> & neighbouringCells,
                                                      Sweep::rng_type &rng) const {
-    // Build up the return value in this vector of lists
-    inflow_lists_vector outflow(geom.numCells());
+    // Flags for the particles that are leaving the cell, by index, and
+    // the cells they are moving into (-1 for leaving the domain).
+    std::vector<bool> leaving(mix.ParticleCount(), false);
+    std::vector<int> destinations;
 
     // The local geometry will be needed repeatedly for this cell
     Geometry::LocalGeometry1d localGeom(geom, cell_index);
@@ -554,7 +615,7 @@ Brush::PredCorrSolver::inflow_lists_vector
     // Now go through the particles updating their position
     Sweep::Ensemble::iterator itPart = mix.Particles().begin();
     const Sweep::Ensemble::iterator itPartEnd = mix.Particles().end();
-    while(itPart != itPartEnd ) {
+    for(size_t i = 0; itPart != itPartEnd; ++itPart, ++i) {
         // Actually calculate new position of particle
         if(mCSTRTransport)
             updateParticlePositionCSTR(t_start, t_stop, mix, mech, localGeom, neighbouringCells, **itPart, rng);
@@ -564,29 +625,31 @@ Brush::PredCorrSolver::inflow_lists_vector
         // Find the index of the cell into which the particle is moving
         const int destination = geom.containingCell((*itPart)->getPosition());
 
-        if(destination >= 0) {
+        if(destination != static_cast<int>(cell_index)) {
             // On moving to a new cell reset the coagulation count
-            if(static_cast<unsigned>(destination) != cell_index)
+            if(destination >= 0)
                (*itPart)->resetCoagCount();
 
-            // Add the details of the particle to a list ready for inserting
-            // into its destination cell
-            outflow[destination].push_back(*itPart);
-
+            leaving[i] = true;
+            destinations.push_back(destination);
         }
-        else {
-            // Particle has left simulation domain
-            delete *itPart;
-            *itPart = NULL;
-        }
-
-        // Remove the particle from this cell and move the iterator on
-        // to the next particle
-        ++itPart;
     } // loop over all particles in cell i updating their position
 
-    // Empty the particle ensemble
-    mix.Particles().TakeParticles();
+    // Take the leaving particles out of the ensemble; they come back in
+    // the order in which they were flagged.
+    Sweep::PartPtrList taken = mix.Particles().TakeParticles(leaving);
+    assert(taken.size() == destinations.size());
+
+    transfer_vector outflow;
+    outflow.reserve(taken.size());
+    std::vector<int>::const_iterator itDest = destinations.begin();
+    for(Sweep::PartPtrList::iterator it = taken.begin(); it != taken.end(); ++it, ++itDest) {
+        if(*itDest >= 0)
+            outflow.push_back(std::make_pair(static_cast<size_t>(*itDest), *it));
+        else
+            // Particle has left simulation domain
+            delete *it;
+    }
 
     return outflow;
 }
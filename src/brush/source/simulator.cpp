@@ -172,6 +172,11 @@ void Brush::Simulator::runOnePath(const int seed) {
     }
     ratesFile << '\n';
 
+    //==================== File in which to log the time spent in each cell for this run
+    std::ofstream cellTimesFile(buildCellTimesFileName(seed).c_str());
+    cellTimesFile << "t,x,Predicted work,Wall time (s)\n";
+    mSolver.resetCellTimes();
+
 
     // write initial moments to file
     saveParticleStats(reac, mOutputTimeSteps.front().StartTime(), mStatBound, momentsFile);
@@ -209,6 +214,9 @@ void Brush::Simulator::runOnePath(const int seed) {
 
             // log process rates
             saveProcessRates(reac, tInt.StartTime() + ti + dt, ratesFile);
+
+            // log the load on each cell
+            saveCellTimes(reac, tInt.StartTime() + ti + dt, cellTimesFile);
         }
 
         //std::cout << "stepped up to " << tInt.EndTime() << ' ' << reac.getTime() << '\n';
@@ -343,6 +351,32 @@ void Brush::Simulator::saveProcessRates(const Reactor1d &reac, const double t, s
     out.flush();
 }
 
+/*!
+ * Log the wall clock time the solver spent on the particle processes in
+ * each cell since the last call, with the work predicted for the cell at
+ * the last step.  Cells are solved in parallel, so the spread of the times
+ * shows how well the work is balanced between the threads.
+ *
+ *\param[in]    reac        Reactor being solved
+ *\param[in]    t           Time to which the times apply
+ *\param[in]    out         File handle into which to write the data
+ */
+void Brush::Simulator::saveCellTimes(const Reactor1d &reac, const double t, std::ostream &out) {
+    const fvector &times = mSolver.getCellTimes();
+    const fvector &costs = mSolver.getCellCosts();
+
+    for(size_t i = 0; i < reac.getNumCells(); ++i) {
+        out << t << ',' << reac.getCellCentre(i) << ','
+            << (i < costs.size() ? costs[i] : 0.0) << ','
+            << (i < times.size() ? times[i] : 0.0) << '\n';
+    }
+    mSolver.resetCellTimes();
+
+    // Flush the buffer, so that a future crash does not lose data before it actually
+    // reaches its destination.
+    out.flush();
+}
+
 /*!
  * Construct the filename for the moments file for a run with the
  * specified seed.  This function takes a seed as an argument to match
@@ -388,3 +422,18 @@ std::string Brush::Simulator::buildParticleRatesFileName(const int seed) const {
     return name.str();
 }
 
+/*!
+ * Construct the filename for the cell timing file for a run with the
+ * specified seed.  This function takes a seed as an argument to match
+ * runOnePath().
+ *
+ *\param[in]    seed        Seed used for the path
+ *
+ *\return       Name for cell timing file
+ */
+std::string Brush::Simulator::buildCellTimesFileName(const int seed) const {
+    std::stringstream name;
+    name << mOutputFile << seed << "_celltimes.csv";
+    return name.str();
+}
+
@@ -67,6 +67,7 @@ class CamAdmin
         int flameletEquationType_;
         std::string restartFile_;
         std::string inputFileName_;
+        std::string gasProfileFile_;
 
     public:
 
@@ -128,6 +129,10 @@ class CamAdmin
         void setInputFile(std::string inputFileName);
         const std::string& getInputFile() const;
 
+        //! Binary gas-phase profile for mops to write, or empty for none.
+        void setGasProfileFile(const std::string& gasProfileFile);
+        const std::string& getGasProfileFile() const;
+
         int getSpeciesOut() const;
 
         //return the temperature
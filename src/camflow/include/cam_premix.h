@@ -112,6 +112,11 @@ namespace Camflow
          */
         void reportToFile(double t, double* soln);
 
+        /*
+         * write the flame as a binary gas-phase profile for mops
+         */
+        void writeGasProfile(double* soln);
+
         /*
          *solve the premix reactor for the stand alone case
          */
@@ -72,20 +72,43 @@ namespace Camflow
 class Radiation
 {
 
+public:
+
+    //! Fit of the Planck mean absorption coefficient of one species.
+    struct PlanckFit
+    {
+        //! Name of the species.
+        const char *species;
+        //! True if the fit is a polynomial in 1000/T rather than in T.
+        bool inverseT;
+        //! The low coefficients apply up to this temperature (K).
+        double switchT;
+        //! Coefficients of the powers 0 to 5 below and above switchT (1/m/atm).
+        double low[6];
+        double high[6];
+    };
+
+    //! Returns the fit for a species, or NULL if there is none.
+    static const PlanckFit* findPlanckFit(const std::string& species);
+
+private:
+
     //! Conversion factor.
     static const double AtmToPascal;
 
     //! Names of the radiative species.
     std::vector<std::string> radiativeSpecies_;
     //! Indices of the species for looking up in Sprog::Mechanism.
-    std::vector<double> speciesIndex_;
+    std::vector<int> speciesIndex_;
     //! Molecular weights of each species.
     std::vector<double> speciesMolWt_;
+    //! Absorption fits of each species.
+    std::vector<const PlanckFit*> speciesFit_;
 
-    //! Absorption coefficients of each species.
-    std::vector<double> absorption;
-    //! Partial pressures for each species.
-    std::vector<double> partialPress;
+    //! 1000/T of each cell.
+    std::vector<double> beta_;
+    //! Sum of the partial pressures times the absorption coefficients of each cell.
+    std::vector<double> spectral_;
 
     //! Stores the radiation sources.
     std::vector<double> radiation;
@@ -94,10 +117,6 @@ class Radiation
     const std::vector<double>& avgMolWt_;
     const Array2D& speciesMassFracs_;
 
-    //! Computes the Planck mean absorption constants,
-    //! as input to the radiative heat loss dissipation model.
-    void PlanckAbsorption(const double Temperature);
-
 public:
 
     //! Default constructor.
@@ -113,14 +132,15 @@ public:
     //! Destructor.
     ~Radiation();
 
-    //! Computes the radiative heat loss term
-    //! for the radiative heat dissipation model.
+    //! Computes the radiative heat loss term of the radiative heat
+    //! dissipation model for the cells iStart to iEnd-1.
     void calculateRadiativeHeatLoss
     (
-        const int i,
-        const double& Temperature,
+        const int iStart,
+        const int iEnd,
+        const std::vector<double>& temperature,
         const double& opPre,
-        const double& soot_vol_frac
+        const std::vector<double>& soot_vol_frac
     );
 
     inline const double& getRadiation(const int i)
@@ -373,6 +373,9 @@ namespace Camflow
             Array2D s_cp;
             Array2D moments;	    // ank25: soot moments
             Array2D moments_dot;    // ank25: moments rate analogous to s_wdot
+            Array2D sootConc;       // species concentrations fed to the soot model
+            Array2D sootGasRates;   // gas phase production rates due to soot
+            Array2D sootProperties; // soot properties derived from moments
 
             std::vector<double> m_T;                  //mixture temperature
             std::vector<double> m_rho;                //mixture density
@@ -188,6 +188,39 @@ class CamSoot {
                 const double& p,
                 const int cellID=0);
 
+        /*!
+         * Same as above, but writes the moment rates into a caller owned
+         * vector so that no memory is allocated in the residual loop.
+         */
+        void rateAll(const realVector& conc,
+                const realVector& moments,
+                const double& T,
+                const double& p,
+                realVector& rates);
+
+        /*!
+         * Calculate the moment source terms of a whole grid in one call.
+         * Row i of conc and moments holds the state of cell i. The moment
+         * rates, gas phase production rates, component rates (as returned
+         * by showSootComponentRates) and derived soot properties (see
+         * sootProperty) of cell i are written to row i of the output arrays.
+         */
+        void rateAllCells(const int nCells,
+                const Array2D& conc,
+                const Array2D& moments,
+                const realVector& T,
+                const double& p,
+                Array2D& momRates,
+                Array2D& gasRates,
+                Array2D& componentRates,
+                Array2D& properties);
+
+        //! Columns of the properties array filled by rateAllCells.
+        enum sootProperty {
+            AvgDiameter, Dispersion, SurfaceArea, VolumeFraction,
+            nSootProperties
+        };
+
         realVector showGasPhaseRates(int nSpecies);
 
         realVector showSootComponentRates(int nMoments);
@@ -230,12 +263,46 @@ class CamSoot {
 
         realVector nucRates, coagRates, cdRates, sRates;	// Rate of change of moments
 
+        /*
+         * Workspaces reused by every call of rateAll, sized once in
+         * initMomentsConstants.
+         */
+        realVector prodRates, rateC2H2, rateO2, rateOH;
+        realVector wholeOrderRedMom, logRedMom, oxidFit, gridValues, massPow;
+        realVector concCell, momCell, ratesCell;
+
+        /*
+         * Exponents of the Lagrange interpolation in log space. Row
+         * i-lowFrac holds the weights of the whole order moments for the
+         * reduced moment of order i/6, so that the interpolant is
+         * exp(sum_k lgWeights(i-lowFrac,k)*log(mu_k)).
+         */
+        Array2D lgWeights;
+
+        //! Same for interpolation at 1/2 over the first n grid functions.
+        Array2D halfWeights;
+
+        /*
+         * One term of the coagulation rate of a whole order moment:
+         * coeff * f_{1/2}^{(n,m)} interpolated from size grid functions.
+         */
+        struct CoagTerm {
+            int moment;
+            double coeff;
+            int n, m;
+            int size;
+        };
+
+        //! Coagulation terms for the number of moments solved.
+        std::vector<CoagTerm> coagTerms;
+
         Array2D bnCoeff,powPAH, prime;
         Array2D wdot; //,surfProdRate;
         realVector surfProdRate;
         Array2D conc_received, momReceived;
 
-        static Array1D sizeMoments, reducedMoments;
+        // Per instance so that several flamelets can be solved concurrently
+        Array1D sizeMoments, reducedMoments;
         /*
          *members for storing the rates
          */
@@ -253,22 +320,22 @@ class CamSoot {
         double Beta_nucl, Beta_fm, Beta_cd, Beta_surf_CGS, CBOHCGS;
 
         /*
-         *calculate nucleation rate
+         *calculate nucleation rate (into nucRates)
          */
-        realVector rateNucleation(const double& concPAH,  // conc of PAH 4 nucln
-                                  const double& T);       // temperature
+        void rateNucleation(const double& concPAH,  // conc of PAH 4 nucln
+                            const double& T);       // temperature
 
         /*
-         * Calculate coagulation rate.
+         * Calculate coagulation rate (into coagRates).
          * Seems to follow Eq 19. in Frenklach (2002).
          */
-        realVector rateCoagulation(const realVector& mom,     // vector of moments
-                                   const double& T);      // temperature
+        void rateCoagulation(const realVector& mom,     // vector of moments
+                             const double& T);      // temperature
 
         /*
-         *calculate condensation rate
+         *calculate condensation rate (into cdRates)
          */
-        realVector rateCondensation(const realVector& mom, //vector of moments
+        void rateCondensation(const realVector& mom, //vector of moments
         		const double& T,           //temperature
         		const double& concPAH     //PAH concentration
                             );
@@ -284,6 +351,15 @@ class CamSoot {
 
         void interpolateReducedMoments(realVector& wom);
 
+        //! Precompute the interpolation weights and coagulation terms.
+        void initInterpolation();
+
+        /*!
+         * Interpolate at 1/2 over the first size entries of gridValues,
+         * which must hold logarithms of the grid functions.
+         */
+        double interpolateHalf(const int size) const;
+
         /*!
          * The grid function.
          * k = , n = , m =
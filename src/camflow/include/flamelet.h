@@ -172,6 +172,15 @@ namespace Camflow
             //! Provide a soot volume fraction from an external calculation.
             void setExternalSootVolumeFraction(const std::vector<double>& soot_fv);
 
+            //! Start the next solve from this solution vector (continuation).
+            void setInitialGuess(const std::vector<double>& guess);
+
+            //! Get the solution vector of the last solve.
+            void getSolutionVector(std::vector<double>& soln) const;
+
+            //! Switch the console output of the residuals on or off.
+            void setConsoleReport(const bool on);
+
             //! Get the residual for use in radauWrapper.
             double getResidual() const;
 
@@ -213,6 +222,12 @@ namespace Camflow
             //! Spatial profile of soot volume fraction
             std::vector<double> m_SootFv;
 
+            //! Initial guess replacing the default initial profile, if not empty.
+            std::vector<double> initialGuess_;
+
+            //! Steps reported to the console and whether to report them.
+            int nStep_;
+            bool consoleReport_;
 
             bool timeHistory, sdrProfile, sdrAnalytic;
             inletStruct fuel, oxid;
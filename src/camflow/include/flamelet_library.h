@@ -0,0 +1,154 @@
+/*!
+ * \file   flamelet_library.h
+ *
+ * \brief Generation of steady flamelet libraries over a range of SDRs.
+ *
+ *
+
+ Licence:
+    This file is part of "camflow".
+
+    camflow is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#ifndef _FLAMELET_LIBRARY_H
+#define	_FLAMELET_LIBRARY_H
+
+#include <string>
+#include <vector>
+
+#include "cam_admin.h"
+#include "cam_configuration.h"
+#include "cam_control.h"
+#include "cam_geometry.h"
+#include "cam_profile.h"
+#include "cam_soot.h"
+#include "gpc_mech.h"
+
+namespace Camflow
+{
+
+class FlameLet;
+
+/*! @brief Steady flamelet library over a list of scalar dissipation rates.
+ *
+ * The SDR values are sorted and split into one contiguous block per
+ * thread. The blocks are solved concurrently, each thread with its own
+ * copies of the setup objects and the mechanism, so that the FlameLet
+ * objects only share the read-only admin object. Inside a block every solve starts
+ * from the converged solution of its neighbour with the next lower SDR.
+ *
+ * The library is written as one binary table of native endian values,
+ * laid out so that a CFD code can memory map it and index it directly:
+ *
+ * \verbatim
+   char     magic[8]              "CAMFLIB" followed by a null byte
+   uint32   version               currently 1
+   uint32   nSDR                  number of flamelets
+   uint32   nPoints               number of mixture fraction points
+   uint32   nVars                 number of variables per point
+   char     names[nVars][32]      null padded variable names
+   double   sdr[nSDR]             stoichiometric SDRs in ascending order (1/s)
+   double   Z[nPoints]            mixture fraction coordinates
+   double   data[nSDR][nVars][nPoints]
+   \endverbatim
+ *
+ * The variables are T (K), rho (kg/m3), the species mass fractions and,
+ * if soot is solved, the moments (1/m3).  Every block starts at an offset
+ * that is a multiple of 8 bytes.
+ */
+class FlameletLibrary
+{
+
+public:
+
+    //! Version of the binary table written by write().
+    static const unsigned int formatVersion = 1;
+
+    //! Length of the null padded variable names in the table.
+    static const unsigned int nameLength = 32;
+
+    /*!
+     * Take copies of the objects read from camflow.xml and chem.inp. The
+     * admin object cannot be copied, so ca is shared by all threads and,
+     * like cg which the copied profile refers to, must outlive the library.
+     */
+    FlameletLibrary
+    (
+        CamAdmin& ca,
+        const CamConfiguration& config,
+        const CamControl& cc,
+        const CamGeometry& cg,
+        const CamProfile& cp,
+        const CamSoot& cs,
+        const Sprog::Mechanism& mech
+    );
+
+    //! Solve one steady flamelet for every SDR, using up to nThreads threads.
+    void generate(const std::vector<double>& sdr, int nThreads=0);
+
+    //! Write the library to a binary table (see class description).
+    void write(const std::string& fileName) const;
+
+    //! Names of the tabulated variables.
+    const std::vector<std::string>& getVariableNames() const {return varNames_;}
+
+    //! Sorted SDRs of the flamelets in the library.
+    const std::vector<double>& getSDRs() const {return sdr_;}
+
+    //! Value of variable var at point i of flamelet k.
+    double getValue(const size_t k, const size_t var, const size_t i) const;
+
+private:
+
+    CamAdmin& admin_;
+    CamConfiguration config_;
+    CamControl control_;
+    CamGeometry geometry_;
+    CamProfile profile_;
+    CamSoot soot_;
+    Sprog::Mechanism mech_;
+
+    std::vector<std::string> varNames_;
+    std::vector<double> sdr_;
+    std::vector<double> mixFracCoords_;
+
+    //! Table data laid out as [flamelet][variable][point].
+    std::vector<double> data_;
+
+    //! Solve the flamelets first to last-1 in order with continuation.
+    void solveBlock(const size_t first, const size_t last);
+
+    //! Copy the solution of flamelet k into the table.
+    void store(const size_t k, FlameLet& flmlt);
+
+}; // End FlameletLibrary class declaration.
+
+} // End Camflow namespace.
+
+#endif	/* _FLAMELET_LIBRARY_H */
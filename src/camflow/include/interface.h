@@ -285,6 +285,10 @@ namespace Camflow {
             void flameletWithSoot(const std::vector<double>& soot_fv, const std::vector<double>& sdr,
                                   const std::vector<double>& intTime, bool continuation=false);
 
+            //! Solve steady flamelets for a list of SDRs in parallel and write them to a binary library.
+            void flameletLibrary(const std::vector<double>& sdr, const std::string& fileName,
+                                 int nThreads=0);
+
             //! Assign the species mass fractions, temperature, density, and velocity into the vector of mixture objects.
             void resetMixtures(std::vector<Thermo::Mixture>& cstrs);
 
@@ -251,8 +251,7 @@ void Batch::updateMixture(double* y)
     // (and contribution to gas phase by surface reactions)
     if (sootMom_.active())
     {
-   	    for (int l=0; l< nMoments; ++l)
-        momRates = sootMom_.rateAll(concentrations, moments, temperature, opPre, 1);
+        sootMom_.rateAll(concentrations, moments, temperature, opPre, momRates);
 
         // Now get the corresponding gas phase rates and add them to wdot
         wdotSootGasPhase = sootMom_.showGasPhaseRates(nSpc);
@@ -161,6 +161,16 @@ const std::string& CamAdmin::getInputFile() const
     return inputFileName_;
 }
 
+void CamAdmin::setGasProfileFile(const std::string& gasProfileFile)
+{
+    gasProfileFile_ = gasProfileFile;
+}
+
+const std::string& CamAdmin::getGasProfileFile() const
+{
+    return gasProfileFile_;
+}
+
 int CamAdmin::getSpeciesOut() const{
     return speciesOut;
 }
@@ -56,6 +56,7 @@
 #include "cam_setup.h"
 #include "cam_premix.h"
 #include "cam_reporter.h"
+#include "gpc_gas_profile_io.h"
 #include "cvode_wrapper.h"
 #include "limex_wrapper.h"
 //#include "ida_wrapper.h"
@@ -878,6 +879,57 @@ void CamPremix::reportToFile(double t, double* soln)
     }
 
     reporter_->closeFiles();
+
+    if (!admin_.getGasProfileFile().empty()) writeGasProfile(soln);
+}
+
+/*
+ * The profile gives the conditions seen by a particle travelling with the
+ * flow, so the time is the residence time integrated along the grid with
+ * the mean velocity of each cell.  The ABF model parameter alpha is not
+ * known here and is written as 1.
+ */
+void CamPremix::writeGasProfile(double* soln)
+{
+    vector<string> columns;
+    columns.push_back("Time");
+    columns.push_back("X[cm]");
+    columns.push_back("T");
+    columns.push_back("P");
+    columns.push_back("Alpha");
+    for (int l=0; l<nSpc; l++)
+    {
+        columns.push_back((*spv_)[l]->Name());
+    }
+
+    Sprog::IO::GasProfileWriter out(admin_.getGasProfileFile(), columns);
+    vector<double> axpos = reacGeom_.getAxpos();
+    vector<double> massfrac(nSpc), molfrac, row;
+    CamConverter convert;
+    double time = 0.0;
+    for (size_t i=0; i<axpos.size(); i++)
+    {
+        if (i > 0) time += 2.0*(axpos[i]-axpos[i-1])/(m_u[i]+m_u[i-1]);
+
+        for (int l=0; l<nSpc; l++)
+        {
+            massfrac[l] = soln[i*nVar+l];
+        }
+        convert.mass2mole(massfrac,molfrac,*camMech_);
+
+        row.clear();
+        row.push_back(time);
+        row.push_back(axpos[i]*100.0);
+        row.push_back(soln[i*nVar+ptrT]);
+        row.push_back(opPre/1.0e5);
+        row.push_back(1.0);
+        for (int l=0; l<nSpc; l++)
+        {
+            row.push_back(fabs(molfrac[l]));
+        }
+        out.Write(row);
+    }
+    out.Close();
 }
 
 
@@ -17,8 +17,9 @@ Radiation::Radiation
   radiativeSpecies_(),
   speciesIndex_(),
   speciesMolWt_(),
-  absorption(),
-  partialPress(),
+  speciesFit_(),
+  beta_(totalCells, 0.0),
+  spectral_(totalCells, 0.0),
   radiation(totalCells, 0.0),
   mech_(mech),
   avgMolWt_(avgMolWt),
@@ -53,15 +54,22 @@ Radiation::Radiation
         }
         else
         {
+            const PlanckFit *fit = findPlanckFit(speciesName);
+            if (fit == NULL)
+            {
+                throw std::runtime_error
+                (
+                    "There is no absorption coefficient model available for "
+                    "species " + speciesName
+                );
+            }
             radiativeSpecies_.push_back(speciesName);
             speciesIndex_.push_back(speciesIndex);
             speciesMolWt_.push_back(mech_->Species(speciesName)->MolWt());
+            speciesFit_.push_back(fit);
         }
     }
 
-    absorption.resize(radiativeSpecies_.size(), 0.0);
-    partialPress.resize(radiativeSpecies_.size(), 0.0);
-
     std::cout<< "Radiative Species: ";
     for (size_t i = 0; i < radiativeSpecies_.size(); ++i)
     {
@@ -79,157 +87,117 @@ Radiation::Radiation
 Radiation::~Radiation()
 {}
 
+namespace
+{
+
 /*!
- * Computes the Planck mean absorption coefficients
- *
- * @param[in]   Temperature   Temperature at a point of the grid, as obtained by the energy residual function.
- * @param[out]  Absorption    An output array containing the computed Planck absorption coefficients.
- *
- * The coefficients are produced for H2O, CO2, and CO, because these are the species that tend to produce the
- * greatest spectral radiative effect in mixtures commonly associated with combustion. Coefficients are known
- * for CH4 as well, but they can lead to inaccurate results, and therefore are not included here.  The computation
- * of these coefficients are based on data from the RADCAL model.  This data was for temperatures between 300K
- * and 2500K.
+ * Planck mean absorption coefficients, in 1/m * 1/atm, from the fits in reference [1]
+ * to results of the RADCAL program (reference [4]).  The RADCAL data was for temperatures
+ * between 300K and 2500K.  H2O and CO2 are fitted in 1000/T; CO (with a change of
+ * fit at 750K) and CH4 in T.
  */
-void Radiation::PlanckAbsorption
-(
-    const double temperature
-)
+const Radiation::PlanckFit planckFits[] =
 {
+    {"H2O", true, 1.0e300,
+        {-0.23093, -1.12390, 9.41530, -2.99880, 0.51382, -1.86840e-5},
+        {-0.23093, -1.12390, 9.41530, -2.99880, 0.51382, -1.86840e-5}},
+    {"CO2", true, 1.0e300,
+        {18.7410, -121.3100, 273.5000, -194.0500, 56.3100, -5.8169},
+        {18.7410, -121.3100, 273.5000, -194.0500, 56.3100, -5.8169}},
+    {"CO", false, 750.0,
+        {4.7869, -0.06953, 2.95775e-4, -4.25732e-7, 2.02894e-10, 0.0},
+        {10.0900, -0.01183, 4.7753e-6, -5.87209e-10, -2.5334e-14, 0.0}},
+    {"CH4", false, 1.0e300,
+        {6.6334, -0.0035686, 1.6682e-8, 2.5611e-10, -2.6558e-14, 0.0},
+        {6.6334, -0.0035686, 1.6682e-8, 2.5611e-10, -2.6558e-14, 0.0}}
+};
+
+const size_t nPlanckFits = sizeof(planckFits)/sizeof(planckFits[0]);
+
+//! Evaluates a fifth order polynomial.
+inline double horner(const double *const c, const double x)
+{
+    return c[0] + x*(c[1] + x*(c[2] + x*(c[3] + x*(c[4] + x*c[5]))));
+}
 
-    //This quantity is reused repeatedly in the equations below
-    const double beta = 1000/temperature;
-
-    //This helps avoid repeated, costly calls to pow().  There is a modest tradeoff of speed vs. accuracy here.
-    const double beta2 = beta * beta;
-    const double beta3 = beta2 * beta;
-    const double beta4 = beta3 * beta;
-    const double beta5 = beta4 * beta;
+} // End anonymous namespace.
 
-    for (size_t i=0; i<radiativeSpecies_.size(); ++i)
+/*!
+ * @param[in]  species  Name of the species.
+ *
+ * @return     The absorption fit of the species, or NULL if there is none.
+ */
+const Radiation::PlanckFit* Radiation::findPlanckFit(const std::string& species)
+{
+    for (size_t k = 0; k < nPlanckFits; ++k)
     {
-        if (radiativeSpecies_[i] == "H2O")
-        {
-            // This code computes the Planck mean absorption coefficient for H2O, using an equation in reference [1].  The specific
-            // equation is based on fitted results from the RADCAL program. See reference [4].  Multiplication by AtmToPascal
-            // converts the absorption coefficients from units of 1/m * 1/atm  to 1/m * 1/pa.
-                absorption[i]
-                =
-                (-0.23093 - 1.12390 * beta + 9.41530 * beta2 - 2.99880 * beta3 + 0.51382 * beta4
-                - 1.86840e-5 * beta5)/AtmToPascal;
-        }
-        else if (radiativeSpecies_[i] == "CO2")
-        {
-            // This code computes the Planck mean absorption coefficient for CO2, using an equation in reference [1].  The specific
-            // equation is based on fitted results from the RADCAL program. See reference [4]. Multiplication by AtmToPascal
-            // converts the absorption coefficients from units of 1/m * 1/atm  to 1/m * 1/pa.
-                absorption[i]
-                =
-                (18.7410 - 121.3100 * beta + 273.5000 * beta2 - 194.0500 * beta3 + 56.3100 * beta4
-                - 5.8169 * beta5)/AtmToPascal;
-        }
-        else if (radiativeSpecies_[i] == "CO")
-        {
-            // This code computes the Planck mean absorption coefficient for CO, using two equations in reference [1].  It uses a
-            // conditional statement on temperature to determine which of the two equations to use. The specific  equation is based
-            // on fitted results from the RADCAL program. See reference [4]. Multiplication by AtmToPascal converts the absorption
-            // coefficients from units of 1/m * 1/atm  to 1/m * 1/pa.
-            if (temperature <= 750)
-            {
-                absorption[i]  =  (4.7869 + temperature * (-0.06953 + temperature * (2.95775e-4 + temperature *
-                                  (-4.25732e-7 + temperature * 2.02894e-10))))/AtmToPascal;
-            }
-            else
-            {
-                absorption[i]  = (10.0900 + temperature * (-0.01183 + temperature * (4.7753e-6 + temperature *
-                                 (-5.87209e-10 + temperature * -2.5334e-14))))/AtmToPascal;
-            }
-        }
-        else if (radiativeSpecies_[i] == "CH4")
-        {
-            // This code computes the Planck mean absorption coefficient for CH4, using two equations in reference [1].  It uses a
-            // conditional statement on temperature to determine which of the two equations to use. The specific  equation is based
-            // on fitted results from the RADCAL program. See reference [4]. Multiplication by AtmToPascal converts the absorption
-            // coefficients from units of 1/m * 1/atm  to 1/m * 1/pa.
-                absorption[i]  =  (6.6334 + temperature * (-0.0035686 + temperature * (1.6682e-8 + temperature *
-                                  (2.5611e-10 + temperature * -2.6558e-14))))/AtmToPascal;
-        }
-        else
-        {
-            throw std::runtime_error
-            (
-                "There is no absorption coefficient model available for "
-                "species " + radiativeSpecies_[i]
-            );
-        }
+        if (species == planckFits[k].species) return &planckFits[k];
     }
-
+    return NULL;
 }
 
 /*!
  * Computes  the radiative heat loss term for radiative heat dissipation model
  *
- * @param[in]  i            Grid cell.
- * @param[in]  Temperature  Temperature at a point of the grid.
- * @param[in]  Pressure     Pressure.
- * @param[in]  SootVolFrac  The soot value fraction.
+ * @param[in]  iStart       First grid cell.
+ * @param[in]  iEnd         One past the last grid cell.
+ * @param[in]  temperature  Temperature of each cell of the grid.
+ * @param[in]  opPre        Pressure (Pa).
+ * @param[in]  soot_vol_frac The soot volume fraction of each cell.
  *
- * This function will be called from the energy residual code in Camflow's Flamelet class,
- * which will provide such parameters as temperature, density, specific heat, mass fractions
- * and soot volume fractions.
+ * This function is called once per energy residual from Camflow's Flamelet class, which
+ * will have computed the temperatures, mass fractions and soot volume fractions of the
+ * whole grid.  The Planck mean absorption coefficients are evaluated species by species
+ * over all the cells, so that the inner loops are free of branches on the species and
+ * can be vectorised.
  */
 void
 Radiation::calculateRadiativeHeatLoss
 (
-    const int i,
-    const double& temperature,
+    const int iStart,
+    const int iEnd,
+    const std::vector<double>& temperature,
     const double& opPre,
-    const double& soot_vol_frac
+    const std::vector<double>& soot_vol_frac
 )
 {
 
-    // RadiativeLoss requires a background setting temperature.  It is usually assumed to be 300K, unless experimental conditions
-    // suggest another temperature. Used 300^4 which is 81e8 in temperaturePowers below.
-    //const double BackgroundTemp = 300;
-
-    double temperature2 = temperature*temperature;
-	double temperature4 = temperature2*temperature2;
-	double temperature5 = temperature4*temperature;
-
-    // The function calls PlanckAbsorption to produce the absorption coefficients.
-    PlanckAbsorption(temperature);
-
-    // Using a single equation in reference [1], the function computes a Radiative Heat Dissipation term.  It uses the Planck mean
-    // absorption coefficients for H2O, CO2 abd CO, as well as the density of each of these species, the specific heat of each species,
-    // the temperature, the partial pressure of each species, and the soot volume fraction.
-
-
-    // Partial pressures of species k.  0 corresponds to H2O, 1 corresponds to CO2, 2 corresponds to CO. Operating pressure
-    // must be expressed in Pascals in the camflow.xml file.
-
-    for (size_t j=0; j<radiativeSpecies_.size(); ++j)
+    for (int i = iStart; i < iEnd; ++i)
     {
-        double speciesMoleFraction
-        =
-        speciesMassFracs_(i,speciesIndex_[j])
-        *avgMolWt_[i]
-        /speciesMolWt_[j];
-
-        partialPress[j] = speciesMoleFraction*opPre;
+        beta_[i] = 1000.0/temperature[i];
+        spectral_[i] = 0.0;
     }
 
-    //The following is used repeatedly in the loop below
-    const double temperaturePowers = 4 * 5.669e-8 * (temperature4 - 81e8);
-
-    double spectralRadiation = 0;   //An intermediate result
+    // Sum of the partial pressures times the Planck mean absorption coefficients,
+    // using the mole fractions (the operating pressure is applied below).
     for (size_t j = 0; j < radiativeSpecies_.size(); ++j)
     {
-        // 0 = H2O,  1 = CO2,  2 = CO
-        //Total spectral radiative heat loss.
-        spectralRadiation += partialPress[j] * absorption[j];
+        const PlanckFit& fit = *speciesFit_[j];
+        const std::vector<double>& x = fit.inverseT ? beta_ : temperature;
+        const int k = speciesIndex_[j];
+        const double invMolWt = 1.0/speciesMolWt_[j];
+
+        for (int i = iStart; i < iEnd; ++i)
+        {
+            const double absorption = (temperature[i] <= fit.switchT)
+                                    ? horner(fit.low, x[i])
+                                    : horner(fit.high, x[i]);
+            spectral_[i] += speciesMassFracs_(i,k)*avgMolWt_[i]*invMolWt*absorption;
+        }
     }
 
-    //Total spectral radiative heat loss + radiative heat loss due to soot
-    radiation[i] = temperaturePowers * spectralRadiation + 3.3337e-4 * soot_vol_frac * temperature5;
+    // RadiativeLoss requires a background setting temperature.  It is usually assumed to be 300K, unless experimental conditions
+    // suggest another temperature. Used 300^4 which is 81e8 below.  Dividing by AtmToPascal converts the absorption coefficients
+    // from units of 1/m * 1/atm  to 1/m * 1/Pa; the operating pressure must be expressed in Pascals in the camflow.xml file.
+    const double pressureFactor = 4 * 5.669e-8 * opPre / AtmToPascal;
+    for (int i = iStart; i < iEnd; ++i)
+    {
+        const double temperature2 = temperature[i]*temperature[i];
+        const double temperature4 = temperature2*temperature2;
+
+        //Total spectral radiative heat loss + radiative heat loss due to soot
+        radiation[i] = pressureFactor * (temperature4 - 81e8) * spectral_[i]
+                     + 3.3337e-4 * soot_vol_frac[i] * temperature4 * temperature[i];
+    }
 
 }
@@ -609,6 +609,7 @@ void CamRead::readReport(CamAdmin& ca, const CamXML::Element& node){
         }else{
             ca.setSpeciesOut(ca.MASS);
         }
+        ca.setGasProfileFile(subnode->GetAttributeValue("gasprofile"));
     }else{
         throw CamError("Report information missing\n");
     }
@@ -54,6 +54,9 @@ CamResidual::CamResidual
   moments(mCord,nMoments),      // ank25: moments analogous to s_mf
   moments_dot(mCord,nMoments),       // ank25: moments rate analogous to s_wdot
   sootComponentRatesAllCells(mCord,nMoments*4),  // ank25: used to output soot rates
+  sootConc(mCord,nSpc),
+  sootGasRates(mCord,nSpc),
+  sootProperties(mCord,CamSoot::nSootProperties),
   avgSootDiamMaster(mCord,0.0),    // soot properties derived from moments.
   dispersionMaster(mCord,0.0),
   sootSurfaceAreaMaster(mCord,0.0),
@@ -47,9 +47,6 @@ using namespace Camflow;
 using namespace Sprog;
 using namespace Strings;
 
-Array1D CamSoot::sizeMoments;
-Array1D CamSoot::reducedMoments;
-
 const double CamSoot::cMass = 0.012; //kg/mol
 const double CamSoot::ohMass = 0.017; //kg/mol
 
@@ -193,10 +190,16 @@ int CamSoot::getAtomsPerDiamer() const {
  */
 void CamSoot::sums(int hMoment, double massAdded, double coeff,
                         realVector& rates){
+    // Integer powers of the added mass, massPow[k] = massAdded^k
+    massPow[0] = 1.0;
+    for (int k = 1; k < hMoment; k++) {
+        massPow[k] = massPow[k-1]*massAdded;
+    }
+
     for (int r = 1; r < hMoment; r++) {
         rates[r] = 0.0;
         for (int l = 0; l < r; l++) {
-            rates[r] += bnCoeff(l,r)*pow(massAdded,r-l)*reducedMoments(6*l+4);
+            rates[r] += bnCoeff(l,r)*massPow[r-l]*reducedMoments(6*l+4);
         }
         rates[r] *= coeff;
 
@@ -392,6 +395,28 @@ void CamSoot::initMomentsConstants(Mechanism &mech){
     CamMath cm;
     cm.prime(nMoments,prime);
     cm.binomCoeff(nMoments,bnCoeff);
+    initInterpolation();
+
+    /*
+     *workspaces for the rate evaluation, so that rateAll does not
+     *allocate any memory
+     */
+    nucRates.assign(nMoments,0.0);
+    coagRates.assign(nMoments,0.0);
+    cdRates.assign(nMoments,0.0);
+    sRates.assign(nMoments,0.0);
+    rateC2H2.assign(nMoments,0.0);
+    rateO2.assign(nMoments,0.0);
+    rateOH.assign(nMoments,0.0);
+    wholeOrderRedMom.assign(nMoments,0.0);
+    logRedMom.assign(nMoments,0.0);
+    oxidFit.assign(nMoments,0.0);
+    gridValues.assign(4,0.0);
+    massPow.assign(nMoments,0.0);
+    momCell.assign(nMoments,0.0);
+    ratesCell.assign(nMoments,0.0);
+    concCell.assign(mech.SpeciesCount(),0.0);
+    prodRates.assign(mech.SpeciesCount(),0.0);
 
    // if(nCells>0){
    //     wdot.resize(nCells,nMoments);
@@ -515,138 +540,87 @@ CamSoot::realVector CamSoot::rateAll
     const int cellID
 )
 {
+    realVector rates(nMoments,0.0);  // Total rate of change of moments
+    rateAll(conc, moments, T, p, rates);
+    return rates;
+}
 
-    realVector rates;  // Total rate of change of moments
-    //realVector nucRates, coagRates, cdRates, sRates;	// Rate of change of moments
-    realVector prodRates; 	// Rate of change of has phase species due to surface chem
-    double prodRatePAHCond; 	// Rate of change of PAH due to condensation
+void CamSoot::rateAll
+(
+    const realVector& conc,     //species concentration
+    const realVector& moments,  //moments
+    const double& T,        //temperature
+    const double& p,        //pressure
+    realVector& rates       //rate of change of moments (output)
+)
+{
+    // All the vectors below are workspaces sized in initMomentsConstants,
+    // so assign and fill do not allocate memory here.
+    std::fill(coagRates.begin(), coagRates.end(), 0.0);
+    std::fill(cdRates.begin(), cdRates.end(), 0.0);
+    std::fill(sRates.begin(), sRates.end(), 0.0);
 
-    rates.resize(moments.size(),0.0);
-    nucRates.resize(moments.size(),0.0);
-    coagRates.resize(moments.size(),0.0);
-    cdRates.resize(moments.size(),0.0);
-    sRates.resize(moments.size(),0.0);
-    prodRates.resize(conc.size(),0.0);
+    // Rate of change of gas phase species due to surface chem
+    prodRates.assign(conc.size(),0.0);
 
     // Clear the surface production rates and set to zero.
-    surfProdRate.clear();
-    surfProdRate.resize(conc.size(),0.0);
+    surfProdRate.assign(conc.size(),0.0);
 
     // Calculate nucleation rate
     // nucRates is rate of change of moments due to nucleation
-    nucRates = rateNucleation(conc[iInception],T);
+    rateNucleation(conc[iInception],T);
 
     // Remove two PAH.
     surfProdRate[iInception]= -2.0 * nucRates[0] / NA;
 
-	// Check the nucleation rates
-    //std::cout << "nucRates[0]  " << nucRates[0] << std::endl;
-    //std::cout << "nucRates[1]  " << nucRates[1] << std::endl;
-    //std::cout << "nucRates[2]  " << nucRates[2] << std::endl;
-    //std::cout << "nucRates[3]  " << nucRates[3] << std::endl;
-    //std::cout << "nucRates[4]  " << nucRates[4] << std::endl;
-    //std::cout << "nucRates[5]  " << nucRates[5] << std::endl;
-    //std::cout << "surfProdRate[iInception]  " << surfProdRate[iInception] << std::endl;
-
-
     // Calculate the interpolated reduced moments
-    realVector wholeOrderRedMom;
-    wholeOrderRedMom.resize(moments.size(),0.0);
     for(int r=0; r<nMoments; r++){
     	wholeOrderRedMom[r] = moments[r]/moments[0];
     }
     interpolateReducedMoments(wholeOrderRedMom);
 
-
-    // Calculate coagulation rates
-    // coagRates is rate of change of moments due to coagulation
     if (moments[0] > m0Threshold)			// Threshold check
-    	coagRates = rateCoagulation(moments,T);
-
-	// Check the coagulation rates
-    //std::cout << "coagRates[0]  " << coagRates[0] << std::endl;
-    //std::cout << "coagRates[1]  " << coagRates[1] << std::endl;
-    //std::cout << "coagRates[2]  " << coagRates[2] << std::endl;
-    //std::cout << "coagRates[3]  " << coagRates[3] << std::endl;
-    //std::cout << "coagRates[4]  " << coagRates[4] << std::endl;
-    //std::cout << "coagRates[5]  " << coagRates[5] << std::endl;
-
-    // Condensation rates
-    // Call this after coagulation. Reduced moments are calculated in Coag
-    // cdRates is rate of change of moments due to condensation
-    // prodRatePAHCond is rate of change in PAH due to condensation.
-    //double tempPAHConc = conc[iInception];
-
-    if (moments[0] > m0Threshold)		// Threshold check
     {
-    	cdRates = rateCondensation(moments, T,conc[iInception]);
-    	prodRatePAHCond = -cdRates[1]/numCAtomInception/NA;
-    	surfProdRate[iInception] += prodRatePAHCond;
-    }
-	// Check the condensation rates
-    //std::cout << "cdRates[0]  " << cdRates[0] << std::endl;
-    //std::cout << "cdRates[1]  " << cdRates[1] << std::endl;
-    //std::cout << "cdRates[2]  " << cdRates[2] << std::endl;
-    //std::cout << "cdRates[3]  " << cdRates[3] << std::endl;
-    //std::cout << "cdRates[4]  " << cdRates[4] << std::endl;
-    //std::cout << "cdRates[5]  " << cdRates[5] << std::endl;
-    //std::cout << "prodRatePAHCond  " << prodRatePAHCond << std::endl;
-
-    // Surface rates
-    // Call this after coagulation. Reduced moments are calculated in Coag
-    // prodRatesSurface is rate of change of gas phase species due to surface chemistry
-    // sRates is rate of change of moments due to surface chemistry
-
-    if (moments[0] > m0Threshold)		// Threshold check
-    {
-    	rateSurface(conc,T,moments,prodRates,sRates);
-    	sRates[0] = 0.0; // Surface chem should not affect M0.  (Why is this needed here?)
-
-
-    // Oxidation regime.
-    // todo: it would be better to include all this in rateSurface function
-    if(sRates[1] <= 0){
+        // Calculate coagulation rates
+        // coagRates is rate of change of moments due to coagulation
+        rateCoagulation(moments,T);
+
+        // Condensation rates
+        // cdRates is rate of change of moments due to condensation
+        // prodRatePAHCond is rate of change in PAH due to condensation.
+        rateCondensation(moments, T,conc[iInception]);
+        double prodRatePAHCond = -cdRates[1]/numCAtomInception/NA;
+        surfProdRate[iInception] += prodRatePAHCond;
+
+        // Surface rates
+        // prodRates is rate of change of gas phase species due to surface chemistry
+        // sRates is rate of change of moments due to surface chemistry
+        rateSurface(conc,T,moments,prodRates,sRates);
+        sRates[0] = 0.0; // Surface chem should not affect M0.  (Why is this needed here?)
 
-        //std::cout << "In oxidation regime."  << std::endl;
+        // Oxidation regime.
+        // todo: it would be better to include all this in rateSurface function
+        if(sRates[1] <= 0){
 
-        realVector f;
-        f.resize(nMoments,0.0);
-        for(int r = 1; r< nMoments; r++){
-            f[r] = log(reducedMoments(6*r));
-        }
+            for(int r = 1; r< nMoments; r++){
+                oxidFit[r] = log(reducedMoments(6*r));
+            }
 
-        double a, b, rsq;
-        linear(nMoments,f,a,b,rsq);
+            double a, b, rsq;
+            linear(nMoments,oxidFit,a,b,rsq);
 
-        for(int n = 4; n<(6*nMoments-2); n += 6){
-            reducedMoments(n) = exp(a+b*n/6.0);
-        }
+            for(int n = 4; n<(6*nMoments-2); n += 6){
+                reducedMoments(n) = exp(a+b*n/6.0);
+            }
 
-        rateSurface(conc,T,moments,prodRates,sRates);
+            rateSurface(conc,T,moments,prodRates,sRates);
 
-        for(int n=1; n<nMoments; n++){
-            sRates[n] *= (moments[n]/(exp(a+b*n)*moments[0]));
+            for(int n=1; n<nMoments; n++){
+                sRates[n] *= (moments[n]/(exp(a+b*n)*moments[0]));
+            }
+            sRates[0] = 0.0;
         }
-        sRates[0] = 0.0;
-    }
-
     }
-	// Check the surface rates
-    //std::cout << "sRates[0]  " << sRates[0] << std::endl;
-    //std::cout << "sRates[1]  " << sRates[1] << std::endl;
-    //std::cout << "sRates[2]  " << sRates[2] << std::endl;
-    //std::cout << "sRates[3]  " << sRates[3] << std::endl;
-    //std::cout << "sRates[4]  " << sRates[4] << std::endl;
-    //std::cout << "sRates[5]  " << sRates[5] << std::endl;
-
-    //std::cout << "prodRates[iInception]  " << prodRates[iInception] << std::endl;
-    //std::cout << "prodRates[iC2H2]  " << prodRates[iC2H2] << std::endl;
-    //std::cout << "prodRates[iCO]  " << prodRates[iCO] << std::endl;
-    //std::cout << "prodRates[iO2]  " << prodRates[iO2] << std::endl;
-    //std::cout << "prodRates[iH]  " << prodRates[iH] << std::endl;
-    //std::cout << "prodRates[iH2]  " << prodRates[iH2] << std::endl;
-    //std::cout << "prodRates[iH2O]  " << prodRates[iH2O] << std::endl;
-    //std::cout << "prodRates[iOH]  " << prodRates[iOH] << std::endl;
 
     // Store the surface production rates
     // To be returned to batch reactor via CamSoot::showGasPhaseRates
@@ -660,24 +634,67 @@ CamSoot::realVector CamSoot::rateAll
     surfProdRate[iH2O] += prodRates[iH2O];
     surfProdRate[iOH] += prodRates[iOH];
 
+    // Note: This only returns the rate of change of moments.
+    // Does not return the rate of change of gas phase species.
     rates.resize(nMoments,0.0);
     for (int m=0; m<nMoments; ++m)
     {
-    	//rates[m] = (nucRates[m]);
-    	//rates[m] = (nucRates[m]+coagRates[m]);
-    	//rates[m] = (nucRates[m]+coagRates[m]+sRates[m]);
     	rates[m] = (nucRates[m]+coagRates[m]+sRates[m]+cdRates[m]);
-    	//rates[m] = (nucRates[m]+coagRates[m]+cdRates[m]);
     }
-
-    // Note: This only returns the rate of change of moments.
-    // Does not return the rate of change of gas phase species.
-    return rates;
 }
 
+void CamSoot::rateAllCells
+(
+    const int nCells,
+    const Array2D& conc,
+    const Array2D& moments,
+    const realVector& T,
+    const double& p,
+    Array2D& momRates,
+    Array2D& gasRates,
+    Array2D& componentRates,
+    Array2D& properties
+)
+{
+    const int nSpecies = surfProdRate.size();
+
+    for (int i=0; i<nCells; ++i)
+    {
+        for (int l=0; l<nSpecies; ++l)
+            concCell[l] = conc(i,l);
+        for (int l=0; l<nMoments; ++l)
+            momCell[l] = moments(i,l);
 
+        rateAll(concCell, momCell, T[i], p, ratesCell);
 
-CamSoot::realVector CamSoot::rateNucleation
+        for (int l=0; l<nMoments; ++l)
+        {
+            momRates(i,l) = ratesCell[l];
+            componentRates(i,l) = nucRates[l];
+            componentRates(i,l+nMoments) = coagRates[l];
+            componentRates(i,l+2*nMoments) = cdRates[l];
+            componentRates(i,l+3*nMoments) = sRates[l];
+        }
+
+        // Only the species touched by the soot model are non-zero
+        gasRates(i,iInception) = surfProdRate[iInception];
+        gasRates(i,iC2H2) = surfProdRate[iC2H2];
+        gasRates(i,iCO) = surfProdRate[iCO];
+        gasRates(i,iH) = surfProdRate[iH];
+        gasRates(i,iH2) = surfProdRate[iH2];
+        gasRates(i,iH2O) = surfProdRate[iH2O];
+        gasRates(i,iO2) = surfProdRate[iO2];
+        gasRates(i,iOH) = surfProdRate[iOH];
+
+        // These use the reduced moments of the cell just evaluated.
+        properties(i,AvgDiameter) = avgSootDiam();
+        properties(i,Dispersion) = dispersion();
+        properties(i,SurfaceArea) = sootSurfaceArea(momCell[0]);
+        properties(i,VolumeFraction) = sootVolumeFraction(momCell[0]);
+    }
+}
+
+void CamSoot::rateNucleation
 (
     const double& concPAH,
     const double& T
@@ -686,11 +703,7 @@ CamSoot::realVector CamSoot::rateNucleation
 // Do this outside this function using:
 // 	prodPAH = -2 * nucRate(0) / NA
 {
-
-    realVector nucRates;
-
     double kNucl = Beta_nucl*sqrt(T);
-    nucRates.resize(nMoments,0.0);
     /*
      *nucleation rate for the zeroth moment
      */
@@ -707,194 +720,44 @@ CamSoot::realVector CamSoot::rateNucleation
     {
     	nucRates[m] = nucRates[m-1] * cDimer;
     }
-
-    return nucRates;
-
 }
 
-CamSoot::realVector CamSoot::rateCoagulation
+/*!
+ * Coagulation rates. The reduced moments must already have been
+ * interpolated (done in rateAll).
+ */
+void CamSoot::rateCoagulation
 (
     const realVector& mom,
     const double& T
 )
 {
-
-    realVector coagRates;
     double kCoag = Beta_fm * sqrt(T);
-    CamMath cm;
-
-    /*
-    *ank25:  Move the calculation of interpolated reduced moments
-    *out of coagulation and into ratesAll
-    realVector wholeOrderRedMom;
-    wholeOrderRedMom.resize(mom.size(),0.0);
-
-    for(int r=0; r<nMoments; r++){
-    	wholeOrderRedMom[r] = mom[r]/mom[0];
-    }
-    interpolateReducedMoments(wholeOrderRedMom);
-     */
-
-     /*
-     *evaluate the grid functions
-     */
-
-    realVector f;
-
-    if (nMoments == 6){
-
-    for(int i=0; i<4; i++)
-        f.push_back(gridFunction(i,0,0));
-    double crk = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-    f.clear();
-    for(int i=0; i<4; i++)
-        f.push_back(gridFunction(i,1,1));
-    double crk2 = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-    f.clear();
-    for(int i=0; i<4; i++)
-        f.push_back(gridFunction(i,1,2));
-    double crk3 = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-    f.clear();
-    for(int i=0; i<3; i++)
-        f.push_back(gridFunction(i,1,3));
-    double crk4a = kCoag*cm.interpolateLG(0.5,3,prime,f);
-
-    f.clear();
-    for(int i=0; i<4; i++)
-        f.push_back(gridFunction(i,2,2));
-    double crk4b = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-    f.clear();
-    for(int i=0; i<2; i++)
-        f.push_back(gridFunction(i,1,4));
-    double crk5a = kCoag*cm.interpolateLG(0.5,2,prime,f);
-
-    f.clear();
-    for(int i=0; i<3; i++)
-        f.push_back(gridFunction(i,2,3));
-    double crk5b = kCoag*cm.interpolateLG(0.5,3,prime,f);
-
     double M02 = mom[0]*mom[0];
 
-    coagRates.resize(nMoments,0.0);
-
-    coagRates[0] = -0.5*crk*M02;
-    coagRates[1] = 0.0;
-    coagRates[2] = crk2 * M02;
-    coagRates[3] = 3*crk3 * M02;
-    coagRates[4] = (4*crk4a + 3*crk4b) * M02;
-    coagRates[5] = (5* crk5a + 10*crk5b) * M02;
-    }
-
-    ///-----
-
-    if (nMoments == 5){
-
-    for(int i=0; i<4; i++)
-        f.push_back(gridFunction(i,0,0));
-    double crk = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-    f.clear();
-    for(int i=0; i<4; i++)
-        f.push_back(gridFunction(i,1,1));
-    double crk2 = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-    f.clear();
-    for(int i=0; i<3; i++)
-        f.push_back(gridFunction(i,1,2));
-    double crk3 = kCoag*cm.interpolateLG(0.5,3,prime,f);
-
-    f.clear();
-    for(int i=0; i<2; i++)
-        f.push_back(gridFunction(i,1,3));
-    double crk4a = kCoag*cm.interpolateLG(0.5,2,prime,f);
-
-    f.clear();
-    for(int i=0; i<3; i++)
-        f.push_back(gridFunction(i,2,2));
-    double crk4b = kCoag*cm.interpolateLG(0.5,3,prime,f);
-
-
-    double M02 = mom[0]*mom[0];
-
-    coagRates.resize(nMoments,0.0);
+    std::vector<CoagTerm>::const_iterator it;
+    for (it = coagTerms.begin(); it != coagTerms.end(); ++it)
+    {
+        /*
+         *evaluate the grid functions
+         */
+        for (int k=0; k<it->size; ++k)
+            gridValues[k] = log(gridFunction(k,it->n,it->m));
 
-    coagRates[0] = -0.5*crk*M02;
-    coagRates[1] = 0.0;
-    coagRates[2] = crk2 * M02;
-    coagRates[3] = 3*crk3 * M02;
-    coagRates[4] = (4*crk4a + 3*crk4b) * M02;
+        coagRates[it->moment] += it->coeff*kCoag*interpolateHalf(it->size)*M02;
     }
-
-    ///-----
-
-      if (nMoments == 4){
-
-      for(int i=0; i<4; i++)
-          f.push_back(gridFunction(i,0,0));
-      double crk = kCoag*cm.interpolateLG(0.5,4,prime,f);
-
-      f.clear();
-      for(int i=0; i<3; i++)
-          f.push_back(gridFunction(i,1,1));
-      double crk2 = kCoag*cm.interpolateLG(0.5,3,prime,f);
-
-      f.clear();
-      for(int i=0; i<2; i++)
-          f.push_back(gridFunction(i,1,2));
-      double crk3 = kCoag*cm.interpolateLG(0.5,2,prime,f);
-
-
-      double M02 = mom[0]*mom[0];
-
-      coagRates.resize(nMoments,0.0);
-
-      coagRates[0] = -0.5*crk*M02;
-      coagRates[1] = 0.0;
-      coagRates[2] = crk2 * M02;
-      coagRates[3] = 3*crk3 * M02;
-      }
-
-      ///-----
-
-        if (nMoments == 3){
-
-        for(int i=0; i<3; i++)
-            f.push_back(gridFunction(i,0,0));
-        double crk = kCoag*cm.interpolateLG(0.5,3,prime,f);
-
-        f.clear();
-        for(int i=0; i<2; i++)
-            f.push_back(gridFunction(i,1,1));
-        double crk2 = kCoag*cm.interpolateLG(0.5,2,prime,f);
-
-        double M02 = mom[0]*mom[0];
-
-        coagRates.resize(nMoments,0.0);
-
-        coagRates[0] = -0.5*crk*M02;
-        coagRates[1] = 0.0;
-        coagRates[2] = crk2 * M02;
-        }
-
-    return coagRates;
-
 }
 
 /*!
  * Condensation rates
  */
-CamSoot::realVector CamSoot::rateCondensation(const realVector& mom,
+void CamSoot::rateCondensation(const realVector& mom,
 									const double& T,
                                     const double& concPAH){
 
     double k_coeff = sqrt(T)*concPAH*mom[0];
-    realVector cdRates;
-    cdRates.resize(nMoments,0.0);
     for(int r=1; r<nMoments; r++){
+        cdRates[r] = 0.0;
         for(int l=0; l<r;l++){
             int l6 = 6*l;
             cdRates[r] += bnCoeff(l,r)*(
@@ -907,11 +770,9 @@ CamSoot::realVector CamSoot::rateCondensation(const realVector& mom,
 
     // Do this calculation in the calling function
     //prodRatePAHCond = -cdRates[1]/numCAtomInception/NA;
-
-    // Return moment rates
-    return cdRates;
 }
 
+
 /*!
  * Surface reaction rates
  * This function modifies both prodRates and sRates.
@@ -948,10 +809,14 @@ void CamSoot::rateSurface(const realVector& conc,
     double alpha = tanh(par_a/log10(reducedMoments(6)) + par_b );
 
     double denom = rr1+rr2+fr3+fr4+fr5;
-    realVector rateC2H2, rateO2, rateOH;		// In cgs units.
     double coef;
     prodRates.resize(conc.size(),0.0);			// In cgs.
 
+    // rateC2H2, rateO2, rateOH are workspace members (in cgs units).
+    std::fill(rateC2H2.begin(), rateC2H2.end(), 0.0);
+    std::fill(rateO2.begin(), rateO2.end(), 0.0);
+    std::fill(rateOH.begin(), rateOH.end(), 0.0);
+
     // ank25: rateC2H2, rateO2, rateOH are vectors describing
     // the rate of change to the moments.
     // prodRates is a vector describing the rate of change to gas phase species.
@@ -963,17 +828,14 @@ void CamSoot::rateSurface(const realVector& conc,
         double cRad = cArea * ssRatio;
 
         // C2H2
-        rateC2H2.resize(nMoments,0.0);
         coef = fr4*cRad;
         sums(nMoments,2,coef,rateC2H2);
 
         // O2
-        rateO2.resize(nMoments,0.0);
         coef = fr5 * cRad;
         sums(nMoments,-2,coef,rateO2);
 
         // OH
-        rateOH.resize(nMoments,0.0);
         coef = fr6 * CBOHCGS * sqrt(T) * mom[0]/1e6;
         sums(nMoments,-1,coef,rateOH);
         // Moment unit conversion and CBOH in CGS units
@@ -985,10 +847,6 @@ void CamSoot::rateSurface(const realVector& conc,
         prodRates[iH2] = (fr1*cArea - rr1*cRad)*reducedMoments(4)/NA;
         prodRates[iH2O] = (fr2*cArea - rr2*cRad)*reducedMoments(4)/NA;
   	    prodRates[iCO]= -(rateO2[1] + rateOH[1]) / NA;
-    }else{
-        rateC2H2.resize(nMoments,0.0);
-        rateO2.resize(nMoments,0.0);
-        rateOH.resize(nMoments,0.0);
     }
 
     // Now convert prodRates from cgs to SI
@@ -1012,34 +870,48 @@ void CamSoot::rateSurface(const realVector& conc,
 /*!
  *interpolate the whole order reduced moments to evaluate the
  *fractional order reduced moments
+ *
+ *The Lagrange interpolation of CamMath::interpolateLG is a weighted
+ *geometric mean of the whole order moments, so it is evaluated here as
+ *one exp of a dot product with the weights precomputed in
+ *initInterpolation, instead of one pow call per moment.
  */
 void CamSoot::interpolateReducedMoments(realVector& wom){
 
     /*
      *order of the highest fractional moment is nMoments+1/6
      */
-    CamMath cm;
     int hMoments = nMoments-1;
 
     reducedMoments.resize(lowFrac,highFrac+1);
 
+    for(int k=0; k<nMoments; k++){
+        logRedMom[k] = log(wom[k]);
+    }
+
     /*
      *negative order moments
      */
     for(int i=lowFrac; i<=-1; i++){
-        reducedMoments(i) = cm.interpolateLG(i/6.0,3,prime,wom);
-        //std::cout << "reducedMoments " << i << " : " << reducedMoments(i) << std::endl;
+        double logMom = 0.0;
+        for(int k=0; k<3; k++){
+            logMom += lgWeights(i-lowFrac,k)*logRedMom[k];
+        }
+        reducedMoments(i) = exp(logMom);
     }
 
     /*
      *positive order moments
      */
     for(int i=0; i<= 6*hMoments+1; i++){
-        if((i%6) != 0.0){
-            reducedMoments(i) = cm.interpolateLG(i/6.0,nMoments,prime,wom);
+        if((i%6) != 0){
+            double logMom = 0.0;
+            for(int k=0; k<nMoments; k++){
+                logMom += lgWeights(i-lowFrac,k)*logRedMom[k];
+            }
+            reducedMoments(i) = exp(logMom);
         }else{
             reducedMoments(i) = wom[i/6];
-
         }
     }
 
@@ -1048,6 +920,77 @@ void CamSoot::interpolateReducedMoments(realVector& wom){
     }
 }
 
+double CamSoot::interpolateHalf(const int size) const
+{
+    double logVal = 0.0;
+    for (int k=0; k<size; ++k)
+        logVal += halfWeights(size,k)*gridValues[k];
+    return exp(logVal);
+}
+
+/*!
+ * Tabulate everything the moment source terms need that depends only on
+ * the number of moments: the exponents of the Lagrange interpolation and
+ * the list of coagulation terms (Frenklach 2002, Eq. 19).
+ */
+void CamSoot::initInterpolation()
+{
+    int hMoments = nMoments-1;
+
+    lgWeights.resize(6*hMoments+2-lowFrac,nMoments);
+    for (int i=lowFrac; i<=6*hMoments+1; ++i)
+    {
+        // Whole order moments are not interpolated
+        if ((i%6) == 0) continue;
+
+        int size = (i < 0) ? 3 : nMoments;
+        double at = i/6.0;
+        double prod = 1.0;
+        for (int k=0; k<size; ++k)
+            prod *= (at-k);
+        for (int k=0; k<size; ++k)
+            lgWeights(i-lowFrac,k) = prod/((at-k)*prime(size,k+1));
+    }
+
+    int maxSize = std::min(nMoments,4);
+    halfWeights.resize(maxSize+1,maxSize);
+    for (int size=1; size<=maxSize; ++size)
+    {
+        double prod = 1.0;
+        for (int k=0; k<size; ++k)
+            prod *= (0.5-k);
+        for (int k=0; k<size; ++k)
+            halfWeights(size,k) = prod/((0.5-k)*prime(size,k+1));
+    }
+
+    // {moment, coefficient, n, m, number of grid functions}
+    coagTerms.clear();
+    if (nMoments == 6)
+    {
+        CoagTerm terms[] = {{0,-0.5,0,0,4}, {2,1.0,1,1,4}, {3,3.0,1,2,4},
+                            {4,4.0,1,3,3}, {4,3.0,2,2,4},
+                            {5,5.0,1,4,2}, {5,10.0,2,3,3}};
+        coagTerms.assign(terms, terms+7);
+    }
+    else if (nMoments == 5)
+    {
+        CoagTerm terms[] = {{0,-0.5,0,0,4}, {2,1.0,1,1,4}, {3,3.0,1,2,3},
+                            {4,4.0,1,3,2}, {4,3.0,2,2,3}};
+        coagTerms.assign(terms, terms+5);
+    }
+    else if (nMoments == 4)
+    {
+        CoagTerm terms[] = {{0,-0.5,0,0,4}, {2,1.0,1,1,3}, {3,3.0,1,2,2}};
+        coagTerms.assign(terms, terms+3);
+    }
+    else if (nMoments == 3)
+    {
+        CoagTerm terms[] = {{0,-0.5,0,0,3}, {2,1.0,1,1,2}};
+        coagTerms.assign(terms, terms+2);
+    }
+}
+
+
 /*
  * Don't use this moment residual for Flamelets.
  * Flamlet code provides its own moment residual.
@@ -22,6 +22,8 @@ FlameLet::FlameLet
 :
 CamSetup(ca, config, cc, cg, cp, cs, mech),
 stoichZ(stoichiometricMixtureFraction()),
+nStep_(0),
+consoleReport_(true),
 timeHistory(false),
 sdrProfile(false),
 sdrAnalytic(false),
@@ -94,6 +96,9 @@ void FlameLet::solve
 
     initSolutionVector();
 
+    // Continue from a converged neighbouring solution if one was given.
+    if (initialGuess_.size() == solvect.size()) solvect = initialGuess_;
+
     reporter_->header("Flamelet");
 
     if(!interface)
@@ -1217,6 +1222,21 @@ void FlameLet::energyResidual
     */
     f[0] = 0.0;
 
+    //======Radiative Heat Loss Term===============
+    // Evaluated for the whole grid in one pass.  This radiation
+    // term is sent to as output to profile.h
+    if (admin_.getRadiationModel())
+    {
+        radiation->calculateRadiativeHeatLoss
+        (
+            iMesh_s,
+            iMesh_e,
+            m_T,
+            opPre,
+            sootVolumeFractionMaster
+        );
+    }
+
     /*
     *intermediate mixture fraction coordinates
     */
@@ -1257,18 +1277,8 @@ void FlameLet::energyResidual
             f[i] += (sdr/(2.0*m_cp[i])) * tGrad * (cpGrad + sumYGrad);
         }
 
-        //======Radiative Heat Loss Term===============
         if (admin_.getRadiationModel())
         {
-            //This radiation term is sent to as output to profile.h
-            radiation->calculateRadiativeHeatLoss
-            (
-            i,
-            m_T[i],
-            opPre,
-            sootVolumeFractionMaster[i]
-            );
-
             // This is the new energy residual term, accounting for radiation.
             // This is DEFINITELY NEGATIVE!
             f[i] -= radiation->getRadiation(i)/(m_rho[i]*m_cp[i]);
@@ -1291,13 +1301,8 @@ void FlameLet::saveMixtureProp(double* y)
     vector<double> htemp(nSpc,0.0);
     vector<double> temp(nSpc,0.0);
     vector<double> cptemp(nSpc,0.0);
-    vector<double> moments_dot_temp(nMoments,0.0);
     vector<double> mom_rho_temp(nMoments,0.0);		// ank25: This is Mr/rho
-    vector<double> mom_temp(nMoments,0.0);			// ank25: This is Mr
-    vector<double> exp_mom_temp(nMoments,0.0);
     vector<double> conc(nSpc,0.0);
-    vector<double> wdotSootGasPhase(nMoments,0.0);
-    vector<double> sootComponentRatesTemp(nMoments*4,0.0);
 
     for (int i=0; i<mCord; ++i)
     {
@@ -1357,7 +1362,6 @@ void FlameLet::saveMixtureProp(double* y)
         {
         	// ank25: Multiply by rho:  Mr/rho ---> Mr
             moments(i,l) = mom_rho_temp[l] *  m_rho[i];
-            mom_temp[l] = mom_rho_temp[l] *  m_rho[i];
 
         // DEBUG:  Before calling rateAll check if any moments have gone negative.
         // If so then:
@@ -1374,53 +1378,53 @@ void FlameLet::saveMixtureProp(double* y)
 
         }
 
-        moments_dot_temp = sootMom_.rateAll(conc, mom_temp, m_T[i], opPre, 1);
-        for(int l=0; l<nMoments; l++)
+        // The moment source terms are evaluated for all cells at once below
+        for(int l=0; l<nSpc; l++)
         {
-            moments_dot(i,l) =  moments_dot_temp[l];
+            sootConc(i,l) = conc[l];
+        }
         }
+    }
+
+    if (sootMom_.active())
+    {
+        sootMom_.rateAllCells(mCord, sootConc, moments, m_T, opPre,
+                              moments_dot, sootGasRates,
+                              sootComponentRatesAllCells, sootProperties);
 
         // Now get the corresponding gas phase rates and add them to s_Wdot
         // Only do this if we are solving a Lagrangian flamelet (not steady state)
         if (sootResidualZeroed == false)
         {
-            wdotSootGasPhase = sootMom_.showGasPhaseRates(nSpc);
-            for (int l=0; l< nSpc; l++)
+            for (int i=0; i<mCord; ++i)
             {
-            s_Wdot(i,l) = s_Wdot(i,l) + wdotSootGasPhase[l] * (*spv_)[l]->MolWt();
-            }
+                for (int l=0; l< nSpc; l++)
+                {
+                s_Wdot(i,l) = s_Wdot(i,l) + sootGasRates(i,l) * (*spv_)[l]->MolWt();
+                }
 
-            // Also get the component soot rates for output.
-            // Ideally we would only do this at the major output times rather than at each call
-            // of saveMixtureProp. (Inefficient)
-            // ToDo: Move this it a better place.
-            sootComponentRatesTemp = sootMom_.showSootComponentRates(nMoments);
-            for (int l=0; l< nMoments*4; l++)
-            {
-            sootComponentRatesAllCells(i,l) = sootComponentRatesTemp[l];
+                // Calculate soot properties at each Z point.
+                // We need volume fraction for radiation.
+                avgSootDiamMaster[i] = sootProperties(i,CamSoot::AvgDiameter);
+                dispersionMaster[i] = sootProperties(i,CamSoot::Dispersion);
+                sootSurfaceAreaMaster[i] = sootProperties(i,CamSoot::SurfaceArea);
+                sootVolumeFractionMaster[i] = sootProperties(i,CamSoot::VolumeFraction);
             }
-
-            // Calculate soot properties at each Z point.
-            // We need volume fraction for radiation.
-            avgSootDiamMaster[i] = sootMom_.avgSootDiam();
-            dispersionMaster[i] = sootMom_.dispersion();
-            sootSurfaceAreaMaster[i] = sootMom_.sootSurfaceArea(moments(i,0));
-            sootVolumeFractionMaster[i] = sootMom_.sootVolumeFraction(moments(i,0));
-        }
         }
-        // Check the A4 species exists first (returns -1 if it does not).
-        if(camMech_->FindSpecies("A4") == -1)
+    }
+
+    // Check the A4 species exists first (returns -1 if it does not).
+    const int iA4 = camMech_->FindSpecies("A4");
+    for (int i=0; i<mCord; ++i)
+    {
+        if(iA4 == -1)
         {
             wdotA4Master[i] = 0.0;
         }
         else
         {
-            const int iA4 = camMech_->FindSpecies("A4");
             wdotA4Master[i] = s_Wdot(i,iA4);
         }
-
-
-
     }
 }
 
@@ -1521,6 +1525,21 @@ void FlameLet::setExternalSDR(const double sdr)
     scalarDissipationRate_.setSDRRate(sdr);
 }
 
+void FlameLet::setInitialGuess(const std::vector<double>& guess)
+{
+    initialGuess_ = guess;
+}
+
+void FlameLet::getSolutionVector(std::vector<double>& soln) const
+{
+    soln = solvect;
+}
+
+void FlameLet::setConsoleReport(const bool on)
+{
+    consoleReport_ = on;
+}
+
 void FlameLet::setExternalTimeSDR
 (
     const std::vector<double>& time,
@@ -1555,14 +1574,15 @@ int FlameLet::eval
 void FlameLet::report(double x, double* solution, double& res)
 {
 
-    static int nStep=0;
+    if (!consoleReport_) return;
+
     cout.width(5);
     cout.setf(ios::scientific);
-    //if(nStep%10==0) reporter->consoleHead("time(s) \t residual");
+    //if(nStep_%10==0) reporter->consoleHead("time(s) \t residual");
 
-    if(nStep%10==0) cout << "Time" <<"\t" << "Residual" << endl;
+    if(nStep_%10==0) cout << "Time" <<"\t" << "Residual" << endl;
     cout << x <<"\t" << res << endl;
-    nStep++;
+    nStep_++;
 
 }
 /*
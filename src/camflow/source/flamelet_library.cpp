@@ -0,0 +1,255 @@
+/*!
+ * \file   flamelet_library.cpp
+ *
+ * \brief Implementation of FlameletLibrary, declared in flamelet_library.h.
+ *
+ *
+
+ Licence:
+    This file is part of "camflow".
+
+    camflow is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Prof Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "flamelet_library.h"
+#include "flamelet.h"
+#include "cam_error.h"
+
+using namespace Camflow;
+
+FlameletLibrary::FlameletLibrary
+(
+    CamAdmin& ca,
+    const CamConfiguration& config,
+    const CamControl& cc,
+    const CamGeometry& cg,
+    const CamProfile& cp,
+    const CamSoot& cs,
+    const Sprog::Mechanism& mech
+)
+:
+admin_(ca),
+config_(config),
+control_(cc),
+geometry_(cg),
+profile_(cp),
+soot_(cs),
+mech_(mech)
+{
+    varNames_.push_back("T");
+    varNames_.push_back("rho");
+    for (unsigned int l=0; l<mech_.SpeciesCount(); ++l)
+    {
+        varNames_.push_back(mech_.Species(l)->Name());
+    }
+    if (soot_.active())
+    {
+        for (int l=0; l<soot_.getNumMoments(); ++l)
+        {
+            varNames_.push_back("M" + boost::lexical_cast<std::string>(l));
+        }
+    }
+
+    mixFracCoords_ = geometry_.getAxpos();
+}
+
+/*!
+ * Solve the steady flamelets. Each thread works through one contiguous
+ * block of the sorted SDRs and uses the converged solution at the
+ * previous SDR of its block as the initial guess of the next solve.
+ *
+ *\param[in]    sdr         Stoichiometric scalar dissipation rates (1/s).
+ *\param[in]    nThreads    Maximum number of threads, 0 for the default.
+ */
+void FlameletLibrary::generate(const std::vector<double>& sdr, int nThreads)
+{
+    sdr_ = sdr;
+    std::sort(sdr_.begin(), sdr_.end());
+    data_.assign(sdr_.size()*varNames_.size()*mixFracCoords_.size(), 0.0);
+
+    if (sdr_.empty()) return;
+
+    if (nThreads <= 0)
+    {
+#ifdef _OPENMP
+        nThreads = omp_get_max_threads();
+#else
+        nThreads = 1;
+#endif
+    }
+    const int nBlocks = std::min(nThreads, static_cast<int>(sdr_.size()));
+
+    // Exceptions may not leave an OpenMP region, so collect the messages.
+    std::vector<std::string> errors(nBlocks);
+
+    // All threads would read and write the same restart file.
+    const int restartType = admin_.getRestartType();
+    admin_.setRestartType("NONE");
+
+#pragma omp parallel for schedule(dynamic) num_threads(nBlocks)
+    for (int b=0; b<nBlocks; ++b)
+    {
+        const size_t first = b*sdr_.size()/nBlocks;
+        const size_t last = (b+1)*sdr_.size()/nBlocks;
+        try
+        {
+            solveBlock(first, last);
+        }
+        catch (CamError &ce)
+        {
+            errors[b] = ce.errorMessage;
+        }
+        catch (std::exception &e)
+        {
+            errors[b] = e.what();
+        }
+    }
+
+    if (restartType == CamAdmin::BINARY) admin_.setRestartType("BINARY");
+    else if (restartType == CamAdmin::TEXT) admin_.setRestartType("TEXT");
+
+    for (int b=0; b<nBlocks; ++b)
+    {
+        if (!errors[b].empty())
+            throw CamError("Flamelet library generation failed: " + errors[b]);
+    }
+}
+
+void FlameletLibrary::solveBlock(const size_t first, const size_t last)
+{
+    // Private copies of everything a FlameLet may modify.
+    CamConfiguration config(config_);
+    CamControl cc(control_);
+    CamGeometry cg(geometry_);
+    CamProfile cp(profile_);
+    CamSoot cs(soot_);
+    Sprog::Mechanism mech(mech_);
+
+    std::vector<double> guess;
+    for (size_t k=first; k<last; ++k)
+    {
+        FlameLet flmlt(admin_, config, cc, cg, cp, cs, mech);
+        flmlt.setExternalSDR(sdr_[k]);
+        flmlt.setInitialGuess(guess);
+
+        // The residuals of concurrent solves would interleave on the console.
+        flmlt.setConsoleReport(false);
+
+        // Steady state without soot at the flame base, as flameletSDR.
+        flmlt.solve(true, true);
+
+        flmlt.getSolutionVector(guess);
+        store(k, flmlt);
+    }
+}
+
+void FlameletLibrary::store(const size_t k, FlameLet& flmlt)
+{
+    std::vector<double> T, rho;
+    Array2D massFracs, moments;
+    flmlt.getTemperatureVector(T);
+    flmlt.getDensityVector(rho);
+    flmlt.getSpeciesMassFracs(massFracs);
+    flmlt.getMoments(moments);
+
+    const size_t nPoints = mixFracCoords_.size();
+    const size_t nSpc = mech_.SpeciesCount();
+    double* const block = &data_[k*varNames_.size()*nPoints];
+
+    for (size_t i=0; i<nPoints; ++i)
+    {
+        block[i] = T[i];
+        block[nPoints+i] = rho[i];
+        for (size_t l=0; l<nSpc; ++l)
+        {
+            block[(2+l)*nPoints+i] = massFracs(i,l);
+        }
+        for (size_t l=2+nSpc; l<varNames_.size(); ++l)
+        {
+            block[l*nPoints+i] = moments(i,l-2-nSpc);
+        }
+    }
+}
+
+double FlameletLibrary::getValue
+(
+    const size_t k,
+    const size_t var,
+    const size_t i
+) const
+{
+    const size_t nPoints = mixFracCoords_.size();
+    return data_[(k*varNames_.size() + var)*nPoints + i];
+}
+
+void FlameletLibrary::write(const std::string& fileName) const
+{
+    std::ofstream out(fileName.c_str(), std::ios::binary);
+    if (!out.good())
+        throw CamError("Could not open " + fileName + " for writing\n");
+
+    const char magic[8] = {'C','A','M','F','L','I','B','\0'};
+    out.write(magic, sizeof(magic));
+
+    const boost::uint32_t header[4] = {
+        formatVersion,
+        static_cast<boost::uint32_t>(sdr_.size()),
+        static_cast<boost::uint32_t>(mixFracCoords_.size()),
+        static_cast<boost::uint32_t>(varNames_.size())};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    char name[nameLength];
+    for (size_t v=0; v<varNames_.size(); ++v)
+    {
+        std::memset(name, 0, nameLength);
+        std::strncpy(name, varNames_[v].c_str(), nameLength-1);
+        out.write(name, nameLength);
+    }
+
+    out.write(reinterpret_cast<const char*>(&sdr_[0]),
+              sdr_.size()*sizeof(double));
+    out.write(reinterpret_cast<const char*>(&mixFracCoords_[0]),
+              mixFracCoords_.size()*sizeof(double));
+    out.write(reinterpret_cast<const char*>(&data_[0]),
+              data_.size()*sizeof(double));
+
+    if (!out.good())
+        throw CamError("Error writing the flamelet library to " + fileName + "\n");
+}
@@ -44,6 +44,7 @@
 #include "cam_control.h"
 #include "interface.h"
 #include "flamelet.h"
+#include "flamelet_library.h"
 #include "linear_interpolator.hpp"
 
 using namespace Camflow;
@@ -374,6 +375,23 @@ void Interface::flameletSDR(const double& SDR) {
     }
 }
 
+/*!
+ *Solve a steady flamelet for each SDR, several at a time, and write the
+ *library to a binary table that can be memory mapped by a CFD code.
+ *
+ *\param[in]    sdr         Stoichiometric SDRs of the library.
+ *\param[in]    fileName    Name of the binary library file.
+ *\param[in]    nThreads    Maximum number of threads, 0 for the default.
+ */
+void Interface::flameletLibrary(const std::vector<double>& sdr,
+                                const std::string& fileName,
+                                int nThreads) {
+
+    FlameletLibrary library(ca, config, cc, cg, cp, cSoot, mech);
+    library.generate(sdr, nThreads);
+    library.write(fileName);
+}
+
 /**
  * This is called when an sdr profile is required instead of just a constant one.
  */
@@ -62,7 +62,6 @@ namespace IO
             std::string globalUnits_;
 	    std::string surfUnits_; // added by mm864	
 
-            bool checkChemFile();
 			bool checkChemSurfFile();
             void readElements();
 			void readPhase();
@@ -97,8 +96,13 @@ namespace IO
 
             void check();
 
+            //! Reads the mechanism, with the ChemkinTokenizer unless a surface
+            //! mechanism is given.
             void read();
 
+            //! Reads the mechanism with the boost::regex based parsers.
+            void readWithRegex();
+
             const std::vector<Element>& elements() const
             {
                 return elements_;
@@ -0,0 +1,103 @@
+/*
+ * chemkinTokenizer.h
+ *
+ *  Hand-written scanner for the gas phase chemkin files read by
+ *  ChemkinReader.  It produces the same elements, species and reactions as
+ *  the boost::regex based parsers (ReactionParser, ThermoParser and
+ *  TransportParser) without building or running any regular expressions:
+ *  each file is read once, and the blocks, lines and fields are found by
+ *  scanning the characters directly.
+ *
+ *  Surface chemistry files are still read with the regex parsers.
+ */
+
+#ifndef CHEMKINTOKENIZER_H_
+#define CHEMKINTOKENIZER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "phase.h"
+#include "element.h"
+#include "species.h"
+#include "reaction.h"
+
+namespace IO
+{
+
+    class ChemkinTokenizer
+    {
+
+            //! Fields of a reaction line.
+            struct ReactionLine
+            {
+                std::string reactants, arrow, products, A, n, E;
+            };
+
+            //! Upper case mechanism file with the comments removed.
+            const std::string& chemfilestring_;
+
+            //! Finds the contents of a block such as ELEMENTS ... END.
+            bool findBlock
+            (
+                const std::string& keyword,
+                const char* const suffixes[],
+                std::string& block
+            ) const;
+
+            static bool splitReactionLine(const std::string& line, ReactionLine& fields);
+            static bool splitParameters(const std::string& line, const size_t begin, ReactionLine& fields);
+            static bool removePressureDependence(std::string& line);
+            static bool keywordFields
+            (
+                const std::string& line,
+                const std::string& keyword,
+                std::vector<std::string>& fields
+            );
+            static std::vector<double> parameters
+            (
+                const std::string& line,
+                const std::string& keyword,
+                const size_t minFields
+            );
+            static std::multimap<std::string, double> parseReactionSpecies(const std::string& reactionSpecies);
+            static std::multimap<std::string, double> parseThirdBodySpecies(const std::string& thirdBodies);
+            static std::map<std::string, int> parseElements(const std::string& elements_string);
+
+        public:
+
+            //! Reads a file in capitals with LF line endings.  If
+            //! stripComments is set, everything from a '!' to the end of
+            //! its line is replaced by a space.
+            static std::string readFile(const std::string& fileName, const bool stripComments);
+
+            //! Checks that a mechanism has ELEMENTS, SPECIES and REACTIONS
+            //! blocks and uses no unsupported keywords.
+            static void checkFormat(const std::string& chemfilestring);
+
+            //! Scans a mechanism read by readFile.  The string must outlive
+            //! the tokenizer.
+            explicit ChemkinTokenizer(const std::string& chemfilestring);
+
+            ~ChemkinTokenizer(){}
+
+            //! Units given after the REACTIONS keyword, or "NO GLOBAL UNITS".
+            std::string globalUnits() const;
+
+            void readElements(std::vector<Element>& elements) const;
+
+            void readSpecies(std::vector<Species>& species, std::vector<Phase>& phases) const;
+
+            void readReactions(std::vector<Reaction>& reactions) const;
+
+            //! Sets the NASA polynomials of each species from a thermo file.
+            static void readThermo(const std::string& thermfile, std::vector<Species>& species);
+
+            //! Sets the transport data of each species from a tran.dat file.
+            static void readTransport(const std::string& transfile, std::vector<Species>& species);
+
+    };
+
+} // namespace IO
+
+#endif /* CHEMKINTOKENIZER_H_ */
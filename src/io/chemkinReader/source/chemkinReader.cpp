@@ -6,6 +6,7 @@
  */
 
 #include "chemkinReader.h"
+#include "chemkinTokenizer.h"
 #include "stringFunctions.h"
 #include "thermoParser.h"
 #include "transportParser.h"
@@ -74,11 +75,11 @@ IO::ChemkinReader::ChemkinReader
     thermfile_(thermfile),
     thermSurfFile_("NOT READ"), // Added by mm864
     transfile_(transfile),
-    chemfilestring_(convertToCaps(replaceComments(fileToString(chemfile_)))),
+    chemfilestring_(ChemkinTokenizer::readFile(chemfile_, true)),
     globalUnits_("NO GLOBAL UNITS"), 
     surfUnits_("NO GLOBAL UNITS") // Added by mm864	
 {
-    checkChemFile();
+    ChemkinTokenizer::checkFormat(chemfilestring_);
 }
 
 
@@ -104,53 +105,6 @@ IO::ChemkinReader::ChemkinReader // Added by mm864
 	checkChemSurfFile();
 }
 
-bool IO::ChemkinReader::checkChemFile()
-{
-    cout << "Checking the format of the chem.inp file." << endl;
-
-    const regex fileStructure
-    (
-        "ELEM(?:|ENT|ENTS).*?END.*?"
-        "SPEC(?:|IE|IES).*?END.*?"
-        "REAC(?:|TION|TIONS).*?END"
-    );
-
-    //! \todo NEED TO ADD REGEXES FOR (LT)|(RLT) IN REACTIONPARSER ASAP
-    const regex unsupported
-    (
-        "(TDEP)|(EXCI)|(JAN)|(FIT1)|"
-        "(HV)|(MOME)|(FORD)|(RORD)|(UNITS)|(HIGH)|(USER)|"
-        "(LT)|(RLT)"
-    );
-
-    if(!regex_search(chemfilestring_, fileStructure))
-    {
-        throw regex_error("chem.inp needs the structure:\n ELEMENTS END\n SPECIES END\n REACTIONS END.");
-    }
-
-    smatch result;
-    if(regex_search(chemfilestring_, result, unsupported))
-    {
-        if (result[1] == "TDEP") throw regex_error("TDEP not supported yet.");
-        if (result[2] == "EXCI") throw regex_error("EXCI not supported yet.");
-        if (result[3] == "JAN") throw regex_error("JAN not supported yet.");
-        if (result[4] == "FIT1") throw regex_error("FIT1 not supported yet.");
-        if (result[5] == "HV") throw regex_error("HV not supported yet.");
-        if (result[6] == "MOME") throw regex_error("MOME not supported yet.");
-        if (result[7] == "RORD") throw regex_error("RORD not supported yet.");
-        if (result[8] == "UNITS") throw regex_error("UNITS not supported yet.");
-        if (result[9] == "HIGH") throw regex_error("HIGH not supported yet.");
-        if (result[10] == "USER") throw regex_error("USER not supported yet.");
-        if (result[11] == "LT") throw regex_error("LT not supported yet.");
-        if (result[12] == "RLT") throw regex_error("RLT not supported yet.");
-    }
-
-	cout << "chem.inp file format check PASSED." << endl;
-	
-    return true;
-
-}
-
 bool IO::ChemkinReader::checkChemSurfFile()
 {
     cout << "Checking the format of the surfchem.inp file." << endl;
@@ -267,7 +221,39 @@ void IO::ChemkinReader::check()
     cout << "Data output to speciesParsed and reactionsParsed." << endl;
 }
 
-void IO::ChemkinReader::read() // added by mm864
+void IO::ChemkinReader::read()
+{
+    if (chemSurfFile_ != "NOT READ")
+    {
+        readWithRegex();
+        return;
+    }
+
+    ChemkinTokenizer tokenizer(chemfilestring_);
+
+    globalUnits_ = tokenizer.globalUnits();
+    cout << "Global Units Read" << endl;
+    cout << "Units for gas reaction " << globalUnits_ << endl;
+
+    tokenizer.readElements(elements_);
+    cout << "elements read" << endl;
+    tokenizer.readSpecies(species_, phase_);
+    cout << "species read" << endl;
+
+    if (transfile_ != "NOT READ")
+    {
+        cout << "Transport file: " << transfile_ << endl;
+        ChemkinTokenizer::readTransport(transfile_, species_);
+    }
+
+    cout << "Parsing NASA thermo file: " << thermfile_ << endl;
+    ChemkinTokenizer::readThermo(thermfile_, species_);
+
+    tokenizer.readReactions(reactions_);
+    cout << "reaction read, size all: " << reactions_.size() << endl;
+}
+
+void IO::ChemkinReader::readWithRegex() // added by mm864
 {
 
     readGlobalUnits();
@@ -0,0 +1,938 @@
+/*
+ * chemkinTokenizer.cpp
+ *
+ *  The scanning rules below reproduce the matches of the regular
+ *  expressions in chemkinReader.cpp, reactionParser.cpp, thermoParser.cpp
+ *  and transportParser.cpp for well formed files, so that both readers
+ *  give identical objects.
+ */
+
+#include "chemkinTokenizer.h"
+#include "stringFunctions.h"
+#include "boost/algorithm/string/trim.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// Character classes of boost::regex (\s, \w) in the "C" locale.
+inline bool isSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline bool isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isUpper(const char c)
+{
+    return c >= 'A' && c <= 'Z';
+}
+
+inline bool isWord(const char c)
+{
+    return isDigit(c) || isUpper(c) || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+//! First position at or after pos which is not white space.
+inline size_t skipSpace(const string& s, size_t pos)
+{
+    while (pos < s.size() && isSpace(s[pos])) ++pos;
+    return pos;
+}
+
+//! First position at or after pos which is white space.
+inline size_t findSpace(const string& s, size_t pos)
+{
+    while (pos < s.size() && !isSpace(s[pos])) ++pos;
+    return pos;
+}
+
+//! Splits a string into its white space separated tokens.
+void tokenize(const string& s, size_t begin, size_t end, vector<string>& tokens)
+{
+    tokens.clear();
+    while (begin < end)
+    {
+        begin = skipSpace(s, begin);
+        if (begin >= end) break;
+        size_t tokenEnd = min(findSpace(s, begin), end);
+        tokens.push_back(s.substr(begin, tokenEnd-begin));
+        begin = tokenEnd;
+    }
+}
+
+/*!
+ * If a keyword and one of its suffixes start at pos and are followed by
+ * white space, returns the position after the suffix.
+ */
+size_t matchKeyword
+(
+    const string& s,
+    const size_t pos,
+    const string& keyword,
+    const char* const suffixes[]
+)
+{
+    if (s.compare(pos, keyword.size(), keyword) != 0) return string::npos;
+    const size_t end = pos + keyword.size();
+    for (size_t i = 0; suffixes[i] != 0; ++i)
+    {
+        const size_t len = strlen(suffixes[i]);
+        if (s.compare(end, len, suffixes[i]) == 0 && end+len < s.size() && isSpace(s[end+len]))
+        {
+            return end + len;
+        }
+    }
+    return string::npos;
+}
+
+//! Is the token a rate parameter, ([0-9]+|\.)\.*[0-9]*([EG][-+]?[0-9]*)* ?
+bool isNumber(const string& s, size_t i, const size_t end)
+{
+    if (i < end && isDigit(s[i]))
+    {
+        while (i < end && isDigit(s[i])) ++i;
+    }
+    else if (i < end && s[i] == '.')
+    {
+        ++i;
+    }
+    else
+    {
+        return false;
+    }
+    while (i < end && s[i] == '.') ++i;
+    while (i < end && isDigit(s[i])) ++i;
+    while (i < end && (s[i] == 'E' || s[i] == 'e' || s[i] == 'G' || s[i] == 'g'))
+    {
+        ++i;
+        if (i < end && (s[i] == '+' || s[i] == '-')) ++i;
+        while (i < end && isDigit(s[i])) ++i;
+    }
+    return i == end;
+}
+
+//! Is s[begin, end) a non-empty run of the characters in chars?
+bool isMadeOf(const string& s, size_t begin, const size_t end, const char* chars)
+{
+    if (begin == end) return false;
+    for (; begin != end; ++begin)
+    {
+        if (strchr(chars, s[begin]) == 0) return false;
+    }
+    return true;
+}
+
+const char* const elementSuffixes[] = {"", "ENT", "ENTS", 0};
+const char* const speciesSuffixes[] = {"", "IE", "IES", 0};
+const char* const reactionSuffixes[] = {"", "TION", "TIONS", 0};
+
+} // namespace
+
+
+string IO::ChemkinTokenizer::readFile(const string& fileName, const bool stripComments)
+{
+    ifstream fin(fileName.c_str(), ios::in | ios::binary);
+    const string raw((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+
+    string text;
+    text.reserve(raw.size() + 1);
+    bool comment = false;
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        char c = raw[i];
+        if (c == '\r')
+        {
+            if (i+1 < raw.size() && raw[i+1] == '\n') ++i;
+            c = '\n';
+        }
+        if (c == '\n')
+        {
+            text += '\n';
+            comment = false;
+        }
+        else if (comment)
+        {
+            continue;
+        }
+        else if (stripComments && c == '!')
+        {
+            text += ' ';
+            comment = true;
+        }
+        else
+        {
+            if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+            text += c;
+        }
+    }
+    if (!text.empty() && text[text.size()-1] != '\n') text += '\n';
+
+    return text;
+}
+
+void IO::ChemkinTokenizer::checkFormat(const string& chemfilestring)
+{
+    cout << "Checking the format of the chem.inp file." << endl;
+
+    const char* const structure[] = {"ELEM", "END", "SPEC", "END", "REAC", "END"};
+    size_t pos = 0;
+    for (size_t i = 0; i != 6; ++i)
+    {
+        pos = chemfilestring.find(structure[i], pos);
+        if (pos == string::npos)
+        {
+            throw runtime_error("chem.inp needs the structure:\n ELEMENTS END\n SPECIES END\n REACTIONS END.");
+        }
+        pos += strlen(structure[i]);
+    }
+
+    // Only the first keyword found is reported, and only the first six
+    // stop the reading; the remaining ones are read or ignored by the
+    // reaction parser.
+    const char* const unsupported[] =
+    {
+        "TDEP", "EXCI", "JAN", "FIT1", "HV", "MOME",
+        "FORD", "RORD", "UNITS", "HIGH", "USER", "LT", "RLT"
+    };
+    size_t first = string::npos, which = 0;
+    for (size_t i = 0; i != 13; ++i)
+    {
+        const size_t found = chemfilestring.find(unsupported[i]);
+        if (found < first)
+        {
+            first = found;
+            which = i;
+        }
+    }
+    if (first != string::npos && which < 6)
+    {
+        throw runtime_error(string(unsupported[which]) + " not supported yet.");
+    }
+
+    cout << "chem.inp file format check PASSED." << endl;
+}
+
+IO::ChemkinTokenizer::ChemkinTokenizer(const string& chemfilestring)
+:
+    chemfilestring_(chemfilestring)
+{}
+
+/*!
+ * The block is the text after the keyword and white space, up to the first
+ * white space followed by END.
+ */
+bool IO::ChemkinTokenizer::findBlock
+(
+    const string& keyword,
+    const char* const suffixes[],
+    string& block
+) const
+{
+    const string& s = chemfilestring_;
+    for (size_t pos = s.find(keyword); pos != string::npos; pos = s.find(keyword, pos+1))
+    {
+        const size_t keywordEnd = matchKeyword(s, pos, keyword, suffixes);
+        if (keywordEnd == string::npos) continue;
+
+        const size_t begin = skipSpace(s, keywordEnd);
+        size_t end = s.find("END", begin);
+        while (end != string::npos && !(end > begin && isSpace(s[end-1])))
+        {
+            end = s.find("END", end+1);
+        }
+        if (end != string::npos)
+        {
+            while (end > begin && isSpace(s[end-1])) --end;
+            block = s.substr(begin, end-begin);
+            return true;
+        }
+        if (begin - keywordEnd >= 2 && s.compare(begin, 3, "END") == 0)
+        {
+            block.clear();
+            return true;
+        }
+    }
+    block.clear();
+    return false;
+}
+
+string IO::ChemkinTokenizer::globalUnits() const
+{
+    const char* const units[] =
+    {
+        "CAL/MOLE", "KCAL/MOLE", "JOULES/MOL", "KJOULES/MOLE", "KJOU/MOL",
+        "KJOU/MOLE", "KELVINS", "EVOLTS", "MOLES", "MOLECULES", 0
+    };
+
+    const string& s = chemfilestring_;
+    string globalUnits("NO GLOBAL UNITS");
+    size_t pos = s.find("REAC");
+    while (pos != string::npos)
+    {
+        size_t next = pos + 1;
+        const size_t keywordEnd = matchKeyword(s, pos, "REAC", reactionSuffixes);
+        if (keywordEnd != string::npos)
+        {
+            const size_t begin = skipSpace(s, keywordEnd);
+            for (size_t i = 0; units[i] != 0; ++i)
+            {
+                const size_t len = strlen(units[i]);
+                if (s.compare(begin, len, units[i]) == 0 && (begin+len == s.size() || !isWord(s[begin+len])))
+                {
+                    if (globalUnits != "NO GLOBAL UNITS")
+                        throw std::logic_error("Units are already specified as " + globalUnits);
+                    globalUnits = units[i];
+                    next = begin + len;
+                    break;
+                }
+            }
+        }
+        pos = s.find("REAC", next);
+    }
+    return globalUnits;
+}
+
+void IO::ChemkinTokenizer::readElements(vector<Element>& elements) const
+{
+    string block;
+    findBlock("ELEM", elementSuffixes, block);
+
+    size_t i = 0;
+    while (i < block.size())
+    {
+        if (!isWord(block[i]))
+        {
+            ++i;
+            continue;
+        }
+        const size_t begin = i;
+        while (i < block.size() && isWord(block[i])) ++i;
+        elements.push_back(Element(block.substr(begin, i-begin), 0.0));
+    }
+}
+
+void IO::ChemkinTokenizer::readSpecies(vector<Species>& species, vector<Phase>& phases) const
+{
+    string block;
+    findBlock("SPEC", speciesSuffixes, block);
+    phases.push_back(Phase("gas", "", 0.0));
+
+    // Species names are separated by spaces and new lines only.
+    int sp_index = 0;
+    std::map<std::string, int> sp_map;
+    size_t i = 0;
+    while (i < block.size())
+    {
+        if (block[i] == ' ' || block[i] == '\n')
+        {
+            ++i;
+            continue;
+        }
+        const size_t begin = i;
+        while (i < block.size() && block[i] != ' ' && block[i] != '\n') ++i;
+        const string name = block.substr(begin, i-begin);
+        species.push_back(Species(name));
+        species.back().setSiteOccupancy(0);
+        species.back().setPhaseName("gas");
+        sp_map.insert(pair<string, int>(name, sp_index));
+        ++sp_index;
+    }
+    phases.back().setSpecies(sp_map);
+}
+
+void IO::ChemkinTokenizer::readReactions(vector<Reaction>& reactions) const
+{
+    string block;
+    findBlock("REAC", reactionSuffixes, block);
+
+    // Split into lines, dropping those which are blank.
+    vector<string> lines;
+    size_t begin = 0;
+    for (size_t i = 0; i <= block.size(); ++i)
+    {
+        if (i == block.size() || block[i] == '\n' || block[i] == '\r' || block[i] == '|')
+        {
+            if (skipSpace(block, begin) < i) lines.push_back(block.substr(begin, i-begin));
+            begin = i + 1;
+        }
+    }
+
+    ReactionLine fields;
+    vector<string> keyFields;
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        Reaction reaction;
+
+        string line = lines[i];
+        if (removePressureDependence(line)) reaction.setPressureDependent();
+
+        if (!splitReactionLine(line, fields)) continue;
+
+        reaction.setReactants(parseReactionSpecies(fields.reactants));
+        if (fields.arrow == "=>") reaction.setReversible(false);
+        reaction.setProducts(parseReactionSpecies(fields.products));
+        reaction.setArrhenius
+        (
+            from_string<double>(fields.A),
+            from_string<double>(fields.n),
+            from_string<double>(fields.E)
+        );
+
+        // Auxiliary lines up to the next reaction.
+        ReactionLine nextFields;
+        while (i < lines.size()-1)
+        {
+            const string& next = lines[i+1];
+
+            if (splitReactionLine(next, nextFields))
+            {
+                break;
+            }
+            else if (next.find("DUP") != string::npos)
+            {
+                reaction.setDuplicate();
+            }
+            else if (keywordFields(next, "REV", keyFields) && keyFields.size() >= 3)
+            {
+                vector<double> reverseArrhenius = parameters(next, "REV", 3);
+                reaction.setArrhenius(reverseArrhenius[0], reverseArrhenius[1], reverseArrhenius[2], true);
+            }
+            else if (reaction.hasThirdBody() || reaction.isPressureDependent())
+            {
+                vector<double> values;
+                if (!(values = parameters(next, "LOW", 3)).empty())
+                {
+                    reaction.setLOW(values);
+                }
+                else if (!(values = parameters(next, "TROE", 3)).empty())
+                {
+                    reaction.setTROE(values);
+                }
+                else if (!(values = parameters(next, "SRI", 3)).empty())
+                {
+                    reaction.setSRI(values);
+                }
+                else
+                {
+                    reaction.setThirdBodies(parseThirdBodySpecies(next));
+                }
+            }
+            else if (keywordFields(next, "COV", keyFields) && keyFields.size() >= 4)
+            {
+                reaction.setCOV
+                (
+                    from_string<double>(keyFields[1]),
+                    from_string<double>(keyFields[2]),
+                    from_string<double>(keyFields[3]),
+                    keyFields[0]
+                );
+            }
+            else if (keywordFields(next, "FORD", keyFields) && keyFields.size() >= 2)
+            {
+                reaction.setFORD(from_string<double>(keyFields[1]), keyFields[0]);
+            }
+            else if (next.find("STICK") != string::npos)
+            {
+                reaction.setSTICK();
+            }
+            else if (next.find("MWON") != string::npos)
+            {
+                reaction.setMWON();
+            }
+            else
+            {
+                throw std::logic_error("Reaction "+next+" is not supported.");
+            }
+            ++i;
+        }
+
+        reactions.push_back(reaction);
+    }
+}
+
+/*!
+ * Splits "reactants arrow products A n E".  The products end before the
+ * first number which is followed by two more fields; the arrows are tried
+ * from the left of the line.
+ *
+ * @return  False if the line is not a reaction.
+ */
+bool IO::ChemkinTokenizer::splitReactionLine(const string& line, ReactionLine& fields)
+{
+    const size_t len = line.size();
+
+    for (size_t x = 0; x < len; ++x)
+    {
+        const char* arrows[3];
+        size_t nArrows = 0;
+        if (line.compare(x, 3, "<=>") == 0) arrows[nArrows++] = "<=>";
+        if (line.compare(x, 2, "=>") == 0) arrows[nArrows++] = "=>";
+        if (line[x] == '=') arrows[nArrows++] = "=";
+
+        for (size_t k = 0; k != nArrows; ++k)
+        {
+            const size_t arrowEnd = x + strlen(arrows[k]);
+            const size_t productsBegin = skipSpace(line, arrowEnd);
+
+            // Try the tokens after the first product, then the first
+            // token itself with no products.
+            size_t productsEnd = string::npos;
+            size_t q = findSpace(line, productsBegin);
+            while (q < len)
+            {
+                const size_t t = skipSpace(line, q);
+                if (splitParameters(line, t, fields))
+                {
+                    productsEnd = q;
+                    break;
+                }
+                q = findSpace(line, t);
+            }
+            if (productsEnd == string::npos && productsBegin > arrowEnd
+                && splitParameters(line, productsBegin, fields))
+            {
+                productsEnd = productsBegin;
+            }
+
+            if (productsEnd != string::npos)
+            {
+                size_t reactantsEnd = x;
+                while (reactantsEnd > 0 && isSpace(line[reactantsEnd-1])) --reactantsEnd;
+                fields.reactants = line.substr(0, reactantsEnd);
+                fields.arrow = arrows[k];
+                fields.products = line.substr(productsBegin, productsEnd-productsBegin);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * Reads the Arrhenius parameters of a reaction line, if an A factor starts
+ * at begin and is followed by two more fields.  As in ReactionParser, an
+ * A factor followed by two spaces and one field gives an empty n.
+ */
+bool IO::ChemkinTokenizer::splitParameters(const string& line, const size_t begin, ReactionLine& fields)
+{
+    const size_t len = line.size();
+    const size_t end = findSpace(line, begin);
+    if (end == len || !isNumber(line, begin, end)) return false;
+
+    const size_t nBegin = skipSpace(line, end);
+    const size_t nEnd = findSpace(line, nBegin);
+    if (nEnd < len)
+    {
+        fields.n = line.substr(nBegin, nEnd-nBegin);
+        fields.E = line.substr(skipSpace(line, nEnd));
+    }
+    else if (nBegin - end >= 2)
+    {
+        fields.n.clear();
+        fields.E = line.substr(nBegin);
+    }
+    else
+    {
+        return false;
+    }
+    fields.A = line.substr(begin, end-begin);
+    return true;
+}
+
+/*!
+ * Removes every "(+...)" from a reaction line.
+ *
+ * @return  True if the reaction is pressure dependent.
+ */
+bool IO::ChemkinTokenizer::removePressureDependence(string& line)
+{
+    string result;
+    size_t pos = 0;
+    bool found = false;
+    while (true)
+    {
+        const size_t open = line.find("(+", pos);
+        if (open == string::npos) break;
+        const size_t close = line.find(')', open+2);
+        if (close == string::npos) break;
+        result.append(line, pos, open-pos);
+        pos = close + 1;
+        found = true;
+    }
+    if (found)
+    {
+        result.append(line, pos, string::npos);
+        line.swap(result);
+    }
+    return found;
+}
+
+/*!
+ * Finds "KEYWORD / fields /" in a line.
+ *
+ * @return  False if the keyword is not followed by a slash.
+ */
+bool IO::ChemkinTokenizer::keywordFields
+(
+    const string& line,
+    const string& keyword,
+    vector<string>& fields
+)
+{
+    for (size_t pos = line.find(keyword); pos != string::npos; pos = line.find(keyword, pos+1))
+    {
+        const size_t open = skipSpace(line, pos + keyword.size());
+        if (open == line.size() || line[open] != '/') continue;
+        const size_t close = line.find('/', open+1);
+        if (close == string::npos) continue;
+        tokenize(line, open+1, close, fields);
+        return true;
+    }
+    fields.clear();
+    return false;
+}
+
+/*!
+ * Reads the LOW, TROE, SRI or REV parameters of a line.  TROE has three or
+ * four parameters and SRI three or five; LOW and REV have three.
+ *
+ * @return  The parameters, or an empty vector if the keyword is not found.
+ */
+vector<double> IO::ChemkinTokenizer::parameters
+(
+    const string& line,
+    const string& keyword,
+    const size_t minFields
+)
+{
+    vector<string> fields;
+    vector<double> values;
+    if (!keywordFields(line, keyword, fields) || fields.size() < minFields) return values;
+
+    size_t n = minFields;
+    if (keyword == "TROE" && fields.size() >= 4) n = 4;
+    if (keyword == "SRI" && fields.size() >= 5) n = 5;
+    for (size_t i = 0; i != n; ++i)
+    {
+        values.push_back(from_string<double>(fields[i]));
+    }
+    return values;
+}
+
+multimap<string, double>
+IO::ChemkinTokenizer::parseReactionSpecies(const string& reactionSpecies)
+{
+    multimap<string, double> reactionSpeciesMap;
+
+    // Species are separated by '+', without a trailing empty one.
+    vector<string> pieces;
+    size_t begin = 0;
+    for (size_t plus = reactionSpecies.find('+'); plus != string::npos; plus = reactionSpecies.find('+', begin))
+    {
+        pieces.push_back(reactionSpecies.substr(begin, plus-begin));
+        begin = plus + 1;
+    }
+    if (begin < reactionSpecies.size()) pieces.push_back(reactionSpecies.substr(begin));
+
+    for (size_t p = 0; p != pieces.size(); ++p)
+    {
+        // The name starts at the first capital letter, and may be preceded
+        // by a stoichiometric coefficient.
+        const string& piece = pieces[p];
+        string stoich, name;
+        for (size_t i = 0; i < piece.size(); ++i)
+        {
+            if (isUpper(piece[i]))
+            {
+                name = piece.substr(i);
+                break;
+            }
+            if (isDigit(piece[i]))
+            {
+                size_t j = i;
+                while (j < piece.size() && isDigit(piece[j])) ++j;
+                if (j < piece.size() && isUpper(piece[j]))
+                {
+                    stoich = piece.substr(i, j-i);
+                    name = piece.substr(j);
+                    break;
+                }
+                i = j;
+            }
+        }
+
+        reactionSpeciesMap.insert
+        (
+            pair<string,double>
+            (
+                boost::trim_copy(name),
+                stoich.empty() ? 1.0 : from_string<double>(stoich)
+            )
+        );
+    }
+
+    return reactionSpeciesMap;
+}
+
+multimap<string, double>
+IO::ChemkinTokenizer::parseThirdBodySpecies(const string& thirdBodies)
+{
+    const string line = boost::trim_copy(thirdBodies);
+
+    // Names and efficiencies are separated by '/'.
+    vector<string> pieces;
+    size_t begin = 0;
+    for (size_t slash = line.find('/'); slash != string::npos; slash = line.find('/', begin))
+    {
+        pieces.push_back(line.substr(begin, slash-begin));
+        begin = slash + 1;
+    }
+    if (begin < line.size()) pieces.push_back(line.substr(begin));
+
+    multimap<string, double> thirdBodyMap;
+    for (size_t i = 0; i+1 < pieces.size(); i += 2)
+    {
+        thirdBodyMap.insert(pair<string,double>(boost::trim_copy(pieces[i]), from_string<double>(pieces[i+1])));
+    }
+    return thirdBodyMap;
+}
+
+map<string, int> IO::ChemkinTokenizer::parseElements(const string& elements_string)
+{
+    map<string, int> elem_count_map;
+    if (elements_string.length() % 5 != 0)
+    {
+        throw runtime_error("Invalid element string found for value: " + elements_string);
+    }
+    for (size_t i = 0; i < elements_string.length() / 5; i++)
+    {
+        const string count_str = boost::trim_copy(elements_string.substr(3 + i * 5, 2));
+        if (count_str.length() == 0) continue;
+        const int count = from_string<int>(count_str);
+        if (count == 0) continue;
+        elem_count_map.insert(pair<string, int>(boost::trim_copy(elements_string.substr(i * 5, 3)), count));
+    }
+    return elem_count_map;
+}
+
+void IO::ChemkinTokenizer::readThermo(const string& thermfile, vector<Species>& species)
+{
+    const string text = readFile(thermfile, false);
+
+    vector<string> lines;
+    for (size_t begin = 0, end; begin < text.size(); begin = end + 1)
+    {
+        end = text.find('\n', begin);
+        lines.push_back(text.substr(begin, end-begin));
+    }
+
+    // The polynomials are between the THERMO line and the first END line.
+    int begin = -1, end = -1;
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const size_t first = skipSpace(lines[i], 0);
+        if (begin < 0 && lines[i].compare(first, 4, "THER") == 0)
+        {
+            begin = (int) i;
+        }
+        else if (lines[i].compare(first, 3, "END") == 0)
+        {
+            end = (int) i;
+            break;
+        }
+    }
+    if (!(-1 < begin && begin < end))
+    {
+        cout << "Error: Thermo file does not contain valid starting and ending tags." << endl;
+        begin = end = 0;
+    }
+
+    // Global temperatures: THER[MO] [ALL] T_low T_common T_high.
+    double globalT[3];
+    bool foundT = false;
+    for (size_t pos = text.find("THER"); pos != string::npos && !foundT; pos = text.find("THER", pos+1))
+    {
+        size_t i = pos + 4;
+        if (!(i < text.size() && isSpace(text[i])))
+        {
+            if (text.compare(i, 2, "MO") != 0) continue;
+            i += 2;
+            if (!(i < text.size() && isSpace(text[i]))) continue;
+        }
+        i = skipSpace(text, i);
+        if (!(i < text.size() && (isDigit(text[i]) || text[i] == '.')))
+        {
+            if (text.compare(i, 3, "ALL") != 0) continue;
+            i = skipSpace(text, i+3);
+        }
+        foundT = true;
+        for (size_t t = 0; t != 3 && foundT; ++t)
+        {
+            const size_t numberBegin = i;
+            while (i < text.size() && (isDigit(text[i]) || text[i] == '.')) ++i;
+            if (i == numberBegin || (t < 2 && !(i < text.size() && isSpace(text[i]))))
+            {
+                foundT = false;
+                break;
+            }
+            globalT[t] = from_string<double>(text.substr(numberBegin, i-numberBegin));
+            i = skipSpace(text, i);
+        }
+    }
+    if (!foundT)
+    {
+        throw std::runtime_error("Could not find list of global temperatures.");
+    }
+
+    // Four line NASA records, numbered 1 to 4 in column 80.
+    vector<Thermo> thermos;
+    map<string, size_t> thermoIndex;
+    for (int i = begin + 1; i < end; ++i)
+    {
+        bool nasa = (i + 4 <= end);
+        for (int l = 0; l != 4 && nasa; ++l)
+        {
+            const string& line = lines[i+l];
+            nasa = line.size() >= 80 && line[79] == '1' + l && line.find('!') >= 79;
+        }
+        if (!nasa)
+        {
+            if (skipSpace(lines[i], 0) < lines[i].size())
+            {
+                cout << "Unmatched : " << lines[i] << endl;
+            }
+            continue;
+        }
+
+        const string& l1 = lines[i];
+        const string& l2 = lines[i+1];
+        const string& l3 = lines[i+2];
+        const string& l4 = lines[i+3];
+        i += 3;
+
+        // Many files use a space rather than column 18 to end the name.
+        const string speciesString = l1.substr(0, 18);
+        const size_t nameBegin = skipSpace(speciesString, 0);
+        const size_t nameEnd = findSpace(speciesString, nameBegin);
+        string speciesName;
+        if (nameEnd < speciesString.size())
+        {
+            speciesName = speciesString.substr(nameBegin, nameEnd-nameBegin);
+        }
+        else if (nameBegin != speciesString.size() || speciesString.empty())
+        {
+            throw std::runtime_error("Can't find a species name. There is probably no"
+                                     "space after column 18.");
+        }
+
+        Thermo thermo(speciesName);
+        thermo.setNote(boost::trim_copy(l1.substr(18, 6)));
+        thermo.setPhase(l1.substr(44, 1));
+        thermo.setTLow(from_string<double>(boost::trim_copy(l1.substr(45, 10))));
+        thermo.setTHigh(from_string<double>(boost::trim_copy(l1.substr(55, 10))));
+        const string tCommon = boost::trim_copy(l1.substr(65, 8));
+        thermo.setTCommon(tCommon.empty() ? globalT[1] : from_string<double>(tCommon));
+        thermo.setElements(parseElements(l1.substr(24, 20)));
+
+        double a[14];
+        const string* coefficientLines[3] = {&l2, &l3, &l4};
+        for (size_t k = 0; k != 14; ++k)
+        {
+            string field = coefficientLines[k/5]->substr((k%5)*15, 15);
+            field.erase(remove(field.begin(), field.end(), ' '), field.end());
+            a[k] = from_string<double>(field);
+        }
+        thermo.setUpperTemperatureCoefficients(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+        thermo.setLowerTemperatureCoefficients(a[7], a[8], a[9], a[10], a[11], a[12], a[13]);
+
+        thermoIndex.insert(pair<string, size_t>(speciesName, thermos.size()));
+        thermos.push_back(thermo);
+    }
+
+    // The first record of each species is used.
+    for (size_t i = 0; i != species.size(); ++i)
+    {
+        const map<string, size_t>::const_iterator it = thermoIndex.find(species[i].name());
+        if (it == thermoIndex.end())
+        {
+            throw runtime_error("Thermo data for Species " + species[i].name() + " not found in " + convertToCaps(thermfile));
+        }
+        species[i].thermo() = thermos[it->second];
+    }
+}
+
+/*!
+ * A transport record is a species name followed by the geometry index
+ * (0, 1 or 2) and five numbers.  The first record whose name ends with the
+ * species name at a word boundary, or at the start of a line, is used.
+ */
+void IO::ChemkinTokenizer::readTransport(const string& transfile, vector<Species>& species)
+{
+    const string text = readFile(transfile, false);
+
+    vector<size_t> tokenBegin, tokenEnd;
+    for (size_t pos = skipSpace(text, 0); pos < text.size(); pos = skipSpace(text, tokenEnd.back()))
+    {
+        tokenBegin.push_back(pos);
+        tokenEnd.push_back(findSpace(text, pos));
+    }
+
+    // Index the records by every name they can match.
+    map<string, size_t> records;
+    for (size_t k = 0; k + 6 < tokenBegin.size(); ++k)
+    {
+        if (tokenEnd[k+6] == text.size()) break;
+        bool record = isMadeOf(text, tokenBegin[k+1], tokenEnd[k+1], "012");
+        for (size_t f = 2; f != 7 && record; ++f)
+        {
+            record = isMadeOf(text, tokenBegin[k+f], tokenEnd[k+f], "0123456789.");
+        }
+        if (!record) continue;
+
+        for (size_t p = tokenBegin[k]; p != tokenEnd[k]; ++p)
+        {
+            bool boundary;
+            if (p == tokenBegin[k])
+            {
+                boundary = p == 0 || text[p-1] == '\n' || text[p-1] == '\r' || text[p-1] == '\f' || isWord(text[p]);
+            }
+            else
+            {
+                boundary = isWord(text[p-1]) != isWord(text[p]);
+            }
+            if (boundary) records.insert(pair<string, size_t>(text.substr(p, tokenEnd[k]-p), k));
+        }
+    }
+
+    vector<double> values(5);
+    for (size_t i = 0; i != species.size(); ++i)
+    {
+        const map<string, size_t>::const_iterator it = records.find(species[i].name());
+        if (it == records.end())
+        {
+            throw runtime_error("Species " + species[i].name() + " not found in " + transfile + ".");
+        }
+        const size_t k = it->second;
+        for (size_t f = 0; f != 5; ++f)
+        {
+            values[f] = from_string<double>(text.substr(tokenBegin[k+f+2], tokenEnd[k+f+2]-tokenBegin[k+f+2]));
+        }
+        Transport& transport = species[i].transport();
+        transport.setMoleculeIndex(from_string<int>(text.substr(tokenBegin[k+1], tokenEnd[k+1]-tokenBegin[k+1])));
+        transport.setPotentialWellDepth(values[0]);
+        transport.setCollisionDiameter(values[1]);
+        transport.setDipoleMoment(values[2]);
+        transport.setPolarizability(values[3]);
+        transport.setRotRelaxationNumber(values[4]);
+    }
+}
@@ -133,23 +133,19 @@ IO::convertToCaps(const vector<string>& str)
 void
 IO::checkNumberFormat(std::string& t)
 {
-    const boost::regex numberFormatRegex("[A-CI-Z]");
-    boost::smatch what;
-
-    std::string::const_iterator start = t.begin();
-    std::string::const_iterator end = t.end();
-
-    if (boost::regex_search(start, end, what, numberFormatRegex))
+    for (std::string::const_iterator c = t.begin(); c != t.end(); ++c)
     {
-        throw std::runtime_error("from_string<> is complaining about the format"
-                                 " of a string you've given it.");
-    } else
+        if ((*c >= 'A' && *c <= 'C') || (*c >= 'I' && *c <= 'Z'))
+        {
+            throw std::runtime_error("from_string<> is complaining about the format"
+                                     " of a string you've given it.");
+        }
+    }
+
+    // This is a bastard: Some numbers have D or G in them instead of E which
+    // from_string can't deal with.
+    for (std::string::iterator c = t.begin(); c != t.end(); ++c)
     {
-         // This is a bastard: Some numbers have D or G in them instead of E which
-         // from_string can't deal with.
-         boost::replace_all(t,"D","E");
-         boost::replace_all(t,"F","E");
-         boost::replace_all(t,"G","E");
-         boost::replace_all(t,"H","E");
+        if (*c == 'D' || *c == 'F' || *c == 'G' || *c == 'H') *c = 'E';
     }
 }
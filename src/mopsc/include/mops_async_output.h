@@ -0,0 +1,136 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    The AsyncOutputBuffer class is a stream buffer which writes a binary
+    output file in a background thread, so that the solver only copies
+    its output into memory.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef MOPS_ASYNC_OUTPUT_H
+#define MOPS_ASYNC_OUTPUT_H
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <cstddef>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace Mops
+{
+/*!
+ * Double-buffered stream buffer for the binary simulation output.
+ *
+ * Writes through a std::ostream go into the front buffer.  When it is
+ * full, or Flush is called, it is swapped with the back buffer, which a
+ * background thread writes to the file while the front buffer fills up
+ * again.  Both buffers are allocated once, when the buffer is created.
+ * The bytes reach the file in the order they were written, so the file
+ * is the same as one written directly.
+ *
+ * Flushing the stream (std::ostream::flush) waits until everything
+ * written so far is in the file.  Write errors set the badbit of the
+ * stream and are reported by Close.
+ */
+class AsyncOutputBuffer : public std::streambuf
+{
+public:
+    // Constructors.
+    AsyncOutputBuffer(std::size_t size = 1 << 20); // Bytes in each buffer.
+
+    // Destructors.
+    ~AsyncOutputBuffer(void); // Closes the file.
+
+    //! Opens the file, appending to it if append is true; returns false
+    //! if the file cannot be opened.
+    bool Open(const std::string &filename, bool append);
+
+    //! Is a file open?
+    bool IsOpen(void) const {return m_open;}
+
+    //! Passes the data written so far to the background thread without
+    //! waiting for it to reach the file.
+    void Flush(void);
+
+    //! Writes all data, stops the background thread and closes the file.
+    void Close(void);
+
+protected:
+    // Stream buffer interface.
+    int_type overflow(int_type c);
+    std::streamsize xsputn(const char *s, std::streamsize n);
+    int sync(void);
+
+private:
+    // Front buffer (the put area) and back buffer (being written).
+    std::vector<char> m_front, m_back;
+
+    // Number of bytes in the back buffer still to write, if m_pending.
+    std::size_t m_backsize;
+    bool m_pending;
+
+    // Should the thread stop?  Is a file open?
+    bool m_stop, m_open;
+
+    // Name of the file and message of the first failed write.
+    std::string m_filename, m_error;
+
+    // The output file, only used by the thread while it is writing.
+    std::ofstream m_out;
+
+    boost::thread m_thread;
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+
+    //! Swaps the front buffer with the back buffer once that has been
+    //! written; returns false after a write error.
+    bool handOff(void);
+
+    //! Waits until the back buffer has been written; returns false after
+    //! a write error.
+    bool wait(void);
+
+    //! Thread function: writes back buffers until stopped.
+    void run(void);
+
+    // Not copyable.
+    AsyncOutputBuffer(const AsyncOutputBuffer &);
+    AsyncOutputBuffer &operator=(const AsyncOutputBuffer &);
+};
+};
+
+#endif
@@ -0,0 +1,159 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    The Checkpoint class holds the state of a simulation at the end of a
+    time interval, so that a run can be continued after the program has
+    stopped.  The CheckpointWriter class writes checkpoints to disk in a
+    background thread.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef MOPS_CHECKPOINT_H
+#define MOPS_CHECKPOINT_H
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Mops
+{
+/*!
+ * State of a simulation at the end of a time interval.
+ *
+ * The mixture (gas phase and particle ensemble) and the in-situ histogram
+ * sums are held in their binary serialised form, so that taking a
+ * checkpoint only copies the state into memory.  The output files that
+ * the simulation appends to are listed with their sizes, so that data
+ * written after the checkpoint can be discarded on restart.
+ *
+ * The gas-phase ODE solver is not part of the checkpoint: on restart it
+ * is reinitialised from the mixture, as it is after every Sweep step.
+ */
+class Checkpoint
+{
+public:
+    //! Output file name and its size in bytes.
+    typedef std::pair<std::string, boost::uint64_t> FileSize;
+
+    // Constructors.
+    Checkpoint(void); // Default constructor.
+
+    // Position in the simulation.
+    unsigned int Run;       // Index of the run.
+    unsigned int Interval;  // Index of the next time interval to solve.
+    unsigned int Step;      // Number of steps completed in the run.
+    unsigned int Console;   // Steps until the next console output.
+    double Time;            // Reactor time (s).
+    double Runtime;         // CPU time spent on the run so far (s).
+
+    // State.
+    std::string RNG;        // Random number generator state (text).
+    std::string Mixture;    // Serialised mixture.
+    std::string Histograms; // Serialised histogram sums.
+    std::vector<unsigned int> ProcessJumps, FictitiousJumps; // Jump counts.
+    std::vector<FileSize> Files; // Output files and their sizes.
+
+    // READ/WRITE.
+
+    //! Writes the checkpoint to a binary stream.
+    void Serialize(std::ostream &out) const;
+
+    //! Reads the checkpoint from a binary stream.
+    void Deserialize(std::istream &in);
+
+    //! Reads a checkpoint file.
+    void Read(const std::string &filename);
+
+    //! Adds an output file with its current size to the list.
+    void AddFile(const std::string &filename);
+
+    //! Cuts the listed output files back to their sizes.
+    void TruncateFiles(void) const;
+};
+
+/*!
+ * Writes checkpoints in a background thread.
+ *
+ * Write takes over the serialised checkpoint by swapping strings, so the
+ * caller is not held up by the disk.  The file is written under a
+ * temporary name and then renamed, so an interrupted write leaves the
+ * previous checkpoint intact.  If a checkpoint is still being written
+ * when the next one arrives, the next one waits its turn; only the
+ * newest waiting checkpoint is kept.
+ */
+class CheckpointWriter
+{
+public:
+    // Constructors.
+    CheckpointWriter(void); // Default constructor.
+
+    // Destructors.
+    ~CheckpointWriter(void); // Waits for the last checkpoint.
+
+    //! Queues data for writing to filename; data is left empty.
+    void Write(const std::string &filename, std::string &data);
+
+    //! Waits until all queued checkpoints are on disk.
+    void Wait(void);
+
+private:
+    boost::thread m_thread;
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+
+    // Queued checkpoint, if m_queued.
+    std::string m_filename, m_data;
+    bool m_queued;
+
+    // Is a checkpoint being written?  Should the thread stop?
+    bool m_busy, m_stop;
+
+    // Message of the last failed write.
+    std::string m_error;
+
+    //! Thread function: writes queued checkpoints until stopped.
+    void run(void);
+
+    // Not copyable.
+    CheckpointWriter(const CheckpointWriter &);
+    CheckpointWriter &operator=(const CheckpointWriter &);
+};
+};
+
+#endif
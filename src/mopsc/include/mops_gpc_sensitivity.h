@@ -156,6 +156,24 @@ public:
     // Return sensitivity problem type.
     SensitivityType ProblemType();
 
+    // Prepares the sensitivity RHS function for the given reactor and
+    // solution, if it was asked for ('rhs="analytic"' in the settings) and
+    // can be used, and returns true if so.  Otherwise CVODES must find
+    // the sensitivity RHS by difference quotients.
+    bool InitSensRHS(const Mops::Reactor &r, const double *const y);
+
+    // Returns true if InitSensRHS has prepared the sensitivity RHS.
+    bool UsesSensRHS() const;
+
+    // Calculates the RHS of the sensitivity equations for CVODES, dF/dy yS
+    // + dF/dp, with dF/dy from difference quotients of the RHS and dF/dp
+    // analytic for Arrhenius parameters of reactions whose rates of
+    // progress are proportional to their forward rate constants.  The
+    // columns are evaluated concurrently when OpenMP is enabled.
+    int SensRHS(double t, N_Vector y, N_Vector ydot,
+                N_Vector *yS, N_Vector *ySdot,
+                N_Vector tmp, void *solver);
+
 private:
 
     // Define problem type.
@@ -170,6 +188,11 @@ private:
     // Sensitivity method.
     int m_sensi_meth;
 
+    // True if the analytic sensitivity RHS is asked for, and whether it
+    // is in use.
+    bool m_analytic;
+    bool m_sensrhs;
+
     // Non-constant mechanism which will be used by rshFn_CVODES in
     // mops_rhs_func.cpp to access reaction set variables.
     // This can only be set via SetMechanism and where Mechanism
@@ -191,6 +214,22 @@ private:
     // SENSITIVITY TEMP RESULT
     N_Vector *m_sens_matrix;
 
+    // SENSITIVITY RHS WORKSPACE
+    // True for parameters with analytic derivatives.
+    std::vector<bool> m_proportional;
+    // Net stoichiometry of the reaction of each parameter, as sparse
+    // rows: species m_nuSp[m_nuStart[k]..m_nuStart[k+1]).
+    std::vector<unsigned int> m_nuStart, m_nuSp;
+    std::vector<double> m_nuMu;
+    // Jacobian J[j*neq+i] = dFi/dyj and derivatives with respect to the
+    // production rates D[k*neq+i] = dFi/dwdotk.
+    std::vector<double> m_jac, m_dfdw;
+    std::vector<double*> m_dfdwRows;
+    Sprog::Kinetics::RateWorkspace m_ratewk;
+
+    // Sets a single Arrhenius parameter of the mechanism.
+    void setMechParam(unsigned int i, double value);
+
     // Add parameters function. m_NS should not be touch anywhere in
     // the code except here.
     bool AddParam(const SENS_PARAM &arr);
@@ -0,0 +1,169 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    The ISAT class implements in situ adaptive tabulation of the
+    gas-phase reaction mapping solved by the ODE_Solver.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef MOPS_ISAT_H
+#define MOPS_ISAT_H
+
+#include "mops_params.h"
+#include <vector>
+
+namespace Mops
+{
+/*!
+ * In situ adaptive tabulation (S.B. Pope, Combust. Theory Modelling 1,
+ * 41-63, 1997) of a mapping f = R(x).  Each table entry stores a point
+ * x0, the mapping f0 = R(x0), its gradient A = dR/dx at x0 and an
+ * ellipsoid of accuracy (EOA) x^T M x <= 1 about x0, in which the
+ * linear approximation f0 + A (x - x0) is taken to be accurate to the
+ * tolerance.  The entries are the leaves of a binary tree of cutting
+ * planes, which is used to find the entry closest to a query.
+ *
+ * The table works in scaled variables; the caller is responsible for
+ * scaling x and f so that an absolute 2-norm error of the tolerance is
+ * acceptable.  The EOA of a new entry is the ball of radius tolerance,
+ * which is grown as direct evaluations show the approximation is still
+ * accurate further out.
+ */
+class ISAT
+{
+public:
+    // Constructors.
+    ISAT(void); // Default constructor (tabulation disabled).
+
+    // SETTINGS.
+
+    //! Turns tabulation on with the given error tolerance and table size.
+    void Enable(double tol, unsigned int maxentries);
+
+    //! Returns true if tabulation has been enabled.
+    bool IsEnabled(void) const {return m_enabled;}
+
+    //! Returns the error tolerance.
+    double Tolerance(void) const {return m_tol;}
+
+    //! Returns the maximum number of table entries.
+    unsigned int MaxEntries(void) const {return m_maxentries;}
+
+    //! Removes all entries and statistics, keeping the settings.
+    void Clear(void);
+
+    // TABLE OPERATIONS.
+
+    //! Returns the linear approximation of R(x) in f if x lies in an EOA.
+    bool Retrieve(const fvector &x, fvector &f);
+
+    //! Grows the EOA of the entry reached by the last Retrieve(x) to
+    //! include x, if R(x) = f is within tolerance of its approximation.
+    bool Grow(const fvector &x, const fvector &f);
+
+    //! Returns true if no more entries can be added.
+    bool IsFull(void) const {return m_entries.size() >= m_maxentries;}
+
+    //! Adds an entry with mapping f and gradient A (row-major, f.size()
+    //! rows by x.size() columns).
+    void Add(const fvector &x, const fvector &f, const fvector &A);
+
+    //! Records a query that was evaluated directly because the table is full.
+    void CountDirect(void) {++m_ndirect;}
+
+    // STATISTICS.
+
+    //! Returns the number of entries in the table.
+    unsigned int EntryCount(void) const {return m_entries.size();}
+
+    //! Sets the query counts to zero, keeping the entries.
+    void ResetCounts(void) {m_nretrieve = m_ngrow = m_nadd = m_ndirect = 0;}
+
+    //! Number of queries answered from the table.
+    unsigned long Retrieves(void) const {return m_nretrieve;}
+
+    //! Number of queries which grew an EOA.
+    unsigned long Grows(void) const {return m_ngrow;}
+
+    //! Number of queries which added an entry.
+    unsigned long Adds(void) const {return m_nadd;}
+
+    //! Number of queries evaluated directly with the table full.
+    unsigned long Directs(void) const {return m_ndirect;}
+
+private:
+    //! A tabulated point.
+    struct Entry {
+        fvector x0; // Tabulation point.
+        fvector f0; // Mapping at x0.
+        fvector A;  // Mapping gradient, row-major.
+        fvector M;  // EOA matrix, row-major and symmetric.
+    };
+
+    //! Node of the binary tree; a leaf if entry >= 0.
+    struct Node {
+        int entry;    // Index of the entry at a leaf, otherwise -1.
+        fvector v;    // Normal of the cutting plane.
+        double a;     // Offset of the cutting plane.
+        int left;     // Child for v.x <= a.
+        int right;    // Child for v.x > a.
+    };
+
+    // Settings.
+    bool m_enabled;
+    double m_tol;
+    unsigned int m_maxentries;
+
+    // Table and search tree; node 0 is the root.
+    std::vector<Entry> m_entries;
+    std::vector<Node> m_nodes;
+
+    // Leaf reached by the last call to Retrieve().
+    int m_leaf;
+
+    // Statistics.
+    unsigned long m_nretrieve, m_ngrow, m_nadd, m_ndirect;
+
+    //! Returns the leaf node reached by traversing the tree with x.
+    int findLeaf(const fvector &x) const;
+
+    //! Returns dx^T M dx with dx = x - x0, and fills dx.
+    double eoaNorm(const Entry &e, const fvector &x, fvector &dx) const;
+
+    //! Returns the linear approximation about entry e in f.
+    void approximate(const Entry &e, const fvector &dx, fvector &f) const;
+};
+};
+
+#endif
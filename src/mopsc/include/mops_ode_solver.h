@@ -47,6 +47,7 @@
 #include "mops_src_terms.h"
 #include "mops_reactor.h"
 #include "mops_gpc_sensitivity.h"
+#include "mops_isat.h"
 
 // CVODE includes.
 #include <sundials/sundials_dense.h>
@@ -126,6 +127,18 @@ public:
     void SetRTOL(double rtol);
 
 
+    // TABULATION.
+
+    //! Tabulates the reactor solutions with ISAT to the given tolerance.
+    void EnableISAT(double tol, unsigned int maxentries);
+
+    //! Returns the ISAT table, for its statistics.
+    const ISAT &GetISAT(void) const {return m_isat;}
+
+    //! Starts the ISAT query counts again, e.g. for a new run.
+    void ResetISATCounts(void) {m_isat.ResetCounts();}
+
+
     // EXTERNAL SOURCE TERMS.
 
     // Returns the vector of external source terms.
@@ -214,6 +227,11 @@ protected:
     // Space required by rate parameter sensitivity.
     N_Vector *m_yS;
 
+    // In situ adaptive tabulation of the reactor solution.
+    ISAT m_isat;
+    fvector m_isatScale; // Scales of the state variables and time step.
+    const Mops::Mechanism *m_isatMech; // Mechanism of the tabulated solutions.
+
 private:
     // CVODE variables.
     void *m_odewk;     // CVODE workspace.
@@ -232,6 +250,16 @@ private:
     // Initialises the CVode ODE solver assuming that the
     // remainder of the the solver has been correctly set up.
     void InitCVode(void);
+
+    // Integrates the reactor from m_time up to the stop time.
+    void integrate(Reactor &reac, double stop_time);
+
+    // Solves the reactor up to the stop time using the ISAT table.
+    void solveISAT(Reactor &reac, double stop_time);
+
+    // Integrates the reactor from the unscaled state y over the
+    // time step dt, leaving the scaled result in f.
+    void integrateFrom(Reactor &reac, const fvector &y, double dt, fvector &f);
     
 };
 };
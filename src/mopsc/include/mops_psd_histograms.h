@@ -0,0 +1,151 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    The PSDHistograms class accumulates binned particle size
+    distributions while a simulation runs, so that they can be output
+    without replaying the save points.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef MOPS_PSD_HISTOGRAMS_H
+#define MOPS_PSD_HISTOGRAMS_H
+
+#include "mops_params.h"
+#include "mops_mixture.h"
+#include "mops_timeinterval.h"
+#include "swp_mechanism.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Mops
+{
+/*!
+ * Histograms of particle properties at the end of every time interval,
+ * accumulated over all runs.
+ *
+ * A histogram bins one of the PSL variables of the particle model
+ * (EnsembleStats::PSL_Names), named without its unit, for example
+ * "Collision Diameter", or the ratio of two PSL variables, such as
+ * "Number of Carbon atoms" over "Number of Hydrogen atoms".  Each particle
+ * adds its statistical weight divided by the sample volume, so that the
+ * bins hold number densities (m-3).  The bins are equally spaced on a
+ * linear or logarithmic scale between the bounds; particles outside the
+ * bounds are counted in an underflow and an overflow bin.
+ *
+ * The sum and sum of squares of every bin over the runs is kept, from
+ * which the average and its confidence interval are written in the same
+ * way as the other simulation outputs.
+ */
+class PSDHistograms
+{
+public:
+    //! Definition of one histogram.
+    struct Histogram {
+        std::string Name;     // Name used in the output file name.
+        std::string Property; // PSL variable to bin.
+        std::string Ratio;    // PSL variable to divide by, if not empty.
+        unsigned int Bins;    // Number of bins between the bounds.
+        double Lower, Upper;  // Bounds of the binned range.
+        bool LogScale;        // Bins equally spaced in log(value)?
+    };
+
+    // Constructors.
+    PSDHistograms(void); // Default constructor (no histograms).
+
+    // SETTINGS.
+
+    //! Adds a histogram.
+    void AddHistogram(const Histogram &h);
+
+    //! Returns true if no histograms have been defined.
+    bool IsEmpty(void) const {return m_hists.empty();}
+
+    //! Number of histograms.
+    unsigned int Count(void) const {return m_hists.size();}
+
+    // ACCUMULATION.
+
+    //! Finds the PSL variables of the histograms and clears the sums for
+    //! npoints save points.
+    void Initialise(const Sweep::Mechanism &mech, unsigned int npoints);
+
+    //! Adds the distribution in the mixture at save point i of one run.
+    void Accumulate(unsigned int i, const Mixture &mix,
+                    const Sweep::Mechanism &mech, double time);
+
+#ifdef USE_MPI
+    //! Sums the accumulated values of all processes on process root.
+    void ReduceRuns(int root);
+#endif
+
+    //! Writes the accumulated sums to a binary stream.
+    void Serialize(std::ostream &out) const;
+
+    //! Reads sums written by Serialize, after Initialise.
+    void Deserialize(std::istream &in);
+
+    // OUTPUT.
+
+    //! Writes one CSV file per histogram, named prefix-psd-name.csv,
+    //! with a row for every bin and an average and confidence interval
+    //! over nruns runs for every save point.
+    void Write(const std::string &prefix, const timevector &times,
+               unsigned int nruns) const;
+
+private:
+    // Histogram definitions.
+    std::vector<Histogram> m_hists;
+
+    // PSL indices of the property and ratio of each histogram (-1 for
+    // no ratio) and the units of the property.
+    std::vector<int> m_prop, m_ratio;
+    std::vector<std::string> m_units;
+
+    // Number of save points.
+    unsigned int m_npoints;
+
+    // Sum and sum of squares over the runs, for each histogram stored as
+    // [point][bin] with the underflow bin first and the overflow bin last.
+    std::vector<fvector> m_sum, m_sumsq;
+
+    //! Returns the bin of value x in histogram h, counting the underflow.
+    unsigned int bin(const Histogram &h, double x) const;
+
+    //! Returns the lower bound of bin b (1 to Bins) of histogram h.
+    double binEdge(const Histogram &h, unsigned int b) const;
+};
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Binary columnar particle size list (PSL) files, written by the
+    Simulator when post-processing the save points and read back
+    through a memory map.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef MOPS_PSL_FILE_H
+#define MOPS_PSL_FILE_H
+
+#include "mops_params.h"
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace Mops
+{
+/*!
+ * Layout of the binary PSL files.  All values are native endian and every
+ * block starts at a multiple of 8 bytes, so that the columns can be used
+ * in place from a memory map.
+ *
+ * \verbatim
+   char     magic[8]              "MOPSPSL" followed by a null byte
+   uint32   version               currently 1
+   uint32   nCols                 number of columns
+   per column:
+     uint32 nameLength, char name[nameLength]
+     uint32 unitLength, char unit[unitLength]
+   padding to a multiple of 8 bytes
+   chunks, until the end of the file:
+     uint32 nRows                 number of particles in the chunk
+     uint32 flags                 1 if the chunk is compressed
+     uint8  encoding[nCols]       0: nRows values, 1: one value for all rows
+     padding to a multiple of 8 bytes
+     double column data, in column order
+   \endverbatim
+ *
+ * The columns are the EnsembleStats::PSL_Names entries.  A name of the
+ * form "Diameter (m)" is stored as the name "Diameter" and the unit "m".
+ * Compression only replaces columns which hold the same value in every
+ * row of a chunk, such as unused components, by that single value.
+ */
+class PSLFile
+{
+public:
+    //! Version of the file layout.
+    static const unsigned int formatVersion = 1;
+
+    //! Column encodings.
+    enum Encoding {Full = 0, Constant = 1};
+
+    //! Splits a PSL column heading into a name and a unit.
+    static void SplitHeading(const std::string &heading,
+                             std::string &name, std::string &unit);
+
+    //! Joins a name and unit into a PSL column heading.
+    static std::string JoinHeading(const std::string &name,
+                                   const std::string &unit);
+};
+
+/*!
+ * Writes a binary PSL file one particle at a time.  The rows are buffered
+ * by column and written out in chunks of a fixed number of rows.
+ */
+class PSLFileWriter
+{
+public:
+    //! Opens the file and writes the header for the given column headings.
+    PSLFileWriter(
+        const std::string &filename,
+        const std::vector<std::string> &headings,
+        unsigned int chunkrows = 65536,
+        bool compress = true
+        );
+
+    //! Closes the file if it is still open.
+    ~PSLFileWriter(void);
+
+    //! Adds the PSL entry of one particle.
+    void Write(const fvector &row);
+
+    //! Writes any buffered rows and closes the file.
+    void Close(void);
+
+    //! Number of rows written so far.
+    unsigned long RowCount(void) const {return m_nrows;}
+
+private:
+    std::ofstream m_file;
+    unsigned int m_ncols;
+    unsigned int m_chunkrows;
+    bool m_compress;
+
+    // Rows not yet written, stored as m_buffer[col * m_chunkrows + row].
+    fvector m_buffer;
+    unsigned int m_nbuffered;
+    unsigned long m_nrows;
+
+    //! Writes the buffered rows as one chunk.
+    void writeChunk(void);
+
+    //! Writes zero bytes up to the next multiple of 8 bytes.
+    void pad(std::streamoff length);
+
+    // Writer objects hold an open file and cannot be copied.
+    PSLFileWriter(const PSLFileWriter &);
+    PSLFileWriter &operator=(const PSLFileWriter &);
+};
+
+/*!
+ * Read access to a binary PSL file through a memory map.  The columns of
+ * each chunk are returned as pointers into the map, so they are only valid
+ * as long as the reader exists.
+ */
+class PSLFileReader
+{
+public:
+    //! Maps the file and indexes its chunks.
+    explicit PSLFileReader(const std::string &filename);
+
+    //! Unmaps the file.
+    ~PSLFileReader(void);
+
+    //! Number of columns.
+    unsigned int ColumnCount(void) const {return m_names.size();}
+
+    //! Name of column i, without its unit.
+    const std::string &Name(unsigned int i) const {return m_names.at(i);}
+
+    //! Unit of column i, empty if it has none.
+    const std::string &Unit(unsigned int i) const {return m_units.at(i);}
+
+    //! Column headings in the EnsembleStats::PSL_Names form.
+    void Headings(std::vector<std::string> &headings) const;
+
+    //! Number of chunks.
+    unsigned int ChunkCount(void) const {return m_chunks.size();}
+
+    //! Number of rows in chunk k.
+    unsigned int ChunkRows(unsigned int k) const {return m_chunks.at(k).nrows;}
+
+    //! Total number of rows.
+    unsigned long RowCount(void) const {return m_nrows;}
+
+    //! Returns true if column i of chunk k is stored as a single value.
+    bool IsConstant(unsigned int k, unsigned int i) const;
+
+    //! Data of column i in chunk k; ChunkRows(k) values, or one value if
+    //! the column is constant.
+    const double *Column(unsigned int k, unsigned int i) const;
+
+    //! Value of column i for row j of chunk k.
+    double Value(unsigned int k, unsigned int i, unsigned int j) const;
+
+    //! Fills row with the PSL entry of row j of chunk k.
+    void ReadRow(unsigned int k, unsigned int j, fvector &row) const;
+
+private:
+    //! Location of a chunk in the map.
+    struct Chunk {
+        unsigned int nrows;
+        const unsigned char *encoding;
+        std::vector<const double*> columns;
+    };
+
+    std::vector<std::string> m_names;
+    std::vector<std::string> m_units;
+    std::vector<Chunk> m_chunks;
+    unsigned long m_nrows;
+
+    // The mapped file.
+    const unsigned char *m_data;
+    size_t m_size;
+#ifdef _WIN32
+    std::vector<unsigned char> m_contents;
+#endif
+
+    //! Reads the header and indexes the chunks.
+    void index(const std::string &filename);
+
+    //! Releases the map.
+    void unmap(void);
+
+    // Reader objects hold a map and cannot be copied.
+    PSLFileReader(const PSLFileReader &);
+    PSLFileReader &operator=(const PSLFileReader &);
+};
+};
+
+#endif
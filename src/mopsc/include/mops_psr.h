@@ -157,6 +157,12 @@ public:
     // Identifies the reactor type for serialisation.
     Serial_ReactorType SerialType() const;
 
+
+    // GOVERNING EQUATIONS.
+
+    //! Inflows from other reactors change between steps.
+    bool IsAutonomous() const;
+
 protected:
     // Reactors should not be defined without knowledge of a Mechanism
     // object.  Therefore the default constructor is declared as protected.
@@ -179,6 +185,12 @@ protected:
         double *ydot           // Derivatives to return.
         ) const;
 
+    //! Derivatives of the RHS with respect to the molar production rates
+    bool RHS_ProdRateDerivs(
+        const double *const y, // Solution values.
+        double **D             // Derivatives D[k][i] = dFi/dwdotk.
+        ) const;
+
 private:
 
     //! Initialise the birth process of the specific inflow
@@ -218,6 +218,11 @@ public:
     // and density.
     virtual unsigned int ODE_Count() const;
 
+    // Returns true if the RHS depends only on the solution values, so
+    // that the solution over a step depends only on the initial values
+    // and the step length.
+    virtual bool IsAutonomous() const;
+
     // Definition of RHS function for constant temperature energy model.
     virtual void RHS_ConstT(
         double t,              // Flow time.
@@ -240,6 +245,18 @@ public:
         double **J,               // Jacobian Matrix J[j][i] = dFi/dYj.
         double uround             // Perturbation size parameter.
         ) const;    
+
+    //! Calculates the derivatives of the RHS with respect to the molar
+    //! production rate of each gas-phase species, with the solution held
+    //! fixed: D[k][i] = dFi/dwdotk, for ODE_Count() values of i.  Returns
+    //! false, leaving D untouched, if the RHS is not linear in the
+    //! production rates (an imposed temperature gradient or surface
+    //! chemistry), so that derivatives through them must be found by
+    //! finite differences.
+    virtual bool RHS_ProdRateDerivs(
+        const double *const y,    // Solution values.
+        double **D                // Derivatives D[k][i] = dFi/dwdotk.
+        ) const;
     
     //! Calculates Jacobian domegai/dcj instead of d/dxj[dxi/dt], as is done above.
     void RateJacobian(
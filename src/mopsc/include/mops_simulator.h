@@ -53,6 +53,9 @@
 #include "mops_timeinterval.h"
 #include "mops_solver.h"
 #include "mops_mechanism.h"
+#include "mops_psd_histograms.h"
+#include "mops_checkpoint.h"
+#include "mops_async_output.h"
 #include "console_io.h"
 #include <string>
 #include <vector>
@@ -173,6 +176,34 @@ public:
 	//! Set simulator to write the PAHs to psl files.
 	void SetWritePP(bool postpocessPP);
 
+    //! Choose the PSL output formats: CSV text and/or binary columnar
+    //! files (see mops_psl_file.h).
+    void SetPSLFormat(bool csv, bool binary);
+
+    //! Set simulator to write the save points used by the PSL
+    //! post-processing.  Default true.
+    void SetWriteSavePoints(bool writesavepoints);
+
+    //! Histograms accumulated during the simulation.
+    PSDHistograms &Histograms(void) {return m_psd;}
+
+    //! Write a checkpoint at the end of a time interval once interval
+    //! seconds of wall-clock time have passed since the last one, and
+    //! stop at the first checkpoint after walltime seconds, unless
+    //! walltime is negative.  A negative interval disables checkpoints.
+    void SetCheckpoint(double interval, double walltime);
+
+    //! Set the simulator to continue from its checkpoint file.
+    void SetRestart(bool restart);
+
+    //! Did RunSimulation complete all the runs, rather than stop at the
+    //! wall-clock limit?
+    bool Finished(void) const {return m_finished;}
+
+    //! Number of particle jumps, including fictitious ones, in the runs
+    //! of the last RunSimulation call.
+    unsigned long long JumpCount(void) const {return m_jumps;}
+
     // options for Postprocess (only for PAH-PP model)
     //! return the option whehter generate mass spectra
     const bool MassSpectra() const;
@@ -208,6 +239,10 @@ public:
     // Set number of particle trackings.
     void SetParticleTrackCount(unsigned int ptcount);
 
+    //! Should the images of the tracked particles be written to one
+    //! file per time rather than one file per particle?
+    void SetParticleTrackCombined(bool combined);
+
 	// PARTICLE TRACKING FOR VIDEOS  (alternative to POVRAY)
 
 	//! Set number of track particles 
@@ -292,8 +327,9 @@ private:
     // Name of output file.
     std::string m_output_filename;
 
-    // Simulation output file stream.
-    mutable std::fstream m_file;
+    // Simulation output file, written in a background thread.
+    mutable AsyncOutputBuffer m_filebuf;
+    mutable std::ostream m_file;
 
     // Sensitivity output file stream.
     mutable std::fstream m_senfile;
@@ -328,6 +364,19 @@ private:
     //! Should the ensemble be written to a reusable binary file?
     bool m_write_ensemble_file;
 
+    //! Should the PSLs be written as CSV files?  Default true.
+    bool m_write_psl_csv;
+
+    //! Should the PSLs be written as binary columnar files?  Default false.
+    bool m_write_psl_binary;
+
+    //! Should save points be written at the end of each time interval?
+    bool m_write_save_points;
+
+    //! Particle size distributions accumulated in-situ at the end of
+    //! each time interval.
+    PSDHistograms m_psd;
+
     //! Flag controlling whether post-process the detailed info about every PAH in the particle ensemble. Default false.
     bool m_write_PAH;
 
@@ -347,6 +396,24 @@ private:
     //! Flag controlling whether considering xmer in the large soot aggregate
     bool m_mass_spectra_frag;
 
+    // CHECKPOINTS.
+
+    //! Wall-clock seconds between checkpoints (negative for none).
+    double m_checkpoint_interval;
+
+    //! Wall-clock seconds after which to stop at a checkpoint (negative
+    //! for no limit).
+    double m_walltime;
+
+    //! Continue from the checkpoint file?
+    bool m_restart;
+
+    //! Were all runs completed?
+    bool m_finished;
+
+    //! Particle jumps of the completed runs.
+    unsigned long long m_jumps;
+
     // STATISTICAL OUTPUT PARAMETERS
 
     Sweep::Stats::IModelStats::StatBound m_statbound;
@@ -360,6 +427,10 @@ private:
     // TEM-style images will also be generated.
     unsigned int m_ptrack_count;
 
+    //! Should the TEM-style images of the tracked particles be built
+    //! concurrently and written to one file per time?  Default false.
+    bool m_ptrack_combined;
+
     // FLUX ANALYSIS ELEMENT LIST.
 
     // A vector list containing pointers to elements which are wanted to analyse the flux of
@@ -381,8 +452,9 @@ private:
 
     // FILE OUTPUT.
 
-    // Opens an output file for the given run number.
-    void openOutputFile() const;
+    // Opens an output file for the given run number.  If append is
+    // true, existing files are extended instead of replaced.
+    void openOutputFile(bool append=false) const;
 
     // Closes the output file.
     void closeOutputFile() const;
@@ -681,6 +753,13 @@ private:
         std::vector<std::vector<fvector> > &track // Vector of tracking data of multiple particles at multiple time points.
         );
 
+    //! Writes the sweep timers and the jump counts of each rate term
+    //! since the start of a run to a CSV file.
+    void writeProfileCSV(
+        const Sweep::Mechanism &mech, // Mechanism defining particle processes.
+        unsigned int run              // Run number.
+        ) const;
+
 
     // SAVE POINTS AND PSL POST-PROCESSING.
 
@@ -699,6 +778,24 @@ private:
         unsigned int run   // Run number.
         ) const;
 
+    //! Name of the checkpoint file.
+    std::string checkpointFile(void) const;
+
+    //! Copies the state of a run into a checkpoint, flushing the
+    //! output files to record their sizes.
+    void fillCheckpoint(
+        const Reactor &r,             // Reactor being solved.
+        const Sweep::rng_type &rng,   // Random number generator of the run.
+        Checkpoint &chk               // Checkpoint to fill.
+        ) const;
+
+    //! Restores a run from a checkpoint.
+    void restoreCheckpoint(
+        const Checkpoint &chk,        // Checkpoint to restore.
+        Reactor &r,                   // Reactor being solved.
+        Sweep::rng_type &rng          // Random number generator of the run.
+        );
+
 
     // Reads a save point file.
     Reactor *const readSavePoint(
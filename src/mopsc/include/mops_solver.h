@@ -113,6 +113,10 @@ public:
     // calculations.
     void SetRTOL(double rtol);
 
+    // Tabulates the gas-phase solutions with ISAT to the given
+    // tolerance, using at most maxentries table entries.
+    void SetISAT(double tol, unsigned int maxentries);
+
     // LOI STATUS FOR ODE SOLVER.
 
     //! Enables LOI status to true.
@@ -70,7 +70,7 @@ public:
 
     // PROFILE INPUT.
 
-    // Reads a flame gas-phase profile from a TAB formatted file.
+    // Reads a flame gas-phase profile from a TAB formatted or binary file.
     void LoadGasProfile(
         const std::string &file, // File name.
         Mops::Mechanism &mech    // Mechanism will be update with species.
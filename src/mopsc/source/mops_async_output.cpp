@@ -0,0 +1,224 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the AsyncOutputBuffer class declared in the
+    mops_async_output.h header file.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "mops_async_output.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Mops;
+using namespace std;
+
+// CONSTRUCTORS AND DESTRUCTORS.
+
+// Default constructor.
+AsyncOutputBuffer::AsyncOutputBuffer(std::size_t size)
+: m_front(max(size, (std::size_t)1)), m_back(max(size, (std::size_t)1)),
+  m_backsize(0), m_pending(false), m_stop(false), m_open(false)
+{
+    setp(0, 0);
+}
+
+// Destructor.
+AsyncOutputBuffer::~AsyncOutputBuffer(void)
+{
+    try {
+        Close();
+    } catch (std::exception &) {
+        // The file is closed anyway; there is nobody to tell.
+    }
+}
+
+
+// FILE HANDLING.
+
+bool AsyncOutputBuffer::Open(const std::string &filename, bool append)
+{
+    Close();
+
+    const ios_base::openmode mode = append ?
+        (ios_base::out | ios_base::app | ios_base::binary) :
+        (ios_base::out | ios_base::trunc | ios_base::binary);
+    m_out.clear();
+    m_out.open(filename.c_str(), mode);
+    if (!m_out.good()) return false;
+
+    m_filename = filename;
+    m_error.clear();
+    m_pending = false;
+    m_stop = false;
+    m_open = true;
+    setp(&m_front[0], &m_front[0] + m_front.size());
+    m_thread = boost::thread(&AsyncOutputBuffer::run, this);
+    return true;
+}
+
+void AsyncOutputBuffer::Flush(void)
+{
+    if (m_open) handOff();
+}
+
+void AsyncOutputBuffer::Close(void)
+{
+    if (!m_open) return;
+
+    handOff();
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+
+    m_out.close();
+    if (m_out.fail() && m_error.empty()) {
+        m_error = "Failed to close " + m_filename +
+                  " (Mops, AsyncOutputBuffer::Close).";
+    }
+    m_open = false;
+    setp(0, 0);
+
+    if (!m_error.empty()) {
+        const string msg = m_error;
+        m_error.clear();
+        throw runtime_error(msg);
+    }
+}
+
+
+// STREAM BUFFER INTERFACE.
+
+AsyncOutputBuffer::int_type AsyncOutputBuffer::overflow(int_type c)
+{
+    if (!m_open || !handOff()) return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize AsyncOutputBuffer::xsputn(const char *s, std::streamsize n)
+{
+    if (!m_open) return 0;
+
+    std::streamsize done = 0;
+    while (done < n) {
+        if (pptr() == epptr() && !handOff()) break;
+        const std::streamsize chunk = min(n - done, (std::streamsize)(epptr() - pptr()));
+        memcpy(pptr(), s + done, chunk);
+        pbump((int)chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+int AsyncOutputBuffer::sync(void)
+{
+    if (!m_open) return 0;
+    if (!handOff() || !wait()) return -1;
+
+    // The thread is idle until the next hand-off.
+    m_out.flush();
+    if (!m_out.good()) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_error.empty()) {
+            m_error = "Failed to write " + m_filename +
+                      " (Mops, AsyncOutputBuffer::sync).";
+        }
+        return -1;
+    }
+    return 0;
+}
+
+
+// BACKGROUND WRITING.
+
+bool AsyncOutputBuffer::handOff(void)
+{
+    const std::size_t n = pptr() - pbase();
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_pending) {
+        m_cond.wait(lock);
+    }
+    if (!m_error.empty()) return false;
+    if (n == 0) return true;
+
+    m_front.swap(m_back);
+    m_backsize = n;
+    m_pending = true;
+    setp(&m_front[0], &m_front[0] + m_front.size());
+    lock.unlock();
+    m_cond.notify_all();
+    return true;
+}
+
+bool AsyncOutputBuffer::wait(void)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_pending) {
+        m_cond.wait(lock);
+    }
+    return m_error.empty();
+}
+
+void AsyncOutputBuffer::run(void)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true) {
+        while (!m_pending && !m_stop) {
+            m_cond.wait(lock);
+        }
+        if (!m_pending) break;
+
+        // The back buffer belongs to this thread until m_pending is reset.
+        const std::size_t n = m_backsize;
+        lock.unlock();
+        m_out.write(&m_back[0], n);
+        const bool ok = m_out.good();
+        lock.lock();
+
+        if (!ok && m_error.empty()) {
+            m_error = "Failed to write " + m_filename +
+                      " (Mops, AsyncOutputBuffer::run).";
+        }
+        m_pending = false;
+        m_cond.notify_all();
+    }
+}
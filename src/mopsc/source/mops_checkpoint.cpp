@@ -0,0 +1,285 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the Checkpoint and CheckpointWriter classes declared
+    in the mops_checkpoint.h header file.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "mops_checkpoint.h"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <stdexcept>
+
+using namespace Mops;
+using namespace std;
+
+namespace
+{
+    void writeString(std::ostream &out, const std::string &s)
+    {
+        const boost::uint64_t n = s.size();
+        out.write((const char*)&n, sizeof(n));
+        out.write(s.data(), n);
+    }
+
+    void readString(std::istream &in, std::string &s)
+    {
+        boost::uint64_t n = 0;
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        s.resize(n);
+        if (n > 0) in.read(&s[0], n);
+    }
+
+    void writeCounts(std::ostream &out, const std::vector<unsigned int> &v)
+    {
+        const unsigned int n = v.size();
+        out.write((const char*)&n, sizeof(n));
+        if (n > 0) out.write((const char*)&v[0], n * sizeof(v[0]));
+    }
+
+    void readCounts(std::istream &in, std::vector<unsigned int> &v)
+    {
+        unsigned int n = 0;
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        v.resize(n);
+        if (n > 0) in.read(reinterpret_cast<char*>(&v[0]), n * sizeof(v[0]));
+    }
+}
+
+// CHECKPOINT.
+
+// Default constructor.
+Checkpoint::Checkpoint(void)
+: Run(0), Interval(0), Step(0), Console(0), Time(0.0), Runtime(0.0)
+{
+}
+
+void Checkpoint::Serialize(std::ostream &out) const
+{
+    if (out.good()) {
+        // Output the version ID (=0 at the moment).
+        const unsigned int version = 0;
+        out.write((char*)&version, sizeof(version));
+
+        out.write((char*)&Run, sizeof(Run));
+        out.write((char*)&Interval, sizeof(Interval));
+        out.write((char*)&Step, sizeof(Step));
+        out.write((char*)&Console, sizeof(Console));
+        out.write((char*)&Time, sizeof(Time));
+        out.write((char*)&Runtime, sizeof(Runtime));
+
+        writeString(out, RNG);
+        writeString(out, Mixture);
+        writeString(out, Histograms);
+        writeCounts(out, ProcessJumps);
+        writeCounts(out, FictitiousJumps);
+
+        const unsigned int n = Files.size();
+        out.write((char*)&n, sizeof(n));
+        for (unsigned int i=0; i!=n; ++i) {
+            writeString(out, Files[i].first);
+            out.write((char*)&Files[i].second, sizeof(Files[i].second));
+        }
+    } else {
+        throw invalid_argument("Output stream not ready "
+                               "(Mops, Checkpoint::Serialize).");
+    }
+}
+
+void Checkpoint::Deserialize(std::istream &in)
+{
+    if (in.good()) {
+        unsigned int version = 0;
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (version != 0) {
+            throw runtime_error("Checkpoint version number is invalid "
+                                "(Mops, Checkpoint::Deserialize).");
+        }
+
+        in.read(reinterpret_cast<char*>(&Run), sizeof(Run));
+        in.read(reinterpret_cast<char*>(&Interval), sizeof(Interval));
+        in.read(reinterpret_cast<char*>(&Step), sizeof(Step));
+        in.read(reinterpret_cast<char*>(&Console), sizeof(Console));
+        in.read(reinterpret_cast<char*>(&Time), sizeof(Time));
+        in.read(reinterpret_cast<char*>(&Runtime), sizeof(Runtime));
+
+        readString(in, RNG);
+        readString(in, Mixture);
+        readString(in, Histograms);
+        readCounts(in, ProcessJumps);
+        readCounts(in, FictitiousJumps);
+
+        unsigned int n = 0;
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        Files.resize(n);
+        for (unsigned int i=0; i!=n; ++i) {
+            readString(in, Files[i].first);
+            in.read(reinterpret_cast<char*>(&Files[i].second), sizeof(Files[i].second));
+        }
+
+        if (!in.good()) {
+            throw runtime_error("Checkpoint is incomplete "
+                                "(Mops, Checkpoint::Deserialize).");
+        }
+    } else {
+        throw invalid_argument("Input stream not ready "
+                               "(Mops, Checkpoint::Deserialize).");
+    }
+}
+
+void Checkpoint::Read(const std::string &filename)
+{
+    ifstream fin(filename.c_str(), ios_base::in | ios_base::binary);
+    if (!fin.good()) {
+        throw runtime_error("Failed to open checkpoint file " + filename +
+                            " (Mops, Checkpoint::Read).");
+    }
+    Deserialize(fin);
+}
+
+void Checkpoint::AddFile(const std::string &filename)
+{
+    boost::uint64_t size = 0;
+    if (boost::filesystem::exists(filename)) {
+        size = boost::filesystem::file_size(filename);
+    }
+    Files.push_back(FileSize(filename, size));
+}
+
+void Checkpoint::TruncateFiles(void) const
+{
+    for (unsigned int i=0; i!=Files.size(); ++i) {
+        if (boost::filesystem::file_size(Files[i].first) < Files[i].second) {
+            throw runtime_error("Output file " + Files[i].first + " is shorter "
+                                "than at the checkpoint (Mops, Checkpoint::TruncateFiles).");
+        }
+        boost::filesystem::resize_file(Files[i].first, Files[i].second);
+    }
+}
+
+
+// CHECKPOINT WRITER.
+
+// Default constructor.
+CheckpointWriter::CheckpointWriter(void)
+: m_queued(false), m_busy(false), m_stop(false)
+{
+}
+
+// Destructor.
+CheckpointWriter::~CheckpointWriter(void)
+{
+    if (m_thread.joinable()) {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        m_thread.join();
+    }
+}
+
+void CheckpointWriter::Write(const std::string &filename, std::string &data)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_filename = filename;
+        m_data.swap(data);
+        m_queued = true;
+    }
+    data.clear();
+
+    if (!m_thread.joinable()) {
+        m_thread = boost::thread(&CheckpointWriter::run, this);
+    }
+    m_cond.notify_all();
+}
+
+void CheckpointWriter::Wait(void)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_queued || m_busy) {
+        m_cond.wait(lock);
+    }
+    if (!m_error.empty()) {
+        const string msg = m_error;
+        m_error.clear();
+        throw runtime_error(msg);
+    }
+}
+
+void CheckpointWriter::run(void)
+{
+    string filename, data;
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true) {
+        while (!m_queued && !m_stop) {
+            m_cond.wait(lock);
+        }
+        if (!m_queued) break;
+
+        filename.swap(m_filename);
+        data.swap(m_data);
+        m_queued = false;
+        m_busy = true;
+        lock.unlock();
+
+        // Write to a temporary file, then replace the old checkpoint.
+        string error;
+        const string tmpname = filename + ".tmp";
+        {
+            ofstream fout(tmpname.c_str(), ios_base::out | ios_base::trunc | ios_base::binary);
+            fout.write(data.data(), data.size());
+            fout.close();
+            if (fout.fail()) {
+                error = "Failed to write checkpoint file " + tmpname +
+                        " (Mops, CheckpointWriter::run).";
+            }
+        }
+        if (error.empty()) {
+            boost::system::error_code ec;
+            boost::filesystem::rename(tmpname, filename, ec);
+            if (ec) {
+                error = "Failed to rename " + tmpname + " to " + filename +
+                        " (Mops, CheckpointWriter::run).";
+            }
+        }
+
+        lock.lock();
+        m_busy = false;
+        if (!error.empty()) m_error = error;
+        m_cond.notify_all();
+    }
+}
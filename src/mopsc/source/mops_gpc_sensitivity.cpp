@@ -41,11 +41,14 @@
 */
 #include "mops_gpc_sensitivity.h"
 #include "mops_simulator.h"
+#include "mops_ode_solver.h"
+#include "mops_rhs_func.h"
 
 #include "camxml.h"
 #include "string_functions.h"
 
 #include <stdexcept>
+#include <algorithm>
 #include <math.h>
 
 using namespace Mops;
@@ -83,6 +86,8 @@ SensitivityAnalyzer &SensitivityAnalyzer::operator=(const SensitivityAnalyzer &r
         m_enable     = rhs.m_enable;
         m_err_con    = rhs.m_err_con;
         m_sensi_meth = rhs.m_sensi_meth;
+        m_analytic   = rhs.m_analytic;
+        m_sensrhs    = false;
         m_mech       = rhs.m_mech;
         m_reactor    = rhs.m_reactor;
         // Copy pointer array
@@ -122,6 +127,8 @@ void SensitivityAnalyzer::Clear()
     m_enable        = false;
     m_err_con       = FALSE;
     m_sensi_meth    = CV_SIMULTANEOUS;
+    m_analytic      = false;
+    m_sensrhs       = false;
     m_mech          = NULL;
     m_reactor       = NULL;
     m_NS            = 0;
@@ -220,6 +227,9 @@ void SensitivityAnalyzer::ReadSettingV1(const CamXML::Element &elemSA)
             } else {
                 m_sensi_meth = CV_SIMULTANEOUS;
             }
+            // The sensitivity RHS is found by difference quotients in
+            // CVODES unless the analytic one is asked for.
+            m_analytic = (sensiElem->GetAttributeValue("rhs").compare("analytic") == 0);
         }
         // Read Error Control.
         // Default value is TRUE.
@@ -316,7 +326,7 @@ void SensitivityAnalyzer::ReadSettingV1(const CamXML::Element &elemSA)
                 unsigned int nend = (allE) ? nrxn : EParams.size();
                 for (unsigned int i = 0; i < nend; i++) {
                     int rxn_index = (allE) ? (i) : ((int)Strings::cdble(EParams.at(i)->GetAttributeValue("rxnth")));
-                    SENS_PARAM arrp(rxn_index, ARR_n);
+                    SENS_PARAM arrp(rxn_index, ARR_E);
                     AddParam(arrp);
                 }
             }
@@ -426,8 +436,9 @@ void SensitivityAnalyzer::ChangeMechParams()
                 default :
                     break;
             }
-            m_mech->GasMech().GetReactions(i)->SetArrhenius(arr);
+            m_mech->GasMech().GetReactions(m_sens_params.at(i).Index)->SetArrhenius(arr);
         }
+        m_mech->GasMech().CompileRateParams();
     } else if (m_probType == Init_Conditions) {
         unsigned int i_temp = m_reactor->Mixture()->GasPhase().temperatureIndex();
         unsigned int i_dens = m_reactor->Mixture()->GasPhase().densityIndex();
@@ -466,8 +477,9 @@ void SensitivityAnalyzer::ResetMechParams()
                 default :
                     break;
             }
-            m_mech->GasMech().GetReactions(i)->SetArrhenius(arr);
+            m_mech->GasMech().GetReactions(m_sens_params.at(i).Index)->SetArrhenius(arr);
         }
+        m_mech->GasMech().CompileRateParams();
     } else if (m_probType == Init_Conditions) {
         unsigned int i_temp = m_reactor->Mixture()->GasPhase().temperatureIndex();
         unsigned int i_dens = m_reactor->Mixture()->GasPhase().densityIndex();
@@ -836,3 +848,200 @@ unsigned int SensitivityAnalyzer::NParams()
     return m_NS;
 }
 
+// Sets a single Arrhenius parameter of the mechanism.
+void SensitivityAnalyzer::setMechParam(unsigned int i, double value)
+{
+    Sprog::Kinetics::Reaction *rxn = m_mech->GasMech().GetReactions(m_sens_params.at(i).Index);
+    Sprog::Kinetics::ARRHENIUS arr = rxn->Arrhenius();
+    switch ( m_sens_params.at(i).Type ) {
+        case ARR_A :
+            arr.A = value;
+            break;
+        case ARR_n :
+            arr.n = value;
+            break;
+        case ARR_E :
+            arr.E = value;
+            break;
+        default :
+            break;
+    }
+    rxn->SetArrhenius(arr);
+    m_mech->GasMech().CompileRateParams();
+}
+
+// Prepares the sensitivity RHS function.
+bool SensitivityAnalyzer::InitSensRHS(const Mops::Reactor &r, const double *const y)
+{
+    m_sensrhs = false;
+    if (!m_enable || !m_analytic || (m_probType != Reaction_Rates) ||
+        (m_sensi_meth == CV_STAGGERED1)) {
+        return false;
+    }
+
+    // Only gas-phase species, temperature and density may be solved for.
+    const Sprog::Mechanism &gas = m_mech->GasMech();
+    const unsigned int nsp = gas.SpeciesCount();
+    const unsigned int neq = r.ODE_Count();
+    if (neq != nsp + 2) return false;
+
+    m_jac.resize(neq * neq);
+    m_dfdw.resize(nsp * neq);
+    m_dfdwRows.resize(nsp);
+    for (unsigned int k = 0; k < nsp; ++k) {
+        m_dfdwRows[k] = &m_dfdw[k * neq];
+    }
+    if (!r.RHS_ProdRateDerivs(y, &m_dfdwRows[0])) return false;
+
+    // The rate of progress of a reaction is proportional to its forward
+    // rate constant, so that its derivatives with respect to the forward
+    // Arrhenius parameters are analytic, unless it has fall-off terms or
+    // explicit reverse parameters.
+    m_proportional.assign(m_NS, false);
+    m_nuStart.assign(1, 0);
+    m_nuSp.clear();
+    m_nuMu.clear();
+    for (unsigned int i = 0; i < m_NS; ++i) {
+        const unsigned int j = m_sens_params.at(i).Index;
+        const Sprog::Kinetics::Reaction *const rxn = gas.Reactions(j);
+        if (rxn == NULL) {
+            throw std::runtime_error("Sensitivity parameter of a reaction which does not exist "
+                                     "(Mops, SensitivityAnalyzer::InitSensRHS).");
+        }
+        m_proportional[i] = (rxn->FallOffType() == Sprog::Kinetics::None) &&
+                            (rxn->RevArrhenius() == NULL) && !rxn->IsSURF() &&
+                            !((m_sens_params.at(i).Type == ARR_A) && (m_params[i] == 0.0));
+
+        // Net stoichiometry, as used for the production rates.
+        for (unsigned int k = 0; k < nsp; ++k) {
+            const Sprog::RxnStoichMap &mu = gas.GetStoichXRef(k);
+            Sprog::RxnStoichMap::const_iterator it = mu.find(j);
+            if ((it != mu.end()) && (it->second != 0.0)) {
+                m_nuSp.push_back(k);
+                m_nuMu.push_back(it->second);
+            }
+        }
+        m_nuStart.push_back(m_nuSp.size());
+    }
+    gas.Reactions().InitWorkspace(m_ratewk);
+
+    m_sensrhs = true;
+    return true;
+}
+
+// Returns true if InitSensRHS has prepared the sensitivity RHS.
+bool SensitivityAnalyzer::UsesSensRHS() const
+{
+    return m_sensrhs;
+}
+
+// Calculates the RHS of the sensitivity equations for CVODES.  The
+// parameters are never changed by CVODES when it is given this function,
+// so the mechanism keeps its original values.
+int SensitivityAnalyzer::SensRHS(double t, N_Vector y, N_Vector ydot,
+                                 N_Vector *yS, N_Vector *ySdot,
+                                 N_Vector tmp, void *solver)
+{
+    Mops::ODE_Solver *s = static_cast<Mops::ODE_Solver*>(solver);
+    const Mops::Reactor &r = *s->GetReactor();
+    double *const yd = NV_DATA_S(y);
+    const double *const f0 = NV_DATA_S(ydot);
+    const double *const f1 = NV_DATA_S(tmp);
+    const int neq = NV_LENGTH_S(y);
+
+    // A copied solver has to set up its own workspace.  A negative
+    // return tells CVODES that the error is unrecoverable.
+    if (!m_sensrhs && !InitSensRHS(r, yd)) return -1;
+
+    // Jacobian dF/dy by forward differences of the RHS, with increments no
+    // smaller than for a mole fraction of one, so that the columns of
+    // trace species are not lost in round-off.  Evaluations of the RHS
+    // share the mechanism and reactor workspaces, so this and the finite
+    // differences below are serial.
+    const double srur = sqrt(UNIT_ROUNDOFF);
+    for (int j = 0; j < neq; ++j) {
+        const double yj = yd[j];
+        yd[j] = yj + srur * std::max(fabs(yj), 1.0);
+        const double inc = yd[j] - yj;
+        rhsFn_CVODE(t, y, tmp, solver);
+        yd[j] = yj;
+
+        double *const Jj = &m_jac[j * neq];
+        for (int n = 0; n < neq; ++n) {
+            Jj[n] = (f1[n] - f0[n]) / inc;
+        }
+    }
+
+    // Rates of progress and the derivatives of the RHS with respect to the
+    // production rates, for the analytic parameter derivatives.
+    const Sprog::Mechanism &gas = m_mech->GasMech();
+    const Sprog::Thermo::IdealGas &thermo = r.Mixture()->GasPhase();
+    const double T = yd[thermo.temperatureIndex()];
+    gas.Reactions().GetRatesOfProgress(T, yd[thermo.densityIndex()], yd,
+                                       gas.SpeciesCount(), thermo, m_ratewk);
+    if (!r.RHS_ProdRateDerivs(yd, &m_dfdwRows[0])) return -1;
+    const double lnT = log(T);
+    const double invRT = 1.0 / (((gas.Units() == Sprog::CGS) ? Sprog::R_CGS : Sprog::R) * T);
+
+    // dF/dp by forward differences for the other parameters.
+    for (unsigned int i = 0; i < m_NS; ++i) {
+        if (m_proportional[i]) continue;
+        const double p = m_params[i];
+        const double inc = srur * std::max(fabs(p), fabs(m_parambars[i]));
+        setMechParam(i, p + inc);
+        rhsFn_CVODE(t, y, tmp, solver);
+        setMechParam(i, p);
+
+        double *const out = NV_DATA_S(ySdot[i]);
+        for (int n = 0; n < neq; ++n) {
+            out[n] = (f1[n] - f0[n]) / inc;
+        }
+    }
+
+    // The columns only read the shared results, so they are independent.
+    const int ns = m_NS;
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < ns; ++i) {
+        double *const out = NV_DATA_S(ySdot[i]);
+        const double *const si = NV_DATA_S(yS[i]);
+
+        // Analytic dF/dp = sum_k dF/dwdotk nu_kj drop_j/dp, where
+        // drop_j/dp = rop_j dln(kf_j)/dp.
+        if (m_proportional[i]) {
+            double dlnk = 0.0;
+            switch ( m_sens_params[i].Type ) {
+                case ARR_A :
+                    dlnk = 1.0 / m_params[i];
+                    break;
+                case ARR_n :
+                    dlnk = lnT;
+                    break;
+                case ARR_E :
+                    dlnk = - invRT;
+                    break;
+                default :
+                    break;
+            }
+            const double drop = m_ratewk.rop[m_sens_params[i].Index] * dlnk;
+            std::fill(out, out + neq, 0.0);
+            for (unsigned int m = m_nuStart[i]; m != m_nuStart[i+1]; ++m) {
+                const double dw = m_nuMu[m] * drop;
+                const double *const Dk = m_dfdwRows[m_nuSp[m]];
+                for (int n = 0; n < neq; ++n) {
+                    out[n] += dw * Dk[n];
+                }
+            }
+        }
+
+        // dF/dy yS.
+        for (int j = 0; j < neq; ++j) {
+            const double sj = si[j];
+            if (sj == 0.0) continue;
+            const double *const Jj = &m_jac[j * neq];
+            for (int n = 0; n < neq; ++n) {
+                out[n] += Jj[n] * sj;
+            }
+        }
+    }
+    return 0;
+}
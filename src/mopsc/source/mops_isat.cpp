@@ -0,0 +1,247 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the ISAT class declared in the mops_isat.h
+    header file.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "mops_isat.h"
+#include <cmath>
+#include <stdexcept>
+
+using namespace Mops;
+using namespace std;
+
+// CONSTRUCTORS AND DESTRUCTORS.
+
+// Default constructor.
+ISAT::ISAT(void)
+: m_enabled(false), m_tol(1.0e-4), m_maxentries(0), m_leaf(-1),
+  m_nretrieve(0), m_ngrow(0), m_nadd(0), m_ndirect(0)
+{
+}
+
+
+// SETTINGS.
+
+void ISAT::Enable(double tol, unsigned int maxentries)
+{
+    if (tol <= 0.0) {
+        throw invalid_argument("ISAT tolerance must be positive "
+                               "(Mops, ISAT::Enable).");
+    }
+    m_enabled    = true;
+    m_tol        = tol;
+    m_maxentries = maxentries;
+    Clear();
+}
+
+void ISAT::Clear(void)
+{
+    m_entries.clear();
+    m_nodes.clear();
+    m_leaf = -1;
+    ResetCounts();
+}
+
+
+// TABLE OPERATIONS.
+
+bool ISAT::Retrieve(const fvector &x, fvector &f)
+{
+    m_leaf = findLeaf(x);
+    if (m_leaf < 0) return false;
+
+    const Entry &e = m_entries[m_nodes[m_leaf].entry];
+    if (e.x0.size() != x.size()) {
+        throw invalid_argument("Query does not match the dimension of the "
+                               "table (Mops, ISAT::Retrieve).");
+    }
+
+    fvector dx;
+    if (eoaNorm(e, x, dx) > 1.0) return false;
+
+    approximate(e, dx, f);
+    ++m_nretrieve;
+    return true;
+}
+
+/*!
+ * If the linear approximation about the entry found by the last Retrieve()
+ * is accurate at x, the EOA is replaced by the smallest ellipsoid which
+ * contains both the old one and x (Pope 1997, eq. 25).  This is a rank-one
+ * update of M in the direction M dx.
+ */
+bool ISAT::Grow(const fvector &x, const fvector &f)
+{
+    if (m_leaf < 0) return false;
+    Entry &e = m_entries[m_nodes[m_leaf].entry];
+
+    fvector dx, fa;
+    const double r2 = eoaNorm(e, x, dx);
+    approximate(e, dx, fa);
+
+    double err = 0.0;
+    for (unsigned int i=0; i!=f.size(); ++i) {
+        err += (f[i] - fa[i]) * (f[i] - fa[i]);
+    }
+    if (sqrt(err) > m_tol) return false;
+
+    // x already in the EOA (possible if Retrieve() was not called first).
+    if (r2 <= 1.0) return true;
+
+    const unsigned int n = x.size();
+    fvector Mdx(n, 0.0);
+    for (unsigned int i=0; i!=n; ++i) {
+        for (unsigned int j=0; j!=n; ++j) {
+            Mdx[i] += e.M[i*n+j] * dx[j];
+        }
+    }
+    const double c = (1.0 - 1.0 / r2) / r2;
+    for (unsigned int i=0; i!=n; ++i) {
+        for (unsigned int j=0; j!=n; ++j) {
+            e.M[i*n+j] -= c * Mdx[i] * Mdx[j];
+        }
+    }
+
+    ++m_ngrow;
+    return true;
+}
+
+/*!
+ * The new entry is stored in a new leaf.  Unless the table was empty, the
+ * leaf found for x is split by the plane which bisects the line between
+ * its tabulation point and x.
+ */
+void ISAT::Add(const fvector &x, const fvector &f, const fvector &A)
+{
+    if (A.size() != f.size() * x.size()) {
+        throw invalid_argument("Gradient matrix has the wrong size "
+                               "(Mops, ISAT::Add).");
+    }
+
+    const unsigned int n = x.size();
+    Entry e;
+    e.x0 = x;
+    e.f0 = f;
+    e.A  = A;
+    e.M.assign(n*n, 0.0);
+    for (unsigned int i=0; i!=n; ++i) {
+        e.M[i*n+i] = 1.0 / (m_tol * m_tol);
+    }
+    m_entries.push_back(e);
+    const int ientry = m_entries.size() - 1;
+
+    Node leaf;
+    leaf.entry = ientry;
+    leaf.a     = 0.0;
+    leaf.left  = -1;
+    leaf.right = -1;
+
+    if (m_nodes.empty()) {
+        m_nodes.push_back(leaf);
+    } else {
+        const int split = findLeaf(x);
+        const fvector &x0 = m_entries[m_nodes[split].entry].x0;
+
+        // Move the old leaf down and insert the new one beside it.
+        const Node old = m_nodes[split];
+        m_nodes.push_back(old);
+        m_nodes.push_back(leaf);
+
+        Node &node = m_nodes[split];
+        node.entry = -1;
+        node.v.resize(n);
+        node.a = 0.0;
+        for (unsigned int i=0; i!=n; ++i) {
+            node.v[i] = x[i] - x0[i];
+            node.a   += node.v[i] * 0.5 * (x[i] + x0[i]);
+        }
+        node.left  = m_nodes.size() - 2;
+        node.right = m_nodes.size() - 1;
+    }
+
+    m_leaf = -1;
+    ++m_nadd;
+}
+
+
+// PRIVATE FUNCTIONS.
+
+int ISAT::findLeaf(const fvector &x) const
+{
+    if (m_nodes.empty()) return -1;
+
+    int i = 0;
+    while (m_nodes[i].entry < 0) {
+        const Node &node = m_nodes[i];
+        double vx = 0.0;
+        for (unsigned int j=0; j!=x.size(); ++j) {
+            vx += node.v[j] * x[j];
+        }
+        i = (vx <= node.a) ? node.left : node.right;
+    }
+    return i;
+}
+
+double ISAT::eoaNorm(const Entry &e, const fvector &x, fvector &dx) const
+{
+    const unsigned int n = x.size();
+    dx.resize(n);
+    for (unsigned int i=0; i!=n; ++i) {
+        dx[i] = x[i] - e.x0[i];
+    }
+
+    double r2 = 0.0;
+    for (unsigned int i=0; i!=n; ++i) {
+        double Mdx = 0.0;
+        for (unsigned int j=0; j!=n; ++j) {
+            Mdx += e.M[i*n+j] * dx[j];
+        }
+        r2 += dx[i] * Mdx;
+    }
+    return r2;
+}
+
+void ISAT::approximate(const Entry &e, const fvector &dx, fvector &f) const
+{
+    const unsigned int n = dx.size();
+    f = e.f0;
+    for (unsigned int i=0; i!=f.size(); ++i) {
+        for (unsigned int j=0; j!=n; ++j) {
+            f[i] += e.A[i*n+j] * dx[j];
+        }
+    }
+}
@@ -116,7 +116,7 @@ void NetworkSimulator::Run(
 
         std::size_t iseed = seed;
         boost::hash_combine(iseed, i);
-        boost::mt19937 rng(iseed);
+        Sweep::rng_type rng(iseed);
 
         Mops::timevector::const_iterator iint;
         unsigned int istep(0u), global_step(0u);
@@ -106,6 +106,9 @@ ODE_Solver &ODE_Solver::operator=(const Mops::ODE_Solver &rhs)
         m_neq      = rhs.m_neq;
         m_srcterms = rhs.m_srcterms;
         _srcTerms  = rhs._srcTerms;
+        m_isat      = rhs.m_isat;
+        m_isatScale = rhs.m_isatScale;
+        m_isatMech  = rhs.m_isatMech;
 
         // Delete memories
         if (m_yS != NULL) N_VDestroyVectorArray_Serial(m_yS, m_sensi.NParams());
@@ -159,6 +162,18 @@ void ODE_Solver::Initialise(Reactor &reac)
         m_deriv[i] = 0.0;
     }
 
+    // Tabulated solutions are kept while the mechanism and the number
+    // of equations are unchanged, so that states repeated in later runs
+    // are retrieved from the table.
+    if ((reac.Mech() != m_isatMech) || (m_isatScale.size() != m_neq + 1)) {
+        m_isat.Clear();
+        m_isatScale.clear();
+    }
+    m_isatMech = reac.Mech();
+
+    // The sensitivity RHS function is used when the reactor supports it.
+    if (m_sensi.isEnable()) m_sensi.InitSensRHS(reac, m_soln);
+
     InitCVode();    
 }
 
@@ -174,7 +189,10 @@ void ODE_Solver::InitCVode(void)
     if (m_yvec != NULL) N_VDestroy_Serial(m_yvec);
     m_yvec = N_VMake_Serial(m_neq, m_soln);
 
-    if (m_sensi.isEnable()) {
+    // The parameters are only changed by CVODES when it has no
+    // sensitivity RHS function.
+    const bool sensRHS = m_sensi.isEnable() && m_sensi.UsesSensRHS();
+    if (m_sensi.isEnable() && !sensRHS) {
         CVodeInit(m_odewk, &rhsFn_CVODES, m_time, m_yvec);
     } else {
         CVodeInit(m_odewk, &rhsFn_CVODE, m_time, m_yvec);
@@ -214,7 +232,8 @@ void ODE_Solver::InitCVode(void)
     if (m_sensi.isEnable()) {
         m_yS = N_VCloneVectorArray_Serial(m_sensi.NParams(), m_yvec);
         m_sensi.InitSensMatrix(m_yS);
-        CVodeSensInit(m_odewk, m_sensi.NParams(), m_sensi.GetMethod(), NULL, m_yS);
+        CVodeSensInit(m_odewk, m_sensi.NParams(), m_sensi.GetMethod(),
+                      sensRHS ? &rhsSensFn_CVODES : NULL, m_yS);
 
         CVodeSensEEtolerances(m_odewk);
         //CVodeSensSStolerances(m_odewk, m_rtol, &m_atol);
@@ -312,6 +331,37 @@ void ODE_Solver::Solve(Reactor &reac, double stop_time)
     // involve copying the data.
     m_reactor = &reac;
     NV_DATA_S(m_solvec) = m_soln;
+
+    // The tabulated mapping depends only on the state and the time step,
+    // which rules out source terms and the other time-dependent inputs.
+    if (m_isat.IsEnabled() && !m_sensi.isEnable() && (_srcTerms == NULL) &&
+        reac.IsAutonomous() && (m_time < stop_time)) {
+        solveISAT(reac, stop_time);
+    } else {
+        integrate(reac, stop_time);
+    }
+
+    // Calculate derivatives at end point.
+    if (reac.EnergyEquation() == Reactor::ConstT) {
+        reac.RHS_ConstT(stop_time, m_soln, m_deriv);
+    } else {
+        reac.RHS_Adiabatic(stop_time, m_soln, m_deriv);
+    }
+    // Add the source terms to derivatives, if defined.
+    if (_srcTerms != NULL) 
+        _srcTerms(m_deriv, m_neq, stop_time, *m_srcterms);
+
+    // Set a pointer in sensitivity object to result for outputting.
+    if (m_sensi.isEnable()) {
+        CVodeGetSens(m_odewk, &m_time, m_yS);
+        m_sensi.SetSensResult(m_yS);
+    }
+
+}
+
+// Integrates the reactor from m_time up to the stop time.
+void ODE_Solver::integrate(Reactor &reac, double stop_time)
+{
     CVodeSetStopTime(m_odewk, stop_time);
 
     // Solve over time step.
@@ -331,24 +381,105 @@ void ODE_Solver::Solve(Reactor &reac, double stop_time)
         }
         reac.Mixture()->GasPhase().Normalise(); // This should not be required if CVODE solves correctly.
     }
-    
+}
 
-    // Calculate derivatives at end point.
-    if (reac.EnergyEquation() == Reactor::ConstT) {
-        reac.RHS_ConstT(stop_time, m_soln, m_deriv);
-    } else {
-        reac.RHS_Adiabatic(stop_time, m_soln, m_deriv);
+/*!
+ * The ISAT query is the reactor state and the time step, both scaled
+ * by their magnitudes when the table is first used, and the tabulated
+ * mapping is the scaled state at the end of the step.  Queries outside
+ * the table are integrated with CVODE from a re-initialised solver, and
+ * the gradient of a new entry is found by forward differences.
+ *
+ * @param[in,out]   reac        Reactor to solve.
+ * @param[in]       stop_time   End of the time step.
+ */
+void ODE_Solver::solveISAT(Reactor &reac, double stop_time)
+{
+    const double dt = stop_time - m_time;
+    const unsigned int n = m_neq + 1;
+
+    if (m_isatScale.size() != n) {
+        m_isat.Clear();
+        m_isatScale.resize(n);
+        for (unsigned int i=0; i!=m_neq; ++i) {
+            m_isatScale[i] = max(fabs(m_soln[i]), 1.0);
+        }
+        m_isatScale[m_neq] = dt;
     }
-    // Add the source terms to derivatives, if defined.
-    if (_srcTerms != NULL) 
-        _srcTerms(m_deriv, m_neq, stop_time, *m_srcterms);
 
-    // Set a pointer in sensitivity object to result for outputting.
-    if (m_sensi.isEnable()) {
-        CVodeGetSens(m_odewk, &m_time, m_yS);
-        m_sensi.SetSensResult(m_yS);
+    fvector x(n), f;
+    for (unsigned int i=0; i!=m_neq; ++i) {
+        x[i] = m_soln[i] / m_isatScale[i];
     }
+    x[m_neq] = dt / m_isatScale[m_neq];
+
+    if (!m_isat.Retrieve(x, f)) {
+        const fvector y(m_soln, m_soln + m_neq);
+        integrateFrom(reac, y, dt, f);
+
+        if (!m_isat.Grow(x, f)) {
+            if (m_isat.IsFull()) {
+                m_isat.CountDirect();
+            } else {
+                // Perturbations well above the CVODE error, but small
+                // compared to the region the entry is expected to cover.
+                const double eps = sqrt(m_isat.Tolerance());
+                fvector A(m_neq * n), yp, fp;
+                for (unsigned int j=0; j!=m_neq; ++j) {
+                    yp = y;
+                    yp[j] += eps * m_isatScale[j];
+                    integrateFrom(reac, yp, dt, fp);
+                    for (unsigned int i=0; i!=m_neq; ++i) {
+                        A[i*n+j] = (fp[i] - f[i]) / eps;
+                    }
+                }
 
+                // The system is autonomous, so the derivative with
+                // respect to the time step is the RHS at the end point.
+                for (unsigned int i=0; i!=m_neq; ++i) {
+                    m_soln[i] = f[i] * m_isatScale[i];
+                }
+                if (reac.EnergyEquation() == Reactor::ConstT) {
+                    reac.RHS_ConstT(stop_time, m_soln, m_deriv);
+                } else {
+                    reac.RHS_Adiabatic(stop_time, m_soln, m_deriv);
+                }
+                for (unsigned int i=0; i!=m_neq; ++i) {
+                    A[i*n+m_neq] = m_deriv[i] * m_isatScale[m_neq] / m_isatScale[i];
+                }
+
+                m_isat.Add(x, f, A);
+            }
+        }
+    }
+
+    for (unsigned int i=0; i!=m_neq; ++i) {
+        m_soln[i] = f[i] * m_isatScale[i];
+    }
+    reac.Mixture()->GasPhase().Normalise();
+
+    // Leave CVODE ready to continue from the new state.
+    m_time = stop_time;
+    ResetSolver();
+}
+
+// Integrates the reactor from the unscaled state y over the time step
+// dt, leaving the scaled result in f.  The solver time is not changed.
+void ODE_Solver::integrateFrom(Reactor &reac, const fvector &y, double dt,
+                               fvector &f)
+{
+    const double t0 = m_time;
+    for (unsigned int i=0; i!=m_neq; ++i) {
+        m_soln[i] = y[i];
+    }
+    ResetSolver();
+    integrate(reac, t0 + dt);
+
+    f.resize(m_neq);
+    for (unsigned int i=0; i!=m_neq; ++i) {
+        f[i] = m_soln[i] / m_isatScale[i];
+    }
+    m_time = t0;
 }
 
 /*!
@@ -432,6 +563,15 @@ void ODE_Solver::SetRTOL(double rtol)
 }
 
 
+// TABULATION.
+
+void ODE_Solver::EnableISAT(double tol, unsigned int maxentries)
+{
+    m_isat.Enable(tol, maxentries);
+    m_isatScale.clear();
+}
+
+
 // EXTERNAL SOURCE TERMS.
 
 // Returns the vector of external source terms (const version).
@@ -584,6 +724,7 @@ void ODE_Solver::init(void)
     // Space required by rate parameter sensitivity.
     m_yS       = NULL;
     m_sensitivity   = NULL;
+    m_isatMech = NULL;
 
     // Init CVODE.
     m_odewk = NULL;
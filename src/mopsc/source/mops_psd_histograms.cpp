@@ -0,0 +1,308 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the PSDHistograms class declared in the
+    mops_psd_histograms.h header file.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "mops_psd_histograms.h"
+#include "mops_psl_file.h"
+#include "swp_ensemble_stats.h"
+#include "csv_io.h"
+#include "string_functions.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+using namespace Mops;
+using namespace Strings;
+using namespace std;
+
+// CONSTRUCTORS AND DESTRUCTORS.
+
+// Default constructor.
+PSDHistograms::PSDHistograms(void)
+: m_npoints(0)
+{
+}
+
+
+// SETTINGS.
+
+void PSDHistograms::AddHistogram(const Histogram &h)
+{
+    if (h.Bins == 0) {
+        throw invalid_argument("Histogram " + h.Name + " has no bins "
+                               "(Mops, PSDHistograms::AddHistogram).");
+    }
+    if (!(h.Upper > h.Lower) || (h.LogScale && (h.Lower <= 0.0))) {
+        throw invalid_argument("Histogram " + h.Name + " has invalid bounds "
+                               "(Mops, PSDHistograms::AddHistogram).");
+    }
+    m_hists.push_back(h);
+}
+
+
+// ACCUMULATION.
+
+void PSDHistograms::Initialise(const Sweep::Mechanism &mech, unsigned int npoints)
+{
+    // Find the PSL variables by name.
+    Sweep::Stats::EnsembleStats stats(mech);
+    vector<string> headings;
+    stats.PSL_Names(headings);
+    vector<string> names(headings.size()), units(headings.size());
+    for (unsigned int i=0; i!=headings.size(); ++i) {
+        PSLFile::SplitHeading(headings[i], names[i], units[i]);
+    }
+
+    m_prop.assign(m_hists.size(), -1);
+    m_ratio.assign(m_hists.size(), -1);
+    m_units.assign(m_hists.size(), "-");
+    for (unsigned int h=0; h!=m_hists.size(); ++h) {
+        for (unsigned int i=0; i!=names.size(); ++i) {
+            if (names[i] == m_hists[h].Property) m_prop[h] = i;
+            if (names[i] == m_hists[h].Ratio) m_ratio[h] = i;
+        }
+        if (m_prop[h] < 0) {
+            throw runtime_error("Particle model has no PSL variable " +
+                                m_hists[h].Property + " for histogram " +
+                                m_hists[h].Name +
+                                " (Mops, PSDHistograms::Initialise).");
+        }
+        if (m_hists[h].Ratio.empty()) {
+            m_units[h] = units[m_prop[h]];
+        } else if (m_ratio[h] < 0) {
+            throw runtime_error("Particle model has no PSL variable " +
+                                m_hists[h].Ratio + " for histogram " +
+                                m_hists[h].Name +
+                                " (Mops, PSDHistograms::Initialise).");
+        }
+    }
+
+    // Clear the sums.
+    m_npoints = npoints;
+    m_sum.resize(m_hists.size());
+    m_sumsq.resize(m_hists.size());
+    for (unsigned int h=0; h!=m_hists.size(); ++h) {
+        m_sum[h].assign(npoints * (m_hists[h].Bins + 2), 0.0);
+        m_sumsq[h].assign(npoints * (m_hists[h].Bins + 2), 0.0);
+    }
+}
+
+void PSDHistograms::Accumulate(unsigned int i, const Mixture &mix,
+                               const Sweep::Mechanism &mech, double time)
+{
+    if (i >= m_npoints) {
+        throw out_of_range("Save point index is out of range "
+                           "(Mops, PSDHistograms::Accumulate).");
+    }
+
+    // Distribution of this run only.  Particles in the particle-number
+    // list of the hybrid model are not included.
+    vector<fvector> run(m_hists.size());
+    for (unsigned int h=0; h!=m_hists.size(); ++h) {
+        run[h].assign(m_hists[h].Bins + 2, 0.0);
+    }
+
+    Sweep::Stats::EnsembleStats stats(mech);
+    fvector psl;
+    const double invV = 1.0 / mix.SampleVolume();
+    for (unsigned int j=0; j!=mix.ParticleCount(); ++j) {
+        const Sweep::Particle &sp = *(mix.Particles().At(j));
+        stats.PSL(sp, mech, time, psl, 1.0);
+        const double wt = sp.getStatisticalWeight() * invV;
+
+        for (unsigned int h=0; h!=m_hists.size(); ++h) {
+            double x = psl[m_prop[h]];
+            if (m_ratio[h] >= 0) {
+                const double d = psl[m_ratio[h]];
+                x = (d != 0.0) ? x / d : numeric_limits<double>::infinity();
+            }
+            run[h][bin(m_hists[h], x)] += wt;
+        }
+    }
+
+    // Add to the sums over all runs.
+    for (unsigned int h=0; h!=m_hists.size(); ++h) {
+        const unsigned int nb = m_hists[h].Bins + 2;
+        for (unsigned int b=0; b!=nb; ++b) {
+            m_sum[h][i*nb+b]   += run[h][b];
+            m_sumsq[h][i*nb+b] += run[h][b] * run[h][b];
+        }
+    }
+}
+
+#ifdef USE_MPI
+void PSDHistograms::ReduceRuns(int root)
+{
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    for (unsigned int h=0; h!=m_hists.size(); ++h) {
+        if (m_sum[h].empty()) continue;
+        const int n = m_sum[h].size();
+        if (rank == root) {
+            MPI_Reduce(MPI_IN_PLACE, &m_sum[h][0], n, MPI_DOUBLE, MPI_SUM, root, MPI_COMM_WORLD);
+            MPI_Reduce(MPI_IN_PLACE, &m_sumsq[h][0], n, MPI_DOUBLE, MPI_SUM, root, MPI_COMM_WORLD);
+        } else {
+            MPI_Reduce(&m_sum[h][0], NULL, n, MPI_DOUBLE, MPI_SUM, root, MPI_COMM_WORLD);
+            MPI_Reduce(&m_sumsq[h][0], NULL, n, MPI_DOUBLE, MPI_SUM, root, MPI_COMM_WORLD);
+        }
+    }
+}
+#endif
+
+void PSDHistograms::Serialize(std::ostream &out) const
+{
+    if (out.good()) {
+        const unsigned int n = m_sum.size();
+        out.write((char*)&n, sizeof(n));
+        for (unsigned int h=0; h!=n; ++h) {
+            const unsigned int len = m_sum[h].size();
+            out.write((char*)&len, sizeof(len));
+            if (len == 0) continue;
+            out.write((char*)&m_sum[h][0], len * sizeof(double));
+            out.write((char*)&m_sumsq[h][0], len * sizeof(double));
+        }
+    } else {
+        throw invalid_argument("Output stream not ready "
+                               "(Mops, PSDHistograms::Serialize).");
+    }
+}
+
+void PSDHistograms::Deserialize(std::istream &in)
+{
+    if (in.good()) {
+        unsigned int n = 0;
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        if (n != m_sum.size()) {
+            throw runtime_error("Serialised histograms do not match the "
+                                "settings (Mops, PSDHistograms::Deserialize).");
+        }
+        for (unsigned int h=0; h!=n; ++h) {
+            unsigned int len = 0;
+            in.read(reinterpret_cast<char*>(&len), sizeof(len));
+            if (len != m_sum[h].size()) {
+                throw runtime_error("Serialised histograms do not match the "
+                                    "settings (Mops, PSDHistograms::Deserialize).");
+            }
+            if (len == 0) continue;
+            in.read(reinterpret_cast<char*>(&m_sum[h][0]), len * sizeof(double));
+            in.read(reinterpret_cast<char*>(&m_sumsq[h][0]), len * sizeof(double));
+        }
+    } else {
+        throw invalid_argument("Input stream not ready "
+                               "(Mops, PSDHistograms::Deserialize).");
+    }
+}
+
+
+// OUTPUT.
+
+void PSDHistograms::Write(const std::string &prefix, const timevector &times,
+                          unsigned int nruns) const
+{
+    const double CONFA = 3.29; // for 99.9% confidence interval.
+    const double invruns = 1.0 / (double)nruns;
+    const double inf = numeric_limits<double>::infinity();
+
+    for (unsigned int h=0; h!=m_hists.size(); ++h) {
+        const Histogram &hist = m_hists[h];
+        const unsigned int nb = hist.Bins + 2;
+
+        CSV_IO out(prefix + "-psd-" + hist.Name + ".csv", true);
+
+        // Header: bin bounds, then the average and error at each time.
+        vector<string> head;
+        head.push_back(PSLFile::JoinHeading("Lower", m_units[h]));
+        head.push_back(PSLFile::JoinHeading("Upper", m_units[h]));
+        for (unsigned int i=0; i!=m_npoints; ++i) {
+            head.push_back("N at " + cstr(times[i].EndTime()) + "s (m-3)");
+            head.push_back("Err");
+        }
+        out.Write(head);
+
+        fvector row(2 + 2 * m_npoints);
+        for (unsigned int b=0; b!=nb; ++b) {
+            row[0] = (b == 0) ? -inf : binEdge(hist, b);
+            row[1] = (b == nb - 1) ? inf : binEdge(hist, b + 1);
+            for (unsigned int i=0; i!=m_npoints; ++i) {
+                const double avg = m_sum[h][i*nb+b] * invruns;
+                double err = 0.0;
+                if (nruns > 1) {
+                    err = m_sumsq[h][i*nb+b] * invruns - avg * avg;
+                    err = CONFA * sqrt(abs(err * invruns));
+                }
+                row[2+2*i]   = avg;
+                row[3+2*i]   = err;
+            }
+            out.Write(row);
+        }
+        out.Close();
+    }
+}
+
+
+// PRIVATE FUNCTIONS.
+
+unsigned int PSDHistograms::bin(const Histogram &h, double x) const
+{
+    // NaN and values below the range go to the underflow bin.
+    if (!(x >= h.Lower)) return 0;
+    if (x >= h.Upper) return h.Bins + 1;
+
+    double f;
+    if (h.LogScale) {
+        f = log(x / h.Lower) / log(h.Upper / h.Lower);
+    } else {
+        f = (x - h.Lower) / (h.Upper - h.Lower);
+    }
+    unsigned int b = (unsigned int)(f * h.Bins);
+    if (b >= h.Bins) b = h.Bins - 1;
+    return b + 1;
+}
+
+double PSDHistograms::binEdge(const Histogram &h, unsigned int b) const
+{
+    const double f = (double)(b - 1) / (double)h.Bins;
+    if (h.LogScale) {
+        return h.Lower * pow(h.Upper / h.Lower, f);
+    }
+    return h.Lower + f * (h.Upper - h.Lower);
+}
@@ -0,0 +1,380 @@
+/*
+  Project:        mopsc (gas-phase chemistry solver).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the binary PSL file classes declared in the
+    mops_psl_file.h header file.
+
+  Licence:
+    This file is part of "mops".
+
+    mops is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "mops_psl_file.h"
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Mops;
+using namespace std;
+
+namespace
+{
+//! File identifier, including the terminating null.
+const char pslMagic[8] = "MOPSPSL";
+
+//! Rounds n up to a multiple of 8.
+size_t align8(size_t n) {return (n + 7) & ~static_cast<size_t>(7);}
+}
+
+// COLUMN HEADINGS.
+
+void PSLFile::SplitHeading(const std::string &heading,
+                           std::string &name, std::string &unit)
+{
+    const string::size_type i = heading.rfind(" (");
+    if ((i != string::npos) && (heading.size() > i + 3) &&
+        (heading[heading.size()-1] == ')')) {
+        name = heading.substr(0, i);
+        unit = heading.substr(i + 2, heading.size() - i - 3);
+    } else {
+        name = heading;
+        unit.clear();
+    }
+}
+
+std::string PSLFile::JoinHeading(const std::string &name,
+                                 const std::string &unit)
+{
+    if (unit.empty()) return name;
+    return name + " (" + unit + ")";
+}
+
+
+// WRITER.
+
+PSLFileWriter::PSLFileWriter(const std::string &filename,
+                             const std::vector<std::string> &headings,
+                             unsigned int chunkrows, bool compress)
+: m_ncols(headings.size()), m_chunkrows(chunkrows), m_compress(compress),
+  m_nbuffered(0), m_nrows(0)
+{
+    if (m_chunkrows == 0) {
+        throw invalid_argument("Chunks must hold at least one row "
+                               "(Mops, PSLFileWriter::PSLFileWriter).");
+    }
+
+    m_file.open(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!m_file.good()) {
+        throw runtime_error("Failed to open " + filename +
+                            " for binary PSL output "
+                            "(Mops, PSLFileWriter::PSLFileWriter).");
+    }
+
+    // Magic number, version and column count.
+    m_file.write(pslMagic, sizeof(pslMagic));
+    const unsigned int version = PSLFile::formatVersion;
+    m_file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    m_file.write(reinterpret_cast<const char*>(&m_ncols), sizeof(m_ncols));
+    streamoff length = sizeof(pslMagic) + 2 * sizeof(unsigned int);
+
+    // Column names and units.
+    string name, unit;
+    for (unsigned int i=0; i!=m_ncols; ++i) {
+        PSLFile::SplitHeading(headings[i], name, unit);
+        unsigned int n = name.size();
+        m_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        m_file.write(name.data(), n);
+        length += sizeof(n) + n;
+        n = unit.size();
+        m_file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        m_file.write(unit.data(), n);
+        length += sizeof(n) + n;
+    }
+    pad(length);
+
+    m_buffer.resize(static_cast<size_t>(m_ncols) * m_chunkrows);
+}
+
+PSLFileWriter::~PSLFileWriter(void)
+{
+    if (m_file.is_open()) {
+        try {
+            Close();
+        } catch (std::exception &) {
+            // Destructors must not throw.
+        }
+    }
+}
+
+void PSLFileWriter::Write(const fvector &row)
+{
+    if (row.size() != m_ncols) {
+        throw invalid_argument("PSL entry does not match the number of "
+                               "columns (Mops, PSLFileWriter::Write).");
+    }
+    for (unsigned int i=0; i!=m_ncols; ++i) {
+        m_buffer[static_cast<size_t>(i) * m_chunkrows + m_nbuffered] = row[i];
+    }
+    if (++m_nbuffered == m_chunkrows) writeChunk();
+}
+
+void PSLFileWriter::Close(void)
+{
+    if (!m_file.is_open()) return;
+    if (m_nbuffered > 0) writeChunk();
+    m_file.close();
+    if (m_file.fail()) {
+        throw runtime_error("Failed to write binary PSL file "
+                            "(Mops, PSLFileWriter::Close).");
+    }
+}
+
+void PSLFileWriter::writeChunk(void)
+{
+    // Find the columns which hold a single value.
+    vector<unsigned char> encoding(m_ncols, PSLFile::Full);
+    if (m_compress) {
+        for (unsigned int i=0; i!=m_ncols; ++i) {
+            const double *col = &m_buffer[static_cast<size_t>(i) * m_chunkrows];
+            unsigned int j = 1;
+            while ((j < m_nbuffered) &&
+                   (memcmp(col + j, col, sizeof(double)) == 0)) ++j;
+            if (j == m_nbuffered) encoding[i] = PSLFile::Constant;
+        }
+    }
+
+    const unsigned int flags = m_compress ? 1 : 0;
+    m_file.write(reinterpret_cast<const char*>(&m_nbuffered), sizeof(m_nbuffered));
+    m_file.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    if (m_ncols > 0) {
+        m_file.write(reinterpret_cast<const char*>(&encoding[0]), m_ncols);
+    }
+    pad(2 * sizeof(unsigned int) + m_ncols);
+
+    for (unsigned int i=0; i!=m_ncols; ++i) {
+        const unsigned int n = (encoding[i] == PSLFile::Constant) ? 1 : m_nbuffered;
+        m_file.write(reinterpret_cast<const char*>(&m_buffer[static_cast<size_t>(i) * m_chunkrows]),
+                     n * sizeof(double));
+    }
+
+    if (!m_file.good()) {
+        throw runtime_error("Failed to write binary PSL chunk "
+                            "(Mops, PSLFileWriter::writeChunk).");
+    }
+
+    m_nrows += m_nbuffered;
+    m_nbuffered = 0;
+}
+
+void PSLFileWriter::pad(std::streamoff length)
+{
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    m_file.write(zeros, align8(length) - length);
+}
+
+
+// READER.
+
+PSLFileReader::PSLFileReader(const std::string &filename)
+: m_nrows(0), m_data(NULL), m_size(0)
+{
+#ifdef _WIN32
+    // No memory map; read the whole file instead.
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in.good()) {
+        throw runtime_error("Failed to open binary PSL file " + filename +
+                            " (Mops, PSLFileReader::PSLFileReader).");
+    }
+    in.seekg(0, ios::end);
+    m_contents.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0, ios::beg);
+    if (!m_contents.empty()) {
+        in.read(reinterpret_cast<char*>(&m_contents[0]), m_contents.size());
+        m_data = &m_contents[0];
+    }
+    m_size = m_contents.size();
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Failed to open binary PSL file " + filename +
+                            " (Mops, PSLFileReader::PSLFileReader).");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw runtime_error("Failed to read the size of " + filename +
+                            " (Mops, PSLFileReader::PSLFileReader).");
+    }
+    m_size = st.st_size;
+    if (m_size > 0) {
+        void *p = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Failed to map " + filename +
+                                " (Mops, PSLFileReader::PSLFileReader).");
+        }
+        m_data = static_cast<const unsigned char*>(p);
+    }
+    close(fd);
+#endif
+
+    try {
+        index(filename);
+    } catch (std::exception &) {
+        unmap();
+        throw;
+    }
+}
+
+PSLFileReader::~PSLFileReader(void)
+{
+    unmap();
+}
+
+void PSLFileReader::Headings(std::vector<std::string> &headings) const
+{
+    headings.resize(m_names.size());
+    for (unsigned int i=0; i!=m_names.size(); ++i) {
+        headings[i] = PSLFile::JoinHeading(m_names[i], m_units[i]);
+    }
+}
+
+bool PSLFileReader::IsConstant(unsigned int k, unsigned int i) const
+{
+    return m_chunks.at(k).encoding[i] == PSLFile::Constant;
+}
+
+const double *PSLFileReader::Column(unsigned int k, unsigned int i) const
+{
+    return m_chunks.at(k).columns.at(i);
+}
+
+double PSLFileReader::Value(unsigned int k, unsigned int i, unsigned int j) const
+{
+    const Chunk &c = m_chunks.at(k);
+    return (c.encoding[i] == PSLFile::Constant) ? c.columns[i][0] : c.columns[i][j];
+}
+
+void PSLFileReader::ReadRow(unsigned int k, unsigned int j, fvector &row) const
+{
+    const Chunk &c = m_chunks.at(k);
+    if (j >= c.nrows) {
+        throw out_of_range("Row index is outside the chunk "
+                           "(Mops, PSLFileReader::ReadRow).");
+    }
+    row.resize(m_names.size());
+    for (unsigned int i=0; i!=m_names.size(); ++i) {
+        row[i] = (c.encoding[i] == PSLFile::Constant) ? c.columns[i][0] : c.columns[i][j];
+    }
+}
+
+void PSLFileReader::index(const std::string &filename)
+{
+    const string err = " in binary PSL file " + filename +
+                       " (Mops, PSLFileReader::index).";
+    size_t pos = 0;
+
+    // Header.
+    const size_t fixed = sizeof(pslMagic) + 2 * sizeof(unsigned int);
+    if ((m_size < fixed) || (memcmp(m_data, pslMagic, sizeof(pslMagic)) != 0)) {
+        throw runtime_error("Unrecognised header" + err);
+    }
+    unsigned int version = 0, ncols = 0;
+    memcpy(&version, m_data + sizeof(pslMagic), sizeof(version));
+    memcpy(&ncols, m_data + sizeof(pslMagic) + sizeof(version), sizeof(ncols));
+    if (version != PSLFile::formatVersion) {
+        throw runtime_error("Unsupported version" + err);
+    }
+    pos = fixed;
+
+    // Column names and units.
+    m_names.resize(ncols);
+    m_units.resize(ncols);
+    for (unsigned int i=0; i!=ncols; ++i) {
+        for (unsigned int s=0; s!=2; ++s) {
+            unsigned int n = 0;
+            if (m_size - pos < sizeof(n)) throw runtime_error("Truncated header" + err);
+            memcpy(&n, m_data + pos, sizeof(n));
+            pos += sizeof(n);
+            if (m_size - pos < n) throw runtime_error("Truncated header" + err);
+            string &str = (s == 0) ? m_names[i] : m_units[i];
+            str.assign(reinterpret_cast<const char*>(m_data + pos), n);
+            pos += n;
+        }
+    }
+    pos = align8(pos);
+
+    // Chunks.
+    while (pos < m_size) {
+        Chunk c;
+        unsigned int flags = 0;
+        const size_t head = 2 * sizeof(unsigned int) + ncols;
+        if (m_size - pos < head) throw runtime_error("Truncated chunk" + err);
+        memcpy(&c.nrows, m_data + pos, sizeof(c.nrows));
+        memcpy(&flags, m_data + pos + sizeof(c.nrows), sizeof(flags));
+        c.encoding = m_data + pos + 2 * sizeof(unsigned int);
+        pos = align8(pos + head);
+
+        c.columns.resize(ncols);
+        for (unsigned int i=0; i!=ncols; ++i) {
+            size_t n = c.nrows;
+            if (c.encoding[i] == PSLFile::Constant) {
+                if ((flags & 1) == 0) throw runtime_error("Unexpected compressed column" + err);
+                n = 1;
+            } else if (c.encoding[i] != PSLFile::Full) {
+                throw runtime_error("Unknown column encoding" + err);
+            }
+            if (pos > m_size || (m_size - pos) / sizeof(double) < n) {
+                throw runtime_error("Truncated chunk" + err);
+            }
+            c.columns[i] = reinterpret_cast<const double*>(m_data + pos);
+            pos += n * sizeof(double);
+        }
+
+        m_nrows += c.nrows;
+        m_chunks.push_back(c);
+    }
+}
+
+void PSLFileReader::unmap(void)
+{
+#ifndef _WIN32
+    if (m_data != NULL) munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_data = NULL;
+    m_size = 0;
+}
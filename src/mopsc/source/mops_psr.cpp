@@ -323,6 +323,21 @@ bool PSR::HasInflow() const {
     else return false;
 }
 
+/*!
+ * Fixed inflow streams are part of the RHS, but the state of a stream
+ * fed by another reactor changes between steps.
+ *
+ * @return      True if the RHS depends only on the solution values.
+ */
+bool PSR::IsAutonomous() const {
+    if (!Reactor::IsAutonomous()) return false;
+    for (FlowPtrVector::const_iterator it=m_inflow_ptrs.begin();
+         it!=m_inflow_ptrs.end(); ++it) {
+        if ((*it)->HasReacInflow()) return false;
+    }
+    return true;
+}
+
 /*!
  * Ensure that all the 'fractional flowrates' specified for the FlowStreams
  * add up to 1.0, for inflows and outflows. This is necessary to check that
@@ -606,4 +621,59 @@ void PSR::RHS_Adiabatic(double t, const double *const y,  double *ydot) const
     PSR::RHS_Complete(t, y, ydot);
 }
 
+/*!
+ * The inflow and outflow terms of RHS_Complete do not depend on the
+ * production rates, so the derivatives are those of the reaction terms
+ * and of the expansion they cause.
+ *
+ * @param[in]   y   Solution values
+ * @param[out]  D   D[k][i] = dFi/dwdotk, for each gas-phase species k
+ *
+ * @return      False if the RHS is not linear in the production rates
+ */
+bool PSR::RHS_ProdRateDerivs(const double *const y, double **D) const
+{
+    if (m_Tfunc || (m_sarea > 0.0)) return false;
+
+    // In the adiabatic model dT/dt has the term -sum_k(Hk wdotk) / (rho C R).
+    fvector H_wdot;
+    double Tfac = 0.0;
+    if (m_emodel == Reactor::Adiabatic) {
+        double C(0.0);
+        if (m_constv) {
+            C = m_mix->GasPhase().ThermoInterface::CalcBulkCv_R(y[m_iT], y, m_nsp);
+            m_mix->GasPhase().CalcUs(y[m_iT], H_wdot);
+        } else {
+            C = m_mix->GasPhase().ThermoInterface::CalcBulkCp_R(y[m_iT], y, m_nsp);
+            m_mix->GasPhase().CalcHs(y[m_iT], H_wdot);
+        }
+        if (m_include_particle_terms) {
+            Tfac = - 1.0 / (y[m_iDens] * C * Sprog::R + m_mix->getParticleDensity());
+        } else {
+            Tfac = - 1.0 / (y[m_iDens] * C * Sprog::R);
+        }
+    }
+
+    for (unsigned int k=0; k!=m_nsp; ++k) {
+        const double dT = (m_emodel == Reactor::Adiabatic) ? Tfac * H_wdot[k] : 0.0;
+        D[k][m_iT] = dT;
+
+        // wtot enters dn_dt, and so the expansion factor gamma at
+        // constant pressure.
+        double dgamma(0.0);
+        if (m_constv) {
+            D[k][m_iDens] = 1.0;
+        } else {
+            D[k][m_iDens] = - y[m_iDens] * dT / y[m_iT];
+            dgamma = 1.0 / y[m_iDens] + dT / y[m_iT];
+        }
+
+        for (unsigned int i=0; i!=m_nsp; ++i) {
+            D[k][i] = - y[i] * (D[k][m_iDens] / y[m_iDens] + dgamma);
+        }
+        D[k][k] += 1.0 / y[m_iDens];
+    }
+    return true;
+}
+
 } // Mops namespace
@@ -476,6 +476,14 @@ unsigned int Reactor::ODE_Count() const
     return m_neq;
 }
 
+// Returns true if the RHS depends only on the solution values.  An imposed
+// dT/dt profile depends on time and the particle terms in the energy
+// balance on the particle population.
+bool Reactor::IsAutonomous() const
+{
+    return (m_Tfunc == NULL) && !m_include_particle_terms;
+}
+
 // Definition of RHS form for constant temperature energy equation.
 void Reactor::RHS_ConstT(double t, const double *const y,  double *ydot) const
 {
@@ -619,6 +627,58 @@ void Reactor::Jacobian(double t, double *const y,
                                      m_constv, m_emodel==ConstT);
 }
 
+/*!
+ * The RHS of RHS_ConstT and RHS_Adiabatic is linear in the molar
+ * production rates when there is no imposed temperature gradient and no
+ * surface chemistry, and its derivatives with respect to them depend only
+ * on the solution.
+ *
+ * @param[in]   y   Solution values
+ * @param[out]  D   D[k][i] = dFi/dwdotk, for each gas-phase species k
+ *
+ * @return      False if the RHS is not linear in the production rates
+ */
+bool Reactor::RHS_ProdRateDerivs(const double *const y, double **D) const
+{
+    if (m_Tfunc || (m_sarea > 0.0)) return false;
+
+    // In the adiabatic model dT/dt = -T sum_k(Hk wdotk) / (C rho).
+    fvector Hs;
+    double Tfac = 0.0;
+    if (m_emodel == Adiabatic) {
+        double C = 0.0;
+        if (m_constv) {
+            C = m_mix->GasPhase().ThermoInterface::CalcBulkCv_R(y[m_iT], y, m_nsp);
+            m_mix->GasPhase().CalcUs_RT(y[m_iT], Hs);
+        } else {
+            C = m_mix->GasPhase().ThermoInterface::CalcBulkCp_R(y[m_iT], y, m_nsp);
+            m_mix->GasPhase().CalcHs_RT(y[m_iT], Hs);
+        }
+        if (m_include_particle_terms) {
+            Tfac = - y[m_iT] / (C * y[m_iDens] + (m_mix->getParticleDensity() / Sprog::R));
+        } else {
+            Tfac = - y[m_iT] / (C * y[m_iDens]);
+        }
+    }
+
+    for (unsigned int k=0; k!=m_nsp; ++k) {
+        // Mole fractions, from (wdoti - xi * wtot) / rho.
+        for (unsigned int i=0; i!=m_nsp; ++i) {
+            D[k][i] = - y[i] / y[m_iDens];
+        }
+        D[k][k] += 1.0 / y[m_iDens];
+
+        // Temperature and density.
+        D[k][m_iT] = (m_emodel == Adiabatic) ? Tfac * Hs[k] : 0.0;
+        if (m_constv) {
+            D[k][m_iDens] = 1.0;
+        } else {
+            D[k][m_iDens] = - y[m_iDens] * D[k][m_iT] / y[m_iT];
+        }
+    }
+    return true;
+}
+
 /*!
 @param[in]          t       Time step
 @param[in]          y       solution vector with mole fractions and density and temperature
@@ -162,6 +162,9 @@ int jacFn_CVODES(long int N,
     return 0;
 }
 
+// The sensitivity RHS evaluator.  This function calculates the RHS of the
+// sensitivity equations, dF/dy yS + dF/dp, for all the parameters at once.
+// CVODES does not change the parameters when it is given this function.
 int rhsSensFn_CVODES(int Ns, realtype t,
                      N_Vector y,
                      N_Vector ydot,
@@ -174,36 +177,6 @@ int rhsSensFn_CVODES(int Ns, realtype t,
 {
     // Cast the Solver object.
     Mops::ODE_Solver *s = static_cast<Mops::ODE_Solver*>(solver);
-    Mops::Reactor *r    = s->GetReactor();
-    double **  temp_jac;
-    unsigned int n_jac_size = NV_LENGTH_S(yS[0]);
-    // Allocate memories for temporarily calculations.
-    temp_jac     = new double * [n_jac_size];
-    for (unsigned int i = 0; i < n_jac_size; ++i) {
-        temp_jac[i]     = new double [n_jac_size];
-        for (unsigned int j = 0; j < n_jac_size; ++j) {
-            temp_jac[i][j]     = 0.0;
-        }
-    }
 
-    s->GetSensitivity().ChangeMechParams();
-    // Get the Jacobian from the reactor model
-    r->Jacobian(t, NV_DATA_S(y), temp_jac,
-                UNIT_ROUNDOFF);
-    
-    // Make an unsigned copy of Ns to avoid compiler warnings
-    const unsigned int uNs = Ns;
-    for (unsigned int k = 0; k < uNs; ++k) {
-        for (unsigned int i = 0; i < n_jac_size; ++i) {
-            for (unsigned int j = 0; j < n_jac_size; ++j) {
-                NV_Ith_S(ySdot[k], i) += temp_jac[i][j] * NV_Ith_S(yS[k], j);
-            }
-        }
-    }
-    for (unsigned int i = 0; i < n_jac_size; ++i) {
-        delete [] temp_jac[i];
-    }
-    delete [] temp_jac;
-
-    return 0;
+    return s->GetSensitivity().SensRHS(t, y, ydot, yS, ySdot, tmp1, solver);
 }
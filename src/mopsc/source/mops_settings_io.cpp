@@ -54,6 +54,7 @@
 #include <sstream>
 #include <memory>
 #include <cstdlib>
+#include <limits>
 
 using namespace Mops;
 
@@ -162,6 +163,19 @@ void readGlobalSettings(const CamXML::Element &node,
         solver.SetATOL(Strings::cdble(subnode->Data()));
     }
 
+    // Read the ISAT settings for tabulating the gas-phase solution,
+    // e.g. <isat tol="1e-4" maxentries="10000"/>.
+    subnode = node.GetFirstChild("isat");
+    if (subnode != NULL) {
+        double tol = 1.0e-4;
+        unsigned int maxentries = 10000;
+        std::string str = subnode->GetAttributeValue("tol");
+        if (!str.empty()) tol = Strings::cdble(str);
+        str = subnode->GetAttributeValue("maxentries");
+        if (!str.empty()) maxentries = (unsigned int)Strings::cdble(str);
+        solver.SetISAT(tol, maxentries);
+    }
+
     // Read the number of runs.
     subnode = node.GetFirstChild("runs");
     if (subnode != NULL) {
@@ -245,11 +259,17 @@ bool checkCoagulationKernel(int old_id, int this_id) {
  *          <m0>3.0e15</m0>
  *     </population>
  *
+ * Part of the ensemble can be loaded with the first and count attributes
+ * of the file element, e.g. <file first="0" count="1024">.  The particles
+ * are taken from the deserialised ensemble without being copied.
+ *
  */
 Sweep::PartPtrList readEnsembleFile(
         const string fname,
         const Sweep::Mechanism &smech, 
-	std::vector<unsigned int> &particle_numbers_list) {
+	std::vector<unsigned int> &particle_numbers_list,
+        const unsigned int first,
+        const unsigned int count) {
     // Open the save point file.
     ifstream fin;
     fin.open(fname.c_str(), ios_base::in | ios_base::binary);
@@ -286,16 +306,11 @@ Sweep::PartPtrList readEnsembleFile(
 
         // Now it's time to load the particle ensemble.
         Sweep::Ensemble fileensemble;
-        fileensemble.Deserialize(fin, smech);
-
-        // Begin adding the particles of fileensemble to the simulation's ensemble
-        Sweep::Particle *sp;
-        for (unsigned int i(0); i != fileensemble.Count(); ++i) {
-            // note we need to use Clone, because fileensemble will be deleted once
-            // we leave the scope of this function.
-            sp = fileensemble.At(i)->Clone();
-            particles.push_back(sp);
-        }
+        fileensemble.Deserialize(fin, smech, first, count);
+
+        // Take ownership of the particles of fileensemble, which will be
+        // deleted once we leave the scope of this function.
+        particles = fileensemble.TakeParticles();
 
 	// Read hybrid model particle-number info into list 
 	if (fileensemble.GetHybridThreshold() > 0)
@@ -350,9 +365,16 @@ void readInitialPopulation(
         std::string filename;
         filename = fnode->Data();
         std::cout << "parser: binary file " << filename << " specified for input.\n";
+        // Optional range of particles to load.
+        unsigned int first = 0, count = std::numeric_limits<unsigned int>::max();
+        std::string str = fnode->GetAttributeValue("first");
+        if (!str.empty()) first = (unsigned int)Strings::cdble(str);
+        str = fnode->GetAttributeValue("count");
+        if (!str.empty()) count = (unsigned int)Strings::cdble(str);
 	std::vector<unsigned int> particle_numbers;
 	particle_numbers.resize(0, 0);
-        fileParticleList = readEnsembleFile(filename, mech.ParticleMech(), particle_numbers);
+        fileParticleList = readEnsembleFile(filename, mech.ParticleMech(), particle_numbers,
+                                            first, count);
 	// Initialise and store hybrid particle-number info for the cell
 	// Note this only works if the primary particle model is univariate
 	if (particle_numbers.size() > 0)
@@ -1200,6 +1222,70 @@ void readOutput(const CamXML::Element &node, Simulator &sim, Mechanism &mech)
         mech.ParticleMech().SetWriteBinaryTrees(false);
     }
 
+    // PSL FILE FORMAT.
+
+    // Read the format of the PSL files: csv (default), binary or both.
+    subnode = node.GetFirstChild("psl");
+    if (subnode != NULL) {
+        std::string str_format = subnode->GetAttributeValue("format");
+        if (str_format.compare("csv") == 0) {
+            sim.SetPSLFormat(true, false);
+        } else if (str_format.compare("binary") == 0) {
+            sim.SetPSLFormat(false, true);
+        } else if (str_format.compare("both") == 0) {
+            sim.SetPSLFormat(true, true);
+        } else {
+            throw std::runtime_error("Unknown PSL format in MOPS input, expected "
+                                "csv, binary or both (Mops, Settings_IO::readOutput)");
+        }
+    }
+
+    // IN-SITU HISTOGRAMS.
+
+    // Read the histograms to accumulate during the simulation, and
+    // whether the save points are still needed.
+    subnode = node.GetFirstChild("psd");
+    if (subnode != NULL) {
+        std::string str_enable = subnode->GetAttributeValue("savepoints");
+        if (str_enable.compare("false") == 0) {
+            sim.SetWriteSavePoints(false);
+        }
+
+        subnode->GetChildren("histogram", nodes);
+        for (i=nodes.begin(); i!=nodes.end(); ++i) {
+            PSDHistograms::Histogram h;
+            h.Name     = (*i)->GetAttributeValue("name");
+            h.Property = (*i)->GetAttributeValue("property");
+            h.Ratio    = (*i)->GetAttributeValue("ratio");
+            h.Bins     = (unsigned int)Strings::cdble((*i)->GetAttributeValue("bins"));
+            h.Lower    = Strings::cdble((*i)->GetAttributeValue("lower"));
+            h.Upper    = Strings::cdble((*i)->GetAttributeValue("upper"));
+            h.LogScale = ((*i)->GetAttributeValue("scale").compare("log") == 0);
+            if (h.Name.empty() || h.Property.empty()) {
+                throw std::runtime_error("Histograms need a name and a property "
+                                    "(Mops, Settings_IO::readOutput)");
+            }
+            sim.Histograms().AddHistogram(h);
+        }
+    }
+
+    // CHECKPOINTS.
+
+    // Read the wall-clock seconds between checkpoints and the wall-clock
+    // limit at which to stop.
+    subnode = node.GetFirstChild("checkpoint");
+    if (subnode != NULL) {
+        std::string str_interval = subnode->GetAttributeValue("interval");
+        std::string str_walltime = subnode->GetAttributeValue("walltime");
+        double interval = str_interval.empty() ? 0.0 : Strings::cdble(str_interval);
+        double walltime = str_walltime.empty() ? -1.0 : Strings::cdble(str_walltime);
+        if (interval < 0.0) {
+            throw std::runtime_error("Checkpoint interval must not be negative "
+                                "(Mops, Settings_IO::readOutput)");
+        }
+        sim.SetCheckpoint(interval, walltime);
+    }
+
     // STATISTICAL BOUNDARIES OF OUTPUT
 
     // Bound parameters
@@ -1225,6 +1311,10 @@ void readOutput(const CamXML::Element &node, Simulator &sim, Mechanism &mech)
             std::string str_ptcount = subnode->GetAttributeValue("ptcount");
             sim.SetParticleTrackCount((unsigned int)Strings::cdble(str_ptcount));
 
+            // Optionally write the images of all the tracked particles
+            // to one file per time.
+            sim.SetParticleTrackCombined(subnode->GetAttributeValue("combined") == "true");
+
             // Also need to ensure full binary trees are written for certain
             // particle models.
             mech.ParticleMech().SetWriteBinaryTrees(true);
@@ -1560,7 +1650,7 @@ Sweep::PartPtrList Settings_IO::ReadInitialParticlesDetailed(const CamXML::Eleme
 	const Sweep::Mechanism & particle_mech)
 {
 	// Generate a random number generator for use inside this once-off function
-	boost::mt19937 rng_temp(0);
+	Sweep::rng_type rng_temp(0);
 
 	// Accumulate in this container a collection of particles to be inserted into the ensemble
 	Sweep::PartPtrList particleList;
@@ -47,6 +47,7 @@
 #include "mops_simulator.h"
 #include "mops_ode_solver.h"
 #include "mops_flux_postprocessor.h"
+#include "mops_psl_file.h"
 #include "mops_reactor_factory.h"
 #include "string_functions.h"
 #include "csv_io.h"
@@ -58,7 +59,10 @@
 #include "mops_gpc_sensitivity.h"
 #include "gpc_species.h"
 #include "swp_particle_image.h"
+#include "swp_profile.h"
 #include <algorithm>
+#include <cstdio>
+#include <sstream>
 #include <time.h>
 
 #include <boost/functional/hash.hpp>
@@ -76,12 +80,14 @@ Simulator::Simulator(void)
 : m_nruns(1), m_niter(1), m_pcount(0), m_maxm0(0.0),
   m_cpu_start((clock_t)0.0), m_cpu_mark((clock_t)0.0), m_runtime(0.0),
   m_console_interval(1), m_console_msgs(true),
-  m_output_filename("mops-out"), m_output_every_iter(false),
+  m_output_filename("mops-out"), m_file(&m_filebuf), m_output_every_iter(false),
   m_output_step(0), m_output_iter(0), m_write_jumps(false),
-  m_write_ensemble_file(false),
+  m_write_ensemble_file(false), m_write_psl_csv(true), m_write_psl_binary(false),
+  m_write_save_points(true),
   m_write_PAH(false), m_write_PP(false), m_mass_spectra(true), m_mass_spectra_ensemble(true),
   m_mass_spectra_xmer(1), m_mass_spectra_frag(false), 
-  m_ptrack_count(0), m_track_bintree_particle_count(0)
+  m_checkpoint_interval(-1.0), m_walltime(-1.0), m_restart(false), m_finished(false),
+  m_jumps(0), m_ptrack_count(0), m_ptrack_combined(false), m_track_bintree_particle_count(0)
 {
 }
 
@@ -92,6 +98,7 @@ Simulator::~Simulator(void)
 
 // Copy constructor.
 Simulator::Simulator(const Mops::Simulator &copy)
+: m_file(&m_filebuf)
 {
     *this = copy;
 }
@@ -114,6 +121,15 @@ Simulator &Simulator::operator=(const Mops::Simulator &rhs) {
         m_output_iter = rhs.m_output_iter;
         m_write_jumps = rhs.m_write_jumps;
         m_write_ensemble_file = rhs.m_write_ensemble_file;
+        m_write_psl_csv = rhs.m_write_psl_csv;
+        m_write_psl_binary = rhs.m_write_psl_binary;
+        m_write_save_points = rhs.m_write_save_points;
+        m_psd = rhs.m_psd;
+        m_checkpoint_interval = rhs.m_checkpoint_interval;
+        m_walltime = rhs.m_walltime;
+        m_restart = rhs.m_restart;
+        m_finished = rhs.m_finished;
+        m_jumps = rhs.m_jumps;
         m_write_PAH = rhs.m_write_PAH;
 		m_write_PP = rhs.m_write_PP;
         m_mass_spectra = rhs.m_mass_spectra;
@@ -121,6 +137,7 @@ Simulator &Simulator::operator=(const Mops::Simulator &rhs) {
         m_mass_spectra_xmer = rhs.m_mass_spectra_xmer;
         m_mass_spectra_frag = rhs.m_mass_spectra_frag;
         m_ptrack_count = rhs.m_ptrack_count;
+        m_ptrack_combined = rhs.m_ptrack_combined;
 		m_track_bintree_particle_count = rhs.m_track_bintree_particle_count;
     }
     return *this;
@@ -271,6 +288,16 @@ void Simulator::SetWritePAH(bool postpocessPAH) {m_write_PAH=postpocessPAH;}
 //! Set simulator to write the detailed primary particles info in the psl file.
 void Simulator::SetWritePP(bool postpocessPP) { m_write_PP = postpocessPP; }
 
+//! Choose the PSL output formats.
+void Simulator::SetPSLFormat(bool csv, bool binary)
+{
+    m_write_psl_csv = csv;
+    m_write_psl_binary = binary;
+}
+
+//! Set simulator to write the save points.
+void Simulator::SetWriteSavePoints(bool writesavepoints) {m_write_save_points=writesavepoints;}
+
 // STATISTICAL BOUNDS OUTPUT
 
 void Simulator::SetOutputStatBoundary(Sweep::PropID pid, double lower, double upper)
@@ -280,6 +307,18 @@ void Simulator::SetOutputStatBoundary(Sweep::PropID pid, double lower, double up
     m_statbound.PID   = pid;
 }
 
+// CHECKPOINTS.
+
+// Sets the wall-clock times of the checkpoints.
+void Simulator::SetCheckpoint(double interval, double walltime)
+{
+    m_checkpoint_interval = interval;
+    m_walltime = walltime;
+}
+
+// Sets the simulator to continue from its checkpoint file.
+void Simulator::SetRestart(bool restart) {m_restart = restart;}
+
 // PARTICLE TRACKING FOR VIDEOS 
 
 //! Set number of track particles 
@@ -293,6 +332,11 @@ const unsigned int Simulator::TrackBintreeParticleCount() const { return m_track
 void Simulator::SetParticleTrackCount(unsigned int ptcount) {
     m_ptrack_count = ptcount;
 }
+
+void Simulator::SetParticleTrackCombined(bool combined) {
+    m_ptrack_combined = combined;
+}
+
 // options for Postprocess (only for PAH-PP model)
 const bool Simulator::MassSpectra() const
 {
@@ -360,6 +404,22 @@ void Simulator::RunSimulation(Mops::Reactor &r,
         s.SetLOIStatusFalse();
     }
 
+    // Read the checkpoint to continue from, and discard any output
+    // written after it was taken.
+    Checkpoint restart;
+    if (m_restart || m_checkpoint_interval >= 0.0) {
+        if (s.GetLOIStatus() || s.GetNumSens() > 0) {
+            throw runtime_error("Checkpoints are not supported with LOI reduction "
+                                "or sensitivity analysis (Mops, Simulator::RunSimulation).");
+        }
+    }
+    if (m_restart) {
+        restart.Read(checkpointFile());
+        restart.TruncateFiles();
+    }
+    m_finished = false;
+    m_jumps = 0;
+
     // Set up file output.
 	#ifdef USE_MPI
 	int rank;
@@ -369,7 +429,7 @@ void Simulator::RunSimulation(Mops::Reactor &r,
 	#endif
 
     writeAux(*r.Mech(), m_times, s);
-    openOutputFile(); //.sim
+    openOutputFile(m_restart); //.sim
 
     // Output initial conditions.
     // - Note: added sensitivity output will write system initial condition, not initial values.
@@ -396,6 +456,7 @@ void Simulator::RunSimulation(Mops::Reactor &r,
 			}
 
 			// write headers
+			if (m_restart) continue;
 			std::ofstream TrackParticlesFile;
 			TrackParticlesFile.open(m_TrackParticlesName[i].c_str(), ios::app);
 			TrackParticlesFile << "Time (s),x (m),y (m),z (m),r (m),orient-x_x (m),orient-x_y (m),orient-x_z (m),orient-z_x (m),orient-z_y (m),orient-z_z (m)" << component_names << "\n";
@@ -403,7 +464,7 @@ void Simulator::RunSimulation(Mops::Reactor &r,
 		}
 	}
 
-    fileOutput(m_output_step, m_output_iter, r, s, this);
+    if (!m_restart) fileOutput(m_output_step, m_output_iter, r, s, this);
 
 	#ifdef USE_MPI
 	closeOutputFile();						//ms785
@@ -412,12 +473,28 @@ void Simulator::RunSimulation(Mops::Reactor &r,
     // Set up the console output.
     icon = m_console_interval;
     setupConsole(*r.Mech());
+
+    // Clear the in-situ histograms.
+    if (!m_psd.IsEmpty()) {
+        m_psd.Initialise(r.Mech()->ParticleMech(), m_times.size());
+        if (m_restart) {
+            istringstream in(restart.Histograms, ios_base::in | ios_base::binary);
+            m_psd.Deserialize(in);
+        }
+    }
+
+    // The checkpoints are written in the background while the next
+    // time interval is solved.
+    CheckpointWriter writer;
+    const time_t wallstart = time(NULL);
+    time_t lastcheck = wallstart;
+
 	string m_output_filename_base=m_output_filename;		//ms785
 
 	// Loop over runs.
 	#ifdef USE_MPI
 	#else
-    for (unsigned int irun=0; irun!=m_nruns; ++irun) {
+    for (unsigned int irun=(m_restart ? restart.Run : 0); irun!=m_nruns; ++irun) {
 	#endif
 
 		#ifdef USE_MPI
@@ -425,13 +502,17 @@ void Simulator::RunSimulation(Mops::Reactor &r,
 		MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 		int irun=rank;
 		m_output_filename=m_output_filename_base+cstr(rank);				//ms785
-		openOutputFile();
+		openOutputFile(m_restart);
 
 		#endif
 
 		size_t runSeed = seed;
 		boost::hash_combine(runSeed, irun);
-		boost::mt19937 rng(runSeed);
+		Sweep::rng_type rng(runSeed);
+
+#ifdef SWEEP_PROFILE
+        Sweep::Profile::Reset();
+#endif
 
         // Start the CPU timing clock.
         m_cpu_start = clock();
@@ -443,11 +524,24 @@ void Simulator::RunSimulation(Mops::Reactor &r,
         // also reset the contents of the reactor
         r.Fill(*(initmix->Clone()), true);
 
+        // Continue the run from the checkpoint, if it was interrupted.
+        const bool resumed = m_restart && (irun == restart.Run);
+        if (resumed) {
+            restoreCheckpoint(restart, r, rng);
+            t2 = restart.Time;
+            icon = restart.Console;
+        }
+
         // Set up the ODE solver for this run.
         s.Reset(r);
 
         // Print initial conditions to the console.
-        printf("mops: Run number %d of %d.\n", irun+1, m_nruns);
+        if (resumed) {
+            printf("mops: Run number %d of %d continued from t = %g s.\n",
+                   irun+1, m_nruns, t2);
+        } else {
+            printf("mops: Run number %d of %d.\n", irun+1, m_nruns);
+        }
         m_console.PrintDivider();
         consoleOutput(r);
 
@@ -472,6 +566,10 @@ void Simulator::RunSimulation(Mops::Reactor &r,
         if (r.Mech()->ParticleMech().IsHybrid())
         {
             r.Mech()->ParticleMech().InitialisePNParticles(0.0, *r.Mixture(), r.Mech()->ParticleMech());
+            if (resumed) {
+                r.Mixture()->Particles().SetTotalParticleNumber();
+                r.Mixture()->Particles().RecalcPNPropertySums();
+            }
         }
 
 		// Check if particle terms are to be included in the energy balance
@@ -486,9 +584,10 @@ void Simulator::RunSimulation(Mops::Reactor &r,
 			r.Mixture()->setConstV(false);
 
         // Loop over the time intervals.
-        unsigned int global_step = 0;
-        timevector::const_iterator iint;
-        for (iint=m_times.begin(); iint!=m_times.end(); ++iint) {
+        unsigned int global_step = resumed ? restart.Step : 0;
+        timevector::const_iterator iint = m_times.begin();
+        if (resumed) iint += restart.Interval;
+        for (; iint!=m_times.end(); ++iint) {
             // Get the step size for this interval.
             dt = (*iint).StepSize();
 
@@ -526,7 +625,17 @@ void Simulator::RunSimulation(Mops::Reactor &r,
             //@todo Reinstate fractal dimension calculations for
             // the PAH-PP model
 
-            createSavePoint(r, global_step, irun);
+            // Pass the output of this interval to the writer thread.
+            m_filebuf.Flush();
+
+            if (m_write_save_points) createSavePoint(r, global_step, irun);
+
+            // Add the particle size distributions to the histograms.
+            if (!m_psd.IsEmpty()) {
+                m_psd.Accumulate(iint - m_times.begin(), *r.Mixture(),
+                                 r.Mech()->ParticleMech(), r.Time());
+            }
+
             if (s.GetLOIStatus() == true){
                 r.DestroyJac(m_loi_J, r.Mech()->GasMech().SpeciesCount());
             }
@@ -534,6 +643,38 @@ void Simulator::RunSimulation(Mops::Reactor &r,
             // Write the ensemble or gas-phase files
             if (m_write_ensemble_file) createEnsembleFile(r, global_step, irun);
 
+            // Take a checkpoint once enough wall-clock time has passed,
+            // unless the simulation is about to finish anyway.
+            const bool last = (irun + 1 == m_nruns) && (iint + 1 == m_times.end());
+            if ((m_checkpoint_interval >= 0.0) && !last) {
+                const time_t now = time(NULL);
+                const bool stop = (m_walltime >= 0.0) &&
+                                  (difftime(now, wallstart) >= m_walltime);
+                if (stop || (difftime(now, lastcheck) >= m_checkpoint_interval)) {
+                    Checkpoint chk;
+                    chk.Run = irun;
+                    chk.Interval = (iint - m_times.begin()) + 1;
+                    chk.Step = global_step;
+                    chk.Console = icon;
+                    chk.Time = t2;
+                    chk.Runtime = m_runtime;
+                    fillCheckpoint(r, rng, chk);
+
+                    ostringstream out(ios_base::out | ios_base::binary);
+                    chk.Serialize(out);
+                    string data = out.str();
+                    writer.Write(checkpointFile(), data);
+                    lastcheck = now;
+                }
+                if (stop) {
+                    writer.Wait();
+                    closeOutputFile();
+                    printf("mops: Stopped at t = %g s of run number %d after %.0f s "
+                           "of wall-clock time.\n", t2, irun+1, difftime(now, wallstart));
+                    return;
+                }
+            }
+
         } // number of time intervals
         if (s.GetLOIStatus() == true) {
             std::vector<std::string> rejects;
@@ -544,7 +685,16 @@ void Simulator::RunSimulation(Mops::Reactor &r,
         // Print run time to the console.
         printf("mops: Run number %d completed in %.1f s.\n", irun+1, m_runtime);
 
-        // Reset the process jump count
+#ifdef SWEEP_PROFILE
+        writeProfileCSV(r.Mech()->ParticleMech(), irun);
+#endif
+
+        // Add up and reset the process jump count
+        vector<unsigned int> accepted, fictitious;
+        r.Mech()->ParticleMech().GetJumpCount(accepted, fictitious);
+        for (unsigned int i=0; i!=accepted.size(); ++i) {
+            m_jumps += accepted[i] + fictitious[i];
+        }
         r.Mech()->ParticleMech().ResetJumpCount();
 
 		// currently this function is limited to PAH-PP model
@@ -564,6 +714,23 @@ void Simulator::RunSimulation(Mops::Reactor &r,
     closeOutputFile();
 	#endif
 
+    // All runs are complete, so the checkpoint is no longer needed.
+    writer.Wait();
+    if (m_checkpoint_interval >= 0.0) remove(checkpointFile().c_str());
+    m_finished = true;
+
+    // Write the histograms, averaged over all runs.
+    if (!m_psd.IsEmpty()) {
+	#ifdef USE_MPI
+        int nproc;
+        MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+        m_psd.ReduceRuns(0);
+        if (rank == 0) m_psd.Write(m_output_filename_base, m_times, nproc);
+	#else
+        m_psd.Write(m_output_filename, m_times, m_nruns);
+	#endif
+    }
+
     // If we have a PSR, clear any stream memory.
     if (r.SerialType() == Mops::Serial_PSR) {
         Mops::PSR* psr = dynamic_cast<Mops::PSR *>(&r);
@@ -913,6 +1080,9 @@ void Simulator::postProcessSimulation(
 
     // POST-PROCESS PSLs.
 
+    // The remaining output is read from the save points.
+    if (!m_write_save_points) return;
+
     // Now post-process the ensemble to find interested information, in this case, mass of Xmer
     if (MassSpectra())
         postProcessXmer(mech, times);
@@ -956,7 +1126,7 @@ void Simulator::postProcessSimulation(
 // FILE OUTPUT (protected).
 
 // Opens the simulation output file.
-void Simulator::openOutputFile() const
+void Simulator::openOutputFile(bool append) const
 {
     // SIMULATOR OUTPUT FILE
     // Build the simulation output file name.
@@ -964,11 +1134,10 @@ void Simulator::openOutputFile() const
 //	std::ostringstream ranstream;
 //	ranstream <<getpid();
 	//string fname = "/scratch/ms785/"+m_output_filename+ranstream.str()+".sim";
-    // Open the simulation output file.
-    m_file.open(fname.c_str(), ios_base::out | ios_base::trunc | ios_base::binary);
-
-    // Throw error if the output file failed to open.
-    if (!m_file.good()) {
+    // Open the simulation output file.  Existing files are extended when
+    // continuing from a checkpoint.
+    m_file.clear();
+    if (!m_filebuf.Open(fname, append)) {
         throw runtime_error("Failed to open file for simulation "
                             "output (Mops, Simulator::openOutputFile).");
     }
@@ -978,7 +1147,10 @@ void Simulator::openOutputFile() const
     string fsenname = m_output_filename + ".sen";
 
     // Open the sensitivity simulation output file.
-    m_senfile.open(fsenname.c_str(), ios_base::out | ios_base::trunc | ios_base::binary);
+    const ios_base::openmode mode = append ?
+        (ios_base::in | ios_base::out | ios_base::ate | ios_base::binary) :
+        (ios_base::out | ios_base::trunc | ios_base::binary);
+    m_senfile.open(fsenname.c_str(), mode);
 
     // Throw error if the output file failed to open.
     if (!m_senfile.good()) {
@@ -990,8 +1162,9 @@ void Simulator::openOutputFile() const
 // Closes the output file.
 void Simulator::closeOutputFile() const
 {
-    // Close the simulation output file.
-    m_file.close();
+    // Close the simulation output file, once the background thread
+    // has written it.
+    m_filebuf.Close();
     // Close the sensitivity output file.
     m_senfile.close();
 }
@@ -2278,6 +2451,71 @@ void Simulator::writePartTrackCSV(const std::string &filename,
     }
 }
 
+/*!
+ * The first rows give the time spent in each timed section of the sweep
+ * stepping algorithm, the following rows the DoProcess calls, accepted
+ * and fictitious jumps and time of each rate term.  Sections may contain
+ * others (Perform contains Doubling, for instance), so the shares add up
+ * to more than 100%.  After a restart the times cover only the part of
+ * the run since the restart, but the jump counts cover the whole run.
+ *
+ * @param[in]   mech    Mechanism defining the particle processes
+ * @param[in]   run     Run number
+ */
+void Simulator::writeProfileCSV(const Sweep::Mechanism &mech,
+                                unsigned int run) const
+{
+    Sweep::Profile::Summary sum;
+    Sweep::Profile::Collect(sum);
+
+    vector<unsigned int> accepted, fictitious;
+    mech.GetJumpCount(accepted, fictitious);
+    vector<string> names;
+    mech.GetTermNames(names);
+
+    CSV_IO csv(m_output_filename + "(" + cstr(run) + ")-profile.csv", true);
+
+    vector<string> row;
+    row.push_back("Name");
+    row.push_back("Type");
+    row.push_back("Calls");
+    row.push_back("Accepted");
+    row.push_back("Fictitious");
+    row.push_back("Time (s)");
+    row.push_back("Share (%)");
+    csv.Write(row);
+
+    const double total = (sum.Seconds > 0.0) ? sum.Seconds : 1.0;
+    for (int i=0; i!=Sweep::Profile::SectionCount; ++i) {
+        const double secs = sum.Time[i] / sum.TicksPerSecond;
+        row.clear();
+        row.push_back(Sweep::Profile::SectionName((Sweep::Profile::Section)i));
+        row.push_back("section");
+        row.push_back(boost::lexical_cast<string>(sum.Calls[i]));
+        row.push_back("");
+        row.push_back("");
+        row.push_back(cstr(secs));
+        row.push_back(cstr(100.0 * secs / total));
+        csv.Write(row);
+    }
+
+    for (unsigned int i=0; i!=names.size(); ++i) {
+        const Sweep::Profile::tick_type calls = (i < sum.TermCalls.size()) ? sum.TermCalls[i] : 0;
+        const double secs = (i < sum.TermTime.size()) ? sum.TermTime[i] / sum.TicksPerSecond : 0.0;
+        row.clear();
+        row.push_back(names[i]);
+        row.push_back("process");
+        row.push_back(boost::lexical_cast<string>(calls));
+        row.push_back(cstr(i < accepted.size() ? accepted[i] : 0));
+        row.push_back(cstr(i < fictitious.size() ? fictitious[i] : 0));
+        row.push_back(cstr(secs));
+        row.push_back(cstr(100.0 * secs / total));
+        csv.Write(row);
+    }
+
+    csv.Close();
+}
+
 
 // SAVE POINTS.
 
@@ -2357,6 +2595,76 @@ void Simulator::createEnsembleFile(const Reactor &r, unsigned int step,
     }
 }
 
+// CHECKPOINTS.
+
+// Returns the name of the checkpoint file.
+std::string Simulator::checkpointFile(void) const
+{
+#ifdef USE_MPI
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return m_output_filename + cstr(rank) + ".chk";
+#else
+    return m_output_filename + ".chk";
+#endif
+}
+
+// Copies the state of a run into a checkpoint.
+void Simulator::fillCheckpoint(const Reactor &r, const Sweep::rng_type &rng,
+                               Checkpoint &chk) const
+{
+    // The generator state is only defined in its text form.
+    ostringstream rngout;
+    rngout << rng;
+    chk.RNG = rngout.str();
+
+    ostringstream mixout(ios_base::out | ios_base::binary);
+    r.Mixture()->Serialize(mixout);
+    chk.Mixture = mixout.str();
+
+    ostringstream psdout(ios_base::out | ios_base::binary);
+    m_psd.Serialize(psdout);
+    chk.Histograms = psdout.str();
+
+    r.Mech()->ParticleMech().GetJumpCount(chk.ProcessJumps, chk.FictitiousJumps);
+
+    // Record the sizes of the output files.
+    m_file.flush();
+    m_senfile.flush();
+    string prefix = m_output_filename;
+#ifdef USE_MPI
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    prefix += cstr(rank);
+#endif
+    chk.AddFile(prefix + ".sim");
+    chk.AddFile(prefix + ".sen");
+    for (unsigned int i = 0; i != m_TrackParticlesName.size(); ++i) {
+        chk.AddFile(m_TrackParticlesName[i]);
+    }
+}
+
+// Restores a run from a checkpoint.  The reactor must already hold a
+// copy of the initial mixture, which provides the inflow and outflow
+// processes that are not part of the serialised mixture.
+void Simulator::restoreCheckpoint(const Checkpoint &chk, Reactor &r,
+                                  Sweep::rng_type &rng)
+{
+    istringstream rngin(chk.RNG);
+    rngin >> rng;
+
+    istringstream mixin(chk.Mixture, ios_base::in | ios_base::binary);
+    r.Mixture()->Deserialize(mixin, r.Mech()->ParticleMech());
+    if (r.Mech()->ParticleMech().IsHybrid()) {
+        r.Mixture()->Particles().InitialiseParticleNumberModel();
+    }
+
+    r.SetTime(chk.Time);
+    r.Mech()->ParticleMech().SetJumpCount(chk.ProcessJumps, chk.FictitiousJumps);
+    m_runtime = chk.Runtime;
+}
+
+
 // Reads a save point file.
 Reactor *const Simulator::readSavePoint(unsigned int step,
                                         unsigned int run,
@@ -2372,7 +2680,7 @@ Reactor *const Simulator::readSavePoint(unsigned int step,
     ifstream fin;
     fin.open(fname.c_str(), ios_base::in | ios_base::binary);
 
-    if (m_file.good()) {
+    if (fin.good()) {
         // Read the step and run number (for file validation).
         unsigned int fstep=0, frun=0;
         fin.read(reinterpret_cast<char*>(&fstep), sizeof(fstep));
@@ -2433,12 +2741,19 @@ void Simulator::postProcessPSLs(const Mechanism &mech,
 	// Open output files for all PSL save points.  Remember to
 	// write the header row as well.
 	vector<CSV_IO*> out(times.size(), NULL);
+	vector<PSLFileWriter*> binout(times.size(), NULL);
 	for (unsigned int i = 0; i != times.size(); ++i) {
 		double t = times[i].EndTime();
-		out[i] = new CSV_IO();
-		out[i]->Open(m_output_filename + "-psl(" +
-			cstr(t) + "s).csv", true);
-		out[i]->Write(header);
+		if (m_write_psl_csv) {
+			out[i] = new CSV_IO();
+			out[i]->Open(m_output_filename + "-psl(" +
+				cstr(t) + "s).csv", true);
+			out[i]->Write(header);
+		}
+		if (m_write_psl_binary) {
+			binout[i] = new PSLFileWriter(m_output_filename + "-psl(" +
+				cstr(t) + "s).bin", header);
+		}
 	}
 
 	// Loop over all time intervals.
@@ -2462,22 +2777,38 @@ void Simulator::postProcessPSLs(const Mechanism &mech,
 					stats.PSL(*(r->Mixture()->Particles().At(j)), mech.ParticleMech(),
 						times[i].EndTime(), psl,
 						1.0 / (r->Mixture()->SampleVolume()*scale));
-					// Output particle PSL to CSV file.
-					out[i]->Write(psl);
+					// Output particle PSL to the CSV and binary files.
+					if (out[i] != NULL) out[i]->Write(psl);
+					if (binout[i] != NULL) binout[i]->Write(psl);
 				}
 
 				// Draw particle images for tracked particles.
 				unsigned int n = min(m_ptrack_count, r->Mixture()->ParticleCount());
-				for (unsigned int j = 0; j != n; ++j) {
-					double t = times[i].EndTime();
-					string fname = m_output_filename + "-tem(" + cstr(t) +
-						"s, " + cstr(j) + ").pov";
+				if (m_ptrack_combined && n > 0) {
+					string fname = m_output_filename + "-tem(" +
+						cstr(times[i].EndTime()) + "s).pov";
 					std::ofstream file;
 					file.open(fname.c_str());
 
-					r->Mixture()->Particles().At(j)->writeParticlePOVRAY(file);
+					std::vector<const Sweep::Particle*> tracked(n);
+					for (unsigned int j = 0; j != n; ++j) {
+						tracked[j] = r->Mixture()->Particles().At(j);
+					}
+					Sweep::Imaging::ParticleImage::WriteBatchPOVRAY(file, tracked, 100);
 
 					file.close();
+				} else {
+					for (unsigned int j = 0; j != n; ++j) {
+						double t = times[i].EndTime();
+						string fname = m_output_filename + "-tem(" + cstr(t) +
+							"s, " + cstr(j) + ").pov";
+						std::ofstream file;
+						file.open(fname.c_str());
+
+						r->Mixture()->Particles().At(j)->writeParticlePOVRAY(file);
+
+						file.close();
+					}
 				}
 
 				// Print primary and connectivity data
@@ -2550,10 +2881,16 @@ void Simulator::postProcessPSLs(const Mechanism &mech,
 	}
 	primsout.Close();
 
-	//// Close output CSV files.
+	//// Close output CSV and binary files.
 	for (unsigned int i = 0; i != times.size(); ++i) {
-		out[i]->Close();
-		delete out[i];
+		if (out[i] != NULL) {
+			out[i]->Close();
+			delete out[i];
+		}
+		if (binout[i] != NULL) {
+			binout[i]->Close();
+			delete binout[i];
+		}
 	}
 }
 
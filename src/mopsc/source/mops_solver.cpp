@@ -102,8 +102,10 @@ void Solver::Initialise(Reactor &r)
 // Resets the solver to solve the given reactor.
 void Solver::Reset(Reactor &r)
 {
-    // Reset the ODE solver.
+    // Reset the ODE solver.  The ISAT table is kept, but its
+    // query counts are for this run only.
     m_ode.ResetSolver(r);
+    m_ode.ResetISATCounts();
     m_ode.SetATOL(m_atol);
     m_ode.SetRTOL(m_rtol);
 }
@@ -133,6 +135,11 @@ void Solver::SetRTOL(double rtol)
     m_ode.SetRTOL(rtol);
 }
 
+void Solver::SetISAT(double tol, unsigned int maxentries)
+{
+    m_ode.EnableISAT(tol, maxentries);
+}
+
 /*!
 Sets the solver status to true
 */
@@ -313,8 +320,11 @@ unsigned int Solver::GetNEquations() const
 // COMPUTATION TIME.
 
 // Returns the number of CT time variables tracked by this
-// solver type.
-unsigned int Mops::Solver::CT_Count(void) const {return 2;}
+// solver type.  The ISAT query counts are included when it is used.
+unsigned int Mops::Solver::CT_Count(void) const
+{
+    return m_ode.GetISAT().IsEnabled() ? 6 : 2;
+}
 
 // Outputs internal computation time data to the given
 // binary stream.
@@ -322,6 +332,13 @@ void Mops::Solver::OutputCT(std::ostream &out) const
 {
     out.write((char*)&m_tottime, sizeof(m_tottime));
     out.write((char*)&m_chemtime, sizeof(m_chemtime));
+
+    const ISAT &isat = m_ode.GetISAT();
+    if (isat.IsEnabled()) {
+        double n[4] = {(double)isat.Retrieves(), (double)isat.Grows(),
+                       (double)isat.Adds(), (double)isat.Directs()};
+        out.write((char*)n, sizeof(n));
+    }
 }
 
 // Attach sensitivity to ODE_Solver by making copy.
@@ -347,6 +364,12 @@ void Solver::CT_Names(vector<string> &names, unsigned int start) const
     // Add names to output array.
     *(i++) = "Total Comput. Time (s)";
     *(i++) = "ODE (gas-phase) Comput. Time (s)";
+    if (m_ode.GetISAT().IsEnabled()) {
+        *(i++) = "ISAT Retrieves";
+        *(i++) = "ISAT Grows";
+        *(i++) = "ISAT Adds";
+        *(i++) = "ISAT Direct Evaluations";
+    }
 }
 
 
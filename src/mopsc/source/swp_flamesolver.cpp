@@ -41,6 +41,7 @@
 
 #include "swp_flamesolver.h"
 #include "swp_gas_profile.h"
+#include "gpc_gas_profile_io.h"
 #include "mops_timeinterval.h"
 #include "mops_reactor.h"
 
@@ -90,7 +91,8 @@ void FlameSolver::SetEndConditions(bool val)
 
 // PROFILE INPUT.
 
-// Reads a flame gas-phase profile from a TAB formatted file.
+// Reads a flame gas-phase profile from a TAB formatted file, or from a
+// binary profile written by camflow or the gasprofileToBinary utility.
 // Species concentrations should be expressed in mole fractions with molar
 // concentrations being inferred from the temperature and pressure.  This
 // rescaling means that quantities proportional to the mole fractions, such
@@ -102,261 +104,199 @@ void FlameSolver::LoadGasProfile(const std::string &file, Mops::Mechanism &mech)
 {
     // Clear the current gas-phase profile.
     m_gas_prof.clear();
-	
-    // Open the file to read.
-    ifstream fin(file.c_str(), ios::in);
-    if (!fin.good()) {
-        throw runtime_error("Unable to open gas profile input "
-                            "file (Mops, Sweep::FlameSolver::LoadGasProfile).");
-    }
-
-    // Variables read from file.
-    vector<string> subs;
-    string delim = ",\t \r"; // Possible file delimiters (comma, tab and space).
-    string line;
-
-    // Get the first line (should be the header defining the columns).
-    if (!getline(fin, line).eof()) {
-
-        // Split the line to get the column headings.
-        split(line, subs, delim);
-
-        // Get important column indices (time, temperature and pressure).
-        int tcol=-1, Tcol=-1, Pcol=-1, Acol = -1, Rcol=-1;
-        tcol = findinlist(string("Time"), subs);
-        if(tcol < 0)
-            tcol = findinlist(string("Time[s]"),subs);
-
-        Tcol = findinlist(string("T"), subs);
-        if(Tcol < 0)
-            Tcol = findinlist(string("T[K]"), subs);
-
-        Pcol = findinlist(string("P"), subs);
-        Acol = findinlist(string("Alpha"), subs);
-        Rcol = findinlist(string("wdotA4"), subs);
-
-		//! Columns necessary for post-process with stagnation flame transport correction
-		int ucol=-1,vcol=-1,Diffcol= -1;
-		// Convective velocity
-		ucol = findinlist(string("ConvectiveVelocity[m/s]"), subs);
-		// Thermophoretic velocity
-		vcol = findinlist(string("ThermophoreticVelocity[m/s]"), subs);
-		// Diffusion term
-		Diffcol = findinlist(string("DiffusionTerm"), subs);
-		// if velocity columns are supplied than turn on stagnation flame correction
-		if (ucol > 0 && vcol > 0){
-			m_stagnation = true;
-			cout << "Stagnation flame correction turned on. \n";
-			if(Diffcol < 0) cout << "Diffusion correction not supplied. \n";
-		}
-
-        // Columns to ignore, but which are useful to have in files for brush compatibility
-        int Xcol = findinlist(string("X[cm]"), subs);
-        int Dcol = findinlist(string("RHO[g/cm3]"), subs);
-        int Vcol = findinlist(string("V[cm/s]"), subs);
 
-        int Gcol = findinlist(string("GradT"), subs);
-        if(Gcol < 0)
-            Gcol = findinlist(string("GradT[K/cm]"), subs);
+    // Read the file; binary profiles are memory-mapped rather than parsed.
+    boost::shared_ptr<const Sprog::IO::GasProfileFile> prof =
+        Sprog::IO::GasProfileFile::Open(file);
+    vector<string> subs = prof->Columns();
+
+    // Get important column indices (time, temperature and pressure).
+    int tcol=-1, Tcol=-1, Pcol=-1, Acol = -1, Rcol=-1;
+    tcol = findinlist(string("Time"), subs);
+    if(tcol < 0)
+        tcol = findinlist(string("Time[s]"),subs);
+
+    Tcol = findinlist(string("T"), subs);
+    if(Tcol < 0)
+        Tcol = findinlist(string("T[K]"), subs);
+
+    Pcol = findinlist(string("P"), subs);
+    Acol = findinlist(string("Alpha"), subs);
+    Rcol = findinlist(string("wdotA4"), subs);
+
+	//! Columns necessary for post-process with stagnation flame transport correction
+	int ucol=-1,vcol=-1,Diffcol= -1;
+	// Convective velocity
+	ucol = findinlist(string("ConvectiveVelocity[m/s]"), subs);
+	// Thermophoretic velocity
+	vcol = findinlist(string("ThermophoreticVelocity[m/s]"), subs);
+	// Diffusion term
+	Diffcol = findinlist(string("DiffusionTerm"), subs);
+	// if velocity columns are supplied than turn on stagnation flame correction
+	if (ucol > 0 && vcol > 0){
+		m_stagnation = true;
+		cout << "Stagnation flame correction turned on. \n";
+		if(Diffcol < 0) cout << "Diffusion correction not supplied. \n";
+	}
 
+    // Columns to ignore, but which are useful to have in files for brush compatibility
+    int Xcol = findinlist(string("X[cm]"), subs);
+    int Dcol = findinlist(string("RHO[g/cm3]"), subs);
+    int Vcol = findinlist(string("V[cm/s]"), subs);
 
-        // Check that the file contains required columns.
-        if (tcol < 0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no Time "
-                                "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
-        }
-        if (Tcol < 0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no temperature "
-                                "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
-        }
-        if (Pcol < 0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no pressure "
-                                "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
-        }
+    int Gcol = findinlist(string("GradT"), subs);
+    if(Gcol < 0)
+        Gcol = findinlist(string("GradT[K/cm]"), subs);
 
-        if (Acol < 0 && Rcol <0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no alpha "
-                                "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
-        }
 
-        // All other columns are chemical species.  Add them, and note
-        // their columns.
-        map<unsigned int,int> spcols;
-        for (int i=0; (unsigned)i!=subs.size(); ++i) {
-            if ((i!=tcol) && (i!=Tcol) && (i!=Pcol) && (i!=Acol) && (i!=Rcol) &&
-                (i!=Xcol) && (i!=Dcol) && (i!=Vcol) && (i!=Gcol) &&
-				(i!=ucol) && (i!=vcol) && (i!=Diffcol)) {
-                // Try to find this species in the mechanism
-                const int speciesMechIndex = mech.GasMech().FindSpecies(subs[i]);
-
-                if(speciesMechIndex < 0) {
-                    std::ostringstream msg("Failed to find species ");
-                    msg << subs[i] << " in mechanism (Mops, Sweep::FlameSolver::LoadGasProfile).";
-                    throw std::runtime_error(msg.str());
-                }
-                // Found species
-                spcols[i] = speciesMechIndex;
-            }
-        }
+    // Check that the file contains required columns.
+    if (tcol < 0) {
+        throw runtime_error("Gas-phase profile contains no Time "
+                            "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
+    }
+    if (Tcol < 0) {
+        throw runtime_error("Gas-phase profile contains no temperature "
+                            "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
+    }
+    if (Pcol < 0) {
+        throw runtime_error("Gas-phase profile contains no pressure "
+                            "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
+    }
 
-        // riap For logging input in way that should match PSDF_input.dat files
-        /*unsigned int logIndices[7];
-        logIndices[0] = mech.FindSpecies("C2H2");
-        logIndices[1] = mech.FindSpecies("H2");
-        logIndices[2] = mech.FindSpecies("H");
-        logIndices[3] = mech.FindSpecies("O2");
-        logIndices[4] = mech.FindSpecies("OH");
-        logIndices[5] = mech.FindSpecies("H2O");
-        logIndices[6] = mech.FindSpecies("A4");
-        unsigned int logIndices[14];
-        logIndices[0]  = mech.FindSpecies("H2");
-        logIndices[1]  = mech.FindSpecies("H");
-        logIndices[2]  = mech.FindSpecies("O");
-        logIndices[3]  = mech.FindSpecies("O2");
-        logIndices[4]  = mech.FindSpecies("OH");
-        logIndices[5]  = mech.FindSpecies("H2O");
-        logIndices[6]  = mech.FindSpecies("CH4");
-        logIndices[7]  = mech.FindSpecies("CO");
-        logIndices[8]  = mech.FindSpecies("CO2");
-        logIndices[9]  = mech.FindSpecies("C2H2");
-        logIndices[10] = mech.FindSpecies("C2H4");
-        logIndices[11] = mech.FindSpecies("AR");
-        logIndices[12] = mech.FindSpecies("N2");
-        logIndices[13] = mech.FindSpecies("A4");*/
-
-        // Now we can read the profile.
-        while(!getline(fin, line).eof()) {
-            // Set t=0 and create a new IdealGas object.
-            double t = 0.0;
-            double T = 0.0;
-            double P = 0.0;
-            double alpha = 0.0;
-            double PAHRate = 0.0;
-			double u_conv = 0.0;
-			double v_thermo = 0.0;
-			double diffusion_term = 0.0;
-            GasPoint gpoint(mech.GasMech().Species());
-
-            // Split the line by columns.
-            split(line, subs, delim);
-
-            // Check that the mole fractions sum to 1
-            double checkSum = 0.0;
-
-            // Loop over all the elements in the line and save them
-            // to the correct gas-phase variable.
-            for (int i=0; (unsigned)i!=subs.size(); ++i) {
-                if (i==tcol) {
-                    // This is the Time column.
-                    t = cdble(subs[i]);
-                    gpoint.Time = t;
-                } else if (i==Tcol) {
-                    // This is the temperature column.
-                    T = cdble(subs[i]);
-                } else if (i==Pcol) {
-                    // This is the pressure column.
-                    P = cdble(subs[i]);
-                } else if (i==Acol) {
-                    alpha = cdble(subs[i]);
-                } else if (i==Rcol) {
-                    PAHRate = cdble(subs[i]);
-				} else if (i==ucol) {
-					//this is the convective velocity column
-					u_conv = cdble(subs[i]);
-				} else if (i==vcol) {
-					v_thermo = cdble(subs[i]);
-				} else if (i==Diffcol) {
-					diffusion_term = cdble(subs[i]);
-                } else {
-                    // This is a gas-phase species column.
-                    map<unsigned int,int>::iterator isp = spcols.find(i);
-                    if (isp != spcols.end()) {
-                        const double frac = cdble(subs[i]);
-                        assert(isp->second >= 0);
-                        gpoint.Gas.RawData()[isp->second] = frac;
-                        checkSum += frac;
-                    }
-                }
-            }
+    if (Acol < 0 && Rcol <0) {
+        throw runtime_error("Gas-phase profile contains no alpha "
+                            "column (Mops, Sweep::FlameSolver::LoadGasProfile).");
+    }
 
-            if((checkSum < 0.997) || checkSum > 1.003) {
-                std::ostringstream msg;
-                msg << "Mole fractions sum to " << checkSum
-                    << ", but should sum to 1.000 (FlameSolver::LoadGasProfile)";
+    // All other columns are chemical species.  Note their columns and
+    // the species they hold.
+    vector<unsigned int> spcols;
+    vector<int> spindices;
+    for (int i=0; (unsigned)i!=subs.size(); ++i) {
+        if ((i!=tcol) && (i!=Tcol) && (i!=Pcol) && (i!=Acol) && (i!=Rcol) &&
+            (i!=Xcol) && (i!=Dcol) && (i!=Vcol) && (i!=Gcol) &&
+			(i!=ucol) && (i!=vcol) && (i!=Diffcol)) {
+            // Try to find this species in the mechanism
+            const int speciesMechIndex = mech.GasMech().FindSpecies(subs[i]);
+
+            if(speciesMechIndex < 0) {
+                std::ostringstream msg("Failed to find species ");
+                msg << subs[i] << " in mechanism (Mops, Sweep::FlameSolver::LoadGasProfile).";
                 throw std::runtime_error(msg.str());
             }
+            // Found species
+            spcols.push_back(i);
+            spindices.push_back(speciesMechIndex);
+        }
+    }
 
-            // Set up the gas-phase by setting temperature, pressure and
-            // normalising the mixture fractions.
-            // TODO:  This will give the wrong component densities
-            //        unless all species are specified!
-            gpoint.Gas.SetTemperature(T);
-            gpoint.Gas.SetPressure(P*1.0e5);//also set the molar density of gas mixture
-            gpoint.Gas.Normalise();
-
-			//! If using the sample volume correction (for a stagnation flame) 
-			//! then set the convective and  thermophoretic velocities, and diffusion term
-			if(m_stagnation == true){
-				gpoint.Gas.SetConvectiveVelocity(u_conv);
-				gpoint.Gas.SetThermophoreticVelocity(v_thermo);
-				if(Diffcol > 0) {
-					gpoint.Gas.SetDiffusionTerm(diffusion_term);
-				}else{
-					// If diffusion term not supplied then set to 0
-					gpoint.Gas.SetDiffusionTerm(0.0);
-				}
-			}else{
-				// set terms to 0
-				gpoint.Gas.SetConvectiveVelocity(0.0);
-				gpoint.Gas.SetThermophoreticVelocity(0.0);
-				gpoint.Gas.SetDiffusionTerm(0.0);
-			}
-
-            //! If postprocessing based on the molar rate of production by
-            //! chemical reaction of the inception species per unit volume
-            //! wdotA4 (mol/cm3/s), PAHRate determines the rate at which the
-            //! inception species is inserted into the ensemble. Otherwise it
-            //! is not required; the number of stochastic particles made up of
-            //! a single primary corresponding to the inception species is
-            //! adjusted to match the inception species concentration in
-            //! FlameSolver::Solve.
-            if (mech.ParticleMech().Postprocessing() == ParticleModel::wdotA4) {
-                gpoint.Gas.SetPAHFormationRate(PAHRate*1E6);    //!< Convert from mol/(cm3*s) to mol/(m3*s).
-            } else {
-                gpoint.Gas.SetPAHFormationRate(PAHRate*0);      //!< Explicitly set to 0 in case the wdotA4 column in the gasphase.inp file is non-zero.
-            }
+    // riap For logging input in way that should match PSDF_input.dat files
+    /*unsigned int logIndices[7];
+    logIndices[0] = mech.FindSpecies("C2H2");
+    logIndices[1] = mech.FindSpecies("H2");
+    logIndices[2] = mech.FindSpecies("H");
+    logIndices[3] = mech.FindSpecies("O2");
+    logIndices[4] = mech.FindSpecies("OH");
+    logIndices[5] = mech.FindSpecies("H2O");
+    logIndices[6] = mech.FindSpecies("A4");
+    unsigned int logIndices[14];
+    logIndices[0]  = mech.FindSpecies("H2");
+    logIndices[1]  = mech.FindSpecies("H");
+    logIndices[2]  = mech.FindSpecies("O");
+    logIndices[3]  = mech.FindSpecies("O2");
+    logIndices[4]  = mech.FindSpecies("OH");
+    logIndices[5]  = mech.FindSpecies("H2O");
+    logIndices[6]  = mech.FindSpecies("CH4");
+    logIndices[7]  = mech.FindSpecies("CO");
+    logIndices[8]  = mech.FindSpecies("CO2");
+    logIndices[9]  = mech.FindSpecies("C2H2");
+    logIndices[10] = mech.FindSpecies("C2H4");
+    logIndices[11] = mech.FindSpecies("AR");
+    logIndices[12] = mech.FindSpecies("N2");
+    logIndices[13] = mech.FindSpecies("A4");*/
+
+    // Now we can read the profile.
+    m_gas_prof.reserve(prof->PointCount());
+    for (size_t k=0; k!=prof->PointCount(); ++k) {
+        const double *row = prof->Row(k);
+        GasPoint gpoint(mech.GasMech().Species());
+        gpoint.Time = row[tcol];
+        const double T = row[Tcol];
+        const double P = row[Pcol];
+        const double alpha = (Acol >= 0) ? row[Acol] : 0.0;
+        const double PAHRate = (Rcol >= 0) ? row[Rcol] : 0.0;
+		const double u_conv = (ucol >= 0) ? row[ucol] : 0.0;
+		const double v_thermo = (vcol >= 0) ? row[vcol] : 0.0;
+		const double diffusion_term = (Diffcol > 0) ? row[Diffcol] : 0.0;
+
+        // Copy the mole fractions, checking that they sum to 1.
+        double checkSum = 0.0;
+        for (size_t j=0; j!=spcols.size(); ++j) {
+            const double frac = row[spcols[j]];
+            gpoint.Gas.RawData()[spindices[j]] = frac;
+            checkSum += frac;
+        }
 
-            gpoint.Gas.SetAlpha(alpha);
+        if((checkSum < 0.997) || checkSum > 1.003) {
+            std::ostringstream msg;
+            msg << "Mole fractions sum to " << checkSum
+                << ", but should sum to 1.000 (FlameSolver::LoadGasProfile)";
+            throw std::runtime_error(msg.str());
+        }
 
-            // Add the profile point.
-            m_gas_prof.push_back(gpoint);
+        // Set up the gas-phase by setting temperature, pressure and
+        // normalising the mixture fractions.
+        // TODO:  This will give the wrong component densities
+        //        unless all species are specified!
+        gpoint.Gas.SetTemperature(T);
+        gpoint.Gas.SetPressure(P*1.0e5);//also set the molar density of gas mixture
+        gpoint.Gas.Normalise();
+
+		//! If using the sample volume correction (for a stagnation flame) 
+		//! then set the convective and  thermophoretic velocities, and diffusion term
+		if(m_stagnation == true){
+			gpoint.Gas.SetConvectiveVelocity(u_conv);
+			gpoint.Gas.SetThermophoreticVelocity(v_thermo);
+			// If diffusion term not supplied then it is 0
+			gpoint.Gas.SetDiffusionTerm(diffusion_term);
+		}else{
+			// set terms to 0
+			gpoint.Gas.SetConvectiveVelocity(0.0);
+			gpoint.Gas.SetThermophoreticVelocity(0.0);
+			gpoint.Gas.SetDiffusionTerm(0.0);
+		}
 
-            // Output in PSDF_input.dat format
-            //std::cout << t << '\t' << std::scientific << std::setprecision(6) << T << '\t';
-            //for(unsigned int j = 0; j != 14; ++j) {
-            //for(unsigned int j = 0; j != 5; ++j) {
-            //    std::cout << gpoint.Gas.MolarConc(logIndices[j]) * 1e-6 << '\t';
-            //}
-            //std::cout << alpha << '\t' << gpoint.Gas.Pressure() << '\t'
-            //          << gpoint.Gas.Density() * 1e-6 << '\n';
+        //! If postprocessing based on the molar rate of production by
+        //! chemical reaction of the inception species per unit volume
+        //! wdotA4 (mol/cm3/s), PAHRate determines the rate at which the
+        //! inception species is inserted into the ensemble. Otherwise it
+        //! is not required; the number of stochastic particles made up of
+        //! a single primary corresponding to the inception species is
+        //! adjusted to match the inception species concentration in
+        //! FlameSolver::Solve.
+        if (mech.ParticleMech().Postprocessing() == ParticleModel::wdotA4) {
+            gpoint.Gas.SetPAHFormationRate(PAHRate*1E6);    //!< Convert from mol/(cm3*s) to mol/(m3*s).
+        } else {
+            gpoint.Gas.SetPAHFormationRate(PAHRate*0);      //!< Explicitly set to 0 in case the wdotA4 column in the gasphase.inp file is non-zero.
         }
 
-        // Close the input file.
-        fin.close();
+        gpoint.Gas.SetAlpha(alpha);
 
-        // Sort the profile by time.
-        SortGasProfile(m_gas_prof);
+        // Add the profile point.
+        m_gas_prof.push_back(gpoint);
 
-    } else {
-        // There was no data in the file.
-        fin.close();
-        throw runtime_error("Input file contains no data "
-                            "(Mops, Sweep::FlameSolver::LoadGasProfile).");
+        // Output in PSDF_input.dat format
+        //std::cout << t << '\t' << std::scientific << std::setprecision(6) << T << '\t';
+        //for(unsigned int j = 0; j != 14; ++j) {
+        //for(unsigned int j = 0; j != 5; ++j) {
+        //    std::cout << gpoint.Gas.MolarConc(logIndices[j]) * 1e-6 << '\t';
+        //}
+        //std::cout << alpha << '\t' << gpoint.Gas.Pressure() << '\t'
+        //          << gpoint.Gas.Density() * 1e-6 << '\n';
     }
+
+    // Sort the profile by time.
+    SortGasProfile(m_gas_prof);
 }
 
 
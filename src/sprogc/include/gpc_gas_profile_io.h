@@ -0,0 +1,161 @@
+/*
+  Project:        sprog (gas-phase chemical kinetics).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Reads and writes the gas-phase profiles used by the flame solvers:
+    tables with one row for each point of a flame, whose columns hold
+    the time, temperature, pressure, other flame properties and the
+    species mole fractions.
+
+    Profiles are either the usual text files, with a header line of
+    column names, or binary files of the same table.  A binary file is
+    laid out as follows, in native byte order:
+
+      char      magic[8]       "SPRGPROF"
+      uint32    version        1
+      uint32    column count   n
+      uint64    point count    m
+      uint64    data offset    from the start of the file, a multiple of 8
+      double    1.0            to detect files of another byte order
+      char[]    column names   n NUL-terminated strings
+      double    data[m][n]     at the data offset, one row for each point
+
+    so that binary files can be memory-mapped and read without parsing.
+
+  Licence:
+    This file is part of "sprog".
+
+    sprog is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef GPC_GAS_PROFILE_IO_H
+#define GPC_GAS_PROFILE_IO_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+namespace Sprog
+{
+namespace IO
+{
+//! A gas-phase profile table read from a text or binary file.
+class GasProfileFile
+{
+public:
+    //! Reads a profile.  Binary files are memory-mapped read-only, and
+    //! all readers of the same file in the process share one mapping.
+    static boost::shared_ptr<const GasProfileFile> Open(const std::string &filename);
+
+    //! Is the file a binary profile?
+    static bool IsBinary(const std::string &filename);
+
+    //! Converts a text profile to a binary one.
+    static void Convert(const std::string &textfile, const std::string &binfile);
+
+    // Destructors.
+    ~GasProfileFile(void);
+
+    //! Column names, in the order of the values in a row.
+    const std::vector<std::string> &Columns(void) const {return m_columns;}
+
+    //! Index of the named column, or -1 if there is none.
+    int FindColumn(const std::string &name) const;
+
+    //! Number of points (rows) in the profile.
+    std::size_t PointCount(void) const {return m_npoints;}
+
+    //! Values of the columns at point i.
+    const double *Row(std::size_t i) const {return m_data + i * m_columns.size();}
+
+    //! Is the profile memory-mapped from a binary file?
+    bool IsMapped(void) const {return m_region != NULL;}
+
+private:
+    // Profiles are only created by Open.
+    GasProfileFile(void);
+    GasProfileFile(const GasProfileFile &);
+    GasProfileFile &operator=(const GasProfileFile &);
+
+    //! Parses a text profile.
+    void readText(const std::string &filename);
+
+    //! Maps a binary profile.
+    void mapBinary(const std::string &filename);
+
+    //! Column names.
+    std::vector<std::string> m_columns;
+
+    //! Number of rows.
+    std::size_t m_npoints;
+
+    //! The rows, either in m_values or in the mapped file.
+    const double *m_data;
+
+    //! Values of a text profile.
+    std::vector<double> m_values;
+
+    //! Mapping of a binary profile.
+    boost::scoped_ptr<boost::interprocess::mapped_region> m_region;
+};
+
+//! Writes a binary gas-phase profile one point at a time.
+class GasProfileWriter
+{
+public:
+    //! Creates the file and writes the column names.
+    GasProfileWriter(const std::string &filename,
+                     const std::vector<std::string> &columns);
+
+    //! Closes the file if Close has not been called.
+    ~GasProfileWriter(void);
+
+    //! Appends a point; row holds one value for each column.
+    void Write(const double *row);
+    void Write(const std::vector<double> &row);
+
+    //! Writes the point count and closes the file.
+    void Close(void);
+
+private:
+    std::string m_filename;
+    std::ofstream m_out;
+    std::size_t m_ncolumns;
+    unsigned long long m_npoints;
+};
+} // IO namespace
+} // Sprog namespace
+
+#endif
@@ -267,6 +267,10 @@ public:
     // Returns a pointer to the ith reaction. Returns NULL if i is invalid.
     Kinetics::Reaction * GetReactions(unsigned int i);
 
+    // Rebuilds the rate parameter arrays of the reaction set.  Must be
+    // called after changing reactions through GetReactions().
+    void CompileRateParams(void);
+
     // Adds an empty reaction to the mechanism.
     Kinetics::Reaction *const AddReaction(void);
 
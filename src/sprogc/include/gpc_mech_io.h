@@ -44,6 +44,7 @@
 #define GPC_MECH_PARSER_H
 
 #include <string>
+#include <vector>
 #include "gpc_mech.h"
 #include "chemkinReader.h"
 
@@ -80,7 +81,38 @@ public:
 		const int verbose = 0,
         const std::string &transFile = "NOT READ"
 	);
-	
+
+    //! Read in a mechanism as ReadChemkin does, through a binary cache
+    //! in directory cachedir keyed on the contents of the input files
+    static void ReadChemkinCached
+    (
+        const std::string &cachedir,
+        const std::string &filename,
+        Sprog::Mechanism &mech,
+        const std::string &thermofile,
+        const int verbose = 0,
+        const std::string &transFile = "NOT READ"
+    );
+
+    //! Read in a mechanism with surface chemistry through a binary cache
+    static void ReadChemkinCached
+    (
+        const std::string &cachedir,
+        const std::string &filename,
+        const std::string &Surffilename,
+        Sprog::Mechanism &mech,
+        const std::string &thermofile,
+        const std::string &Surfthermofile,
+        const int verbose = 0,
+        const std::string &transFile = "NOT READ"
+    );
+
+    //! Path of the cache file in cachedir for the given input files
+    static std::string CacheFileName
+    (
+        const std::string &cachedir,
+        const std::vector<std::string> &files
+    );
 		
 private:
 
@@ -103,6 +135,13 @@ private:
     static void parseCK_Units(
         const std::string &rxndef,          // String containing the REACTION statement.
         Sprog::Kinetics::ARRHENIUS &scale); // Scaling factors.
+
+    // Loads a cached mechanism, returning false if the cache file does
+    // not exist or cannot be read.
+    static bool readCache(const std::string &cachefile, Sprog::Mechanism &mech);
+
+    // Writes a mechanism to a cache file.
+    static void writeCache(const std::string &cachefile, const Sprog::Mechanism &mech);
    
     
 
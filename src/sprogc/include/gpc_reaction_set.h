@@ -57,6 +57,22 @@ class Mechanism; // Forward declare Mechanism class.
 
 namespace Kinetics
 {
+/*!
+ * Scratch vectors for the rate calculations, owned by the caller.  The
+ * workspace versions of the ReactionSet rate functions only read the
+ * mechanism and write into a workspace, so one Mechanism can be used from
+ * many threads at once provided each thread has its own workspace and its
+ * own gas-phase (thermo) object.
+ */
+struct RateWorkspace
+{
+    fvector kf, kr;     // Forward and reverse rate constants.
+    fvector tbconcs;    // Third-body concentrations.
+    fvector Gs;         // Dimensionless Gibbs free energies of the species.
+    fvector rop;        // Rates of progress.
+    fvector rfwd, rrev; // Forward and reverse rates.
+};
+
 //! Calculates reaction data
 class ReactionSet
 {
@@ -97,6 +113,15 @@ public:
     void Clear(void);
 
 
+    // RATE PARAMETERS.
+
+    // Rebuilds the contiguous rate parameter arrays used by the rate
+    // constant calculations.  AddReaction() keeps them up to date, but
+    // this must be called after the parameters of reactions already in
+    // the set have been changed.
+    void CompileRateParams(void);
+
+
 	
     // SPECIES MOLAR PRODUCTION RATES.
 
@@ -255,6 +280,44 @@ public:
         ) const;
 
 
+    // RATES WITH A CALLER-OWNED WORKSPACE.
+
+    //! Sizes the vectors of a workspace for this reaction set.
+    void InitWorkspace(RateWorkspace &wk) const;
+
+    //! Calculates the rate constants into wk.kf and wk.kr (and wk.Gs).
+    void GetRateConstants(
+        double T,              // The mixture temperature.
+        double density,        // Mixture molar density.
+        const double *const x, // Species mole fractions.
+        unsigned int n,      // Number of values in x array.
+        const Sprog::Thermo::ThermoInterface &thermo, // Thermodynamics interface.
+        RateWorkspace &wk    // Workspace for the results.
+        ) const;
+
+    //! Calculates the rates of progress into wk.rop, wk.rfwd and wk.rrev.
+    void GetRatesOfProgress(
+        double T,              // The mixture temperature.
+        double density,        // Mixture molar density.
+        const double *const x, // Species mole fractions.
+        unsigned int n,      // Number of values in x array.
+        const Sprog::Thermo::ThermoInterface &thermo, // Thermodynamics interface.
+        RateWorkspace &wk    // Workspace for the results.
+        ) const;
+
+    //! Calculates the molar production rates of all species.  Returns
+    //! the total molar production rate.
+    double GetMolarProdRates(
+        double T,              // The mixture temperature.
+        double density,        // Mixture molar density.
+        const double *const x, // Species mole fractions.
+        unsigned int n,      // Number of values in x array.
+        const Sprog::Thermo::ThermoInterface &thermo, // Thermodynamics interface.
+        RateWorkspace &wk,   // Workspace for the intermediate results.
+        fvector &wdot        // Return vector for molar prod. rates.
+        ) const;
+
+
     // JACOBIAN EVALUATION.
 
     // Calculates the Jacobian matrix for a constant volume, adiabatic
@@ -308,6 +371,11 @@ public:
         ar & m_rxns & m_rev_rxns
            & m_tb_rxns & m_fo_rxns
            & m_lt_rxns & m_revlt_rxns & m_surface_rxns & m_ford_rxns & m_cov_rxns & m_stick_rxns & m_mottw_rxns & m_mech;
+
+        // The rate parameter arrays are not stored.
+        if (Archive::is_loading::value) {
+            CompileRateParams();
+        }
     }
 
     // Writes the element to a binary data stream.
@@ -328,6 +396,19 @@ protected:
         fvector &kr        // Return vector for reverse rate constants.
         ) const;
 
+    // Calculates the forward and reverse rate constants using the
+    // given third-body concentration workspace.
+    void calcRateConstants(
+        double T,              // The mixture temperature.
+        double density,        // Mixture molar density.
+        const double *const x, // Species mole fractions.
+        unsigned int n,      // Number of values in x array.
+        const fvector &Gs,   // Dimensionless Gibbs free energy of each species (1/mol).
+        fvector &kf,         // Return vector for forward rate constants.
+        fvector &kr,         // Return vector for reverse rate constants.
+        fvector &tbconcs     // Workspace for third-body concentrations.
+        ) const;
+
     // Calculates the concentration dependent COVERAGE rate constant expression 
     void calcCOVERAGE(
 				double T,            // The mixture temperature. 
@@ -366,6 +447,12 @@ protected:
     // Clears all memory used by the set.
     void releaseMemory(void);
 
+    // Appends the rate parameters of the jth reaction to the arrays.
+    void compileRateParams(unsigned int j);
+
+    // Clears the rate parameter arrays.
+    void clearRateParams(void);
+
 private:
     // In the following map the key is the index in the vector of all reactions.
     typedef std::vector<unsigned int> RxnMap;
@@ -383,8 +470,31 @@ private:
     RxnMap m_stick_rxns;  // Map of reactions with STICK 
     RxnMap m_mottw_rxns;  // Map of reactions with Mott-Wise 
 
+    // Rate parameters copied out of the reactions into contiguous arrays,
+    // so that the rate constant loops do not go through the reaction
+    // objects.  The forward parameters are held for every reaction; the
+    // other groups run parallel to their reaction maps.  Species lists are
+    // stored one reaction after another, reaction m using the entries from
+    // start[m] to start[m+1].
+    fvector m_arrA, m_arrn, m_arrE;  // Forward Arrhenius parameters.
+    fvector m_revA, m_revn, m_revE;  // Explicit reverse parameters (m_rev_rxns).
+    RxnMap m_eq_rxns;    // Map of reversible reactions without explicit reverse parameters.
+    fvector m_eqStoich;  // Total stoichiometry of the m_eq_rxns reactions.
+    RxnMap m_eqStart, m_eqSp; // Species lists of the m_eq_rxns reactions.
+    fvector m_eqMu;      // Reactant (positive) and product (negative) coefficients.
+    fvector m_ltB, m_ltC;        // Landau Teller parameters (m_lt_rxns).
+    fvector m_revltB, m_revltC;  // Reverse Landau Teller parameters (m_revlt_rxns).
+    RxnMap m_tbStart, m_tbSp;    // Third-body species lists (m_tb_rxns).
+    fvector m_tbEff;             // Third-body efficiencies less one.
+    fvector m_foA, m_fon, m_foE; // Low pressure limits (m_fo_rxns).
+
     // Pointer to mechanism to which this ReactionSet belongs.
     Sprog::Mechanism *m_mech;
+
+    // Workspace for the rate functions which do not take one.  Those
+    // functions must not be called from several threads at once; use
+    // the RateWorkspace versions instead.
+    mutable RateWorkspace m_wk;
 };
 }
 }
@@ -0,0 +1,328 @@
+/*
+  Project:        sprog (gas-phase chemical kinetics).
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the GasProfileFile and GasProfileWriter classes
+    declared in the gpc_gas_profile_io.h header file.
+
+  Licence:
+    This file is part of "sprog".
+
+    sprog is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "gpc_gas_profile_io.h"
+#include "string_functions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+using namespace Sprog::IO;
+using namespace Strings;
+using namespace std;
+
+namespace {
+    // Marker at the start of every binary profile.
+    const char profileMagic[8] = {'S','P','R','G','P','R','O','F'};
+
+    // Version of the binary layout.
+    const boost::uint32_t profileVersion = 1;
+
+    // Size of the fixed part of the header, after which the column
+    // names start.
+    const size_t headerSize = 40;
+
+    // Positions of the header fields.
+    const size_t versionPos = 8, columnsPos = 12, pointsPos = 16,
+                 offsetPos = 24, checkPos = 32;
+
+    // Binary profiles mapped by this process, by canonical path.  The
+    // mappings are released when the last reader lets go of them.
+    typedef map<string, boost::weak_ptr<const GasProfileFile> > ProfileCache;
+    ProfileCache mappedProfiles;
+    boost::mutex mappedProfilesMutex;
+
+    // Reads a header field.
+    template<class T> T field(const char *data, size_t pos)
+    {
+        T val;
+        memcpy(&val, data + pos, sizeof(val));
+        return val;
+    }
+
+    // Key of a file in the cache of mapped profiles.
+    string cacheKey(const string &filename)
+    {
+        boost::system::error_code ec;
+        const boost::filesystem::path p = boost::filesystem::canonical(filename, ec);
+        return ec ? filename : p.string();
+    }
+}
+
+
+// CONSTRUCTORS AND DESTRUCTORS.
+
+GasProfileFile::GasProfileFile(void)
+: m_npoints(0), m_data(NULL)
+{
+}
+
+GasProfileFile::~GasProfileFile(void)
+{
+}
+
+
+// READING.
+
+/*!
+* Mappings of binary files are kept while any profile returned for the
+* file is alive, so that solvers on different threads which read the same
+* profile also share its memory.  A file which is changed on disk while
+* it is mapped must be written under a new name and renamed.
+*
+* @param[in]   filename        Path of a text or binary profile
+*
+* @return      The profile
+*/
+boost::shared_ptr<const GasProfileFile> GasProfileFile::Open(const std::string &filename)
+{
+    if (!IsBinary(filename)) {
+        boost::shared_ptr<GasProfileFile> prof(new GasProfileFile());
+        prof->readText(filename);
+        return prof;
+    }
+
+    const string key = cacheKey(filename);
+    boost::mutex::scoped_lock lock(mappedProfilesMutex);
+    boost::shared_ptr<const GasProfileFile> shared = mappedProfiles[key].lock();
+    if (!shared) {
+        boost::shared_ptr<GasProfileFile> prof(new GasProfileFile());
+        prof->mapBinary(filename);
+        shared = prof;
+        mappedProfiles[key] = shared;
+    }
+    return shared;
+}
+
+bool GasProfileFile::IsBinary(const std::string &filename)
+{
+    ifstream fin(filename.c_str(), ios::in | ios::binary);
+    char magic[sizeof(profileMagic)];
+    fin.read(magic, sizeof(magic));
+    return fin.good() && (memcmp(magic, profileMagic, sizeof(magic)) == 0);
+}
+
+int GasProfileFile::FindColumn(const std::string &name) const
+{
+    for (size_t i=0; i!=m_columns.size(); ++i) {
+        if (m_columns[i] == name) return (int)i;
+    }
+    return -1;
+}
+
+// Parses a text profile.  Values missing at the end of a line are read
+// as zero and values beyond the last column name are ignored.
+void GasProfileFile::readText(const std::string &filename)
+{
+    ifstream fin(filename.c_str(), ios::in);
+    if (!fin.good()) {
+        throw runtime_error("Unable to open gas profile input file " + filename +
+                            " (Sprog, GasProfileFile::Open).");
+    }
+
+    vector<string> subs;
+    const string delim = ",\t \r"; // Possible file delimiters (comma, tab and space).
+    string line;
+
+    // The first line should be the header defining the columns.
+    if (getline(fin, line).eof()) {
+        throw runtime_error("Input file " + filename + " contains no data "
+                            "(Sprog, GasProfileFile::Open).");
+    }
+    split(line, subs, delim);
+    m_columns = subs;
+
+    const size_t ncols = m_columns.size();
+    while (!getline(fin, line).eof()) {
+        split(line, subs, delim);
+        const size_t n = min(subs.size(), ncols);
+        for (size_t i=0; i!=n; ++i) {
+            m_values.push_back(cdble(subs[i]));
+        }
+        m_values.resize(m_values.size() + ncols - n, 0.0);
+        ++m_npoints;
+    }
+
+    m_data = m_values.empty() ? NULL : &m_values[0];
+}
+
+// Maps a binary profile and checks its header.
+void GasProfileFile::mapBinary(const std::string &filename)
+{
+    namespace bip = boost::interprocess;
+    try {
+        bip::file_mapping file(filename.c_str(), bip::read_only);
+        m_region.reset(new bip::mapped_region(file, bip::read_only));
+    } catch (bip::interprocess_exception &e) {
+        throw runtime_error("Unable to map gas profile input file " + filename +
+                            ": " + e.what() + " (Sprog, GasProfileFile::Open).");
+    }
+
+    const char *data = static_cast<const char*>(m_region->get_address());
+    const size_t size = m_region->get_size();
+    const string damaged = "Gas profile " + filename + " is damaged or truncated "
+                           "(Sprog, GasProfileFile::Open).";
+    if (size < headerSize) throw runtime_error(damaged);
+
+    if (field<boost::uint32_t>(data, versionPos) != profileVersion) {
+        throw runtime_error("Gas profile " + filename + " has an unknown version "
+                            "(Sprog, GasProfileFile::Open).");
+    }
+    if (field<double>(data, checkPos) != 1.0) {
+        throw runtime_error("Gas profile " + filename + " was written with another "
+                            "byte order (Sprog, GasProfileFile::Open).");
+    }
+
+    const boost::uint32_t ncols = field<boost::uint32_t>(data, columnsPos);
+    const boost::uint64_t npoints = field<boost::uint64_t>(data, pointsPos);
+    const boost::uint64_t offset = field<boost::uint64_t>(data, offsetPos);
+    if ((offset % sizeof(double) != 0) || (offset < headerSize) || (offset > size) ||
+        ((size - offset) / sizeof(double) / (ncols ? ncols : 1) < npoints)) {
+        throw runtime_error(damaged);
+    }
+
+    // The column names lie between the header and the data.
+    const char *name = data + headerSize;
+    const char *end = data + offset;
+    m_columns.clear();
+    for (boost::uint32_t i=0; i!=ncols; ++i) {
+        const char *nul = static_cast<const char*>(memchr(name, '\0', end - name));
+        if (nul == NULL) throw runtime_error(damaged);
+        m_columns.push_back(string(name, nul));
+        name = nul + 1;
+    }
+
+    m_npoints = (size_t)npoints;
+    m_data = reinterpret_cast<const double*>(data + offset);
+}
+
+// Converts a text profile to a binary one.
+void GasProfileFile::Convert(const std::string &textfile, const std::string &binfile)
+{
+    boost::shared_ptr<const GasProfileFile> prof = Open(textfile);
+    GasProfileWriter out(binfile, prof->Columns());
+    for (size_t i=0; i!=prof->PointCount(); ++i) {
+        out.Write(prof->Row(i));
+    }
+    out.Close();
+}
+
+
+// WRITING.
+
+GasProfileWriter::GasProfileWriter(const std::string &filename,
+                                   const std::vector<std::string> &columns)
+: m_filename(filename), m_ncolumns(columns.size()), m_npoints(0)
+{
+    m_out.open(filename.c_str(), ios::out | ios::trunc | ios::binary);
+    if (!m_out.good()) {
+        throw runtime_error("Unable to open gas profile output file " + filename +
+                            " (Sprog, GasProfileWriter::GasProfileWriter).");
+    }
+
+    boost::uint64_t offset = headerSize;
+    for (vector<string>::const_iterator i=columns.begin(); i!=columns.end(); ++i) {
+        offset += i->size() + 1;
+    }
+    const boost::uint64_t padding = (sizeof(double) - offset % sizeof(double)) % sizeof(double);
+    offset += padding;
+
+    const boost::uint32_t version = profileVersion;
+    const boost::uint32_t ncols = (boost::uint32_t)columns.size();
+    const boost::uint64_t npoints = 0; // Written by Close.
+    const double check = 1.0;
+    m_out.write(profileMagic, sizeof(profileMagic));
+    m_out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    m_out.write(reinterpret_cast<const char*>(&ncols), sizeof(ncols));
+    m_out.write(reinterpret_cast<const char*>(&npoints), sizeof(npoints));
+    m_out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    m_out.write(reinterpret_cast<const char*>(&check), sizeof(check));
+    for (vector<string>::const_iterator i=columns.begin(); i!=columns.end(); ++i) {
+        m_out.write(i->c_str(), i->size() + 1);
+    }
+    const char zeros[sizeof(double)] = {0};
+    m_out.write(zeros, padding);
+}
+
+GasProfileWriter::~GasProfileWriter(void)
+{
+    try {
+        Close();
+    } catch (std::exception &) {
+        // Nobody to tell; a file without a point count reads as empty.
+    }
+}
+
+void GasProfileWriter::Write(const double *row)
+{
+    m_out.write(reinterpret_cast<const char*>(row), m_ncolumns * sizeof(double));
+    ++m_npoints;
+}
+
+void GasProfileWriter::Write(const std::vector<double> &row)
+{
+    if (row.size() != m_ncolumns) {
+        throw invalid_argument("Row has the wrong number of columns "
+                               "(Sprog, GasProfileWriter::Write).");
+    }
+    if (m_ncolumns > 0) Write(&row[0]);
+}
+
+void GasProfileWriter::Close(void)
+{
+    if (!m_out.is_open()) return;
+
+    const boost::uint64_t npoints = m_npoints;
+    m_out.seekp(pointsPos);
+    m_out.write(reinterpret_cast<const char*>(&npoints), sizeof(npoints));
+    m_out.close();
+    if (m_out.fail()) {
+        throw runtime_error("Failed to write gas profile " + m_filename +
+                            " (Sprog, GasProfileWriter::Close).");
+    }
+}
@@ -95,6 +95,7 @@ Mechanism &Mechanism::operator=(const Sprog::Mechanism &mech)
 
         // Copy reaction set and stoich cross-referencing.
         m_rxns = mech.m_rxns;
+        m_rxns.SetMechanism(*this);
         m_stoich_xref.assign(mech.m_stoich_xref.begin(), mech.m_stoich_xref.end());
         m_stoich_xref_valid = mech.m_stoich_xref_valid;
 
@@ -346,6 +347,9 @@ void Mechanism::SetUnits(Sprog::UnitSystem u)
 //                               "CGS units.  Consult your programmer.");
         m_units = CGS;
     }
+
+    // The reaction parameters may have been converted.
+    m_rxns.CompileRateParams();
 }
 
 
@@ -839,6 +843,13 @@ Kinetics::Reaction * Mechanism::GetReactions(unsigned int i)
     return m_rxns[i];
 }
 
+// Rebuilds the reaction set's rate parameter arrays after reactions have
+// been changed through GetReactions().
+void Mechanism::CompileRateParams()
+{
+    m_rxns.CompileRateParams();
+}
+
 // Adds an empty reaction to the mechanism.
 Sprog::Kinetics::Reaction *const Mechanism::AddReaction()
 {
@@ -53,11 +53,36 @@ Website:     http://como.cheng.cam.ac.uk
 #include <vector>
 #include <map>
 #include <cstdio>
+#include <cstring>
+
+#include <boost/version.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 
 using namespace Sprog::IO;
 using namespace std;
 using namespace Sprog::Kinetics;
 
+namespace {
+    // Version of the mechanism cache files, part of the cache key so that
+    // older caches are ignored when the layout changes.
+    const unsigned int cacheVersion = 1;
+
+    // Marker at the start of every cache file.
+    const char cacheMagic[8] = {'S','P','R','G','M','E','C','H'};
+
+    // Adds n bytes to a 64 bit FNV-1a hash.
+    void hashBytes(boost::uint64_t &h, const char *data, size_t n)
+    {
+        for (size_t i=0; i!=n; ++i) {
+            h ^= (unsigned char)data[i];
+            h *= 1099511628211ULL;
+        }
+    }
+}
+
 
 
 
@@ -130,6 +155,186 @@ void MechanismParser::ReadChemkin
 
 }
 
+/*!
+* The mechanism is loaded from cachedir if a cache of the same input files
+* exists, otherwise it is parsed as usual and the cache written for the
+* next start.  The cache is keyed on the contents of the files and not on
+* their names.  It is not used if cachedir is empty.
+*
+* @param[in]   cachedir        Directory holding the cache files
+* @param[in]   filename        Path to main CHEMKIN mechanism file
+* @param[out]  mech            Mechanism into which to place newly read data
+* @param[in]   thermofile      Thermodynamic database file
+* @param[in]   verbose         Level of informational output (higher is more, default is 0)
+* @param[in]   transfile       Species transport properties
+*/
+void MechanismParser::ReadChemkinCached
+    (
+    const std::string &cachedir,
+    const std::string &filename,
+    Sprog::Mechanism &mech,
+    const std::string &thermofile,
+    const int verbose,
+    const std::string &transFile
+    )
+{
+    if (cachedir.empty()) {
+        ReadChemkin(filename, mech, thermofile, verbose, transFile);
+        return;
+    }
+
+    vector<string> files;
+    files.push_back(filename);
+    files.push_back(thermofile);
+    files.push_back(transFile);
+    const string cachefile = CacheFileName(cachedir, files);
+
+    if (readCache(cachefile, mech)) {
+        if (verbose >= 1) {
+            cout << "Read mechanism from " << cachefile << endl;
+            mech.WriteDiagnostics("mech.log");
+        }
+    } else {
+        ReadChemkin(filename, mech, thermofile, verbose, transFile);
+        writeCache(cachefile, mech);
+    }
+}
+
+void MechanismParser::ReadChemkinCached
+    (
+    const std::string &cachedir,
+    const std::string &filename,
+    const std::string &Surffilename,
+    Sprog::Mechanism &mech,
+    const std::string &thermofile,
+    const std::string &Surfthermofile,
+    const int verbose,
+    const std::string &transFile
+    )
+{
+    if (cachedir.empty()) {
+        ReadChemkin(filename, Surffilename, mech, thermofile, Surfthermofile,
+                    verbose, transFile);
+        return;
+    }
+
+    vector<string> files;
+    files.push_back(filename);
+    files.push_back(thermofile);
+    files.push_back(transFile);
+    files.push_back(Surffilename);
+    files.push_back(Surfthermofile);
+    const string cachefile = CacheFileName(cachedir, files);
+
+    if (readCache(cachefile, mech)) {
+        if (verbose >= 1) {
+            cout << "Read mechanism from " << cachefile << endl;
+            mech.WriteDiagnostics("mech.log");
+        }
+    } else {
+        ReadChemkin(filename, Surffilename, mech, thermofile, Surfthermofile,
+                    verbose, transFile);
+        writeCache(cachefile, mech);
+    }
+}
+
+/*!
+* The key is a 64 bit FNV-1a hash of the cache version, the Boost version
+* (binary archives are not portable between Boost versions) and the
+* contents of the files in order.  Files which are "NOT READ" or cannot be
+* opened only add a marker.
+*
+* @param[in]   cachedir        Directory holding the cache files
+* @param[in]   files           Input files of the mechanism
+*
+* @return      Path of the cache file
+*/
+std::string MechanismParser::CacheFileName
+    (
+    const std::string &cachedir,
+    const std::vector<std::string> &files
+    )
+{
+    boost::uint64_t h = 14695981039346656037ULL;
+    const unsigned int versions[3] = {cacheVersion, BOOST_VERSION, sizeof(long)};
+    hashBytes(h, reinterpret_cast<const char*>(versions), sizeof(versions));
+
+    vector<char> buffer(65536);
+    for (vector<string>::const_iterator f=files.begin(); f!=files.end(); ++f) {
+        ifstream in;
+        if (*f != "NOT READ") in.open(f->c_str(), ios::in | ios::binary);
+        if (!in.is_open()) {
+            hashBytes(h, "\0NOT READ\0", 10);
+            continue;
+        }
+
+        boost::uint64_t length = 0;
+        while (in) {
+            in.read(&buffer[0], buffer.size());
+            hashBytes(h, &buffer[0], in.gcount());
+            length += in.gcount();
+        }
+        hashBytes(h, reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+
+    char key[17];
+    sprintf(key, "%016llx", (unsigned long long)h);
+    return (boost::filesystem::path(cachedir) / ("sprog-mech-" + string(key) + ".bin")).string();
+}
+
+// Loads a cached mechanism.
+bool MechanismParser::readCache(const std::string &cachefile, Sprog::Mechanism &mech)
+{
+    ifstream in(cachefile.c_str(), ios::in | ios::binary);
+    if (!in.good()) return false;
+
+    char magic[sizeof(cacheMagic)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() || (memcmp(magic, cacheMagic, sizeof(magic)) != 0)) return false;
+
+    try {
+        boost::archive::binary_iarchive ia(in);
+        ia >> mech;
+    } catch (std::exception &e) {
+        // A damaged or incompatible cache is parsed again and replaced.
+        cerr << "Ignoring mechanism cache " << cachefile << ": " << e.what() << endl;
+        mech.Clear();
+        return false;
+    }
+    return true;
+}
+
+// Writes a mechanism to a cache file.  The file is written under a unique
+// temporary name and then renamed, so that simultaneous processes never
+// read a partly written cache.
+void MechanismParser::writeCache(const std::string &cachefile, const Sprog::Mechanism &mech)
+{
+    namespace fs = boost::filesystem;
+    try {
+        const fs::path target(cachefile);
+        if (target.has_parent_path()) fs::create_directories(target.parent_path());
+        const fs::path tmp = target.parent_path() / fs::unique_path(target.filename().string() + ".%%%%-%%%%-%%%%");
+
+        {
+            ofstream out(tmp.string().c_str(), ios::out | ios::binary);
+            if (!out.good()) {
+                throw runtime_error("cannot write " + tmp.string());
+            }
+            out.write(cacheMagic, sizeof(cacheMagic));
+            boost::archive::binary_oarchive oa(out);
+            oa << mech;
+        }
+
+        boost::system::error_code ec;
+        fs::rename(tmp, target, ec);
+        if (ec) fs::remove(tmp, ec);
+    } catch (std::exception &e) {
+        // The cache only speeds up later starts, so failing to write it
+        // is not an error.
+        cerr << "Could not write mechanism cache " << cachefile << ": " << e.what() << endl;
+    }
+}
+
 void MechanismParser::ReadChemkin(
 ::IO::ChemkinReader& chemkinReader, Sprog::Mechanism &mech)
 {
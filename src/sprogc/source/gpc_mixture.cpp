@@ -895,6 +895,7 @@ void Mixture::Deserialize(std::istream &in)
 
                 // Fill the data vector.
                 double val;
+                m_data.clear();
                 m_data.reserve(sz);
                 for (unsigned int i=0; i<sz; i++) {
                     in.read(reinterpret_cast<char*>(&val), sizeof(val));
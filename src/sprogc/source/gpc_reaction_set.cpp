@@ -129,7 +129,8 @@ ReactionSet &ReactionSet::operator=(const ReactionSet &rxns)
 	// Build MOTT WISE reaction map.
 	m_mottw_rxns = rxns.m_mottw_rxns; 
 
-	// Build 
+        // Build the rate parameter arrays.
+        CompileRateParams();
     }
 
     return *this;
@@ -214,6 +215,8 @@ ReactionSet &ReactionSet::operator+=(const ReactionSet &rxns)
             m_mottw_rxns.push_back(n + *jrxn);
         }
 
+        // Rebuild the rate parameter arrays.
+        CompileRateParams();
     }
 
     return *this;
@@ -327,6 +330,10 @@ Reaction *const ReactionSet::AddReaction(const Sprog::Kinetics::Reaction &rxn)
         m_mottw_rxns.push_back(m_rxns.size()-1);
     }
 
+    // Copy the rate parameters into the arrays used by the rate
+    // constant calculations.
+    compileRateParams(m_rxns.size()-1);
+
     return pr;
 }
 
@@ -340,6 +347,106 @@ void ReactionSet::Clear()
 }
 
 
+// RATE PARAMETERS.
+
+// Rebuilds the rate parameter arrays from the reactions.
+void ReactionSet::CompileRateParams()
+{
+    clearRateParams();
+    for (unsigned int j=0; j!=m_rxns.size(); ++j) {
+        compileRateParams(j);
+    }
+}
+
+// Appends the rate parameters of the jth reaction to the arrays.  The
+// tests which decide the groups a reaction belongs to must match those
+// used to build the reaction maps in AddReaction(), so that each group of
+// parameters runs parallel to its map.
+void ReactionSet::compileRateParams(unsigned int j)
+{
+    const Reaction &rxn = *m_rxns[j];
+
+    // Forward Arrhenius parameters.
+    m_arrA.push_back(rxn.Arrhenius().A);
+    m_arrn.push_back(rxn.Arrhenius().n);
+    m_arrE.push_back(rxn.Arrhenius().E);
+
+    // Explicit reverse parameters, otherwise the stoichiometry
+    // needed to find the reverse rate from equilibrium.
+    if (rxn.RevArrhenius() != NULL) {
+        m_revA.push_back(rxn.RevArrhenius()->A);
+        m_revn.push_back(rxn.RevArrhenius()->n);
+        m_revE.push_back(rxn.RevArrhenius()->E);
+    } else if (rxn.IsReversible()) {
+        if (m_eqStart.empty()) m_eqStart.push_back(0);
+        m_eq_rxns.push_back(j);
+        m_eqStoich.push_back(rxn.TotalStoich());
+        for (int k=0; k!=rxn.ReactantCount(); ++k) {
+            m_eqSp.push_back(rxn.Reactants()[k].Index());
+            m_eqMu.push_back(rxn.Reactants()[k].Mu());
+        }
+        for (int k=0; k!=rxn.ProductCount(); ++k) {
+            m_eqSp.push_back(rxn.Products()[k].Index());
+            m_eqMu.push_back(-rxn.Products()[k].Mu());
+        }
+        m_eqStart.push_back(m_eqSp.size());
+    }
+
+    // Landau-Teller parameters.
+    if (rxn.LTCoeffs() != NULL) {
+        m_ltB.push_back(rxn.LTCoeffs()->B);
+        m_ltC.push_back(rxn.LTCoeffs()->C);
+    }
+    if (rxn.RevLTCoeffs() != NULL) {
+        m_revltB.push_back(rxn.RevLTCoeffs()->B);
+        m_revltC.push_back(rxn.RevLTCoeffs()->C);
+    }
+
+    // Third-body enhancement factors.
+    if (rxn.UseThirdBody()) {
+        if (m_tbStart.empty()) m_tbStart.push_back(0);
+        for (int k=0; k!=rxn.ThirdBodyCount(); ++k) {
+            m_tbSp.push_back(rxn.ThirdBody(k).Index());
+            m_tbEff.push_back(rxn.ThirdBody(k).Mu() - 1.0);
+        }
+        m_tbStart.push_back(m_tbSp.size());
+    }
+
+    // Low pressure limits of fall-off reactions.
+    if (rxn.FallOffType() != None) {
+        m_foA.push_back(rxn.FallOffParams().LowP_Limit.A);
+        m_fon.push_back(rxn.FallOffParams().LowP_Limit.n);
+        m_foE.push_back(rxn.FallOffParams().LowP_Limit.E);
+    }
+}
+
+// Clears the rate parameter arrays.
+void ReactionSet::clearRateParams()
+{
+    m_arrA.clear();
+    m_arrn.clear();
+    m_arrE.clear();
+    m_revA.clear();
+    m_revn.clear();
+    m_revE.clear();
+    m_eq_rxns.clear();
+    m_eqStoich.clear();
+    m_eqStart.clear();
+    m_eqSp.clear();
+    m_eqMu.clear();
+    m_ltB.clear();
+    m_ltC.clear();
+    m_revltB.clear();
+    m_revltC.clear();
+    m_tbStart.clear();
+    m_tbSp.clear();
+    m_tbEff.clear();
+    m_foA.clear();
+    m_fon.clear();
+    m_foE.clear();
+}
+
+
 
 // MOLAR PRODUCTION RATES.
 
@@ -457,9 +564,8 @@ double ReactionSet::GetSurfaceMolarProdRates(const fvector &rop,
 double ReactionSet::GetMolarProdRates(const Sprog::Thermo::GasPhase &gas,
                                     fvector &wdot) const
 {
-    static fvector rop;
-    GetRatesOfProgress(gas, rop);//  Calling GetRatesofProgress 4 
-    return GetMolarProdRates(rop, wdot); // Caling GetMolarProdRates 1
+    GetRatesOfProgress(gas, m_wk.rop);//  Calling GetRatesofProgress 4 
+    return GetMolarProdRates(m_wk.rop, wdot); // Caling GetMolarProdRates 1
 }
 
 // Calculates the molar production rates of all species.GetMolarProdRates 3
@@ -468,9 +574,8 @@ double ReactionSet::GetMolarProdRates(double T, double density, const double *x,
                                     const Sprog::Thermo::ThermoInterface &thermo,
                                     fvector &wdot) const
 {
-    static fvector rop;
-    GetRatesOfProgress(T, density, x, n, thermo, rop); //  Calling GetRatesofProgress6
-    return GetMolarProdRates(rop, wdot); // Caling GetMolarProdRates 1
+    GetRatesOfProgress(T, density, x, n, thermo, m_wk.rop); //  Calling GetRatesofProgress6
+    return GetMolarProdRates(m_wk.rop, wdot); // Caling GetMolarProdRates 1
 }
 
 
@@ -480,9 +585,8 @@ double ReactionSet::GetSurfaceMolarProdRates(double T, double density, const dou
                                     const Sprog::Thermo::ThermoInterface &thermo,
                                     fvector &sdot) const
 {
-    static fvector rop;
-    GetRatesOfProgress(T, density, x, n, thermo, rop); //  Calling GetRatesofProgress6
-    return GetSurfaceMolarProdRates(rop, sdot); // Caling GetMolarProdRates 1
+    GetRatesOfProgress(T, density, x, n, thermo, m_wk.rop); //  Calling GetRatesofProgress6
+    return GetSurfaceMolarProdRates(m_wk.rop, sdot); // Caling GetMolarProdRates 1
 }
 
 
@@ -740,8 +844,7 @@ void ReactionSet::GetRatesOfProgress(double density,
                                      const fvector &kreverse,
                                      fvector &rop) const
 {
-    static fvector rfwd, rrev;
-    GetRatesOfProgress(density, x, n, kforward, kreverse, rop, rfwd, rrev); // Calling GetRatesOfProgress 1
+    GetRatesOfProgress(density, x, n, kforward, kreverse, rop, m_wk.rfwd, m_wk.rrev); // Calling GetRatesOfProgress 1
 }
 
 // Returns the rates of progress of all reactions given the mixture
@@ -761,9 +864,8 @@ void ReactionSet::GetRatesOfProgress(const Sprog::Thermo::GasPhase &mix,
 // Calculates the rate of progress of each reaction. GetRatesOfProgress 4
 void ReactionSet::GetRatesOfProgress(const Sprog::Thermo::GasPhase &gas, fvector &rop) const
 {
-    static fvector kf, kr;
-    GetRateConstants(gas, kf, kr); // Calling GetRateConstants 4
-    GetRatesOfProgress(gas, kf, kr, rop);// Calling GetRatesOfProgress 3
+    GetRateConstants(gas, m_wk.kf, m_wk.kr); // Calling GetRateConstants 4
+    GetRatesOfProgress(gas, m_wk.kf, m_wk.kr, rop);// Calling GetRatesOfProgress 3
 }
 
 // Calculates the rate of progress of each reaction. GetRatesOfProgress 5
@@ -772,11 +874,10 @@ void ReactionSet::GetRatesOfProgress(const Sprog::Thermo::GasPhase &gas,
                                      fvector &rfwd,
                                      fvector &rrev) const
 {
-    static fvector kf, kr;
-    GetRateConstants(gas, kf, kr); // Calling GetRateConstants 4
+    GetRateConstants(gas, m_wk.kf, m_wk.kr); // Calling GetRateConstants 4
     GetRatesOfProgress(gas.Density(), &(gas.MoleFractions()[0]),
                        m_mech->Species().size(),
-                       kf, kr, rop, rfwd, rrev); // Calling GetRatesOfProgress 1
+                       m_wk.kf, m_wk.kr, rop, rfwd, rrev); // Calling GetRatesOfProgress 1
 }
 
 // Calculates the rate of progress of each reaction. GetRatesOfProgress 6
@@ -785,9 +886,8 @@ void ReactionSet::GetRatesOfProgress(double T, double density, const double *x,
                                      const Sprog::Thermo::ThermoInterface &thermo,
                                      fvector &rop) const
 {
-    static fvector kf, kr;
-    GetRateConstants(T, density, x, n, thermo, kf, kr); // Calling GetRateConstants 3
-    GetRatesOfProgress(density, x, n, kf, kr, rop); // Calling GetRatesOfProgress 2
+    GetRateConstants(T, density, x, n, thermo, m_wk.kf, m_wk.kr); // Calling GetRateConstants 3
+    GetRatesOfProgress(density, x, n, m_wk.kf, m_wk.kr, rop); // Calling GetRatesOfProgress 2
 }
 
 
@@ -803,9 +903,20 @@ void ReactionSet::GetRateConstants(double T,
                                    fvector &kf,
                                    fvector &kr) const
 {
-    static fvector tbconcs;
-    static bool fallocated = false;
+    calcRateConstants(T, density, x, n, Gs, kf, kr, m_wk.tbconcs);
+}
 
+// Calculates the forward and reverse rate constants using the given
+// third-body concentration workspace.
+void ReactionSet::calcRateConstants(double T,
+                                    double density,
+                                    const double *x,
+                                    unsigned int n,
+                                    const fvector &Gs,
+                                    fvector &kf,
+                                    fvector &kr,
+                                    fvector &tbconcs) const
+{
     // Check that we have been given enough species concentrations.
     if (n < m_mech->Species().size()) {
         return;
@@ -817,11 +928,8 @@ void ReactionSet::GetRateConstants(double T,
     if (n < m_mech->Species().size()) {
         return;
     } else {
-        if (!fallocated) {
-            // Allocate temporary memory.
-            tbconcs.resize(m_rxns.size(), 0.0);
-            fallocated = true;
-        }
+        // Allocate temporary memory.
+        tbconcs.resize(m_rxns.size(), 0.0);
         kf.resize(m_rxns.size(), 0.0);
         kr.resize(m_rxns.size(), 0.0);
     }
@@ -875,9 +983,8 @@ void ReactionSet::GetRateConstants(double T,
                                    fvector &kforward,
                                    fvector &kreverse) const
 {
-    static fvector Gs;
-    thermo.CalcGs_RT(T, Gs);
-    GetRateConstants(T, density, x, n, Gs, kforward, kreverse); // Calling GetRateConstants 1
+    thermo.CalcGs_RT(T, m_wk.Gs);
+    GetRateConstants(T, density, x, n, m_wk.Gs, kforward, kreverse); // Calling GetRateConstants 1
 }
 
 // Calculates the forward and reverse rate constants
@@ -886,10 +993,63 @@ void ReactionSet::GetRateConstants(const Sprog::Thermo::GasPhase &mix,
                                    std::vector<double> &kforward,
                                    std::vector<double> &kreverse) const
 {
-    static fvector Gs;
-    mix.Gs_RT(Gs);
+    mix.Gs_RT(m_wk.Gs);
     GetRateConstants(mix.Temperature(), mix.Density(), &(mix.MoleFractions()[0]),
-                     m_mech->Species().size(), Gs, kforward, kreverse); // Calling GetRateConstant 3
+                     m_mech->Species().size(), m_wk.Gs, kforward, kreverse); // Calling GetRateConstant 3
+}
+
+
+// RATES WITH A CALLER-OWNED WORKSPACE.
+
+// Sizes the vectors of a workspace for this reaction set.
+void ReactionSet::InitWorkspace(RateWorkspace &wk) const
+{
+    wk.kf.resize(m_rxns.size(), 0.0);
+    wk.kr.resize(m_rxns.size(), 0.0);
+    wk.tbconcs.resize(m_rxns.size(), 0.0);
+    wk.rop.resize(m_rxns.size(), 0.0);
+    wk.rfwd.resize(m_rxns.size(), 0.0);
+    wk.rrev.resize(m_rxns.size(), 0.0);
+    wk.Gs.resize(m_mech->Species().size(), 0.0);
+}
+
+// Calculates the forward and reverse rate constants of all reactions
+// into the workspace.
+void ReactionSet::GetRateConstants(double T,
+                                   double density,
+                                   const double *x,
+                                   unsigned int n,
+                                   const Sprog::Thermo::ThermoInterface &thermo,
+                                   RateWorkspace &wk) const
+{
+    thermo.CalcGs_RT(T, wk.Gs);
+    calcRateConstants(T, density, x, n, wk.Gs, wk.kf, wk.kr, wk.tbconcs);
+}
+
+// Calculates the rates of progress of all reactions into the workspace.
+void ReactionSet::GetRatesOfProgress(double T,
+                                     double density,
+                                     const double *x,
+                                     unsigned int n,
+                                     const Sprog::Thermo::ThermoInterface &thermo,
+                                     RateWorkspace &wk) const
+{
+    GetRateConstants(T, density, x, n, thermo, wk);
+    GetRatesOfProgress(density, x, n, wk.kf, wk.kr, wk.rop, wk.rfwd, wk.rrev); // Calling GetRatesOfProgress 1
+}
+
+// Calculates the molar production rates of all species using the
+// workspace for the intermediate results.
+double ReactionSet::GetMolarProdRates(double T,
+                                      double density,
+                                      const double *x,
+                                      unsigned int n,
+                                      const Sprog::Thermo::ThermoInterface &thermo,
+                                      RateWorkspace &wk,
+                                      fvector &wdot) const
+{
+    GetRatesOfProgress(T, density, x, n, thermo, wk);
+    return GetMolarProdRates(wk.rop, wdot); // Caling GetMolarProdRates 1
 }
 
 
@@ -922,65 +1082,61 @@ void ReactionSet::calcRateConstantsT(double T, const fvector &Gs,
             invRT = 0.0;
             Patm_RT = 0.0;
     }
-    if (m_lt_rxns.size() > 0) {
+    if ((m_lt_rxns.size() > 0) || (m_revlt_rxns.size() > 0)) {
         T_1_3 = 1.0 / pow(T, ONE_THIRD);
         T_2_3 = T_1_3 * T_1_3;
     }
 
-    // Calculate classic Arrhenius forward rate expression.
-    for (i=m_rxns.begin(),j=0; i!=m_rxns.end(); ++i,++j) {
-        kf[j] = (*i)->Arrhenius().A *
-                      exp(((*i)->Arrhenius().n * lnT) -
-                          ((*i)->Arrhenius().E * invRT)); // This is equal to k_f = A_i T^{beta_i} exp(-Ei / RcT)
-
-	// cout << "classic Arrhenius " << kf[j] << endl; 
+    // The loops below run over the contiguous parameter arrays built by
+    // CompileRateParams(), with no calls through the reaction objects, so
+    // that the compiler is free to vectorise them.
+    const unsigned int nrxn = m_rxns.size();
+
+    // Calculate classic Arrhenius forward rate expression,
+    // k_f = A_i T^{beta_i} exp(-Ei / RcT).
+    if (nrxn > 0) {
+        const double *const A = &m_arrA[0];
+        const double *const b = &m_arrn[0];
+        const double *const E = &m_arrE[0];
+        double *const k = &kf[0];
+        for (m=0; m<nrxn; ++m) {
+            k[m] = A[m] * exp((b[m] * lnT) - (E[m] * invRT));
+        }
     }
 
     // Landau-Teller rate expressions.
-    for (im=m_lt_rxns.begin(); im!=m_lt_rxns.end(); ++im) {
-        j = *im;
-        kf[j] *= exp((m_rxns[j]->LTCoeffs()->B / T_1_3) +
-                           (m_rxns[j]->LTCoeffs()->C / T_2_3));
-
-	// cout << "Landau " << kf[j] << endl; 
+    for (m=0; m<m_lt_rxns.size(); ++m) {
+        kf[m_lt_rxns[m]] *= exp((m_ltB[m] / T_1_3) + (m_ltC[m] / T_2_3));
     }
 
+    // Reverse rate constants.  Irreversible reactions have none.
+    fill(kr.begin(), kr.begin() + nrxn, 0.0);
 
-    
-    // Reverse rate constants.
-    for (i=m_rxns.begin(),j=0; i!=m_rxns.end(); ++i,++j) {
-
-	
-	  if ((*i)->RevArrhenius() != NULL) {
-            // This reaction has explicit reverse rate parameters.
-            kr[j] = (*i)->RevArrhenius()->A *
-	      exp(((*i)->RevArrhenius()->n * lnT) -
-		  ((*i)->RevArrhenius()->E * invRT));
-	  } else if ((*i)->IsReversible()) {
-            // Must find the reverse rate constants by equilibrium.
-            kr[j] = 0.0;
-
-            // Calculate the Gibbs free energy change for reaction i and sum up
-            // the stoichiometric coefficients.
-            for (k=0; k!=(*i)->ReactantCount(); ++k) {
-	      // Integer Reactants.
-	      kr[j] += (*i)->Reactants()[k].Mu() * Gs[(*i)->Reactants()[k].Index()];
-            }
-            for (k=0; k!=(*i)->ProductCount(); ++k) {
-	      // Integer Products.
-	      kr[j] -= (*i)->Products()[k].Mu() * Gs[(*i)->Products()[k].Index()];
-            }
-
-            // Calculate the reverse rate constant.
-            kr[j]  = exp(min(kr[j], log(1.0e250)));
-            kr[j] *= pow(Patm_RT, (*i)->TotalStoich());
-            kr[j]  = kf[j] / max(kr[j], 1.0e-250);
-	  }
+    // Reactions with explicit reverse rate parameters.
+    for (m=0; m<m_rev_rxns.size(); ++m) {
+        kr[m_rev_rxns[m]] = m_revA[m] *
+                            exp((m_revn[m] * lnT) - (m_revE[m] * invRT));
+    }
 
-	  // cout << "classic reverse Arrhenius " << kr[j] << endl; 
+    // Reversible reactions whose reverse rate constants must be found by
+    // equilibrium.
+    const double lnkmax = log(1.0e250);
+    for (m=0; m<m_eq_rxns.size(); ++m) {
+        j = m_eq_rxns[m];
+
+        // Calculate the Gibbs free energy change for the reaction.  The
+        // product coefficients are stored negated.
+        double dG = 0.0;
+        for (n=m_eqStart[m]; n!=m_eqStart[m+1]; ++n) {
+            dG += m_eqMu[n] * Gs[m_eqSp[n]];
+        }
 
+        // Calculate the reverse rate constant.
+        kr[j]  = exp(min(dG, lnkmax));
+        kr[j] *= pow(Patm_RT, m_eqStoich[m]);
+        kr[j]  = kf[j] / max(kr[j], 1.0e-250);
     }
-	
+
     for (im=m_surface_rxns.begin(),j=0; im!=m_surface_rxns.end(); ++im) {
       j = *im; 
 
@@ -1080,10 +1236,9 @@ void ReactionSet::calcRateConstantsT(double T, const fvector &Gs,
 	 
 
     // Explicit reverse Landau-Teller parameters.
-      for (im=m_revlt_rxns.begin(); im!=m_revlt_rxns.end(); ++im) {
-        j = *im;
-        kr[j] *= exp((m_rxns[j]->RevLTCoeffs()->B / T_1_3) +
-                           (m_rxns[j]->RevLTCoeffs()->C / T_2_3));
+      for (m=0; m<m_revlt_rxns.size(); ++m) {
+        kr[m_revlt_rxns[m]] *= exp((m_revltB[m] / T_1_3) +
+                                   (m_revltC[m] / T_2_3));
       }
 
 
@@ -1429,30 +1584,17 @@ void ReactionSet::calcCOVERAGE(double T, const double *const x, fvector &kf) con
 void ReactionSet::calcTB_Concs(double density, const double *x,
                                unsigned int n, fvector &tbconcs) const
 {
-    RxnPtrVector::const_iterator i;
-    RxnMap::const_iterator im;
-    int j, k;
-
-    // Third body concentrations for each reaction.
-    for (i=m_rxns.begin(),j=0; i!=m_rxns.end(); ++i,++j)
-    {
-        if ((*i)->UseThirdBody())
-        {
-            // Calculate enhanced third body concentration using the enhancement
-            // factors defined for this reaction.
-            tbconcs[j] = 0.0;
-            for (k=0; k<(*i)->ThirdBodyCount(); ++k)
-            {
-                tbconcs[j] += ((*i)->ThirdBody(k).Mu() - 1.0) *
-                              x[(*i)->ThirdBody(k).Index()];
-            }
-            tbconcs[j] = density * (1.0 + tbconcs[j]);
-        }
-        else
-        {
-            // This reaction has no third body requirement.
-            tbconcs[j] = density; // Changed as recommended by Will Menz
+    // Reactions with no third body requirement use the mixture density.
+    fill(tbconcs.begin(), tbconcs.begin() + m_rxns.size(), density); // Changed as recommended by Will Menz
+
+    // Calculate enhanced third body concentrations using the enhancement
+    // factors defined for each third-body reaction.
+    for (unsigned int m=0; m<m_tb_rxns.size(); ++m) {
+        double sum = 0.0;
+        for (unsigned int k=m_tbStart[m]; k!=m_tbStart[m+1]; ++k) {
+            sum += m_tbEff[k] * x[m_tbSp[k]];
         }
+        tbconcs[m_tb_rxns[m]] = density * (1.0 + sum);
     }
 }
 
@@ -1466,8 +1608,6 @@ void ReactionSet::calcFallOffTerms(double T, double density, const double *x,
                                    fvector &kf, fvector &kr) const
 {
     double lowk=0.0, pr=0.0, logpr=0.0, lnT=log(T), invRT=0.0;
-    RxnPtrVector::const_iterator i;
-    RxnMap::const_iterator im;
     int j;
     const Reaction *rxn;
 
@@ -1484,14 +1624,12 @@ void ReactionSet::calcFallOffTerms(double T, double density, const double *x,
     }
 
     // Pressure dependent fall-off reactions.
-    for (im=m_fo_rxns.begin(); im!=m_fo_rxns.end(); ++im) {
-        j   = *im;  // Reaction index of imth fall-off reaction.
+    for (unsigned int m=0; m<m_fo_rxns.size(); ++m) {
+        j   = m_fo_rxns[m];  // Reaction index of mth fall-off reaction.
         rxn = m_rxns[j];
 
         // Calculate low pressure limit.
-        lowk = rxn->FallOffParams().LowP_Limit.A *
-               exp((rxn->FallOffParams().LowP_Limit.n * lnT) -
-                    (rxn->FallOffParams().LowP_Limit.E * invRT));
+        lowk = m_foA[m] * exp((m_fon[m] * lnT) - (m_foE[m] * invRT));
 
         // Calculate reduced pressure.
         if (rxn->FallOffParams().ThirdBody >= 0) {
@@ -2231,6 +2369,7 @@ void ReactionSet::releaseMemory()
     m_cov_rxns.clear();
     m_stick_rxns.clear();
     m_mottw_rxns.clear();
+    clearRateParams();
 
     // Delete the reactions.
     RxnPtrVector::iterator i;
@@ -2567,6 +2706,9 @@ void ReactionSet::Deserialize(std::istream &in)
                     m_mottw_rxns[i] = ix;
                 }
 
+                // Build the rate parameter arrays.
+                CompileRateParams();
+
                 break;
             default:
                 throw runtime_error("Serialized version number is unsupported (Sprog, ReactionSet::Deserialize).");
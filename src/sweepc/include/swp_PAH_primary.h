@@ -210,6 +210,9 @@ public:
     //! Deserialize object from input binary stream
     void Deserialize(std::istream &in, const Sweep::ParticleModel &model, PahDeserialisationMap &pah_duplicates);
 
+    //! Lists the PAHs that Serialize would write, each once
+    void CollectPAHs(PahSerialisationMap &seen, std::vector<const PAH*> &pahs) const;
+
 	//! Return primary particle details and connectivity
 	void PrintPrimary(std::vector<fvector> &surface, std::vector<fvector> &primary_diameter, int k) const;
     
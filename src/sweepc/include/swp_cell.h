@@ -122,6 +122,12 @@ public:
             std::list<Particle*>::iterator particle_list_end,
             double statistical_weight);
 
+    //! Add particles to those in the cell, keeping the statistical weight of the cell
+    void AddParticles(
+            std::list<Particle*>::iterator particle_list_begin,
+            std::list<Particle*>::iterator particle_list_end,
+            rng_type &rng);
+
     // THE PARTICLE MODEL.
 
     // Returns the particle model used to define particles in this
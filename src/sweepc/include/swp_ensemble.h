@@ -164,6 +164,13 @@ public:
     //! Empty the tree and pass on ownership of the particles
     PartPtrList TakeParticles();
 
+    //! Pass on ownership of the particles flagged in take, leaving the others in place
+    PartPtrList TakeParticles(const std::vector<bool> &take);
+
+    //! Add particles to those already present, downsampling as necessary
+    void AddParticles(std::list<Particle*>::iterator first, std::list<Particle*>::iterator last,
+                      rng_type &rng);
+
     void SetDoubling(const bool val);
 
 	unsigned int DoubleLimit();
@@ -193,8 +200,11 @@ public:
         bool fdel=true  // Set true to delete particle from memory as well, otherwise false.
         );
 
-    //! Removes invalid particles.
-    void RemoveInvalids(void);
+    //! Removes invalid particles.  The order of the remaining particles
+    //! is not preserved: each gap is filled by the particle from the end.
+    //! Only the tree entries of the moved particles are updated, unless
+    //! frebuild is set because other particles have changed as well.
+    void RemoveInvalids(bool frebuild=false);
 
     //! Replaces the particle at the given index with the given particle.
     void Replace (
@@ -240,6 +250,14 @@ public:
     // negative.
     int Select_usingGivenRand(Sweep::PropID id, double rng_number, rng_type &rng) const;
 
+    // Selects two particles, weighted by the given particle property
+    // indices, with the same random numbers as two calls to Select.  The
+    // properties are indexed in the binary tree the first time they are
+    // used, after which both particles are found in one descent of the
+    // tree and later calls to Select by them are also faster.
+    void SelectPair(Sweep::PropID id1, Sweep::PropID id2, rng_type &rng,
+                    int &ip1, int &ip2);
+
     // ENSEMBLE CAPACITY AND PARTICLE COUNT.
 
     //! Returns the particle count.
@@ -343,6 +361,15 @@ public:
         const Sweep::ParticleModel &mech // Model used to define particles.
         );
 
+    //! Reads the object from a binary stream, keeping only n particles
+    //! starting with particle first.
+    void Deserialize(
+        std::istream &in,                 // Input stream.
+        const Sweep::ParticleModel &mech, // Model used to define particles.
+        unsigned int first,               // Index of the first particle to keep.
+        unsigned int n                    // Maximum number of particles to keep.
+        );
+
     int NumOfInceptedPAH(int ID) const;// return the number of pyrene in current state.
     int IndexOfInceptedPAH(int ID) const; //move backwards.
     Sweep::KMC_ARS::KMCSimulator* Simulator();
@@ -438,12 +465,24 @@ private:
     //! Reset the contents of the binary tree
     void rebuildTree();
 
+    //! Fill the given places, which no longer own particles, from the end
+    void closeGaps(const std::vector<unsigned int> &gaps, bool frebuild);
+
+    //! True if rebuilding the tree is cheaper than filling ngaps gaps
+    bool rebuildIsCheaper(std::size_t ngaps) const;
+
     //! Type of weight tree for particle selection and property summation
     typedef Utils::BinaryTree<particle_cache_type, PartPtrVector::iterator> tree_type;
 
     //! Tree for inverting probability distributions on the particles and summing their properties
     tree_type m_tree;
 
+    //! Properties indexed in m_tree, in the order of their numbers in the tree
+    std::vector<Sweep::PropID> m_selectprops;
+
+    //! Number of a property in the index of m_tree, or -1 if it is not indexed
+    int indexedProperty(Sweep::PropID id) const;
+
 
     // MEMORY MANAGEMENT.
 
@@ -459,6 +498,14 @@ private:
     //! Empties the main population
     void ClearMain();
 
+    //! Writes the PAH table, the record index and the particle records.
+    void serializeParticles(std::ostream &out) const;
+
+    //! Reads m_count particles, starting with particle first of nfile.
+    void deserializeParticles(std::istream &in, const Sweep::ParticleModel &model,
+                              unsigned int version, unsigned int nfile,
+                              unsigned int first);
+
     //! Functor to extract weights from nodes of the new binary tree
     class WeightExtractor : public std::unary_function<const particle_cache_type&, double>
     {
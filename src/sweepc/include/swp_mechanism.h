@@ -151,6 +151,9 @@ public:
         unsigned int start=0             // Optional vector start index.
         ) const;
 
+    //! Names of the rate terms, in the order of the jump counts.
+    void GetTermNames(std::vector<std::string> &names) const;
+
     // Initialise a list of particle-number particles using the given mechanism
     void InitialisePNParticles(
         double t,                  // Current solution time.
@@ -181,6 +184,12 @@ public:
     //! Reset the jump number vectors
     void ResetJumpCount() const;
 
+    //! Copies the jump number vectors, e.g. for a checkpoint
+    void GetJumpCount(std::vector<unsigned int> &proc, std::vector<unsigned int> &fict) const;
+
+    //! Restores jump number vectors copied by GetJumpCount
+    void SetJumpCount(const std::vector<unsigned int> &proc, const std::vector<unsigned int> &fict) const;
+
     // Get rates of all processes separated into different
     // terms.  Rate terms are useful for subsequent particle
     // selection by different properties for the same process.
@@ -268,6 +277,15 @@ public:
 		rng_type &rng
 		) const;
 
+    //! As UpdateSections, but with one random jump for each particle;
+    //! the reference against which UpdateSections is tested
+	void UpdateSectionsPerParticle(
+		double t,   // Time up to which to integrate.
+		double dt,
+		Cell &sys,// System to update.
+		rng_type &rng
+		) const;
+
     //! Set properties of particle picked for coagulation/outflow using 
     //! distribution parameters
 	unsigned int SetRandomParticle(
@@ -360,6 +378,13 @@ private:
 
 	mutable int m_i_particle_species;         // Index of particulate species in gas-phase vector, used for enthalpy etc.
 
+    // Moves count particles of the particle-number list up from index i
+    // by jump indices, adding those which reach the threshold size to the
+    // ensemble.
+    void moveSection(double t, Cell &sys, const Particle &sp_threshold,
+                     unsigned int i, unsigned int count, unsigned int jump,
+                     rng_type &rng) const;
+
     // Clears the mechanism from memory.
     void releaseMem(void);
 
@@ -46,6 +46,7 @@
 #include <cmath>
 #include <vector>
 #include <boost/random/mersenne_twister.hpp>
+#include "swp_philox.h"
 
 namespace Sweep
 {
@@ -53,7 +54,11 @@ namespace Sweep
     typedef Sprog::fvector fvector;
 
     //! Type of random number generator to use throughout sweep
+#ifdef SWEEP_PHILOX_RNG
+    typedef Philox4x32 rng_type;
+#else
     typedef boost::mt19937 rng_type;
+#endif
 
     const double PI         = Sprog::PI;
     const double ONE_THIRD  = Sprog::ONE_THIRD;
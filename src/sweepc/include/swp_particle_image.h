@@ -79,6 +79,12 @@ public:
     // Constructs the particle image from the given particle.
     void Construct(const Particle &sp, const ParticleModel &model);
 
+    //! Constructs the particle image, drawing the orientations from rng.
+    void Construct(const Particle &sp, const ParticleModel &model, rng_type &rng);
+
+    //! Returns the primary coordinates (x, y, z and radius, in nm).
+    void GetPriCoords(std::vector<fvector> &coords) const;
+
     // RENDERING FUNCTIONS.
     //! Writes 3dout file (Markus Sander), deprecated
     void Write3dout(std::ofstream &file, double x, double y, double z);
@@ -87,6 +93,14 @@ public:
     void WritePOVRAY(
         std::ofstream &file // Output file stream.
         );
+
+    //! Constructs the images of many particles concurrently and
+    //! writes them to a single POVRAY file.
+    static void WriteBatchPOVRAY(
+        std::ofstream &file,                          //!< Output file stream.
+        const std::vector<const Particle*> &particles, //!< Particles to draw.
+        unsigned int seed                             //!< Seed of the image streams.
+        );
     
     /*!
      * @brief       Loop helper function to construct particle images
@@ -120,6 +134,19 @@ private:
     // Amount of necking between particles in output.
     static const double m_necking;
 
+    //! Centre and radius of a primary, for the collision search.
+    struct Sphere
+    {
+        double x, y, z, r;
+    };
+
+    //! Uniform grid of the x-y projections of the primaries of an
+    //! aggregate, searched for the first collision along z.
+    class CollisionGrid;
+
+    //! Appends the primaries below a node.
+    static void getLeaves(const ImgNode &node, std::vector<Sphere> &leaves);
+
     // AGGREGATE SPHERE-TREE CONSTRUCTORS (FREE-MOLECULAR).
 
     //! Generate the free-molecular structure of a particle.
@@ -191,14 +218,6 @@ private:
         const bool trackPrimaryCoordinates //!< Flag used to indicate whether to track primary coordinates.
         );
 
-    //! Calculates the minimum collision distance.
-    static bool minCollZ(
-        const ImgNode &target, //!< Target node.
-        const ImgNode &bullet, //!< Bullet node.
-        double dx, double dy,  //!< Bullet x-y displacements.
-        double &dz             //!< Return minimum distance.
-        );
-
     // OUTPUT FUNCTIONS.
 
 };
@@ -106,6 +106,9 @@ public:
         double scale         // Scaling factor to unit volume (summed stats).
         );
 
+    //! Allows Calculate to split the sums over the ensemble between threads.
+    void SetThreadedReduction(bool threaded);
+
     // Returns a vector containing the stats.
     const fvector &Get(void) const;
 
@@ -212,12 +215,21 @@ private:
     // PSL count and indices.
     static const unsigned int PSL_COUNT = 9;
 
+    // Particles whose properties are gathered and summed together
+    // by Calculate, and the number of properties for each particle
+    // besides the components and tracker variables.
+    static const unsigned int BLOCK_SIZE = 1024;
+    static const unsigned int COLUMN_COUNT = 8;
+
     // Component and tracker counts.
     unsigned int m_ncomp, m_ntrack;
 
     // The stats.
     fvector m_stats;
 
+    // Whether Calculate may split the sums between threads.
+    bool m_threaded;
+
     // The stat names.
     static const std::string m_statnames[STAT_COUNT];
     std::vector<std::string> m_names;
@@ -233,6 +245,18 @@ private:
     // components and tracker variables there are for
     // each particle.
     ParticleStats(void); // Default constructor.
+
+    // Gathers the properties of particles [begin, end) of the ensemble
+    // into the columns of cols and adds their weighted sums to sums,
+    // which is laid out like m_stats.
+    void sumBlock(
+        const Ensemble &e,      // Ensemble from which to get stats.
+        unsigned int begin,     // First particle of the block.
+        unsigned int end,       // One past the last particle of the block.
+        fvector &cols,          // Workspace for the gathered properties.
+        double *sums,           // Output weighted sums.
+        unsigned int &maxCoag   // Output max. number of coags in the block.
+        ) const;
 };
 };
 }
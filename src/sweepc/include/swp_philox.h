@@ -0,0 +1,249 @@
+/*
+  Project:        sweep (population balance solver)
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    The Philox-4x32-10 counter-based random number generator of Salmon
+    et al., "Parallel random numbers: as easy as 1, 2, 3", SC11 (2011).
+
+    Each block of four 32-bit outputs is a keyed bijection of a 128-bit
+    counter, so the state is a key and a counter of six words in all.
+    Skipping ahead is O(1) and independent streams can be derived from a
+    generator in O(1) by hashing an identifier into a new key, which lets
+    a run give each cell, process or particle its own stream whatever
+    the order in which they are simulated.
+
+    The class models the Boost.Random uniform random number generator
+    concept, so the boost distributions used with boost::mt19937
+    (uniform_01, poisson, bernoulli, exponential, ...) work with it
+    unchanged.  Build with SWEEP_PHILOX_RNG defined (cmake
+    -DSWEEP_PHILOX_RNG=ON) to use it as Sweep::rng_type.
+
+  Licence:
+    This file is part of "sweepc".
+
+    sweepc is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef SWEEP_PHILOX_H
+#define SWEEP_PHILOX_H
+
+#include <istream>
+#include <ostream>
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+namespace Sweep
+{
+//! Philox-4x32-10 counter-based random number generator.
+class Philox4x32
+{
+public:
+    typedef boost::uint32_t result_type;
+    BOOST_STATIC_CONSTANT(bool, has_fixed_range = false);
+
+    //! Seeds with the default seed of boost::mt19937.
+    Philox4x32() {seed();}
+
+    //! Seeds with the given value, which is used as the key.
+    explicit Philox4x32(boost::uint64_t value) {seed(value);}
+
+    void seed() {seed(5489u);}
+
+    //! Sets the key to the value and restarts the counter from zero.
+    void seed(boost::uint64_t value)
+    {
+        m_key[0] = static_cast<result_type>(value);
+        m_key[1] = static_cast<result_type>(value >> 32);
+        m_ctr[0] = m_ctr[1] = m_ctr[2] = m_ctr[3] = 0;
+        m_index = 4;
+    }
+
+    static result_type min BOOST_PREVENT_MACRO_SUBSTITUTION () {return 0;}
+    static result_type max BOOST_PREVENT_MACRO_SUBSTITUTION () {return 0xFFFFFFFFu;}
+
+    //! Returns the next number.
+    result_type operator()()
+    {
+        if (m_index == 4) generate();
+        return m_out[m_index++];
+    }
+
+    //! Skips the next z numbers in constant time.
+    void discard(boost::uint64_t z)
+    {
+        // Use up the current block, then skip whole blocks.
+        while (z > 0 && m_index < 4) {
+            ++m_index;
+            --z;
+        }
+        increment(z / 4);
+        if (z % 4 != 0) {
+            generate();
+            m_index = static_cast<unsigned int>(z % 4);
+        }
+    }
+
+    /*!
+     * Derives a generator for the stream with the given identifier.  The
+     * new key is a hash of this generator's key and the identifier, and
+     * its counter starts from zero, so the stream does not depend on how
+     * many numbers have been drawn from this generator.  Derivations
+     * nest, so that rng.Stream(cell).Stream(process).Stream(particle)
+     * gives a stream for each triple of identifiers.
+     */
+    Philox4x32 Stream(boost::uint64_t id) const
+    {
+        // The last two counter words distinguish these hashes from the
+        // blocks of any stream.
+        const result_type ctr[4] = {static_cast<result_type>(id),
+                                    static_cast<result_type>(id >> 32),
+                                    0x53545245u, 0x414D4B59u};
+        result_type out[4];
+        Bijection(ctr, m_key, out);
+
+        Philox4x32 s;
+        s.m_key[0] = out[0];
+        s.m_key[1] = out[1];
+        return s;
+    }
+
+    //! The keyed bijection from counters to blocks of four outputs.
+    static void Bijection(const result_type ctr[4], const result_type key[2],
+                          result_type out[4])
+    {
+        result_type c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+        result_type k0 = key[0], k1 = key[1];
+        for (int r = 0; r != 10; ++r) {
+            if (r > 0) {
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            const boost::uint64_t p0 = static_cast<boost::uint64_t>(0xD2511F53u) * c0;
+            const boost::uint64_t p1 = static_cast<boost::uint64_t>(0xCD9E8D57u) * c2;
+            const result_type hi0 = static_cast<result_type>(p0 >> 32), lo0 = static_cast<result_type>(p0);
+            const result_type hi1 = static_cast<result_type>(p1 >> 32), lo1 = static_cast<result_type>(p1);
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    friend bool operator==(const Philox4x32 &a, const Philox4x32 &b)
+    {
+        if (a.m_key[0] != b.m_key[0] || a.m_key[1] != b.m_key[1] || a.m_index != b.m_index)
+            return false;
+        for (int i = 0; i != 4; ++i) {
+            if (a.m_ctr[i] != b.m_ctr[i]) return false;
+        }
+        // The blocks only matter where they have not been used.
+        for (unsigned int i = a.m_index; i != 4; ++i) {
+            if (a.m_out[i] != b.m_out[i]) return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const Philox4x32 &a, const Philox4x32 &b) {return !(a == b);}
+
+    //! Writes the state as text, as the boost generators do.
+    template<class CharT, class Traits>
+    friend std::basic_ostream<CharT, Traits> &
+    operator<<(std::basic_ostream<CharT, Traits> &os, const Philox4x32 &g)
+    {
+        os << g.m_key[0] << ' ' << g.m_key[1];
+        for (int i = 0; i != 4; ++i) os << ' ' << g.m_ctr[i];
+        os << ' ' << g.m_index;
+        return os;
+    }
+
+    //! Reads a state written by operator<<.
+    template<class CharT, class Traits>
+    friend std::basic_istream<CharT, Traits> &
+    operator>>(std::basic_istream<CharT, Traits> &is, Philox4x32 &g)
+    {
+        is >> g.m_key[0] >> std::ws >> g.m_key[1];
+        for (int i = 0; i != 4; ++i) is >> std::ws >> g.m_ctr[i];
+        is >> std::ws >> g.m_index;
+        if (g.m_index < 4) {
+            // Recompute the current block, whose counter is one behind.
+            g.decrement();
+            const unsigned int index = g.m_index;
+            g.generate();
+            g.m_index = index;
+        } else {
+            g.m_index = 4;
+        }
+        return is;
+    }
+
+private:
+    //! Computes the block for the counter and moves the counter on.
+    void generate()
+    {
+        Bijection(m_ctr, m_key, m_out);
+        increment(1);
+        m_index = 0;
+    }
+
+    //! Adds n to the 128-bit counter.
+    void increment(boost::uint64_t n)
+    {
+        const boost::uint64_t lo = (static_cast<boost::uint64_t>(m_ctr[1]) << 32) | m_ctr[0];
+        const boost::uint64_t sum = lo + n;
+        m_ctr[0] = static_cast<result_type>(sum);
+        m_ctr[1] = static_cast<result_type>(sum >> 32);
+        if (sum < lo && ++m_ctr[2] == 0) ++m_ctr[3];
+    }
+
+    //! Subtracts one from the 128-bit counter.
+    void decrement()
+    {
+        if (m_ctr[0]-- == 0 && m_ctr[1]-- == 0 && m_ctr[2]-- == 0) --m_ctr[3];
+    }
+
+    //! Key, which selects the bijection.
+    result_type m_key[2];
+
+    //! Counter of the next block.
+    result_type m_ctr[4];
+
+    //! Current block of outputs.
+    result_type m_out[4];
+
+    //! Position of the next output in m_out; 4 when it is used up.
+    unsigned int m_index;
+};
+} // namespace Sweep
+
+#endif
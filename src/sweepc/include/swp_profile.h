@@ -0,0 +1,174 @@
+/*
+  Project:        sweep (population balance solver)
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Compile-time switchable timers for the parts of the stochastic
+    stepping algorithm.  Build with SWEEP_PROFILE defined (cmake
+    -DSWEEP_PROFILE=ON) to enable them; otherwise the SWEEP_PROFILE_*
+    macros expand to nothing.
+
+    Every call of a section is counted, but only one call in
+    SampleInterval of the sections run for each jump is timed, because
+    reading the clock around each jump would cost more than the cheaper
+    jumps themselves.  Their times are scaled up from the timed calls
+    when the counters are collected.
+
+  Licence:
+    This file is part of "sweepc".
+
+    sweepc is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#ifndef SWEEP_PROFILE_H
+#define SWEEP_PROFILE_H
+
+#include <ctime>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace Sweep
+{
+namespace Profile
+{
+//! Timed parts of the stochastic stepping algorithm.  The sections up
+//! to Perform run once for each jump and are sampled.
+enum Section {
+    RateTerms,   // Mechanism::CalcJumpRateTerms.
+    Selection,   // Choosing the process of a jump.
+    Perform,     // Mechanism::DoProcess.
+    Transport,   // Mechanism::DoParticleFlow.
+    LPDA,        // Mechanism::LPDA.
+    Sections,    // Mechanism::UpdateSections (particle-number model).
+    Doubling,    // Ensemble doubling.
+    Contraction, // Ensemble contraction.
+    SectionCount
+};
+
+//! Name of a section, for output.
+const char *SectionName(Section s);
+
+//! One call in this many of the sampled sections is timed, on each thread.
+const unsigned int SampleInterval = 16;
+
+typedef unsigned long long tick_type;
+
+//! Reads the time stamp counter, or the CPU clock where there is none.
+inline tick_type Ticks(void)
+{
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    return (tick_type)std::clock();
+#endif
+}
+
+//! Calls and (estimated) ticks counted since the last Reset.
+struct Summary
+{
+    tick_type Calls[SectionCount];
+    tick_type Time[SectionCount];
+
+    //! Calls and ticks of DoProcess for each process term.
+    std::vector<tick_type> TermCalls, TermTime;
+
+    //! Ticks in one second of wall-clock time, measured over the
+    //! period since the last Reset.
+    double TicksPerSecond;
+
+    //! Wall-clock time since the last Reset (s).
+    double Seconds;
+};
+
+//! Clears the counters of all threads and starts the clock calibration.
+void Reset(void);
+
+//! Adds up the counters of all threads.
+void Collect(Summary &s);
+
+//! Should the call of section s starting now on this thread be timed?
+bool Sample(Section s);
+
+//! Adds a call of a section to the counters of this thread; ticks is
+//! only used if the call was sampled.
+void Add(Section s, tick_type ticks, bool sampled);
+
+//! Adds a DoProcess call for process term i to the counters of this
+//! thread, which also counts as a call of Perform.
+void AddTerm(unsigned int i, tick_type ticks, bool sampled);
+
+//! Times a section from construction to destruction.
+class ScopedTimer
+{
+public:
+    ScopedTimer(Section s)
+    : m_section(s), m_sampled(Sample(s)), m_start(m_sampled ? Ticks() : 0) {}
+    ~ScopedTimer(void)
+    {
+        Add(m_section, m_sampled ? Ticks() - m_start : 0, m_sampled);
+    }
+private:
+    Section m_section;
+    bool m_sampled;
+    tick_type m_start;
+};
+
+//! Times DoProcess for a process term.
+class ScopedTermTimer
+{
+public:
+    ScopedTermTimer(unsigned int i)
+    : m_term(i), m_sampled(Sample(Perform)), m_start(m_sampled ? Ticks() : 0) {}
+    ~ScopedTermTimer(void)
+    {
+        AddTerm(m_term, m_sampled ? Ticks() - m_start : 0, m_sampled);
+    }
+private:
+    unsigned int m_term;
+    bool m_sampled;
+    tick_type m_start;
+};
+} // Profile namespace
+} // Sweep namespace
+
+#ifdef SWEEP_PROFILE
+#define SWEEP_PROFILE_SCOPE(section) \
+    Sweep::Profile::ScopedTimer sweepProfileTimer(Sweep::Profile::section)
+#define SWEEP_PROFILE_TERM(i) \
+    Sweep::Profile::ScopedTermTimer sweepProfileTermTimer(i)
+#else
+#define SWEEP_PROFILE_SCOPE(section)
+#define SWEEP_PROFILE_TERM(i)
+#endif
+
+#endif
@@ -4088,6 +4088,29 @@ void PAHPrimary::SerializePrimary(std::ostream &out, void *duplicates) const
 	}
 }
 
+/*!
+ * Appends the PAHs referenced by this primary to a list, in the order in
+ * which Serialize meets them, skipping those already in seen.  Passing the
+ * filled set to Serialize then writes only the addresses of the PAHs, so
+ * that the PAHs can be stored once in a separate table.
+ *
+ * @param[in,out]    seen    Addresses of PAHs that are already listed
+ * @param[in,out]    pahs    List of PAHs to which new ones are appended
+ */
+void PAHPrimary::CollectPAHs(PahSerialisationMap &seen, std::vector<const PAH*> &pahs) const
+{
+    for (size_t i = 0; i != m_PAH.size(); ++i) {
+        if (seen.insert(m_PAH[i].get()).second)
+            pahs.push_back(m_PAH[i].get());
+    }
+
+    // The whole tree is only serialised if binary trees are written
+    if (m_pmodel->WriteBinaryTrees() && m_leftchild != NULL && m_rightchild != NULL) {
+        m_leftchild->CollectPAHs(seen, pahs);
+        m_rightchild->CollectPAHs(seen, pahs);
+    }
+}
+
 /*
  * @brief Writes individual PAHs to a binary stream 
  *
@@ -223,6 +223,29 @@ void Cell::SetParticles(
     assert(isValid());
 }
 
+/**
+ * Add the particles in the range [particle_list_begin, particle_list_end)
+ * to those already in the ensemble, downsampling if the capacity is
+ * exceeded.  Like SetParticles this clears the scaling stored inside the
+ * ensemble, which is moved into the sample volume so that the statistical
+ * weight of the cell does not change.
+ *
+ *@param[in]        particle_list_begin     Iterator to first in range of particle pointers to insert
+ *@param[in]        particle_list_end       Iterator to one past end of range of particle pointers to insert
+ *@param[in,out]    rng                     Random number generator
+ */
+void Cell::AddParticles(
+        std::list<Particle*>::iterator particle_list_begin,
+        std::list<Particle*>::iterator particle_list_end,
+        rng_type &rng)
+{
+    const double smpvol = SampleVolume();
+    m_ensemble.AddParticles(particle_list_begin, particle_list_end, rng);
+
+    m_smpvol = smpvol;
+    assert(isValid());
+}
+
 // Returns particle statistics.
 void Cell::GetVitalStats(Stats::EnsembleStats &stats) const
 {
@@ -450,6 +473,7 @@ void Cell::Deserialize(std::istream &in, const Sweep::ParticleModel &model)
                 pGas->Implementation()->Deserialize(in);
                 // Set the species, because the pointer gets reset in Sprog::Mixture::Deserialize
                 pGas->Implementation()->SetSpecies(*model.Species());
+                delete m_gas;
                 m_gas = pGas;
                 break;
             }
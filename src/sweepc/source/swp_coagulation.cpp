@@ -234,8 +234,8 @@ int Coagulation::WeightedPerform(const double t, const Sweep::PropID prop1,
 
 	PartPtrVector dummy;
 
-    int ip1 = sys.Particles().Select(prop1, rng);
-    int ip2 = sys.Particles().Select(prop2, rng);
+    int ip1 = -1, ip2 = -1;
+    sys.Particles().SelectPair(prop1, prop2, rng, ip1, ip2);
 
     // Choose and get first particle, then update it.
     Particle *sp1=NULL;
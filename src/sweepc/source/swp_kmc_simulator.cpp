@@ -46,6 +46,7 @@
 
 #include "gpc_mech.h"
 #include "gpc_mech_io.h"
+#include "gpc_gas_profile_io.h"
 
 #include "csv_io.h"
 
@@ -461,157 +462,109 @@ void KMCSimulator::LoadGasProfiles(const std::string gasphase, const std::string
     // Clear the current gas-phase profile.
     m_gasprof->clear();
 
-    // Open the file to read.
-    ifstream fin(gasphase.c_str(), ios::in);
-    if (!fin.good()) {
-        throw runtime_error("Unable to open gas profile input "
-                            "file (Sweep, KMCSimulator::LoadGasProfile).");
-    }
-
-    // Variables read from file.
-    vector<string> subs;
-    string delim = ",\t \r"; // Possible file delimiters (comma, tab and space).
-    string line;
-
-    // Get the first line (should be the header defining the columns).
-    if (!getline(fin, line).eof()) {
+    // Read the file; binary profiles are memory-mapped rather than parsed.
+    boost::shared_ptr<const Sprog::IO::GasProfileFile> prof =
+        Sprog::IO::GasProfileFile::Open(gasphase);
+    vector<string> subs = prof->Columns();
 
-        // Split the line to get the column headings.
-        split(line, subs, delim);
+    // Get important column indices (time, temperature and pressure).
+    int tcol=-1, Tcol=-1, Pcol=-1;
+    tcol = findinlist(string("Time"), subs);
 
-        // Get important column indices (time, temperature and pressure).
-        int tcol=-1, Tcol=-1, Pcol=-1;
-        tcol = findinlist(string("Time"), subs);
+    Tcol = findinlist(string("T"), subs);
+    if(Tcol < 0)
+        Tcol = findinlist(string("T[K]"), subs);
 
-        Tcol = findinlist(string("T"), subs);
-        if(Tcol < 0)
-            Tcol = findinlist(string("T[K]"), subs);
+    Pcol = findinlist(string("P"), subs);
 
-        Pcol = findinlist(string("P"), subs);
+    // Columns to ignore, but which are useful to have in files for brush compatibility
+    int Xcol = findinlist(string("X[cm]"), subs);
+    int Dcol = findinlist(string("RHO[g/cm3]"), subs);
+    int Vcol = findinlist(string("V[cm/s]"), subs);
+    int Gcol = findinlist(string("GradT"), subs);
+    int Acol = findinlist(string("Alpha"), subs);
+    int Rcol = findinlist(string("wdotA4"), subs);
 
-        // Columns to ignore, but which are useful to have in files for brush compatibility
-        int Xcol = findinlist(string("X[cm]"), subs);
-        int Dcol = findinlist(string("RHO[g/cm3]"), subs);
-        int Vcol = findinlist(string("V[cm/s]"), subs);
-        int Gcol = findinlist(string("GradT"), subs);
-        int Acol = findinlist(string("Alpha"), subs);
-        int Rcol = findinlist(string("wdotA4"), subs);
 
+    // Check that the file contains required columns.
+    if (tcol < 0) {
+        throw runtime_error("Gas-phase profile contains no Time "
+                            "column (Sweep::KMCSimulator::LoadGasProfiles).");
+    }
+    if (Tcol < 0) {
+        throw runtime_error("Gas-phase profile contains no temperature "
+                            "column (Sweep::KMCSimulator::LoadGasProfiles).");
+    }
+    if (Pcol < 0) {
+        throw runtime_error("Gas-phase profile contains no pressure "
+                            "column (Sweep::KMCSimulator::LoadGasProfiles).");
+    }
 
-        // Check that the file contains required columns.
-        if (tcol < 0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no Time "
-                                "column (Sweep::KMCSimulator::LoadGasProfiles).");
-        }
-        if (Tcol < 0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no temperature "
-                                "column (Sweep::KMCSimulator::LoadGasProfiles).");
-        }
-        if (Pcol < 0) {
-            fin.close();
-            throw runtime_error("Gas-phase profile contains no pressure "
-                                "column (Sweep::KMCSimulator::LoadGasProfiles).");
-        }
-
-        // All other columns are chemical species.  Add them, and note
-        // their columns.
-        map<unsigned int,int> spcols;
-        for (int i=0; (unsigned)i!=subs.size(); ++i) {
-            if ((i!=tcol) && (i!=Tcol) && (i!=Pcol) && (i!=Acol) && (i!=Rcol) &&
-                (i!=Xcol) && (i!=Dcol) && (i!=Vcol) && (i!=Gcol)) {
-                // Try to find this species in the mechanism
-                const int speciesMechIndex = m_mech->FindSpecies(subs[i]);
-
-                if(speciesMechIndex < 0) {
-                    std::ostringstream msg("Failed to find species ");
-                    msg << subs[i] << " in mechanism (Sweep::KMCSimulator::LoadGasProfiles).";
-                    throw std::runtime_error(msg.str());
-                }
-                // Found species
-                spcols[i] = speciesMechIndex;
+    // All other columns are chemical species.  Note their columns and
+    // the species they hold.
+    vector<unsigned int> spcols;
+    vector<int> spindices;
+    for (int i=0; (unsigned)i!=subs.size(); ++i) {
+        if ((i!=tcol) && (i!=Tcol) && (i!=Pcol) && (i!=Acol) && (i!=Rcol) &&
+            (i!=Xcol) && (i!=Dcol) && (i!=Vcol) && (i!=Gcol)) {
+            // Try to find this species in the mechanism
+            const int speciesMechIndex = m_mech->FindSpecies(subs[i]);
+
+            if(speciesMechIndex < 0) {
+                std::ostringstream msg("Failed to find species ");
+                msg << subs[i] << " in mechanism (Sweep::KMCSimulator::LoadGasProfiles).";
+                throw std::runtime_error(msg.str());
             }
+            // Found species
+            spcols.push_back(i);
+            spindices.push_back(speciesMechIndex);
         }
+    }
 
-        // Now we can read the profile.
-        while(!getline(fin, line).eof()) {
-            // Set t=0 and create a new IdealGas object.
-            double t = 0.0;
-            double T = 0.0;
-            double P = 0.0;
-            double alpha = 0.0;
-            double PAHRate = 0.0;
-            GasPoint gpoint(m_mech->Species());
-
-            // Split the line by columns.
-            split(line, subs, delim);
-
-            // Check that the mole fractions sum to 1
-            double checkSum = 0.0;
-
-            // Loop over all the elements in the line and save them
-            // to the correct gas-phase variable.
-            for (int i=0; (unsigned)i!=subs.size(); ++i) {
-                if (i==tcol) {
-                    // This is the Time column.
-                    t = cdble(subs[i]);
-                    gpoint.Time = t;
-                } else if (i==Tcol) {
-                    // This is the temperature column.
-                    T = cdble(subs[i]);
-                } else if (i==Pcol) {
-                    // This is the pressure column.
-                    P = cdble(subs[i]);
-                } else if (i==Acol) {
-                    alpha = cdble(subs[i]);
-                } else if (i==Rcol) {
-                    PAHRate = cdble(subs[i]);
-                } else {
-                    // This is a gas-phase species column.
-                    map<unsigned int,int>::iterator isp = spcols.find(i);
-                    if (isp != spcols.end()) {
-                        const double frac = cdble(subs[i]);
-                        assert(isp->second >= 0);
-                        gpoint.Gas.RawData()[isp->second] = frac;
-                        checkSum += frac;
-                    }
-                }
-            }
-
-            if((checkSum < 0.997) || checkSum > 1.003) {
-                std::ostringstream msg;
-                msg << "Mole fractions sum to " << checkSum
-                    << ", but should sum to 1.000 (KMCSimulator::LoadGasProfiles)";
-                throw std::runtime_error(msg.str());
-            }
+    // Now we can read the profile.
+    m_gasprof->reserve(prof->PointCount());
+    for (size_t k=0; k!=prof->PointCount(); ++k) {
+        const double *row = prof->Row(k);
+        GasPoint gpoint(m_mech->Species());
+        const double t = row[tcol];
+        const double T = row[Tcol];
+        const double P = row[Pcol];
+        const double alpha = (Acol >= 0) ? row[Acol] : 0.0;
+        const double PAHRate = (Rcol >= 0) ? row[Rcol] : 0.0;
+        gpoint.Time = t;
+
+        // Copy the mole fractions, checking that they sum to 1.
+        double checkSum = 0.0;
+        for (size_t j=0; j!=spcols.size(); ++j) {
+            const double frac = row[spcols[j]];
+            gpoint.Gas.RawData()[spindices[j]] = frac;
+            checkSum += frac;
+        }
 
-            // Set up the gas-phase by setting temperature, pressure and
-            // normalising the mixture fractions.
-            // TODO:  This will give the wrong component densities
-            //        unless all species are specified!
-            gpoint.Gas.SetTemperature(T);
-            gpoint.Gas.SetPressure(P*1.0e5);
-            gpoint.Gas.Normalise();
-            gpoint.Gas.SetPAHFormationRate(PAHRate*1E6);
-
-            // Add the profile point.
-            alpha_prof[t] = alpha;
-            m_gasprof->push_back(gpoint);
+        if((checkSum < 0.997) || checkSum > 1.003) {
+            std::ostringstream msg;
+            msg << "Mole fractions sum to " << checkSum
+                << ", but should sum to 1.000 (KMCSimulator::LoadGasProfiles)";
+            throw std::runtime_error(msg.str());
         }
 
-        // Close the input file.
-        fin.close();
-
-        // Sort the profile by time.
-        SortGasProfile(*m_gasprof);
-        m_gas = new KMCGasPoint(*m_gasprof, m_mech->Species());
-    } else {
-        // There was no data in the file.
-        fin.close();
-        throw runtime_error("Input file contains no data "
-                            "(Sweep::KMCSimulator::LoadGasProfiles).");
+        // Set up the gas-phase by setting temperature, pressure and
+        // normalising the mixture fractions.
+        // TODO:  This will give the wrong component densities
+        //        unless all species are specified!
+        gpoint.Gas.SetTemperature(T);
+        gpoint.Gas.SetPressure(P*1.0e5);
+        gpoint.Gas.Normalise();
+        gpoint.Gas.SetPAHFormationRate(PAHRate*1E6);
+
+        // Add the profile point.
+        alpha_prof[t] = alpha;
+        m_gasprof->push_back(gpoint);
     }
+
+    // Sort the profile by time.
+    SortGasProfile(*m_gasprof);
+    m_gas = new KMCGasPoint(*m_gasprof, m_mech->Species());
 }
 //! Write column headings for CSV files
 void KMCSimulator::writeCSVlabels() {
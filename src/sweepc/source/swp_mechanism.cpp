@@ -41,6 +41,7 @@
 */
 
 #include "swp_mechanism.h"
+#include "swp_profile.h"
 #include "swp_model_factory.h"
 #include "swp_process_factory.h"
 #include "swp_tempwriteXmer.h"
@@ -51,6 +52,7 @@
 #include <stdexcept>
 #include <cassert>
 #include <boost/random/poisson_distribution.hpp>
+#include <boost/random/binomial_distribution.hpp>
 #include <boost/random/discrete_distribution.hpp>
 #include <boost/math/special_functions/erf.hpp>
 #include <boost/random/uniform_01.hpp>
@@ -356,6 +358,40 @@ void Mechanism::GetProcessNames(std::vector<std::string> &names,
     }
 }
 
+/*!
+ * Processes with more than one rate term, such as coagulation with a
+ * majorant kernel, have one name for each term, with the term number in
+ * brackets.
+ *
+ * @param[out]  names   Names of all m_termcount terms
+ */
+void Mechanism::GetTermNames(std::vector<std::string> &names) const
+{
+    names.clear();
+    names.reserve(m_termcount);
+
+    for (unsigned int j=0; j!=m_inceptions.size(); ++j) {
+        names.push_back(m_inceptions[j]->Name());
+    }
+    for (unsigned int j=0; j!=m_processes.size(); ++j) {
+        names.push_back(m_processes[j]->Name());
+    }
+    for (unsigned int j=0; j!=m_coags.size(); ++j) {
+        const unsigned int n = m_coags[j]->TermCount();
+        for (unsigned int k=0; k!=n; ++k) {
+            names.push_back(n == 1 ? m_coags[j]->Name() :
+                            m_coags[j]->Name() + " (" + Strings::cstr(k+1) + ")");
+        }
+    }
+    for (unsigned int j=0; j!=m_frags.size(); ++j) {
+        const unsigned int n = m_frags[j]->TermCount();
+        for (unsigned int k=0; k!=n; ++k) {
+            names.push_back(n == 1 ? m_frags[j]->Name() :
+                            m_frags[j]->Name() + " (" + Strings::cstr(k+1) + ")");
+        }
+    }
+}
+
 // Initialise a list of PN particles using the given mechanism
 void Mechanism::InitialisePNParticles(double t, Cell &sys, const Mechanism &mech) const
 {
@@ -524,6 +560,30 @@ void Mechanism::ResetJumpCount() const {
     fill(m_fictcount.begin(), m_fictcount.end(), 0.0);
 }
 
+/*!
+ * @param[out]  proc    Number of jumps of each process
+ * @param[out]  fict    Number of fictitious jumps of each process
+ */
+void Mechanism::GetJumpCount(std::vector<unsigned int> &proc, std::vector<unsigned int> &fict) const {
+    proc = m_proccount;
+    fict = m_fictcount;
+}
+
+/*!
+ * @param[in]   proc    Number of jumps of each process
+ * @param[in]   fict    Number of fictitious jumps of each process
+ *
+ * @exception   invalid_argument    Vector lengths do not match the mechanism
+ */
+void Mechanism::SetJumpCount(const std::vector<unsigned int> &proc, const std::vector<unsigned int> &fict) const {
+    if (proc.size() != m_proccount.size() || fict.size() != m_fictcount.size()) {
+        throw invalid_argument("Jump counts do not match the mechanism "
+                               "(Sweep, Mechanism::SetJumpCount).");
+    }
+    m_proccount = proc;
+    m_fictcount = fict;
+}
+
 
 // Get rates of all processes separated into different
 // terms.  Rate terms are useful for subsequent particle
@@ -583,6 +643,7 @@ double Mechanism::CalcRateTerms(double t, const Cell &sys, const Geometry::Local
 // of all rates.
 double Mechanism::CalcJumpRateTerms(double t, const Cell &sys, const Geometry::LocalGeometry1d& local_geom, fvector &terms) const
 {
+    SWEEP_PROFILE_SCOPE(RateTerms);
     // This routine only calculates the rates of those processes which are
     // not deferred.  The rate terms of deferred processes are returned
     // as zero.
@@ -791,6 +852,8 @@ void Mechanism::DoProcess(unsigned int i, double t, Cell &sys,
                           const Geometry::LocalGeometry1d& local_geom,
                           rng_type &rng) const
 {
+    SWEEP_PROFILE_TERM(i);
+
     // Test for now
     assert(sys.ParticleModel() != NULL);
 
@@ -895,6 +958,7 @@ void Mechanism::DoParticleFlow(
         Cell &sys,
         const Geometry::LocalGeometry1d& local_geom,
         rng_type &rng) const {
+    SWEEP_PROFILE_SCOPE(Transport);
     Processes::ProcessPtrVector flows;
     std::vector<double> rates;
 
@@ -987,6 +1051,8 @@ void Mechanism::MassTransfer(int i, double t, Cell &sys, rng_type &rng, const Ge
  */
 void Mechanism::LPDA(double t, Cell &sys, rng_type &rng) const
 {
+    SWEEP_PROFILE_SCOPE(LPDA);
+
     // Check that there are particles to update and that there are
     // deferred processes to perform.
     if ((sys.ParticleCount() > 0) &&
@@ -1015,8 +1081,10 @@ void Mechanism::LPDA(double t, Cell &sys, rng_type &rng) const
         }
         // aab64: Could the particle updates be made more efficient here using OpenMP parallelization? 
 
-		// Now remove any invalid particles and update the ensemble.
-		sys.Particles().RemoveInvalids();
+		// Now remove any invalid particles and update the ensemble.  The
+		// updates have changed the caches of all the particles, so the
+		// whole tree is rebuilt.
+		sys.Particles().RemoveInvalids(true);
 
 		if (sys.ParticleModel()->Components(0)->WeightedPAHs() && AggModel() == AggModels::PAH_KMC_ID){
 			//Check for duplicates
@@ -1090,9 +1158,12 @@ void Mechanism::LPDA(double t, Cell &sys, rng_type &rng) const
 
 // LINEAR PROCESS DEFERMENT ALGORITHM #2: Hybrid particle-number/particle model
 // Applies surface updates to particles tracked in the particle-number list
-// Note: this method is less optimal than the one commented out below it, but
-// it produces results more similar to the standard particle model because random
-// choices for surface events are applied to only one particle at the index each time.
+// Each particle still makes its own random jump, as in the standard particle
+// model, but the jumps of all the particles at an index are drawn together:
+// the numbers of particles making jumps of 0, 1, 2, ... indices are
+// multinomial, and are drawn as a sequence of binomials, each conditional
+// on the particles not yet placed.  This takes about as many draws as the
+// largest jump, rather than one for each particle.
 /*!
 * Performs linear process updates on all particles in a system.
 *
@@ -1102,6 +1173,142 @@ void Mechanism::LPDA(double t, Cell &sys, rng_type &rng) const
 */
 void Mechanism::UpdateSections(double t, double dt, Cell &sys, rng_type &rng) const
 {
+	SWEEP_PROFILE_SCOPE(Sections);
+
+	// Above this mean jump the multinomial would take more draws than
+	// there are particles at most indices, and exp(-rate) loses precision.
+	const double maxBatchedRate = 100.0;
+
+	double rate_constant = 0.0;
+	unsigned int added_total = 0;
+	const unsigned int hybrid_threshold = sys.Particles().GetHybridThreshold();
+	Particle * sp_hybrid_threshold = sys.Particles().GetPNParticleAt(hybrid_threshold - 1)->Clone();
+	sp_hybrid_threshold->SetTime(t);
+
+	for (PartProcPtrVector::const_iterator j = m_processes.begin(); j != m_processes.end(); ++j)
+	{
+		if ((*j)->IsDeferred())
+		{
+			rate_constant = PI * ((*j)->Rate(t, sys) * dt);
+		}
+	}
+
+	for (unsigned int i = hybrid_threshold - 1; (i > 0) && (rate_constant > 0.0); --i)
+	{
+		const unsigned int n_index = sys.Particles().NumberAtIndex(i);
+		const double rate_index = rate_constant * sys.Particles().Diameter2AtIndex(i);
+		if (n_index == 0 || !(rate_index > 0.0))
+			continue;
+
+		if (n_index == 1 || rate_index > maxBatchedRate)
+		{
+			// One draw for each particle.
+			boost::random::poisson_distribution<unsigned, double> repeatDistrib(rate_index);
+			for (unsigned int n_el = 0; n_el != n_index; ++n_el)
+			{
+				const unsigned int num = repeatDistrib(rng);
+				if (num > 0)
+				{
+					moveSection(t, sys, *sp_hybrid_threshold, i, 1, num, rng);
+					added_total += num;
+				}
+			}
+		}
+		else
+		{
+			// p is the probability of a jump of k, tail that of a jump
+			// of k or more, so p/tail is the chance that one of the
+			// particles not yet placed jumps by exactly k.
+			unsigned int remaining = n_index;
+			double p = exp(-rate_index);
+			double tail = 1.0;
+			for (unsigned int k = 0; remaining > 0; ++k)
+			{
+				if (k > 0)
+					p *= rate_index / k;
+				unsigned int count = remaining;
+				if (p > 0.0 && p < tail)
+				{
+					boost::random::binomial_distribution<int, double> countDistrib((int)remaining, p / tail);
+					count = (unsigned int)countDistrib(rng);
+				}
+				tail -= p;
+				remaining -= count;
+				if (count > 0 && k > 0)
+				{
+					moveSection(t, sys, *sp_hybrid_threshold, i, count, k, rng);
+					added_total += count * k;
+				}
+			}
+		}
+	}
+
+	// The gas-phase updates are performed all at once, as in the
+	// per-particle update.
+	for (PartProcPtrVector::const_iterator i = m_processes.begin(); i != m_processes.end(); ++i)
+	{
+		if ((*i)->IsDeferred())
+		{
+			(*i)->Perform(t, sys, rng, added_total);
+		}
+	}
+	delete sp_hybrid_threshold;
+	sp_hybrid_threshold = NULL;
+}
+
+// Particles which cross the threshold all start as copies of the largest
+// particle in the list and grow by the same amount, so the grown particle
+// is made once and copied for each of them.
+void Mechanism::moveSection(double t, Cell &sys, const Particle &sp_threshold,
+                            unsigned int i, unsigned int count, unsigned int jump,
+                            rng_type &rng) const
+{
+	const unsigned int hybrid_threshold = sys.Particles().GetHybridThreshold();
+	const unsigned int index = i + jump;
+
+	sys.Particles().UpdateTotalsWithIndex(i, -1.0 * (double)count);
+	sys.Particles().UpdateNumberAtIndex(i, -(int)count);
+	if (index < hybrid_threshold)
+	{
+		sys.Particles().UpdateTotalsWithIndex(index, (double)count);
+		sys.Particles().UpdateNumberAtIndex(index, (int)count);
+		return;
+	}
+
+	sys.Particles().UpdateTotalParticleNumber(-(int)count);
+	const unsigned int n_add = index - (hybrid_threshold - 1);
+	Particle * sp_add = sp_threshold.Clone();
+	for (PartProcPtrVector::const_iterator j = m_processes.begin(); j != m_processes.end(); ++j)
+	{
+		if ((*j)->IsDeferred())
+		{
+			(*j)->Perform(t, sys, *sp_add, rng, n_add, true);
+			sp_add->UpdateCache();
+		}
+	}
+	for (unsigned int n = 0; n != count; ++n)
+	{
+		Particle * sp2 = sp_add->Clone();
+		sys.Particles().Add(*sp2, rng);
+	}
+	delete sp_add;
+}
+
+// Per-particle update which UpdateSections replaced, kept as the reference
+// for its tests.  This method is less optimal than the one commented out
+// below it, but it produces results more similar to the standard particle
+// model because random choices for surface events are applied to only one
+// particle at the index each time.
+/*!
+* Performs linear process updates on all particles in a system.
+*
+*@param[in,out]    sys         System containing particles to update
+*@param[in]        t           Time upto which particles to be updated
+*@param[in,out]    rng         Random number generator
+*/
+void Mechanism::UpdateSectionsPerParticle(double t, double dt, Cell &sys, rng_type &rng) const
+{
+	SWEEP_PROFILE_SCOPE(Sections);
 	double rate_constant = 0.0, rate_index = 0.0;
 	unsigned int n_index = 0, index = 0, n_add = 0, num = 0, added_total = 0;
 	unsigned int hybrid_threshold = sys.Particles().GetHybridThreshold();
@@ -47,7 +47,10 @@
 #include "string_functions.h"
 #include <boost/random/uniform_01.hpp>
 #include <boost/random/mersenne_twister.hpp>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <vector>
 #include <stdexcept>
 using namespace Sweep;
@@ -88,7 +91,18 @@ void ParticleImage::Construct(const Particle &sp, const ParticleModel &model)
     // Initialise new RNG here as the calling functions do not have access to
     // the original one
     rng_type rng(size_t(100));
+    Construct(sp, model, rng);
+}
 
+/*!
+ * @brief           Construct a particle image
+ *
+ * @param sp        Particle object
+ * @param model     Particle model describing object
+ * @param rng       Random number generator for the orientations
+ */
+void ParticleImage::Construct(const Particle &sp, const ParticleModel &model, rng_type &rng)
+{
     // Clear the current image data structure.
     m_root.Clear();
 
@@ -114,7 +128,7 @@ void ParticleImage::Construct(const Particle &sp, const ParticleModel &model)
 
         //! At the moment tracking of the distance between the centres of
         //! primary particles does not apply to the surface-volume model.
-        calc_FM(m_root, *(&rng), false);
+        calc_FM(m_root, rng, false);
 
     } else if (model.AggModel() == AggModels::BinTree_ID ||
             model.AggModel() == AggModels::BinTreeSilica_ID) {
@@ -122,14 +136,14 @@ void ParticleImage::Construct(const Particle &sp, const ParticleModel &model)
 
         const AggModels::BinTreePrimary *p;
         p = dynamic_cast<const AggModels::BinTreePrimary*>(sp.Primary());
-        ConstructTree(p, *(&rng), model.getTrackPrimaryCoordinates());
+        ConstructTree(p, rng, model.getTrackPrimaryCoordinates());
 
     } else if (model.AggModel() == AggModels::PAH_KMC_ID) {
         // PAHPP (binary tree like) model
 
         const AggModels::PAHPrimary *p;
         p = dynamic_cast<const AggModels::PAHPrimary*>(sp.Primary());
-        ConstructTree(p, *(&rng), model.getTrackPrimaryCoordinates());
+        ConstructTree(p, rng, model.getTrackPrimaryCoordinates());
     } else {
         throw std::runtime_error("Unknown particle model. (ParticleImage::Construct)");
     }
@@ -198,6 +212,12 @@ void ParticleImage::CopyTree(ImgNode &node, const ParticleClass *source)
     UpdateAllPointers(node, source);
 }
 
+//! Returns the primary coordinates: x, y, z and radius (nm).
+void ParticleImage::GetPriCoords(std::vector<fvector> &coords) const
+{
+    m_root.GetPriCoords(coords);
+}
+
 //! Generates a projection on the zx plane (set all y to 0)
 void ParticleImage::Project()
 {
@@ -484,6 +504,325 @@ void ParticleImage::WritePOVRAY(std::ofstream &file)
 }
 
 
+/*!
+ *  @brief Draws the images of many particles to one POVRAY file.
+ *
+ *  The images are constructed concurrently.  Particle i has its own
+ *  generator, which depends only on the seed and i, so the file does
+ *  not depend on the number of threads.  When rng_type is Philox4x32
+ *  (SWEEP_PHILOX_RNG) the generator is stream i of the seed; otherwise
+ *  it is an rng_type seeded with the first draw of that stream.
+ *
+ *  In place of one file per particle, the primaries of all the
+ *  particles are written as one array, which the macro MyParticle(i)
+ *  turns into the contents of the blob of particle i (i = 0 to
+ *  ParticleCount-1), as in blob {MyParticle(i) texture {...}}.
+ *
+ *  @param[in,out] file      Output file stream.
+ *  @param[in]     particles Particles to draw.
+ *  @param[in]     seed      Seed from which the streams are derived.
+ */
+void ParticleImage::WriteBatchPOVRAY(std::ofstream &file,
+                                     const std::vector<const Particle*> &particles,
+                                     unsigned int seed)
+{
+    if (!file.good()) {
+        throw invalid_argument("Output stream not ready "
+                               "(Sweep, ParticleImage::WriteBatchPOVRAY).");
+    }
+
+    // Construct the images.
+    const int n = (int)particles.size();
+    const Philox4x32 streams(seed);
+    std::vector<ParticleImage*> images(n, (ParticleImage*)NULL);
+    std::string error;
+#pragma omp parallel for schedule(dynamic)
+    for (int i=0; i<n; ++i) {
+        try {
+#ifdef SWEEP_PHILOX_RNG
+            rng_type rng = streams.Stream(i);
+#else
+            rng_type rng(streams.Stream(i)());
+#endif
+            images[i] = new ParticleImage();
+            images[i]->Construct(*particles[i], *particles[i]->Primary()->ParticleModel(), rng);
+        } catch (std::exception &e) {
+#pragma omp critical (particle_image_error)
+            error = e.what();
+        }
+    }
+    if (!error.empty()) {
+        for (int i=0; i<n; ++i) delete images[i];
+        throw runtime_error(error + " (Sweep, ParticleImage::WriteBatchPOVRAY).");
+    }
+
+    // Write the diameters and where the primaries of each particle start.
+    std::vector<std::vector<fvector> > coords(n);
+    std::vector<unsigned int> start(n + 1, 0);
+    file << "#declare ParticleCount = " << n << ";\n";
+    file << setprecision(6);
+    if (n > 0) {
+        file << "#declare ParticleDiameter = array[" << n << "] {";
+        for (int i=0; i<n; ++i) {
+            images[i]->GetPriCoords(coords[i]);
+            start[i + 1] = start[i] + (unsigned int)coords[i].size();
+            file << (i > 0 ? ", " : "") << images[i]->m_root.Radius() * 2.0;
+            delete images[i];
+        }
+        file << "}\n";
+
+        file << "#declare PrimaryStart = array[" << n + 1 << "] {";
+        for (int i=0; i<=n; ++i) {
+            file << (i > 0 ? ", " : "") << start[i];
+        }
+        file << "}\n";
+
+        // Write the primaries: x, y, z and the radius based on the necking.
+        file << "#declare Primaries = array[" << start[n] << "][4] {\n";
+        for (int i=0; i<n; ++i) {
+            for (unsigned int j=0; j!=coords[i].size(); ++j) {
+                const fvector &c = coords[i][j];
+                file << "{" << c[0] << ", " << c[1] << ", " << c[2] << ", "
+                     << c[3] * m_necking << "}"
+                     << ((start[i] + j + 1 < start[n]) ? ",\n" : "\n");
+            }
+        }
+        file << "}\n";
+    }
+
+    // Threshold radius based on necking parameter, and the macro that
+    // draws the primaries of a particle.
+    file << "#declare ParticleThreshold = "
+         << max(pow(1.0 - (1.0/(m_necking*m_necking)), 2.0), 1.0e-4) << ";\n"
+         << "#macro MyParticle(i)\n"
+         << "  threshold ParticleThreshold\n"
+         << "  #local k = PrimaryStart[i];\n"
+         << "  #while (k < PrimaryStart[i+1])\n"
+         << "    sphere {<Primaries[k][0], Primaries[k][1], Primaries[k][2]>, Primaries[k][3], 1.0}\n"
+         << "    #local k = k + 1;\n"
+         << "  #end\n"
+         << "#end\n";
+}
+
+
+// COLLISION SEARCH.
+
+/*!
+ *  Appends the centres and radii of the primaries (the leaves) below
+ *  the given node.
+ *
+ *  @param[in]     node   Node of the ImgNode tree.
+ *  @param[in,out] leaves The primaries, in the order of the tree.
+ */
+void ParticleImage::getLeaves(const ImgNode &node, std::vector<Sphere> &leaves)
+{
+    if (node.IsLeaf()) {
+        const Sphere s = {node.m_cen_bsph[0], node.m_cen_bsph[1],
+                          node.m_cen_bsph[2], node.m_r};
+        leaves.push_back(s);
+    } else {
+        getLeaves(*node.m_leftchild, leaves);
+        getLeaves(*node.m_rightchild, leaves);
+    }
+}
+
+/*!
+ *  @brief Spatial index for the collision of two aggregates along z.
+ *
+ *  The primaries of the target are binned on a uniform grid over their
+ *  projections on the x-y plane, with cells about one primary diameter
+ *  wide, and sorted by z within each cell.  A bullet primary can only
+ *  touch target primaries in the cells that its projection overlaps,
+ *  and the sweep along z through a cell stops as soon as no later
+ *  primary can be reached before the best contact found so far.  Small
+ *  pairs of aggregates are searched pair by pair instead.
+ *
+ *  Unlike a descent through the bounding spheres of the two trees, the
+ *  search considers every pair of primaries whose projections overlap,
+ *  so the bullet stops at its first contact with the target.
+ */
+class ParticleImage::CollisionGrid
+{
+public:
+    //! Bins the target primaries; both must outlive the grid.
+    CollisionGrid(const std::vector<Sphere> &target, const std::vector<Sphere> &bullet);
+
+    //! Calculates the minimum collision distance of the bullet.
+    bool MinCollZ(double dx, double dy, double &dz) const;
+
+private:
+    //! Orders target primaries by z.
+    struct ByZ
+    {
+        const std::vector<Sphere> *spheres;
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            return (*spheres)[a].z < (*spheres)[b].z;
+        }
+    };
+
+    //! Largest count of pairs searched without the grid.
+    static const size_t m_maxPairs = 64;
+
+    const std::vector<Sphere> &m_target;
+    const std::vector<Sphere> &m_bullet;
+
+    //! Largest radius of the target primaries.
+    double m_rmax;
+
+    //! Origin and width of the cells, and cell counts along x and y
+    //! (zero if the grid is not used).
+    double m_x0, m_y0, m_h;
+    int m_nx, m_ny;
+
+    //! Target primaries of cell i are m_index[m_start[i]] to
+    //! m_index[m_start[i+1]-1], in order of z.
+    std::vector<unsigned int> m_start;
+    std::vector<unsigned int> m_index;
+
+    //! Calculates the z-displacement of a bullet primary (as calcCollZ).
+    static bool collZ(const Sphere &t, const Sphere &b, double dx, double dy, double &dz);
+};
+
+ParticleImage::CollisionGrid::CollisionGrid(const std::vector<Sphere> &target,
+                                            const std::vector<Sphere> &bullet)
+: m_target(target), m_bullet(bullet), m_rmax(0.0),
+  m_x0(0.0), m_y0(0.0), m_h(0.0), m_nx(0), m_ny(0)
+{
+    if (target.size() * bullet.size() <= m_maxPairs) return;
+
+    double xmax = target[0].x, ymax = target[0].y;
+    m_x0 = xmax;
+    m_y0 = ymax;
+    for (size_t i = 0; i != target.size(); ++i) {
+        m_rmax = max(m_rmax, target[i].r);
+        m_x0 = min(m_x0, target[i].x);
+        m_y0 = min(m_y0, target[i].y);
+        xmax = max(xmax, target[i].x);
+        ymax = max(ymax, target[i].y);
+    }
+
+    // Cells one primary diameter wide, unless there would be many
+    // more cells than primaries.
+    const double maxCells = 4.0 * target.size() + 16.0;
+    m_h = 2.0 * m_rmax;
+    double nx = floor((xmax - m_x0) / m_h) + 1.0;
+    double ny = floor((ymax - m_y0) / m_h) + 1.0;
+    while (nx * ny > maxCells) {
+        m_h *= sqrt(nx * ny / maxCells) * 1.01;
+        nx = floor((xmax - m_x0) / m_h) + 1.0;
+        ny = floor((ymax - m_y0) / m_h) + 1.0;
+    }
+    m_nx = (int)nx;
+    m_ny = (int)ny;
+
+    // Count the primaries of each cell, then place them.
+    std::vector<unsigned int> cell(target.size());
+    m_start.assign(m_nx * m_ny + 1, 0);
+    for (size_t i = 0; i != target.size(); ++i) {
+        const int ix = min(m_nx - 1, (int)((target[i].x - m_x0) / m_h));
+        const int iy = min(m_ny - 1, (int)((target[i].y - m_y0) / m_h));
+        cell[i] = ix + m_nx * iy;
+        ++m_start[cell[i] + 1];
+    }
+    for (size_t c = 0; c != m_start.size() - 1; ++c) {
+        m_start[c + 1] += m_start[c];
+    }
+    std::vector<unsigned int> next(m_start.begin(), m_start.end() - 1);
+    m_index.resize(target.size());
+    for (size_t i = 0; i != target.size(); ++i) {
+        m_index[next[cell[i]]++] = (unsigned int)i;
+    }
+
+    ByZ byZ;
+    byZ.spheres = &m_target;
+    for (size_t c = 0; c != m_start.size() - 1; ++c) {
+        std::sort(m_index.begin() + m_start[c], m_index.begin() + m_start[c + 1], byZ);
+    }
+}
+
+/*!
+ *  @param[in]  dx  Bullet x displacement.
+ *  @param[in]  dy  Bullet y displacement.
+ *  @param[out] dz  Smallest z displacement over the pairs of primaries
+ *                  that collide, or a large number if none do.
+ *
+ *  @return Do the target and bullet collide?
+ */
+bool ParticleImage::CollisionGrid::MinCollZ(double dx, double dy, double &dz) const
+{
+    bool hit = false;
+    double dzPair = 0.0;
+    dz = 1.0e10; //!< A large number.
+
+    if (m_nx == 0) {
+        for (size_t j = 0; j != m_bullet.size(); ++j) {
+            for (size_t i = 0; i != m_target.size(); ++i) {
+                if (collZ(m_target[i], m_bullet[j], dx, dy, dzPair) && (dzPair < dz)) {
+                    dz = dzPair;
+                    hit = true;
+                }
+            }
+        }
+        return hit;
+    }
+
+    for (size_t j = 0; j != m_bullet.size(); ++j) {
+        const Sphere &b = m_bullet[j];
+        const double reach = m_rmax + b.r;
+        const double x = b.x + dx - m_x0;
+        const double y = b.y + dy - m_y0;
+
+        // Cells overlapped by the projection of the bullet primary,
+        // widened by the largest target radius.
+        const int ix0 = (int)max(0.0, floor((x - reach) / m_h));
+        const int ix1 = (int)min(m_nx - 1.0, floor((x + reach) / m_h));
+        const int iy0 = (int)max(0.0, floor((y - reach) / m_h));
+        const int iy1 = (int)min(m_ny - 1.0, floor((y + reach) / m_h));
+
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                const int c = ix + m_nx * iy;
+                for (unsigned int k = m_start[c]; k != m_start[c + 1]; ++k) {
+                    const Sphere &t = m_target[m_index[k]];
+
+                    // No pair is closer than the z separation less the
+                    // sum of the radii, and z increases along the cell.
+                    if (t.z - b.z - reach >= dz) break;
+
+                    if (collZ(t, b, dx, dy, dzPair) && (dzPair < dz)) {
+                        dz = dzPair;
+                        hit = true;
+                    }
+                }
+            }
+        }
+    }
+    return hit;
+}
+
+bool ParticleImage::CollisionGrid::collZ(const Sphere &t, const Sphere &b,
+                                         double dx, double dy, double &dz)
+{
+    double sumrsqr = t.r + b.r;
+    sumrsqr *= sumrsqr;
+
+    const double xdev = b.x - t.x + dx;
+    const double ydev = b.y - t.y + dy;
+    const double zdev = b.z - t.z;
+
+    const double bq = 2.0 * zdev;
+    const double c = xdev * xdev + ydev * ydev + zdev * zdev - sumrsqr;
+    const double dis = (bq * bq) - (4.0 * c);
+
+    if (dis >= 0.0) {
+        dz = - 0.5 * (bq + sqrt(dis));
+        return true;
+    }
+    return false;
+}
+
+
 // AGGREGATE SPHERE-TREE CONSTRUCTORS (FREE-MOLECULAR).
 
 
@@ -530,6 +869,14 @@ void ParticleImage::calc_FM(ImgNode &node, Sweep::rng_type &rng, const bool trac
         target->CentreBoundSph();
         bullet->CentreBoundSph();
 
+        //! Index the primaries of the target for the collision search.
+        std::vector<Sphere> targetLeaves, bulletLeaves;
+        if (!trackPrimaryCoordinates) {
+            getLeaves(*target, targetLeaves);
+            getLeaves(*bullet, bulletLeaves);
+        }
+        const CollisionGrid grid(targetLeaves, bulletLeaves);
+
         //! Perform the collision of the left and right nodes.
         //! This may require several iterations if the chosen
         //! x-y displacement means that the aggregates cannot
@@ -569,16 +916,10 @@ void ParticleImage::calc_FM(ImgNode &node, Sweep::rng_type &rng, const bool trac
 
             if (!trackPrimaryCoordinates) {
                 //! The next code determines the displacement along the z-axis
-                //! required for the target and bullet aggregates to touch.  This
-                //! requires falling down the tree progressively recalculating
-                //! the nearest nodes at each level, until the leaf nodes
-                //! are reached.
-                //! This next code calculates the minimum distance between the
-                //! target's children and bullet's children, or the target or
-                //! bullet if they have no children.  The two children with
-                //! the smallest separation are chosen as the next target
-                //! and bullet.
-                hit = minCollZ(*target, *bullet, D[0], D[1], D[2]);
+                //! required for the target and bullet aggregates to touch,
+                //! which is the smallest displacement over the pairs of
+                //! target and bullet primaries that collide.
+                hit = grid.MinCollZ(D[0], D[1], D[2]);
             } else {
                 //! By including pointers to a node's left and right particles,
                 //! we can directly calculate the displacement in the z
@@ -601,102 +942,6 @@ void ParticleImage::calc_FM(ImgNode &node, Sweep::rng_type &rng, const bool trac
     }
 }
 
-// Calculates the minimum collision distance between
-// a target and a bullet node by moving down the
-// binary tree.  If the nodes collide then returns
-// true, otherwise returns false.
-/*!
- * @brief           Calculates the minimum collision distance
- *
- * Calculates the minimum collision distance between
- * a target and a bullet node by moving down the
- * binary tree.  If the nodes collide then returns
- * true, otherwise returns false.
- *
- * @param target    Target node
- * @param bullet    Bullet node
- * @param dx        ?
- * @param dy        ?
- * @param dz        ?
- * @return          Have the nodes collided?
- */
-bool ParticleImage::minCollZ(const ImgNode &target,
-                             const ImgNode &bullet,
-                             double dx, double dy, double &dz)
-{
-    bool hit=false, hit1=false;
-    double dz2=0.0, dz3=0.0, dz4=0.0;
-
-    if (target.IsLeaf()) {
-        // Target is a leaf
-        if (bullet.IsLeaf()) {
-            // Bullet is a leaf (both leaves).
-           return calcCollZ(target.BoundSphCentre(), target.Radius(),
-                            bullet.BoundSphCentre(), bullet.Radius(),
-                            dx, dy, dz, 0.0, false);
-        } else {
-            // Bullet is not a leaf, call sub-nodes.
-            // Calculate minimum dz for the target and the bullet left subnode.
-            hit1 = calcCollZ(target.BoundSphCentre(), target.Radius(),
-                             bullet.m_leftchild->BoundSphCentre(), bullet.m_leftchild->Radius(),
-                             dx, dy, dz, 0.0, false);
-            if (hit1) hit = minCollZ(target, *bullet.m_leftchild, dx, dy, dz);
-            // Calculate minimum dz for the target and the bullet right subnode.
-            hit1 = calcCollZ(target.BoundSphCentre(), target.Radius(),
-                             bullet.m_rightchild->BoundSphCentre(), bullet.m_rightchild->Radius(),
-                             dx, dy, dz2, 0.0, false);
-            if (hit1) hit = minCollZ(target, *bullet.m_rightchild, dx, dy, dz2) || hit;
-            // Return minimum dz.
-            dz = min(dz, dz2);
-            return hit;
-        }
-    } else {
-        // Target is not a leaf.
-        if (bullet.IsLeaf()) {
-            // Bullet is a leaf, call target sub-nodes..
-            // Calculate minimum dz for the target left subnode and the bullet.
-            hit1 = calcCollZ(target.m_leftchild->BoundSphCentre(), target.m_leftchild->Radius(),
-                             bullet.BoundSphCentre(), bullet.Radius(),
-                             dx, dy, dz, 0.0, false);
-            if (hit1) hit = minCollZ(*target.m_leftchild, bullet, dx, dy, dz);
-            // Calculate minimum dz for the target right subnode and the bullet.
-            hit1 = calcCollZ(target.m_rightchild->BoundSphCentre(), target.m_rightchild->Radius(),
-                             bullet.BoundSphCentre(), bullet.Radius(),
-                             dx, dy, dz2, 0.0, false);
-            if (hit1) hit = minCollZ(*target.m_rightchild, bullet, dx, dy, dz2) || hit;
-            // Return minimum dz.
-            dz = min(dz, dz2);
-            return hit;
-        } else {
-            // Bullet is not a leaf (neither is a leaf), check all left/right
-            // collision combinations.
-            // Target left and bullet left.
-            hit1 = calcCollZ(target.m_leftchild->BoundSphCentre(), target.m_leftchild->Radius(),
-                             bullet.m_leftchild->BoundSphCentre(), bullet.m_leftchild->Radius(),
-                             dx, dy, dz, 0.0, false);
-            if (hit1) hit = minCollZ(*target.m_leftchild, *bullet.m_leftchild, dx, dy, dz);
-            // Target left and bullet right.
-            hit1 = calcCollZ(target.m_leftchild->BoundSphCentre(), target.m_leftchild->Radius(),
-                             bullet.m_rightchild->BoundSphCentre(), bullet.m_rightchild->Radius(),
-                             dx, dy, dz2, 0.0, false);
-            if (hit1) hit = minCollZ(*target.m_leftchild, *bullet.m_rightchild, dx, dy, dz2) || hit;
-            // Target right and bullet left.
-            hit1 = calcCollZ(target.m_rightchild->BoundSphCentre(), target.m_rightchild->Radius(),
-                             bullet.m_leftchild->BoundSphCentre(), bullet.m_leftchild->Radius(),
-                             dx, dy, dz3, 0.0, false);
-            if (hit1) hit = minCollZ(*target.m_rightchild, *bullet.m_leftchild, dx, dy, dz3) || hit;
-            // Target right and bullet right.
-            hit1 = calcCollZ(target.m_rightchild->BoundSphCentre(), target.m_rightchild->Radius(),
-                             bullet.m_rightchild->BoundSphCentre(), bullet.m_rightchild->Radius(),
-                             dx, dy, dz4, 0.0, false);
-            if (hit1) hit = minCollZ(*target.m_rightchild, *bullet.m_rightchild, dx, dy, dz4) || hit;
-            // Returns minimum dz.
-            dz = min(min(dz, dz2), min(dz3, dz4));
-            return hit;
-        }
-    }
-}
-
 /*!
  *  @brief Calculates the z-displacement of a sphere.
  *
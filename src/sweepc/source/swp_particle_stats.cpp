@@ -44,10 +44,21 @@
 #include "swp_particle.h"
 #include "swp_particle_model.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 using namespace Sweep;
 using namespace std;
+
+// Lets the compiler vectorise the sums over a block of particles
+// (needs OpenMP 4.0).
+#if defined(_OPENMP) && (_OPENMP >= 201307)
+#define SWP_STATS_SIMD_MOMENTS _Pragma("omp simd reduction(+:m0,d,dcol,dmob,s,v,m,m2,m3,coag)")
+#define SWP_STATS_SIMD_SUM _Pragma("omp simd reduction(+:sum)")
+#else
+#define SWP_STATS_SIMD_MOMENTS
+#define SWP_STATS_SIMD_SUM
+#endif
 using namespace Sweep::Stats;
 
 // STATIC CONST MEMBER VARIABLES.
@@ -105,7 +116,7 @@ const std::string ParticleStats::m_const_pslnames[ParticleStats::PSL_COUNT] = {
 
 // Default constructor (private).
 ParticleStats::ParticleStats()
-: m_ncomp(0), m_ntrack(0), m_stats(STAT_COUNT,0.0)
+: m_ncomp(0), m_ntrack(0), m_stats(STAT_COUNT,0.0), m_threaded(true)
 {
     for (unsigned int i=0; i!=STAT_COUNT; ++i) {
         m_names.push_back(m_statnames[i]);
@@ -118,6 +129,7 @@ ParticleStats::ParticleStats()
 
 // Default constructor (public).
 ParticleStats::ParticleStats(const Sweep::ParticleModel &model)
+: m_threaded(true)
 {
     for (unsigned int i=0; i!=STAT_COUNT; ++i) {
         m_names.push_back(m_statnames[i]);
@@ -152,6 +164,7 @@ ParticleStats::ParticleStats(const ParticleStats &copy)
 
 // Stream-reading constructor.
 ParticleStats::ParticleStats(std::istream &in, const Sweep::ParticleModel &model)
+: m_threaded(true)
 {
     Deserialize(in, model);
 }
@@ -171,6 +184,7 @@ ParticleStats &ParticleStats::operator=(const ParticleStats &rhs)
         m_stats.assign(rhs.m_stats.begin(), rhs.m_stats.end());
         m_ncomp = rhs.m_ncomp;
         m_ntrack = rhs.m_ntrack;
+        m_threaded = rhs.m_threaded;
     }
     return *this;
 }
@@ -194,48 +208,33 @@ void ParticleStats::Calculate(const Ensemble &e, double scale)
     // using this int before copying into the stats array
     unsigned int maxNumCoag = 0;
 
+    // Sum the stats of each block of particles separately, so that the
+    // blocks can be shared between threads.
+    const unsigned int n = e.Count();
+    const unsigned int nblocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const unsigned int nsums = m_stats.size();
+    fvector blockSums(nblocks * nsums, 0.0);
+    std::vector<unsigned int> blockMaxCoag(nblocks, 0);
+
+#pragma omp parallel if (m_threaded && nblocks > 1)
+    {
+        fvector cols;
+#pragma omp for schedule(dynamic)
+        for (int b = 0; b < static_cast<int>(nblocks); ++b) {
+            const unsigned int begin = b * BLOCK_SIZE;
+            sumBlock(e, begin, std::min(begin + BLOCK_SIZE, n), cols,
+                     &blockSums[b * nsums], blockMaxCoag[b]);
+        }
+    }
 
-    // Loop over all particles, getting the stats from each.
-    Ensemble::const_iterator ip;
-    for (ip=e.begin(); ip!=e.end(); ++ip) {
-        double sz = (*ip)->Property(m_statbound.PID);
-        // Check if the value of the property is within the stats bound
-        if ((m_statbound.Lower < sz) && (sz < m_statbound.Upper) ) {
-            const double wt = (*ip)->getStatisticalWeight();
-            // Sum stats from this particle.
-            m_stats[iM0]   += wt;
-            m_stats[iD]    += (*ip)->SphDiameter() * wt;
-            m_stats[iDcol] += (*ip)->CollDiameter() * wt;
-            m_stats[iDmob] += (*ip)->MobDiameter() * wt;
-            m_stats[iS]    += (*ip)->SurfaceArea() * wt;
-            m_stats[iS+1]  += (*ip)->SurfaceArea() * wt;
-            m_stats[iV]    += (*ip)->Volume() * wt;
-            m_stats[iV+1]  += (*ip)->Volume() * wt;
-            const double m = (*ip)->Mass();
-            m_stats[iM]    += m * wt;
-            m_stats[iM+1]  += m * wt;
-            m_stats[iM2]   += m * m * wt;
-            m_stats[iM3]   += m * m * m * wt;
-
-            // Coagulations experienced by this particle
-            const unsigned int coagCount = (*ip)->getCoagCount();
-            m_stats[iCoag] += coagCount * wt;
-
-            // Check if this the highest count so far
-            if(coagCount > maxNumCoag)
-                maxNumCoag = coagCount;
-
-            // Sum component and tracker values.
-            fvector::iterator i = m_stats.begin()+STAT_COUNT;
-            for (unsigned int j=0; j!=m_ncomp; ++j,++i) {
-                *i     += (*ip)->Composition(j) * wt;
-                *(++i) += (*ip)->Composition(j) * wt;
-            }
-            for (unsigned int j=0; j!=m_ntrack; ++j,++i) {
-                *i     += (*ip)->Values(j) * wt;
-                *(++i) += (*ip)->Values(j) * wt;
-            }
+    // Add up the blocks in order, so that the stats do not depend on
+    // the number of threads.
+    for (unsigned int b = 0; b != nblocks; ++b) {
+        const double *sums = &blockSums[b * nsums];
+        for (unsigned int i = 0; i != nsums; ++i) {
+            m_stats[i] += sums[i];
         }
+        maxNumCoag = std::max(maxNumCoag, blockMaxCoag[b]);
     }
 
 	// Add contributions from hybrid particle-number/particle model
@@ -302,6 +301,113 @@ void ParticleStats::Calculate(const Ensemble &e, double scale)
 
 }
 
+// Allows Calculate to split the sums over the ensemble between threads.
+void ParticleStats::SetThreadedReduction(bool threaded)
+{
+    m_threaded = threaded;
+}
+
+// Gathers the properties of a block of particles into columns and adds
+// their weighted sums to sums.
+void ParticleStats::sumBlock(const Ensemble &e, unsigned int begin,
+                             unsigned int end, fvector &cols, double *sums,
+                             unsigned int &maxCoag) const
+{
+    const unsigned int n = end - begin;
+    const unsigned int nvals = m_ncomp + m_ntrack;
+
+    cols.resize((COLUMN_COUNT + nvals) * BLOCK_SIZE);
+    double *const wt    = &cols[0];
+    double *const dsph  = wt + n;
+    double *const dc    = dsph + n;
+    double *const dm    = dc + n;
+    double *const surf  = dm + n;
+    double *const vol   = surf + n;
+    double *const mass  = vol + n;
+    double *const ncoag = mass + n;
+    double *const vals  = ncoag + n;
+
+    for (unsigned int i = 0; i != n; ++i) {
+        const Particle &sp = *e.At(begin + i);
+        const double sz = sp.Property(m_statbound.PID);
+        // Check if the value of the property is within the stats bound
+        if ((m_statbound.Lower < sz) && (sz < m_statbound.Upper) ) {
+            wt[i]    = sp.getStatisticalWeight();
+            dsph[i]  = sp.SphDiameter();
+            dc[i]    = sp.CollDiameter();
+            dm[i]    = sp.MobDiameter();
+            surf[i]  = sp.SurfaceArea();
+            vol[i]   = sp.Volume();
+            mass[i]  = sp.Mass();
+
+            // Coagulations experienced by this particle
+            const unsigned int coagCount = sp.getCoagCount();
+            ncoag[i] = coagCount;
+            maxCoag  = std::max(maxCoag, coagCount);
+
+            // Component and tracker values.
+            for (unsigned int j=0; j!=m_ncomp; ++j) {
+                vals[j * n + i] = sp.Composition(j);
+            }
+            for (unsigned int j=0; j!=m_ntrack; ++j) {
+                vals[(m_ncomp + j) * n + i] = sp.Values(j);
+            }
+        } else {
+            // Particles outside the bound are given no weight and no
+            // values, so that they add nothing to the sums.
+            wt[i] = dsph[i] = dc[i] = dm[i] = 0.0;
+            surf[i] = vol[i] = mass[i] = ncoag[i] = 0.0;
+            for (unsigned int j=0; j!=nvals; ++j) {
+                vals[j * n + i] = 0.0;
+            }
+        }
+    }
+
+    // Sum the moments over the block.
+    double m0 = 0.0, d = 0.0, dcol = 0.0, dmob = 0.0, s = 0.0, v = 0.0;
+    double m = 0.0, m2 = 0.0, m3 = 0.0, coag = 0.0;
+    SWP_STATS_SIMD_MOMENTS
+    for (int i = 0; i < static_cast<int>(n); ++i) {
+        const double w = wt[i];
+        m0   += w;
+        d    += dsph[i] * w;
+        dcol += dc[i] * w;
+        dmob += dm[i] * w;
+        s    += surf[i] * w;
+        v    += vol[i] * w;
+        m    += mass[i] * w;
+        m2   += mass[i] * mass[i] * w;
+        m3   += mass[i] * mass[i] * mass[i] * w;
+        coag += ncoag[i] * w;
+    }
+    sums[iM0]   += m0;
+    sums[iD]    += d;
+    sums[iDcol] += dcol;
+    sums[iDmob] += dmob;
+    sums[iS]    += s;
+    sums[iS+1]  += s;
+    sums[iV]    += v;
+    sums[iV+1]  += v;
+    sums[iM]    += m;
+    sums[iM+1]  += m;
+    sums[iM2]   += m2;
+    sums[iM3]   += m3;
+    sums[iCoag] += coag;
+
+    // Sum component and tracker values, which are stored in the
+    // same order in the stats.
+    for (unsigned int j=0; j!=nvals; ++j) {
+        const double *const x = vals + j * n;
+        double sum = 0.0;
+        SWP_STATS_SIMD_SUM
+        for (int i = 0; i < static_cast<int>(n); ++i) {
+            sum += x[i] * wt[i];
+        }
+        sums[STAT_COUNT + 2 * j]     += sum;
+        sums[STAT_COUNT + 2 * j + 1] += sum;
+    }
+}
+
 // Returns a vector containing the stats.
 const fvector &ParticleStats::Get(void) const
 {
@@ -0,0 +1,194 @@
+/*
+  Project:        sweep (population balance solver)
+  Sourceforge:    http://sourceforge.net/projects/mopssuite
+
+  File purpose:
+    Implementation of the counters declared in the swp_profile.h header
+    file.
+
+  Licence:
+    This file is part of "sweepc".
+
+    sweepc is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+  Contact:
+    Dr Markus Kraft
+    Dept of Chemical Engineering
+    University of Cambridge
+    New Museums Site
+    Pembroke Street
+    Cambridge
+    CB2 3RA
+    UK
+
+    Email:       mk306@cam.ac.uk
+    Website:     http://como.cheng.cam.ac.uk
+*/
+
+#include "swp_profile.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace Sweep;
+
+namespace
+{
+    //! Counters of one thread, padded so that threads do not share
+    //! cache lines.  Time holds the ticks of the sampled calls only.
+    struct Record
+    {
+        Profile::tick_type Calls[Profile::SectionCount];
+        Profile::tick_type Sampled[Profile::SectionCount];
+        Profile::tick_type Time[Profile::SectionCount];
+        std::vector<Profile::tick_type> TermCalls, TermSampled, TermTime;
+        unsigned int Countdown;
+        char Padding[64];
+    };
+
+    //! Threads beyond this number share the last record, so their
+    //! counts are only approximate.
+    const int maxThreads = 64;
+    Record records[maxThreads];
+
+    //! Clock readings at the last Reset.
+    Profile::tick_type startTicks = 0;
+    boost::posix_time::ptime startTime;
+
+    Record &threadRecord(void)
+    {
+#ifdef _OPENMP
+        const int i = omp_get_thread_num();
+        return records[i < maxThreads ? i : maxThreads - 1];
+#else
+        return records[0];
+#endif
+    }
+
+    //! Scales the ticks of the sampled calls up to all calls.
+    Profile::tick_type estimate(Profile::tick_type ticks,
+                                Profile::tick_type calls,
+                                Profile::tick_type sampled)
+    {
+        if (sampled == 0) return 0;
+        return (Profile::tick_type)((double)ticks * calls / sampled);
+    }
+}
+
+const char *Profile::SectionName(Section s)
+{
+    static const char *names[SectionCount] = {
+        "Rate terms", "Selection", "Perform", "Transport",
+        "LPDA", "Sections", "Doubling", "Contraction"
+    };
+    return names[s];
+}
+
+void Profile::Reset(void)
+{
+    for (int i = 0; i != maxThreads; ++i) {
+        for (int s = 0; s != SectionCount; ++s) {
+            records[i].Calls[s] = 0;
+            records[i].Sampled[s] = 0;
+            records[i].Time[s] = 0;
+        }
+        records[i].TermCalls.clear();
+        records[i].TermSampled.clear();
+        records[i].TermTime.clear();
+        records[i].Countdown = 1;
+    }
+    startTime = boost::posix_time::microsec_clock::universal_time();
+    startTicks = Ticks();
+}
+
+void Profile::Collect(Summary &sum)
+{
+    for (int s = 0; s != SectionCount; ++s) {
+        sum.Calls[s] = 0;
+        sum.Time[s] = 0;
+    }
+    sum.TermCalls.clear();
+    sum.TermTime.clear();
+
+    for (int i = 0; i != maxThreads; ++i) {
+        const Record &r = records[i];
+        for (int s = 0; s != SectionCount; ++s) {
+            sum.Calls[s] += r.Calls[s];
+            sum.Time[s] += estimate(r.Time[s], r.Calls[s], r.Sampled[s]);
+        }
+        if (sum.TermCalls.size() < r.TermCalls.size()) {
+            sum.TermCalls.resize(r.TermCalls.size(), 0);
+            sum.TermTime.resize(r.TermTime.size(), 0);
+        }
+        for (size_t j = 0; j != r.TermCalls.size(); ++j) {
+            sum.TermCalls[j] += r.TermCalls[j];
+            sum.TermTime[j] += estimate(r.TermTime[j], r.TermCalls[j], r.TermSampled[j]);
+        }
+    }
+
+    const double seconds = (boost::posix_time::microsec_clock::universal_time()
+                            - startTime).total_microseconds() * 1.0e-6;
+    const tick_type ticks = Ticks() - startTicks;
+    sum.Seconds = seconds;
+    if (seconds > 0.0 && ticks > 0) {
+        sum.TicksPerSecond = ticks / seconds;
+    } else {
+        sum.TicksPerSecond = CLOCKS_PER_SEC;
+    }
+}
+
+bool Profile::Sample(Section s)
+{
+    if (s > Perform) return true;
+
+    Record &r = threadRecord();
+    if (r.Countdown > 1) {
+        --r.Countdown;
+        return false;
+    }
+    r.Countdown = SampleInterval;
+    return true;
+}
+
+void Profile::Add(Section s, tick_type ticks, bool sampled)
+{
+    Record &r = threadRecord();
+    ++r.Calls[s];
+    if (sampled) {
+        ++r.Sampled[s];
+        r.Time[s] += ticks;
+    }
+}
+
+void Profile::AddTerm(unsigned int i, tick_type ticks, bool sampled)
+{
+    Record &r = threadRecord();
+    if (i >= r.TermCalls.size()) {
+        r.TermCalls.resize(i + 1, 0);
+        r.TermSampled.resize(i + 1, 0);
+        r.TermTime.resize(i + 1, 0);
+    }
+    ++r.Calls[Perform];
+    ++r.TermCalls[i];
+    if (sampled) {
+        ++r.Sampled[Perform];
+        r.Time[Perform] += ticks;
+        ++r.TermSampled[i];
+        r.TermTime[i] += ticks;
+    }
+}
@@ -41,6 +41,7 @@
 */
 
 #include "swp_solver.h"
+#include "swp_profile.h"
 #include "local_geometry1d.h"
 
 #include "choose_index.hpp"
@@ -215,7 +216,11 @@ void Solver::timeStep(double &t, double t_stop, Cell &sys, const Geometry::Local
     // to perform.
     if (t+dt <= t_stop) {
         boost::uniform_01<rng_type &> uniformGenerator(rng);
-        const int i = chooseIndex(rates, uniformGenerator);
+        int i;
+        {
+            SWEEP_PROFILE_SCOPE(Selection);
+            i = chooseIndex(rates, uniformGenerator);
+        }
         mech.DoProcess(i, t+dt, sys, geom, rng);
         t += dt;
     } else {
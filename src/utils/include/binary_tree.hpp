@@ -34,9 +34,12 @@
 
 #include <list>
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include<iostream>
 
+#include <boost/function.hpp>
+
 namespace Utils {
 
 //!Structure for the efficient evaluation of sums and inversion of probability distributions.
@@ -70,6 +73,14 @@ namespace Utils {
  * refer to the elements of the list at the bottom of the tree
  * since this is the STL convention for referring to the items
  * one puts into a tree.
+ *
+ * Selection by walking the nodes reads one scalar out of a whole weight
+ * at each level, which for large weight types means a cache miss per
+ * level.  Scalar weights that are selected by often can be indexed, see
+ * \ref index, in which case their sums are also kept in a compact
+ * implicit layout: one array of doubles per indexed weight with the
+ * children of node n at 2n and 2n+1, so that both children of a node
+ * share a cache line and the top levels of the tree stay in cache.
  */
 template<class Weight, class Selectee> class BinaryTree
 {
@@ -121,6 +132,9 @@ template<class Weight, class Selectee> class BinaryTree
      */
     typedef const value_type const_value_type; //extra to STL
 
+    //! Function returning a scalar weight that is linear in a weight_type
+    typedef boost::function<double (const weight_type&)> scalar_extractor_type;
+
     //! Create an empty tree with no space for particles
     BinaryTree();
 
@@ -162,9 +176,22 @@ template<class Weight, class Selectee> class BinaryTree
     //! Remove final element
     void pop_back();
 
+    //! Remove the final n elements
+    void pop_back(size_type n);
+
     //! Change a stored value
     void replace(iterator i, const value_type& x);
 
+    //! Change several stored values
+    template<typename IndexIteratorType, typename ValueIteratorType>
+      void replace(IndexIteratorType first, IndexIteratorType last,
+                   ValueIteratorType values);
+
+    //! Remove the final n elements and change several of the remaining values
+    template<typename IndexIteratorType, typename ValueIteratorType>
+      void pop_back_replace(size_type n, IndexIteratorType first, IndexIteratorType last,
+                            ValueIteratorType values);
+
     //! Remove the element referred to by i
     iterator erase(iterator i);
 
@@ -191,6 +218,22 @@ template<class Weight, class Selectee> class BinaryTree
     //! Select an entry according to the weights
     template<typename ScalarExtractorType> iterator select(double d, ScalarExtractorType f);
 
+    //! Keep the sums of a scalar weight in the compact layout
+    size_type index(const scalar_extractor_type& f);
+
+    //! Number of indexed scalar weights
+    size_type indexCount() const {return mIndexExtractors.size();}
+
+    //! Sum of an indexed scalar weight
+    double indexHead(size_type w) const {return mIndexSums[w * 2 * mCapacity + 1];}
+
+    //! Select an entry according to an indexed scalar weight
+    const_iterator select_indexed(size_type w, double d) const;
+
+    //! Select several entries according to indexed scalar weights
+    void select_indexed(size_type n, const size_type *w, const double *d,
+                        const_iterator *selected) const;
+
     //!Write the nodes to stdout.
     void print_tree() const;
 
@@ -221,6 +264,20 @@ template<class Weight, class Selectee> class BinaryTree
      * is associated with.*/
     std::vector<return_pointer_type> mIdentifiers;
 
+    //! Extractors of the indexed scalar weights.
+    std::vector<scalar_extractor_type> mIndexExtractors;
+
+    //!Sums of the indexed scalar weights.
+    /*!The sums of weight w are the 2 * mCapacity values from
+     * w * 2 * mCapacity.  Within them element n < mCapacity is the sum
+     * over the sub-tree below node n and element mCapacity + i is the
+     * weight of entry i, so that the children of element n are at 2n
+     * and 2n + 1 for all n.  Element 0 is not used.*/
+    std::vector<double> mIndexSums;
+
+    //!Number of descents interleaved by select_indexed.
+    static const size_type sSelectBatch = 8;
+
     //!Largest number of entries to permit is 2^31.
     static const size_type sMaxSize = 0x80000000;
 
@@ -249,6 +306,20 @@ template<class Weight, class Selectee> class BinaryTree
     //!Update the sums in the tree that depend on a node.
     void ascending_recalc(const size_type start_node);
 
+    //!Update the sums in the tree that depend on several nodes.
+    void ascending_recalc(std::vector<size_type>& start_nodes);
+
+    //!Empty the final n leaves, collecting the nodes above them.
+    void clear_back(size_type n, std::vector<size_type>& changed_nodes);
+
+    //!Store several values, collecting the nodes above them.
+    template<typename IndexIteratorType, typename ValueIteratorType>
+      void replace_leaves(IndexIteratorType first, IndexIteratorType last,
+                          ValueIteratorType values, std::vector<size_type>& changed_nodes);
+
+    //!Set the indexed weights of an entry.
+    void index_entry(const size_type entry, const weight_type& x);
+
     //! Recalculate the whole tree based on the values in the leaf nodes
     void recalculate();
 
@@ -789,6 +860,8 @@ template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::clear(
     mIdentifiers.clear();
     mIdentifiers.reserve(mCapacity);
 
+    std::fill(mIndexSums.begin(), mIndexSums.end(), 0.0);
+
     assert(isValid());
 }
 
@@ -845,6 +918,7 @@ template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::push_b
 
     //store the iterator that points back into the ensemble
     mIdentifiers.push_back(x.second);
+    index_entry(mFirstSpace - 1, x.first);
 
     //update the tree structre above the new entry
     ascending_recalc(leaf.node);
@@ -866,11 +940,29 @@ template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::pop_ba
 
     // A space has 0 weight
     mNodes[leaf.node].*(leaf.side_ptr) = weight_type();
+    index_entry(mFirstSpace, weight_type());
     ascending_recalc(leaf.node);
 
     assert(isValid());
 }
 
+/*!
+ * Remove the last n entries in the tree, recalculating each sum that
+ * depends on them once.
+ *
+ * \param[in] n Number of entries to remove
+ *
+ * \pre size() >= n
+ */
+template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::pop_back(size_type n) {
+    std::vector<size_type> changedNodes;
+    changedNodes.reserve(n);
+    clear_back(n, changedNodes);
+
+    ascending_recalc(changedNodes);
+    assert(isValid());
+}
+
 /*!
  * Replace the value pointed to by i with the values in x.
  * This will be more efficient than delete(i) followed by
@@ -887,10 +979,59 @@ template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::replac
 
   //now update the tree above the change
   const_cast<weight_type&>(mNodes[changed_leaf.node].*(changed_leaf.side_ptr)) = x.first;
+  index_entry(i.element_index, x.first);
   //finally propogate the new rates up the tree
   ascending_recalc(changed_leaf.node);
 }
 
+/*!
+ * Replace the values at several positions, recalculating each sum that
+ * depends on them once, rather than once for every changed value.  This
+ * is cheaper than calling replace for each position when the positions
+ * are close together, because their paths to the top of the tree merge.
+ *
+ * @tparam  IndexIteratorType   Input iterator with value type convertible to size_type
+ * @tparam  ValueIteratorType   Input iterator with value type BinaryTree<Weight, Selectee>::value_type
+ *
+ * @param[in]   first       Start of the positions of the values to replace
+ * @param[in]   last        One past the end of the positions
+ * @param[in]   values      New values, one for each position
+ */
+template<class Weight, class Selectee> template<typename IndexIteratorType, typename ValueIteratorType>
+  void BinaryTree<Weight, Selectee>::replace(IndexIteratorType first, IndexIteratorType last,
+                                             ValueIteratorType values) {
+    std::vector<size_type> changedNodes;
+    replace_leaves(first, last, values, changedNodes);
+    ascending_recalc(changedNodes);
+}
+
+/*!
+ * Remove the last n entries and then replace the values at several of the
+ * remaining positions, as pop_back(n) followed by the batched replace but
+ * recalculating each sum that depends on any of the changes only once.
+ *
+ * @tparam  IndexIteratorType   Input iterator with value type convertible to size_type
+ * @tparam  ValueIteratorType   Input iterator with value type BinaryTree<Weight, Selectee>::value_type
+ *
+ * @param[in]   n           Number of entries to remove
+ * @param[in]   first       Start of the positions of the values to replace
+ * @param[in]   last        One past the end of the positions
+ * @param[in]   values      New values, one for each position
+ *
+ * \pre size() >= n and all the positions are below size() - n
+ */
+template<class Weight, class Selectee> template<typename IndexIteratorType, typename ValueIteratorType>
+  void BinaryTree<Weight, Selectee>::pop_back_replace(size_type n, IndexIteratorType first,
+                                                      IndexIteratorType last, ValueIteratorType values) {
+    std::vector<size_type> changedNodes;
+    changedNodes.reserve(n);
+    clear_back(n, changedNodes);
+    replace_leaves(first, last, values, changedNodes);
+
+    ascending_recalc(changedNodes);
+    assert(isValid());
+}
+
 /*!
  * Replace the current contents of the tree with a new tree of the smallest power of 2
  * size sufficient to hold all the data in the input sequence and that is no smaller
@@ -931,6 +1072,7 @@ template<class Weight, class Selectee> template<class ForwardIteratorType>
     // Get rid of any existing return pointers
     mIdentifiers.clear();
     mIdentifiers.reserve(mCapacity);
+    mIndexSums.assign(mIndexExtractors.size() * 2 * mCapacity, 0.0);
 
     // Input will go in the first available spaces so the first unused
     // space will be equal to the length of the input.
@@ -946,6 +1088,7 @@ template<class Weight, class Selectee> template<class ForwardIteratorType>
         // Now work out what to do with the weight
         leaf_pos leafPosition = place_entry(i);
         mNodes[leafPosition.node].*leafPosition.side_ptr = it->first;
+        index_entry(i, it->first);
 
         // Move on to the next particle
         ++it;
@@ -957,6 +1100,7 @@ template<class Weight, class Selectee> template<class ForwardIteratorType>
       // Zero weight
       leaf_pos leafPosition = place_entry(i);
       mNodes[leafPosition.node].*leafPosition.side_ptr = weight_type();
+      index_entry(i, weight_type());
 
       ++i;
     }
@@ -1154,6 +1298,133 @@ template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::ascend
 
   // Cache the overall sums
   mNodes[0].left = mNodes[1].left + mNodes[1].right;
+
+  // The indexed sums are numbered like the nodes
+  for(size_type w = 0; w != mIndexExtractors.size(); ++w) {
+    double *sums = &mIndexSums[w * 2 * mCapacity];
+    for(i = start_node; i > 0; i >>= 1) {
+      sums[i] = sums[2 * i] + sums[2 * i + 1];
+    }
+  }
+}
+
+/*!
+ * Propagate the values in several leaf nodes up to the top node, one
+ * level at a time, so that a node above several of them is only
+ * recalculated once.  When so many nodes have changed that the passes
+ * could visit as many nodes as there are in the tree, the whole tree is
+ * recalculated instead.  Neighbouring nodes share their parents, so the
+ * passes are bounded level by level rather than by the number of levels
+ * times the number of changed nodes.
+ *
+ * @param[in,out]   start_nodes     Indices of changed leaf nodes, in any order and
+ *                                  possibly repeated; used as working space
+ */
+template<class Weight, class Selectee>
+  void BinaryTree<Weight, Selectee>::ascending_recalc(std::vector<size_type>& start_nodes) {
+  if(start_nodes.empty())
+    return;
+
+  std::sort(start_nodes.begin(), start_nodes.end());
+  start_nodes.erase(std::unique(start_nodes.begin(), start_nodes.end()), start_nodes.end());
+
+  // Each level holds at most as many changed nodes as the level below
+  // and as the level is wide.
+  size_type maxVisits = 0;
+  for(size_type width = mCapacity >> 1; width != 0; width >>= 1)
+    maxVisits += std::min(static_cast<size_type>(start_nodes.size()), width);
+  if(maxVisits >= (mCapacity >> 1)) {
+    recalculate();
+    return;
+  }
+
+  // All the leaf nodes are on the same level, so each pass moves the
+  // whole list up one level and keeps it sorted.
+  while(true) {
+    for(size_type w = 0; w != mIndexExtractors.size(); ++w) {
+      double *sums = &mIndexSums[w * 2 * mCapacity];
+      for(typename std::vector<size_type>::const_iterator it = start_nodes.begin();
+          it != start_nodes.end(); ++it) {
+        sums[*it] = sums[2 * *it] + sums[2 * *it + 1];
+      }
+    }
+    if(start_nodes.front() == 1)
+      break;
+
+    size_type nParents = 0;
+    for(size_type k = 0; k != start_nodes.size(); ++k) {
+      const size_type i = start_nodes[k];
+      const size_type j = (i >> 1);
+      if(i & 0x1) { //i is to right of parent
+        mNodes[j].right = mNodes[i].left + mNodes[i].right;
+      }
+      else { //i is to left of parent
+        mNodes[j].left = mNodes[i].left + mNodes[i].right;
+      }
+      if(nParents == 0 || start_nodes[nParents - 1] != j)
+        start_nodes[nParents++] = j;
+    }
+    start_nodes.resize(nParents);
+  }
+
+  // Cache the overall sums
+  mNodes[0].left = mNodes[1].left + mNodes[1].right;
+}
+
+/*!
+ * Empty the leaves of the last n entries, without updating the sums
+ * above them.
+ *
+ * @param[in]       n               Number of entries to remove
+ * @param[in,out]   changed_nodes   Nodes whose sums must be recalculated
+ *
+ * \pre size() >= n
+ */
+template<class Weight, class Selectee>
+  void BinaryTree<Weight, Selectee>::clear_back(size_type n, std::vector<size_type>& changed_nodes) {
+    assert(n <= mFirstSpace);
+    for(size_type i = mFirstSpace - n; i != mFirstSpace; ++i) {
+        leaf_pos leaf = place_entry(i);
+        mNodes[leaf.node].*(leaf.side_ptr) = weight_type();
+        index_entry(i, weight_type());
+        changed_nodes.push_back(leaf.node);
+    }
+    mFirstSpace -= n;
+    mIdentifiers.resize(mFirstSpace);
+}
+
+/*!
+ * Store values at several positions, without updating the sums above them.
+ *
+ * @param[in]       first           Start of the positions of the values to replace
+ * @param[in]       last            One past the end of the positions
+ * @param[in]       values          New values, one for each position
+ * @param[in,out]   changed_nodes   Nodes whose sums must be recalculated
+ */
+template<class Weight, class Selectee> template<typename IndexIteratorType, typename ValueIteratorType>
+  void BinaryTree<Weight, Selectee>::replace_leaves(IndexIteratorType first, IndexIteratorType last,
+                                                    ValueIteratorType values,
+                                                    std::vector<size_type>& changed_nodes) {
+    for(; first != last; ++first, ++values) {
+        const size_type i = *first;
+        assert(i < mFirstSpace);
+        leaf_pos leaf = place_entry(i);
+        mIdentifiers[i] = values->second;
+        mNodes[leaf.node].*(leaf.side_ptr) = values->first;
+        index_entry(i, values->first);
+        changed_nodes.push_back(leaf.node);
+    }
+}
+
+/*!
+ * @param[in]   entry   Index in mIdentifiers
+ * @param[in]   x       Weight of the entry, weight_type() for a space
+ */
+template<class Weight, class Selectee>
+  void BinaryTree<Weight, Selectee>::index_entry(const size_type entry, const weight_type& x) {
+  for(size_type w = 0; w != mIndexExtractors.size(); ++w) {
+    mIndexSums[w * 2 * mCapacity + mCapacity + entry] = mIndexExtractors[w](x);
+  }
 }
 
 /*!
@@ -1196,6 +1467,13 @@ template<class Weight, class Selectee> void BinaryTree<Weight, Selectee>::recalc
 
     // Calculate the overall sum
     mNodes[0].left = mNodes[1].left + mNodes[1].right;
+
+    for(size_type w = 0; w != mIndexExtractors.size(); ++w) {
+        double *sums = &mIndexSums[w * 2 * mCapacity];
+        for(size_type j = mCapacity - 1; j > 0; --j) {
+            sums[j] = sums[2 * j] + sums[2 * j + 1];
+        }
+    }
 }
 
 /*!
@@ -1254,12 +1532,122 @@ template<class Weight, class Selectee> template<typename ScalarExtractorType>
   BinaryTree<Weight, Selectee>::select(double d, ScalarExtractorType f) {
 
     // Call the const version to do the calculation
-    const_iterator selectee = (static_cast<const BinaryTree<Weight, Selectee> >(this))->select(d, f);
+    const_iterator selectee = static_cast<const BinaryTree<Weight, Selectee>*>(this)->select(d, f);
 
     // Now convert to a non-const iterator
     return iterator(selectee.element_index, this);
 }
 
+/*!
+ * Start keeping the sums of a scalar weight in the compact layout, so
+ * that entries can be selected by it with \ref select_indexed.  The
+ * index is kept up to date by all the methods that change the tree,
+ * which then cost a little more, so only weights that are selected by
+ * often should be indexed.
+ *
+ * The extractor is applied to the weight of each entry and the results
+ * summed, whereas \ref select applies its extractor to the sums of the
+ * weights, so both give the same selections when the extractor is a
+ * linear function of the weight (as the extraction of a member is).
+ *
+ * @param[in]   f   Univariate function object
+ *
+ * @return  Number by which to refer to the weight in select_indexed
+ */
+template<class Weight, class Selectee>
+  typename BinaryTree<Weight, Selectee>::size_type
+  BinaryTree<Weight, Selectee>::index(const scalar_extractor_type& f) {
+    const size_type w = mIndexExtractors.size();
+    mIndexExtractors.push_back(f);
+    mIndexSums.resize((w + 1) * 2 * mCapacity, 0.0);
+
+    if(mCapacity > 0) {
+        double *sums = &mIndexSums[w * 2 * mCapacity];
+        for(size_type i = 0; i != mCapacity; ++i) {
+            leaf_pos leaf = place_entry(i);
+            sums[mCapacity + i] = f(mNodes[leaf.node].*(leaf.side_ptr));
+        }
+        for(size_type j = mCapacity - 1; j > 0; --j) {
+            sums[j] = sums[2 * j] + sums[2 * j + 1];
+        }
+    }
+    return w;
+}
+
+/*!
+ * Select an entry according to a weight that has been indexed.  This
+ * gives the same entry as \ref select with the extractor that was
+ * indexed, but only reads one cache line at each level of the tree.
+ *
+ * @param[in]   w   Number of the weight returned by \ref index
+ * @param[in]   d   Value indicating where in the distribution to select the particle,
+ *                  in general r * indexHead(w) for r a U[0,1] random variable
+ *
+ * @return  Iterator to a selected entry, or end if nothing selected
+ */
+template<class Weight, class Selectee>
+  typename BinaryTree<Weight, Selectee>::const_iterator
+  BinaryTree<Weight, Selectee>::select_indexed(size_type w, double d) const {
+    const_iterator selected;
+    select_indexed(1, &w, &d, &selected);
+    return selected;
+}
+
+/*!
+ * Select several entries, each according to an indexed weight.  The
+ * descents are made together, a level at a time, so that the memory
+ * reads at each level overlap instead of each waiting for the last.
+ * This is the way to select the several particles of an event, such as
+ * the two particles of a coagulation chosen by different properties.
+ *
+ * @param[in]   n           Number of entries to select
+ * @param[in]   w           Numbers of the weights, returned by \ref index, by which to select
+ * @param[in]   d           Values indicating where in each distribution to select
+ * @param[out]  selected    Iterators to the selected entries, or end if nothing selected
+ */
+template<class Weight, class Selectee>
+  void BinaryTree<Weight, Selectee>::select_indexed(size_type n, const size_type *w, const double *d,
+                                                    const_iterator *selected) const {
+    for(size_type first = 0; first < n; first += sSelectBatch) {
+        const size_type batch = (n - first < sSelectBatch) ? n - first : sSelectBatch;
+        const double *sums[sSelectBatch];
+        double remaining[sSelectBatch];
+        size_type node[sSelectBatch];
+        for(size_type k = 0; k != batch; ++k) {
+            assert(w[first + k] < mIndexExtractors.size());
+            sums[k] = &mIndexSums[w[first + k] * 2 * mCapacity];
+            remaining[k] = d[first + k];
+            node[k] = 1;
+        }
+
+        // As in select, including the escape from a zero weighted right
+        // hand side, which takes the descent straight to the last entry.
+        for(size_type i = 0; i < mNumLevels; ++i) {
+            for(size_type k = 0; k != batch; ++k) {
+                if(node[k] >= mCapacity)
+                    continue;
+                const double leftWeight = sums[k][2 * node[k]];
+                if(remaining[k] <= leftWeight) {
+                    node[k] = 2 * node[k];
+                }
+                else if(sums[k][2 * node[k] + 1] == 0.0) {
+                    assert(mFirstSpace >= 1);
+                    node[k] = mFirstSpace + mCapacity - 1;
+                }
+                else {
+                    remaining[k] -= leftWeight;
+                    node[k] = 2 * node[k] + 1;
+                }
+            }
+        }
+
+        for(size_type k = 0; k != batch; ++k) {
+            assert(node[k] >= mCapacity);
+            selected[first + k] = const_iterator(std::min(node[k] - mCapacity, mFirstSpace), this);
+        }
+    }
+}
+
 /*
  * Sanity checks with error messages to describe any problems
  */
@@ -1288,6 +1676,11 @@ template<class Weight, class Selectee> bool BinaryTree<Weight, Selectee>::isVali
                   << ") inconsistent with position of first space " << mFirstSpace << '\n';
         valid = false;
     }
+    if(mIndexSums.size() != mIndexExtractors.size() * 2 * mCapacity) {
+        std::cerr << "Indexed sums (" << mIndexSums.size() << ") inconsistent with "
+                  << mIndexExtractors.size() << " indexed weights and capacity of " << mCapacity << '\n';
+        valid = false;
+    }
 
     return valid;
 }
@@ -0,0 +1,88 @@
+#!/bin/bash
+
+# Checks that a simulation stopped at its checkpoints and continued with
+# --restart gives the results of an uninterrupted simulation.  The input
+# stops the simulation at the end of every time interval, so mops is
+# restarted until the checkpoint file has gone.
+#
+# Arguments: path to mops and working directory.
+program=$1
+
+if test -z "$program"
+  then
+    echo "No executable supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+args="--flamepp -g regress1/regress1.inp -s regress1/regress1.xml -c regress1/chem.inp -t regress1/therm.dat"
+
+# The same simulation without checkpoints
+refInput="checkpoint1-ref.inx"
+sed -e '/<checkpoint /d' -e 's#<filename>checkpoint1<#<filename>checkpoint1-ref<#' checkpoint1/checkpoint1.inx > $refInput
+"$program" -p $args -r $refInput > /dev/null
+if (($? != 0))
+  then
+    echo "****** Uninterrupted simulation failed ******"
+    exit 255
+fi
+
+# 2 runs of 3 time intervals stop 5 times before the end
+"$program" -p $args -r checkpoint1/checkpoint1.inx > /dev/null
+if (($? != 0))
+  then
+    echo "****** Simulation failed ******"
+    exit 255
+fi
+nrestarts=0
+while test -f checkpoint1.chk
+do
+  if ((nrestarts == 10))
+    then
+      echo "****** Simulation did not finish ******"
+      exit 1
+  fi
+  "$program" -p --restart $args -r checkpoint1/checkpoint1.inx > /dev/null
+  if (($? != 0))
+    then
+      echo "****** Restart failed ******"
+      exit 255
+  fi
+  ((nrestarts++))
+done
+echo "Finished simulation after $nrestarts restarts"
+echo "========================"
+
+if ((nrestarts != 5))
+  then
+    echo "****** Expected 5 restarts ******"
+    exit 1
+fi
+
+# Compare the particle stats and the histograms with those of the
+# uninterrupted simulation
+for suffix in part.csv psd-pah.csv psd-dcol.csv
+do
+  if test "`wc -l < checkpoint1-ref-$suffix`" != "`wc -l < checkpoint1-$suffix`" || ! awk -F, 'NR==FNR {ref[FNR]=$0; next}
+                {n=split(ref[FNR], a, ",");
+                 if (n != NF) exit 1;
+                 for (i=1; i<=n; ++i) {
+                   d = a[i] - $i; if (d < 0) d = -d;
+                   m = a[i]; if (m < 0) m = -m;
+                   if (d > 1e-3 * m + 1e-300) exit 1;
+                 }}' checkpoint1-ref-$suffix checkpoint1-$suffix
+    then
+      echo "****** checkpoint1-$suffix differs from the uninterrupted simulation ******"
+      exit 1
+  fi
+done
+
+# All tests passed
+echo "All tests passed"
+rm -f checkpoint1-* checkpoint1.aux checkpoint1.sim checkpoint1.sen $refInput
+exit 0
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# Checks the binary gas-phase profiles: a profile converted by
+# gasprofileToBinary must give the same results as the text profile,
+# and a damaged binary profile must be rejected.
+#
+# Arguments: path to mops, working directory and path to gasprofileToBinary.
+program=$1
+converter=$3
+
+if test -z "$program" || test -z "$converter"
+  then
+    echo "No executables supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+rm -f gasprofile1-*
+
+# run mops on the problem of regress1 with the given gas-phase profile
+runMops() {
+  "$program" --flamepp -p -g "$1" -r gasprofile1/gasprofile1.inx -s regress1/regress1.xml -c regress1/chem.inp -t regress1/therm.dat
+}
+
+runMops regress1/regress1.inp
+if(($?!=0))
+  then
+    echo "****** Simulation with the text profile failed ******"
+    exit 255
+fi
+mv gasprofile1-part.csv gasprofile1-part-text.csv
+mv gasprofile1-chem.csv gasprofile1-chem-text.csv
+
+"$converter" --output gasprofile1-profile.bin regress1/regress1.inp
+if(($?!=0))
+  then
+    echo "****** Conversion of regress1/regress1.inp failed ******"
+    exit 1
+fi
+
+runMops gasprofile1-profile.bin
+if(($?!=0))
+  then
+    echo "****** Simulation with the binary profile failed ******"
+    exit 1
+fi
+for f in part chem
+do
+  if ! cmp -s gasprofile1-$f.csv gasprofile1-$f-text.csv
+    then
+      echo "****** Results with the binary profile differ in gasprofile1-$f.csv ******"
+      exit 1
+  fi
+done
+
+# A truncated profile must be rejected rather than read
+head -c 100 gasprofile1-profile.bin > gasprofile1-truncated.bin
+runMops gasprofile1-truncated.bin
+if(($?==0))
+  then
+    echo "****** A truncated binary profile was accepted ******"
+    exit 1
+fi
+
+# All tests passed
+echo "All tests passed"
+rm -f gasprofile1-* gasprofile1.aux gasprofile1.sim gasprofile1.sen gasprofile1\(*
+exit 0
@@ -20,6 +20,11 @@
 #   tests that the correct number (4) of -track.csv and .pov files
 #      are written
 #   tests povray running the output, where povray is installed
+# CASE 4:
+#   BINTREE PRIMARY PARTICLES, IMAGES WRITTEN TO ONE FILE
+#   as case 3 with ptrack combined="true"
+#   tests that one .pov file holding the 4 particles is written
+#   tests povray running the output, where povray is installed
 
 ######################################################################
 # GET ARGUMENTS
@@ -124,4 +129,36 @@ fi
 # Clean bintree files
 rm -f bintree*
 
+######################################################################
+# 4: BINTREE PRIMARY PARTICLES, IMAGES WRITTEN TO ONE FILE
+
+# Run calculation
+echo "Running MOPS for bintree primary case with combined images."
+"$program" -p --strang -r "mops.combined.inx" -s "sweep.bintree.xml" > /dev/null
+CheckErr $?
+
+# Check that there is one POV file, holding four particles.
+numPovFiles=`ls combined*.pov -l | wc -l`
+ans=`grep -c "ParticleCount = 4;" combined-tem\(0.1s\).pov`
+if [ $numPovFiles -eq 1 ] && [ "$ans" -eq 1 ]; then
+    echo "Correct combined file found for bintree primary."
+else
+    echo "ERROR: COULDN'T FIND REQUIRED COMBINED FILE FROM BINTREE PRIMARY."
+    exit 4
+fi
+
+# Now try running POVray, if installed.
+type povray > /dev/null 2>&1
+if [ $? -gt 0 ]; then
+    echo "POVray not installed.. skipping test!"
+else
+    echo "Trying to run POVray with the combined file."
+    povray +H600 +W800 -D +iparticle-combined.pov +ocombined-output.png > /dev/null 2> /dev/null
+    CheckErr $?
+    echo "POVray passed!"
+fi
+
+# Clean combined files
+rm -f combined*
+
 echo "All tests passed! :D"
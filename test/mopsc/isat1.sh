@@ -0,0 +1,122 @@
+#!/bin/bash
+
+# Checks the ISAT tabulation of the gas-phase solution of mops: the species
+# and temperature profiles of an adiabatic batch reactor solved with <isat>
+# must agree with the direct CVODE solution to within the ISAT tolerance,
+# and the CPU time output must give the retrieve, grow, add and direct
+# evaluation counts.  The ISAT input has two runs, so the second run is
+# answered from the table built by the first.
+#
+# Arguments: path to mops and working directory.
+program=$1
+
+if test -z "$program"
+  then
+    echo "No executable supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+cd isat1
+
+# run mops with the given input file
+runMops() {
+  "$program" -p -r "$1" -c ../sensi1/chem.inp -t ../sensi1/therm.dat > /dev/null
+  if(($?!=0))
+    then
+      echo "****** Simulation with $1 failed ******"
+      exit 255
+  fi
+}
+
+runMops mops.inx
+runMops mops-isat.inx
+
+# Mole fractions and the temperature relative to its initial value must
+# differ by at most the tolerance of <isat>.
+perl - isat1-direct-chem.csv isat1-isat-chem.csv 1.0e-4 <<'PERL'
+my ($direct, $isat, $tol) = @ARGV;
+open(my $a, '<', $direct) or die "Cannot open $direct\n";
+open(my $b, '<', $isat) or die "Cannot open $isat\n";
+my @head = split /,/, <$a>;
+<$b>;
+my ($iT) = grep { $head[$_] =~ /^T / } 0..$#head;
+my ($iRho) = grep { $head[$_] =~ /^Density/ } 0..$#head;
+my ($T0, $fail);
+while (my $la = <$a>) {
+    my $lb = <$b>;
+    die "$isat has fewer steps than $direct\n" unless defined $lb;
+    chomp($la, $lb);
+    my @x = split /,/, $la;
+    my @y = split /,/, $lb;
+    $T0 = $x[$iT] unless defined $T0;
+    for (my $c = 2; $c < $iT; $c += 2) {
+        my $err = abs($x[$c] / $x[$iRho] - $y[$c] / $y[$iRho]);
+        if ($err > $tol) {
+            print "Step $x[0], $head[$c]: mole fraction differs by $err\n";
+            $fail = 1;
+        }
+    }
+    my $err = abs($x[$iT] - $y[$iT]) / $T0;
+    if ($err > $tol) {
+        print "Step $x[0]: temperature differs by $err of its initial value\n";
+        $fail = 1;
+    }
+}
+exit($fail ? 1 : 0);
+PERL
+if(($?!=0))
+  then
+    echo "****** Tabulated and direct solutions differ ******"
+    exit 1
+fi
+
+# The query counts are output with the CPU times of the ISAT run only.
+perl - isat1-direct-cput.csv isat1-isat-cput.csv <<'PERL'
+my ($direct, $isat) = @ARGV;
+open(my $a, '<', $direct) or die "Cannot open $direct\n";
+if (<$a> =~ /ISAT/) {
+    print "$direct has ISAT columns\n";
+    exit 1;
+}
+open(my $b, '<', $isat) or die "Cannot open $isat\n";
+my @head = split /,/, <$b>;
+chomp @head;
+my %col;
+for my $name ("ISAT Retrieves", "ISAT Grows", "ISAT Adds", "ISAT Direct Evaluations") {
+    ($col{$name}) = grep { $head[$_] eq $name } 0..$#head;
+    unless (defined $col{$name}) {
+        print "$isat has no column $name\n";
+        exit 1;
+    }
+}
+my $last;
+$last = $_ while <$b>;
+chomp $last;
+my @v = split /,/, $last;
+# The counts are averaged over the two runs.
+if ($v[$col{"ISAT Adds"}] <= 0 || $v[$col{"ISAT Retrieves"}] <= 0) {
+    print "Expected both added and retrieved queries, got $last\n";
+    exit 1;
+}
+if ($v[$col{"ISAT Direct Evaluations"}] != 0) {
+    print "Expected no direct evaluations with the table not full, got $last\n";
+    exit 1;
+}
+exit 0;
+PERL
+if(($?!=0))
+  then
+    echo "****** ISAT query counts are missing from the CPU time output ******"
+    exit 1
+fi
+
+# All tests passed
+echo "All tests passed"
+rm -f isat1-*
+exit 0
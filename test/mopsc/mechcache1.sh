@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Checks the binary mechanism cache of mops: the first run writes a cache,
+# the second run reads it and must give identical results, and a changed
+# mechanism file must get a cache of its own.
+#
+# Arguments: path to mops and working directory.
+program=$1
+
+if test -z "$program"
+  then
+    echo "No executable supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+cacheDir=mechcache1-cache
+rm -rf $cacheDir
+
+# run mops on the problem of regress1 with the given mechanism file
+runMops() {
+  "$program" --flamepp -p -g regress1/regress1.inp -r mechcache1/mechcache1.inx -s regress1/regress1.xml -c "$1" -t regress1/therm.dat --mechcache $cacheDir
+  if(($?!=0))
+    then
+      echo "****** Simulation failed ******"
+      exit 255
+  fi
+}
+
+runMops regress1/chem.inp
+if(( `ls $cacheDir/sprog-mech-*.bin | wc -l` != 1 ))
+  then
+    echo "****** No mechanism cache was written ******"
+    exit 1
+fi
+mv mechcache1-part.csv mechcache1-part-parsed.csv
+mv mechcache1-chem.csv mechcache1-chem-parsed.csv
+
+runMops regress1/chem.inp
+for f in part chem
+do
+  if ! cmp -s mechcache1-$f.csv mechcache1-$f-parsed.csv
+    then
+      echo "****** Results with the cached mechanism differ in mechcache1-$f.csv ******"
+      exit 1
+  fi
+done
+
+cp regress1/chem.inp mechcache1-chem.inp
+echo "! changed" >> mechcache1-chem.inp
+runMops mechcache1-chem.inp
+if(( `ls $cacheDir/sprog-mech-*.bin | wc -l` != 2 ))
+  then
+    echo "****** The changed mechanism did not get its own cache ******"
+    exit 1
+fi
+
+# All tests passed
+echo "All tests passed"
+rm -rf $cacheDir mechcache1-* mechcache1.aux mechcache1.sim mechcache1.sen mechcache1\(*
+exit 0
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Checks the particle size distributions accumulated by mops during the
+# runs: no save points should be written, and the number densities in all
+# bins of each histogram must add up to M0.
+#
+# Arguments: path to mops and working directory.
+program=$1
+
+if test -z "$program"
+  then
+    echo "No executable supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+# run mops on the problem of regress1 with in-situ histograms
+"$program" --flamepp -p -g regress1/regress1.inp -r psd1/psd1.inx -s regress1/regress1.xml -c regress1/chem.inp -t regress1/therm.dat
+
+# capture exit value of simulation
+simulationResult=$?
+
+if((simulationResult==0))
+  then
+    echo "Finished simulation"
+    echo "========================"
+else
+  echo "****** Simulation failed ******"
+  exit 255
+fi
+
+if ls psd1\(*.sav > /dev/null 2>&1
+  then
+    echo "****** Save points were written ******"
+    exit 1
+fi
+
+for name in pah dcol
+do
+  psdFile="psd1-psd-${name}.csv"
+  if test ! -f "$psdFile"
+    then
+      echo "****** $psdFile was not written ******"
+      exit 1
+  fi
+
+  # Column 3 holds the distribution at 0.1s and column 5 that at 1s, the
+  # M0 column of the particle stats is column 5.
+  col=3
+  for t in 0.1 1
+  do
+    total=`tail -n +2 "$psdFile" | awk -F, -v c=$col '{s+=$c} END {printf "%.12e", s}'`
+    m0=`awk -F, -v t=$t 'NR>1 && $2==t {printf "%.12e", $5}' psd1-part.csv`
+    echo "$psdFile at ${t}s: total $total, M0 $m0"
+    if ! awk -v a=$total -v b=$m0 'BEGIN {d=a-b; if (d<0) d=-d; exit !(d <= 1e-9*b)}'
+      then
+        echo "****** $psdFile does not add up to M0 ******"
+        exit 1
+    fi
+    ((col+=2))
+  done
+done
+
+# All tests passed
+echo "All tests passed"
+rm -f psd1-* psd1.aux psd1.sim psd1.sen psd1\(*
+exit 0
@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Checks that the binary PSL files written by mops, converted back to CSV
+# by pslToCSV, match the CSV PSL files written by mops itself.
+#
+# Arguments: path to mops, working directory and path to pslToCSV.
+program=$1
+converter=$3
+
+if test -z "$program" || test -z "$converter"
+  then
+    echo "No executables supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+# run mops on the problem of regress1 with both PSL formats
+"$program" --flamepp -p -g regress1/regress1.inp -r pslbinary1/pslbinary1.inx -s regress1/regress1.xml -c regress1/chem.inp -t regress1/therm.dat
+
+# capture exit value of simulation
+simulationResult=$?
+
+if((simulationResult==0))
+  then
+    echo "Finished simulation"
+    echo "========================"
+else
+  echo "****** Simulation failed ******"
+  exit 255
+fi
+
+for t in 0.1 1
+do
+  csvFile="pslbinary1-psl(${t}s).csv"
+  binFile="pslbinary1-psl(${t}s).bin"
+
+  "$converter" --output pslbinary1-converted.csv "$binFile"
+  if(($?!=0))
+    then
+      echo "****** Conversion of $binFile failed ******"
+      exit 1
+  fi
+
+  if ! cmp -s "$csvFile" pslbinary1-converted.csv
+    then
+      echo "****** $binFile does not match $csvFile ******"
+      exit 1
+  fi
+done
+
+# All tests passed
+echo "All tests passed"
+rm -f pslbinary1-* pslbinary1.aux pslbinary1.sim pslbinary1.sen pslbinary1\(*
+exit 0
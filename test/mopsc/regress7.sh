@@ -165,12 +165,25 @@ EOF
 CheckErr $?
 fi
 
+# Load part of the ensemble file and check the initial particle count
+echo "Running calculation from particles 16 to 47 of the ensemble file..."
+temp3="mops-3-silica.inx"
+eval "sed 's/<file>/<file first=\"16\" count=\"32\">/' $temp1" > $temp3
+eval "sed -i 's/<filename>$filenames</<filename>3-silica</' $temp3"
+"$exe" -p --strang -r $temp3 -s "sweep-2-silica.xml" > /dev/null
+CheckErr $?
+count=`sed -n 2p 3-silica-part.csv | cut -d, -f3`
+if [ "$count" != "32" ]; then
+    echo "TEST FAILURE!!! LOADED $count PARTICLES INSTEAD OF 32."
+    exit 1
+fi
+
 # If we've made it here, everything has been going well!
 echo "All tests passed. :D"
 # Remove temporary files
 echo "Cleaning files.."
-rm -f 1-silica* 2-silica*
-rm -f $temp1
+rm -f 1-silica* 2-silica* 3-silica*
+rm -f $temp1 $temp3
 
 cd ..
 
@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# Checks the sensitivity RHS function of mops: the sensitivities of an
+# adiabatic hydrogen ignition to all the Arrhenius parameters must be the
+# same when CVODES finds the sensitivity RHS by difference quotients and
+# when it is given the analytic parameter derivatives.  The mechanism has
+# a fall-off reaction, which has no analytic derivatives.
+#
+# Arguments: path to mops and working directory.
+program=$1
+
+if test -z "$program"
+  then
+    echo "No executable supplied to $0"
+    exit 255
+fi
+
+# An optional second argument may specify the working directory
+if test -n "$2"
+  then
+    cd "$2"
+fi
+
+cd sensi1
+
+# run mops with the given sensitivity settings
+runMops() {
+  "$program" -p -q "$1.xml" > /dev/null
+  if(($?!=0))
+    then
+      echo "****** Simulation with $1.xml failed ******"
+      exit 255
+  fi
+  mv hydrogen-sensi.csv "hydrogen-$1.csv"
+}
+
+runMops sensi-dq
+runMops sensi-analytic
+
+# Each difference must be within 1% of the largest sensitivity of the same
+# variable to the same kind of parameter.
+perl - hydrogen-sensi-dq.csv hydrogen-sensi-analytic.csv <<'PERL'
+my (%a, %b, %scale);
+for my $f ([$ARGV[0], \%a], [$ARGV[1], \%b]) {
+    open(my $in, '<', $f->[0]) or die "Cannot open $f->[0]\n";
+    <$in>;
+    while (<$in>) {
+        chomp;
+        my @v = split /,/;
+        my $key = "$v[0],$v[1],$v[2]";
+        for (my $c = 3; $c < @v; $c += 2) {
+            $f->[1]{$key}[$c] = $v[$c];
+            my $s = "$v[1],$c";
+            $scale{$s} = abs($v[$c]) if abs($v[$c]) > ($scale{$s} // 0);
+        }
+    }
+}
+my $fail = 0;
+for my $key (keys %a) {
+    my ($t, $type) = split /,/, $key;
+    die "Missing sensitivities at $key\n" unless exists $b{$key};
+    for (my $c = 3; $c < @{$a{$key}}; $c += 2) {
+        my $err = abs($a{$key}[$c] - $b{$key}[$c]);
+        if ($err > 0.01 * $scale{"$type,$c"}) {
+            print "Sensitivity $key column $c: $a{$key}[$c] vs $b{$key}[$c]\n";
+            $fail = 1;
+        }
+    }
+}
+exit $fail;
+PERL
+if(($?!=0))
+  then
+    echo "****** Analytic and difference quotient sensitivities differ ******"
+    exit 1
+fi
+
+# All tests passed
+echo "All tests passed"
+rm -f hydrogen*
+exit 0